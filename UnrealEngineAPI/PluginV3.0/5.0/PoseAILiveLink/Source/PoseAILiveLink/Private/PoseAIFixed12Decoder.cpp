@@ -0,0 +1,326 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIFixed12Decoder.h"
+#include "PoseAIStructs.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON && PLATFORM_64BITS
+	#define POSEAI_FIXED12_NEON 1
+	#include <arm_neon.h>
+#else
+	#define POSEAI_FIXED12_NEON 0
+#endif
+
+#if defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2
+	#define POSEAI_FIXED12_AVX2 1
+#else
+	#define POSEAI_FIXED12_AVX2 0
+#endif
+
+#if defined(PLATFORM_ALWAYS_HAS_SSE4_1) && PLATFORM_ALWAYS_HAS_SSE4_1
+	#define POSEAI_FIXED12_SSE 1
+#else
+	#define POSEAI_FIXED12_SSE 0
+#endif
+
+#if POSEAI_FIXED12_AVX2 || POSEAI_FIXED12_SSE
+	#include <immintrin.h>
+#endif
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+static const char Fixed12Alphabet[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// characters are decoded in chunks so the intermediate buffers can live on the stack
+static const int32 Fixed12ChunkChars = 256;
+
+/*
+ * The float tables are taken from FixedB64pairToFloat rather than computed as value * 2 / 4094 - 1, as the arithmetic form
+ * rounds differently for over half of the 4096 values.  A pair decodes to First[high] + Second[low], the same float add as the original.
+ */
+struct FFixed12Tables
+{
+	uint8 Sextet[256];
+	float First[64];
+	float Second[64];
+
+	FFixed12Tables() {
+		FMemory::Memset(Sextet, 0xFF, sizeof(Sextet));
+		for (int32 i = 0; i < 64; ++i) {
+			Sextet[static_cast<uint8>(Fixed12Alphabet[i])] = (uint8)i;
+			// 'A' maps to 0.0f as a second character and ' ' to 0.0f as a first character
+			First[i] = FixedB64pairToFloat(Fixed12Alphabet[i], 'A');
+			Second[i] = FixedB64pairToFloat(' ', Fixed12Alphabet[i]);
+		}
+	}
+};
+
+static const FFixed12Tables GFixed12Tables;
+
+
+/* shuffle based base64 to 6 bit mapping (W. Mula and D. Lemire), rejecting anything outside the standard alphabet */
+#if POSEAI_FIXED12_AVX2
+static FORCEINLINE bool Fixed12MapBlock32(const uint8* src, uint8* dst) {
+	const __m256i lutLo = _mm256_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lutHi = _mm256_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lutRoll = _mm256_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+	const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+	const __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+	const __m256i lo = _mm256_and_si256(in, mask2F);
+	const __m256i invalid = _mm256_and_si256(_mm256_shuffle_epi8(lutLo, lo), _mm256_shuffle_epi8(lutHi, hi));
+	if (!_mm256_testz_si256(invalid, invalid))
+		return false;
+	const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, mask2F), hi));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi8(in, roll));
+	return true;
+}
+#endif
+
+#if POSEAI_FIXED12_SSE
+static FORCEINLINE bool Fixed12MapBlock16(const uint8* src, uint8* dst) {
+	const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+	const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+	const __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+	const __m128i lo = _mm_and_si128(in, mask2F);
+	const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lutLo, lo), _mm_shuffle_epi8(lutHi, hi));
+	if (!_mm_testz_si128(invalid, invalid))
+		return false;
+	const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(in, mask2F), hi));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi8(in, roll));
+	return true;
+}
+#elif POSEAI_FIXED12_NEON
+static FORCEINLINE bool Fixed12MapBlock16(const uint8* src, uint8* dst) {
+	static const uint8 lutLoBytes[16] = { 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A };
+	static const uint8 lutHiBytes[16] = { 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 };
+	static const uint8 lutRollBytes[16] = { 0, 16, 19, 4, 0xBF, 0xBF, 0xB9, 0xB9, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+	// tbl returns 0 for indices past 15 rather than masking them, so the nibbles are taken exactly
+	const uint8x16_t in = vld1q_u8(src);
+	const uint8x16_t hi = vshrq_n_u8(in, 4);
+	const uint8x16_t lo = vandq_u8(in, vdupq_n_u8(0x0F));
+	const uint8x16_t invalid = vandq_u8(vqtbl1q_u8(vld1q_u8(lutLoBytes), lo), vqtbl1q_u8(vld1q_u8(lutHiBytes), hi));
+	if (vmaxvq_u8(invalid) != 0)
+		return false;
+	const uint8x16_t roll = vqtbl1q_u8(vld1q_u8(lutRollBytes), vaddq_u8(vceqq_u8(in, vdupq_n_u8(0x2F)), hi));
+	vst1q_u8(dst, vaddq_u8(in, roll));
+	return true;
+}
+#endif
+
+/* maps num characters to their 6 bit values.  Returns false if any character is outside the standard alphabet */
+static bool Fixed12MapSextets(const uint8* chars, int32 num, uint8* sextets) {
+	int32 i = 0;
+#if POSEAI_FIXED12_AVX2
+	for (; i + 32 <= num; i += 32) {
+		if (!Fixed12MapBlock32(chars + i, sextets + i))
+			return false;
+	}
+#endif
+#if POSEAI_FIXED12_SSE || POSEAI_FIXED12_NEON
+	for (; i + 16 <= num; i += 16) {
+		if (!Fixed12MapBlock16(chars + i, sextets + i))
+			return false;
+	}
+#endif
+	uint8 invalid = 0;
+	for (; i < num; ++i) {
+		sextets[i] = GFixed12Tables.Sextet[chars[i]];
+		invalid |= sextets[i];
+	}
+	return (invalid & 0xC0) == 0;
+}
+
+/* combines pairs of 6 bit values into floats */
+static void Fixed12SextetsToFloats(const uint8* sextets, int32 numValues, float* out) {
+	int32 i = 0;
+#if POSEAI_FIXED12_AVX2
+	const __m128i deinterleave = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+	for (; i + 8 <= numValues; i += 8) {
+		const __m128i split = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sextets + 2 * i)), deinterleave);
+		const __m256 first = _mm256_i32gather_ps(GFixed12Tables.First, _mm256_cvtepu8_epi32(split), 4);
+		const __m256 second = _mm256_i32gather_ps(GFixed12Tables.Second, _mm256_cvtepu8_epi32(_mm_srli_si128(split, 8)), 4);
+		_mm256_storeu_ps(out + i, _mm256_add_ps(first, second));
+	}
+#endif
+	for (; i < numValues; ++i)
+		out[i] = GFixed12Tables.First[sextets[2 * i]] + GFixed12Tables.Second[sextets[2 * i + 1]];
+}
+
+static FORCEINLINE const uint8* Fixed12NarrowChars(const uint8* chars, int32 num, uint8* narrow) {
+	return chars;
+}
+
+// anything beyond ASCII is marked invalid, sending the chunk through FixedB64pairToFloat with the original characters
+static FORCEINLINE const uint8* Fixed12NarrowChars(const TCHAR* chars, int32 num, uint8* narrow) {
+	for (int32 i = 0; i < num; ++i)
+		narrow[i] = (static_cast<uint32>(chars[i]) < 0x80) ? static_cast<uint8>(chars[i]) : 0xFF;
+	return narrow;
+}
+
+template <typename CharType>
+static int32 DecodeFixed12Floats(const CharType* chars, int32 numChars, float* out) {
+	const int32 numValues = FMath::Max(0, numChars / 2);
+	uint8 narrow[Fixed12ChunkChars];
+	uint8 sextets[Fixed12ChunkChars];
+	for (int32 start = 0; start < numValues * 2; start += Fixed12ChunkChars) {
+		const int32 len = FMath::Min(Fixed12ChunkChars, numValues * 2 - start);
+		if (Fixed12MapSextets(Fixed12NarrowChars(chars + start, len, narrow), len, sextets)) {
+			Fixed12SextetsToFloats(sextets, len / 2, out + start / 2);
+		}
+		else {
+			for (int32 i = start; i < start + len; i += 2)
+				out[i / 2] = FixedB64pairToFloat(chars[i], chars[i + 1]);
+		}
+	}
+	return numValues;
+}
+
+template <typename CharType>
+static int32 DecodeFixed12Quats(const CharType* chars, int32 numChars, TArray<FQuat>& quatArray) {
+	const int32 numQuats = FMath::Max(0, numChars / 8);
+	float values[Fixed12ChunkChars / 2];
+	quatArray.Reserve(quatArray.Num() + numQuats);
+	for (int32 start = 0; start < numQuats * 8; start += Fixed12ChunkChars) {
+		const int32 len = FMath::Min(Fixed12ChunkChars, numQuats * 8 - start);
+		DecodeFixed12Floats(chars + start, len, values);
+		for (int32 i = 0; i < len / 2; i += 4) {
+			FQuat quat(values[i], values[i + 1], values[i + 2], values[i + 3]);
+			quat.Normalize();
+			quatArray.Add(quat);
+		}
+	}
+	return numQuats;
+}
+
+
+float Fixed12ToFloat(uint32 value) {
+	return GFixed12Tables.First[(value >> 6) & 63] + GFixed12Tables.Second[value & 63];
+}
+
+int32 Fixed12DecodeFloats(const UTF8CHAR* chars, int32 numChars, float* out) {
+	return DecodeFixed12Floats(reinterpret_cast<const uint8*>(chars), numChars, out);
+}
+
+int32 Fixed12DecodeFloats(const TCHAR* chars, int32 numChars, float* out) {
+	return DecodeFixed12Floats(chars, numChars, out);
+}
+
+int32 Fixed12DecodeQuats(const UTF8CHAR* chars, int32 numChars, TArray<FQuat>& quatArray) {
+	return DecodeFixed12Quats(reinterpret_cast<const uint8*>(chars), numChars, quatArray);
+}
+
+int32 Fixed12DecodeQuats(const TCHAR* chars, int32 numChars, TArray<FQuat>& quatArray) {
+	return DecodeFixed12Quats(chars, numChars, quatArray);
+}
+
+const TCHAR* Fixed12DecoderPath() {
+#if POSEAI_FIXED12_AVX2
+	return TEXT("AVX2");
+#elif POSEAI_FIXED12_SSE
+	return TEXT("SSE4.1");
+#elif POSEAI_FIXED12_NEON
+	return TEXT("NEON");
+#else
+	return TEXT("scalar");
+#endif
+}
+
+
+/*
+ * Console check and microbenchmark for the decoder:  PoseAI.Fixed12Benchmark [iterations]
+ * Compares every base64 pair and a set of random strings (including invalid characters) against FixedB64pairToFloat bit for bit,
+ * then times the original FString path (FStringFixed12ToFloat + FlatArrayToQuats) against Fixed12DecodeQuats on MetaHuman sized rotation strings.
+ */
+static void RunFixed12Benchmark(const TArray<FString>& Args) {
+	const int32 iterations = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+	int32 mismatches = 0;
+	TArray<float> decoded;
+	FString allPairs;
+	for (int32 a = 0; a < 256; ++a) {
+		for (int32 b = 0; b < 256; ++b) {
+			allPairs.AppendChar((TCHAR)FMath::Max(a, 1));
+			allPairs.AppendChar((TCHAR)FMath::Max(b, 1));
+		}
+	}
+	decoded.SetNumUninitialized(allPairs.Len() / 2);
+	Fixed12DecodeFloats(*allPairs, allPairs.Len(), decoded.GetData());
+	for (int32 i = 0; i < decoded.Num(); ++i) {
+		const float expected = FixedB64pairToFloat(allPairs[2 * i], allPairs[2 * i + 1]);
+		mismatches += (FMemory::Memcmp(&expected, &decoded[i], sizeof(float)) != 0) ? 1 : 0;
+	}
+	for (uint32 value = 0; value < 4096; ++value) {
+		const float expected = FixedB64pairToFloat(Fixed12Alphabet[value >> 6], Fixed12Alphabet[value & 63]);
+		const float actual = Fixed12ToFloat(value);
+		mismatches += (FMemory::Memcmp(&expected, &actual, sizeof(float)) != 0) ? 1 : 0;
+	}
+
+	FRandomStream random(1234);
+	for (int32 trial = 0; trial < 1000; ++trial) {
+		TArray<UTF8CHAR> utf8;
+		const int32 len = random.RandRange(0, 600);
+		for (int32 i = 0; i < len; ++i) {
+			const bool invalid = random.FRand() < 0.002f;
+			utf8.Add((UTF8CHAR)(invalid ? random.RandRange(1, 255) : Fixed12Alphabet[random.RandRange(0, 63)]));
+		}
+		decoded.SetNumUninitialized(len / 2);
+		Fixed12DecodeFloats(utf8.GetData(), len, decoded.GetData());
+		for (int32 i = 0; i < len / 2; ++i) {
+			const float expected = FixedB64pairToFloat((char)utf8[2 * i], (char)utf8[2 * i + 1]);
+			mismatches += (FMemory::Memcmp(&expected, &decoded[i], sizeof(float)) != 0) ? 1 : 0;
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("PoseAI: Fixed12 decoder (%s) verification, %d mismatches"), Fixed12DecoderPath(), mismatches);
+
+	// 23 body rotations, as streamed for the MetaHuman rig
+	FString rotA;
+	for (int32 i = 0; i < 23 * 8; ++i)
+		rotA.AppendChar((TCHAR)Fixed12Alphabet[random.RandRange(0, 63)]);
+
+	TArray<float> flatArray;
+	TArray<FQuat> quatArray;
+	double checksum = 0.0;
+	double startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; ++i) {
+		flatArray.Reset();
+		quatArray.Reset();
+		FStringFixed12ToFloat(rotA, flatArray);
+		FlatArrayToQuats(flatArray, quatArray);
+		checksum += quatArray[i % quatArray.Num()].X;
+	}
+	const double legacySeconds = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; ++i) {
+		quatArray.Reset();
+		Fixed12DecodeQuats(*rotA, rotA.Len(), quatArray);
+		checksum += quatArray[i % quatArray.Num()].X;
+	}
+	const double decoderSeconds = FPlatformTime::Seconds() - startTime;
+
+	UE_LOG(LogTemp, Display, TEXT("PoseAI: Fixed12 decoder benchmark, %d iterations of %d quaternions.  Original %.1f ns/frame, %s %.1f ns/frame (checksum %f)"),
+		iterations, quatArray.Num(), legacySeconds * 1.0e9 / iterations, Fixed12DecoderPath(), decoderSeconds * 1.0e9 / iterations, checksum);
+}
+
+static FAutoConsoleCommand Fixed12BenchmarkCommand(
+	TEXT("PoseAI.Fixed12Benchmark"),
+	TEXT("Verifies the vectorized Fixed12 decoder against FixedB64pairToFloat and times it against the original path.  Optional argument: iterations"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunFixed12Benchmark));
+
+#undef LOCTEXT_NAMESPACE
@@ -2,6 +2,7 @@
 
 #include "PoseAILiveLinkFaceSubSource.h"
 #include "PoseAIStructs.h"
+#include "PoseAIFixed12Decoder.h"
 #include "Features/IModularFeatures.h"
 
 #define LOCTEXT_NAMESPACE "PoseAI"
@@ -15,20 +16,27 @@ static FName ParseEnumName(FName EnumName)
 }
 
 
-PoseAILiveLinkFaceSubSource::PoseAILiveLinkFaceSubSource(FLiveLinkSubjectKey& poseSubjectKey, ILiveLinkClient* liveLinkClient) : liveLinkClient(liveLinkClient) {
+PoseAILiveLinkFaceSubSource::PoseAILiveLinkFaceSubSource(FLiveLinkSubjectKey& poseSubjectKey, ILiveLinkClient* liveLinkClient) :
+	liveLinkClient(liveLinkClient),
+	pipelineStats(&FPoseAIPipelineStats::ForSource(poseSubjectKey.SubjectName.Name)) {
 
 	//Update the subject key to match latest one
 	subjectKey = FLiveLinkSubjectKey(poseSubjectKey.Source, FName(*(FString("Face-") + poseSubjectKey.SubjectName.ToString())));
 	//Update property names array
-	StaticData.PropertyNames.Reset((int32)PoseAIFaceBlendShape::MAX);
-
-	//Iterate through all valid blend shapes to extract names
-	const UEnum* EnumPtr = StaticEnum<PoseAIFaceBlendShape>();
-	for (int32 Shape = 0; Shape < (int32)PoseAIFaceBlendShape::MAX; Shape++)
-	{
-		const FName ShapeName = ParseEnumName(EnumPtr->GetNameByValue(Shape));
-		StaticData.PropertyNames.Add(ShapeName);
-	}
+	StaticData.PropertyNames = BlendShapeNames();
+}
+
+const TArray<FName>& PoseAILiveLinkFaceSubSource::BlendShapeNames() {
+	static const TArray<FName> names = []() {
+		TArray<FName> shapeNames;
+		shapeNames.Reserve((int32)PoseAIFaceBlendShape::MAX);
+		//Iterate through all valid blend shapes to extract names
+		const UEnum* EnumPtr = StaticEnum<PoseAIFaceBlendShape>();
+		for (int32 Shape = 0; Shape < (int32)PoseAIFaceBlendShape::MAX; Shape++)
+			shapeNames.Add(ParseEnumName(EnumPtr->GetNameByValue(Shape)));
+		return shapeNames;
+	}();
+	return names;
 }
 
 
@@ -71,45 +79,95 @@ bool PoseAILiveLinkFaceSubSource::RequestSubSourceShutdown()
 
 
 
-void PoseAILiveLinkFaceSubSource::UpdateFace(TSharedPtr<FJsonObject> jsonPose)
+bool PoseAILiveLinkFaceSubSource::DecodeFace(TSharedPtr<FJsonObject> jsonPose, TArray<float>& outValues)
+{
+	if (jsonPose == nullptr || !jsonPose->HasField("Face"))
+		return false;
+	uint32 packetFormat = 1;
+	jsonPose->TryGetNumberField("PF", packetFormat);
+
+	outValues.Reset((int32)PoseAIFaceBlendShape::MAX);
+	if (packetFormat == 0) {
+		auto blendShapes = jsonPose->GetArrayField("Face");
+		if (blendShapes.Num() < (int32)PoseAIFaceBlendShape::MAX)
+			return false;
+		// Iterate through all of the blend shapes copying them into the LiveLink data type
+		for (int32 Shape = 0; Shape < (int32)PoseAIFaceBlendShape::MAX; Shape++)
+			outValues.Add(blendShapes[Shape]->AsNumber());
+	}
+	else {
+		FStringFixed12ToFloat(jsonPose->GetStringField("Face"), outValues);
+		if (outValues.Num() < (int32)PoseAIFaceBlendShape::MAX)
+			return false;
+		outValues.SetNum((int32)PoseAIFaceBlendShape::MAX);
+	}
+	return true;
+}
+
+bool PoseAILiveLinkFaceSubSource::DecodeFace(const FPoseAIBinaryPacket& packet, TArray<float>& outValues)
+{
+	if (packet.GetSectionCount(EPoseAIBinarySection::Face) < (int32)PoseAIFaceBlendShape::MAX)
+		return false;
+	outValues.Reset(packet.GetSectionCount(EPoseAIBinarySection::Face));
+	packet.ReadFixed12(EPoseAIBinarySection::Face, outValues);
+	outValues.SetNum((int32)PoseAIFaceBlendShape::MAX);
+	return true;
+}
+
+bool PoseAILiveLinkFaceSubSource::DecodeFace(const FPoseAICompactFrame& frame, TArray<float>& outValues)
+{
+	if (!frame.bHasFace || frame.Face.Len() < 2 * (int32)PoseAIFaceBlendShape::MAX)
+		return false;
+	outValues.SetNumUninitialized((int32)PoseAIFaceBlendShape::MAX);
+	Fixed12DecodeFloats(frame.Face.GetData(), 2 * (int32)PoseAIFaceBlendShape::MAX, outValues.GetData());
+	return true;
+}
+
+bool PoseAILiveLinkFaceSubSource::DecodeFace(const FPoseAIVerboseFrame& frame, TArray<float>& outValues)
+{
+	if (!frame.bHasFace || frame.Face.Num() < (int32)PoseAIFaceBlendShape::MAX)
+		return false;
+	outValues.Reset((int32)PoseAIFaceBlendShape::MAX);
+	outValues.Append(frame.Face.GetData(), (int32)PoseAIFaceBlendShape::MAX);
+	return true;
+}
+
+
+template <typename FrameType>
+void PoseAILiveLinkFaceSubSource::PushFace(const FrameType& frame)
 {
+	POSEAI_TRACE_SCOPE(UpdateFace);
+	FPoseAIPipelineScope faceScope(*pipelineStats, EPoseAIPipelineTimer::Face);
 	if (liveLinkClient) {
 		FLiveLinkFrameDataStruct FrameDataStruct(FLiveLinkBaseFrameData::StaticStruct());
 		FLiveLinkBaseFrameData* FrameData = FrameDataStruct.Cast<FLiveLinkBaseFrameData>();
-		FrameData->WorldTime = FPlatformTime::Seconds();
-		//FrameData->MetaData.SceneTime = FrameTime;
-		
-		FrameData->PropertyValues.Reserve((int32)PoseAIFaceBlendShape::MAX);
-		if (jsonPose != nullptr && jsonPose->HasField("Face")) {
-			uint32 packetFormat = 1;
-			jsonPose->TryGetNumberField("PF", packetFormat);
-
-			if (packetFormat == 0) {
-				auto blendShapes = jsonPose->GetArrayField("Face");
-				// Iterate through all of the blend shapes copying them into the LiveLink data type
-				for (int32 Shape = 0; Shape < (int32)PoseAIFaceBlendShape::MAX; Shape++)
-				{
-					const float CurveValue = blendShapes[Shape]->AsNumber();
-					FrameData->PropertyValues.Add(CurveValue);
-				}
-			}
-			else {
-				TArray<float> blendShapes;
-				FString compactFace = jsonPose->GetStringField("Face");
-				FStringFixed12ToFloat(compactFace, blendShapes);
-				// Iterate through all of the blend shapes copying them into the LiveLink data type
-				for (int32 Shape = 0; Shape < (int32)PoseAIFaceBlendShape::MAX; Shape++)
-				{
-					const float CurveValue = blendShapes[Shape];
-					FrameData->PropertyValues.Add(CurveValue);
-				}
-			}
-			
-
+		// decoded straight into the frame, which is only pushed if the packet had a face
+		if (DecodeFace(frame, FrameData->PropertyValues)) {
+			FrameData->WorldTime = FPlatformTime::Seconds();
 			// Share the data locally with the LiveLink client
 			liveLinkClient->PushSubjectFrameData_AnyThread(subjectKey, MoveTemp(FrameDataStruct));
 		}
 	}
 }
 
+void PoseAILiveLinkFaceSubSource::UpdateFace(TSharedPtr<FJsonObject> jsonPose)
+{
+	PushFace(jsonPose);
+}
+
+void PoseAILiveLinkFaceSubSource::UpdateFace(const FPoseAIBinaryPacket& packet)
+{
+	PushFace(packet);
+}
+
+void PoseAILiveLinkFaceSubSource::UpdateFace(const FPoseAICompactFrame& frame)
+{
+	PushFace(frame);
+}
+
+void PoseAILiveLinkFaceSubSource::UpdateFace(const FPoseAIVerboseFrame& frame)
+{
+	PushFace(frame);
+}
+
 #undef LOCTEXT_NAMESPACE
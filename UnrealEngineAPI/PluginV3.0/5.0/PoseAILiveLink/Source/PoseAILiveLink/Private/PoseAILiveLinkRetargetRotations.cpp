@@ -9,6 +9,7 @@
 #include "LiveLinkTypes.h"
 #include "Roles/LiveLinkAnimationRole.h"
 #include "Roles/LiveLinkAnimationTypes.h"
+#include "PoseAILatencyTracker.h"
 
 
 UPoseAILiveLinkRetargetRotations::UPoseAILiveLinkRetargetRotations(const FObjectInitializer& ObjectInitializer)
@@ -46,37 +47,48 @@ void UPoseAILiveLinkRetargetRotations::OnBlueprintClassCompiled(UBlueprint* Targ
 
 void UPoseAILiveLinkRetargetRotations::BuildPoseFromAnimationData(float DeltaTime, const FLiveLinkSkeletonStaticData* InSkeletonData, const FLiveLinkAnimationFrameData* InFrameData, FCompactPose& OutPose)
 {
-    auto rootTransform = InFrameData->Transforms[0];
-    auto rootTranslation = rootTransform.GetTranslation() * scaleTranslation;
-    auto rootZ = FVector3d(0.0f, 0.0f, rootTranslation.Z);
-    auto rootXY = FVector3d(rootTranslation.X, rootTranslation.Y, 0.0f);
-    for (int32 i = 0; i < InSkeletonData->BoneNames.Num(); i++)
+    if (FPoseAILatencyTracker::IsEnabled())
+        FPoseAILatencyTracker::Get().MarkEvaluated(InFrameData->WorldTime.GetSourceTime());
+    const FBoneContainer& requiredBones = OutPose.GetBoneContainer();
+    if (cachedBoneContainer != &requiredBones || cachedSerialNumber != requiredBones.GetSerialNumber() || cachedBoneNames != InSkeletonData->BoneNames)
+        RebuildBoneMap(InSkeletonData, OutPose);
+
+    const int32 numBones = FMath::Min(compactIndices.Num(), InFrameData->Transforms.Num());
+    if (numBones < 1)
+        return;
+    const FVector rootTranslation = InFrameData->Transforms[0].GetTranslation() * scaleTranslation;
+    for (int32 i = 0; i < numBones; i++)
+    {
+        const FCompactPoseBoneIndex boneIndex = compactIndices[i];
+        if (!boneIndex.IsValid())
+            continue;
+        // root motion goes on the root horizontally and on the hips vertically, other bones keep their reference translations
+        FVector translation = refTranslations[i];
+        if (i == 0)
+            translation += FVector(rootTranslation.X, rootTranslation.Y, 0.0f);
+        else if (i == 1)
+            translation.Z += rootTranslation.Z;
+        OutPose[boneIndex].SetComponents(InFrameData->Transforms[i].GetRotation(), translation, refScales[i]);
+    }
+}
+
+void UPoseAILiveLinkRetargetRotations::RebuildBoneMap(const FLiveLinkSkeletonStaticData* InSkeletonData, const FCompactPose& OutPose)
+{
+    const FBoneContainer& requiredBones = OutPose.GetBoneContainer();
+    const int32 numBones = InSkeletonData->BoneNames.Num();
+    cachedBoneContainer = &requiredBones;
+    cachedSerialNumber = requiredBones.GetSerialNumber();
+    cachedBoneNames = InSkeletonData->BoneNames;
+    compactIndices.Reset(numBones);
+    refTranslations.Reset(numBones);
+    refScales.Reset(numBones);
+    for (int32 i = 0; i < numBones; i++)
     {
-        FName boneName = InSkeletonData->BoneNames[i];
-        auto jointTransform = InFrameData->Transforms[i];
-        const int32 meshIndex = OutPose.GetBoneContainer().GetPoseBoneIndexForBoneName(boneName);
-        if (meshIndex != INDEX_NONE)
-        {
-            FCompactPoseBoneIndex boneIndex = OutPose.GetBoneContainer().MakeCompactPoseIndex(FMeshPoseBoneIndex(meshIndex));
-            if (i == 0)
-            {
-                jointTransform.SetLocation(OutPose.GetRefPose(boneIndex).GetTranslation() + rootXY);
-                jointTransform.SetScale3D(OutPose.GetRefPose(boneIndex).GetScale3D());
-                OutPose[boneIndex] = jointTransform;
-            }
-            
-            else if (i == 1)
-            {
-                jointTransform.SetLocation(OutPose.GetRefPose(boneIndex).GetTranslation() + rootZ);
-                jointTransform.SetScale3D(OutPose.GetRefPose(boneIndex).GetScale3D());
-                OutPose[boneIndex] = jointTransform;
-            }
-            else if (boneIndex != INDEX_NONE)
-            {
-                jointTransform.SetLocation(OutPose.GetRefPose(boneIndex).GetLocation());
-                jointTransform.SetScale3D(OutPose.GetRefPose(boneIndex).GetScale3D());   
-                OutPose[boneIndex] = jointTransform;
-            }
-        }
+        const int32 meshIndex = requiredBones.GetPoseBoneIndexForBoneName(InSkeletonData->BoneNames[i]);
+        const FCompactPoseBoneIndex boneIndex = meshIndex != INDEX_NONE ? requiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(meshIndex)) : FCompactPoseBoneIndex(INDEX_NONE);
+        compactIndices.Add(boneIndex);
+        const FTransform& refPose = boneIndex.IsValid() ? OutPose.GetRefPose(boneIndex) : FTransform::Identity;
+        refTranslations.Add(refPose.GetTranslation());
+        refScales.Add(refPose.GetScale3D());
     }
 }
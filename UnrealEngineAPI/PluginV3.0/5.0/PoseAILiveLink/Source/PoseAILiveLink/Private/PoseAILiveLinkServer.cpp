@@ -2,6 +2,11 @@
 
 #include "PoseAILiveLinkServer.h"
 #include "Async/Async.h"
+#include "Misc/EngineVersionComparison.h"
+#include "PoseAICompactFrame.h"
+#include "PoseAIJsonTokenizer.h"
+#include "PoseAIVerboseFrame.h"
+#include "PoseAINetworkReactor.h"
 #include "PoseAIRig.h"
 #include "PoseAIEventDispatcher.h"
 #include "PoseAILiveLinkNetworkSource.h"
@@ -18,18 +23,24 @@ const FString PoseAILiveLinkServer::fieldVersion = FString(TEXT("version"));
 PoseAILiveLinkServer::PoseAILiveLinkServer(FPoseAIHandshake myHandshake, bool isIPv6, int32 portNum) :
 	listener(MakeShared<PoseAILiveLinkServerListener>(this)),
 	handshake(myHandshake),
-	port(portNum)
+	port(portNum),
+	pipelineStats(&FPoseAIPipelineStats::ForSource(PoseAILiveLinkNetworkSource::SubjectNameFromPort(portNum))),
+	captureTap(MakeShared<FPoseAICaptureTap, ESPMode::ThreadSafe>(PoseAILiveLinkNetworkSource::SubjectNameFromPort(portNum)))
 {
+	captureTap->SetHandshake(handshake.ToString());
 
 	protocolType = (isIPv6) ? FNetworkProtocolTypes::IPv6 : FNetworkProtocolTypes::IPv4;
 	
 	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: Creating Server"));
 	
 	FString serverName = "PoseAIServerSocketOnPort_" + FString::FromInt(port);
-	FString senderName = "PoseAILiveLinkSenderOnPort_" + FString::FromInt(port);
 	serverSocket = BuildUdpSocket(serverName, protocolType, port);
-	poseAILiveLinkRunnable = MakeShared<PoseAILiveLinkReceiverRunnable, ESPMode::ThreadSafe>(port, listener, this);
-	udpSocketSender = MakeShared<FPoseAISocketSender>(serverSocket, *senderName);
+	FString receiverName = "PoseAILiveLink_Receiver_On_Port_" + FString::FromInt(port);
+	udpSocketReceiver = MakeShared<FPoseAIUdpSocketReceiver>(serverSocket, FTimespan::FromMilliseconds(250), *receiverName);
+	udpSocketReceiver->OnBytesReceived().BindSP(listener.ToSharedRef(), &PoseAILiveLinkServerListener::ReceiveBytesDelegate);
+	udpSocketSender = MakeShared<FPoseAISocketSender, ESPMode::ThreadSafe>(serverSocket);
+	// registered last, as packets may be delivered from the reactor thread straight away
+	FPoseAINetworkReactor::Get().Register(udpSocketReceiver);
 		
 	FString myIP;
 	if (protocolType == FNetworkProtocolTypes::IPv6) {
@@ -78,20 +89,23 @@ void PoseAILiveLinkServer::CleanUp() {
 void PoseAILiveLinkServer::CleanUpReceiver() {
 	if (udpSocketReceiver && udpSocketReceiver.IsValid()) {
 		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: Cleaning up socketReceiver"));
-		udpSocketReceiver->Stop();
-	}
-
-	if (poseAILiveLinkRunnable && poseAILiveLinkRunnable.IsValid()) {
-		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: Cleaning up serverThread"));
-		poseAILiveLinkRunnable.Reset();
+		FPoseAIReceiveStats stats = udpSocketReceiver->GetStats();
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: received %llu datagrams in %llu batches (largest %d)"),
+			stats.DatagramsReceived, stats.BatchesRead, stats.LargestBatch);
+		FPoseAIMailboxStats mailboxStats = mailbox->GetStats();
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: published %llu frames, %llu overwritten before processing, %llu queued for events (%llu dropped, deepest queue %d)"),
+			mailboxStats.Published, mailboxStats.Overwritten, mailboxStats.EventFramesQueued, mailboxStats.EventFramesDropped, mailboxStats.MaxEventQueueDepth);
+		FPoseAINetworkReactor::Get().Unregister(udpSocketReceiver);
 	}
 }
 void PoseAILiveLinkServer::CleanUpSender() {
 	if (udpSocketSender && udpSocketSender.IsValid()) {
 		Disconnect();
 		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: Cleaning up socketSender"));
-		udpSocketSender->Stop(); 
-		udpSocketSender->Exit();
+		udpSocketSender->Stop();
+		FPoseAISenderStats stats = udpSocketSender->GetStats();
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: sent %llu of %llu queued messages (%llu bytes), %llu coalesced, %llu failed"),
+			stats.Sent, stats.Queued, stats.BytesSent, stats.Coalesced, stats.Failed);
 	}
 }
 
@@ -100,24 +114,62 @@ bool PoseAILiveLinkServer::HasValidConnection() const {
 	return endpoint.IsValid() && (FDateTime::Now() - lastConnection).GetTotalSeconds() < TIMEOUT_SECONDS;
 }
 
+bool PoseAILiveLinkServer::IsCurrentEndpoint(const FPoseAIEndpoint& endpointRecv) const {
+	// compares address and port directly, avoiding two string allocations per packet
+	return endpoint.IsValid() && endpointRecv.IsValid() && *endpoint.Address == *endpointRecv.Address;
+}
+
 void PoseAILiveLinkServer::ProcessNetworkPacket(const FString& recvMessage, const FPoseAIEndpoint& endpointRecv) {
-	static const FGuid GUID_Error = FGuid();
 	if (cleaningUp) return;
+	POSEAI_TRACE_SCOPE(ProcessNetworkPacket);
+	packetReceiveTime = FPlatformTime::Seconds();
+
+	FTCHARToUTF8 utf8(*recvMessage, recvMessage.Len());
+	pipelineStats->Count(EPoseAIPipelineCounter::Packets);
+	pipelineStats->Count(EPoseAIPipelineCounter::Bytes, utf8.Length());
+	const TArrayView<const uint8> utf8Bytes(reinterpret_cast<const uint8*>(utf8.Get()), utf8.Length());
+	captureTap->Capture(utf8Bytes, packetReceiveTime);
+	if (ProcessFramePacket(utf8Bytes, endpointRecv))
+		return;
+	ProcessJsonPacket(recvMessage, endpointRecv);
+}
+
+void PoseAILiveLinkServer::ProcessNetworkBytes(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpointRecv) {
+	if (cleaningUp) return;
+	POSEAI_TRACE_SCOPE(ProcessNetworkPacket);
+	packetReceiveTime = FPlatformTime::Seconds();
+	pipelineStats->Count(EPoseAIPipelineCounter::Packets);
+	pipelineStats->Count(EPoseAIPipelineCounter::Bytes, recvBytes.Num());
+	captureTap->Capture(recvBytes, packetReceiveTime);
+
+	if (FPoseAIBinaryPacket::IsBinaryPacket(recvBytes.GetData(), recvBytes.Num())) {
+		ProcessBinaryPacket(recvBytes, endpointRecv);
+		return;
+	}
+	if (ProcessFramePacket(recvBytes, endpointRecv))
+		return;
+	// hello messages are rare, so only they pay for the conversion
+	ProcessJsonPacket(FString(recvBytes.Num(), reinterpret_cast<const UTF8CHAR*>(recvBytes.GetData())), endpointRecv);
+}
+
+void PoseAILiveLinkServer::ProcessJsonPacket(const FString& recvMessage, const FPoseAIEndpoint& endpointRecv) {
+	static const FGuid GUID_Error = FGuid();
 
 	TSharedPtr<FJsonObject> jsonObject = MakeShareable(new FJsonObject);
 	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(recvMessage);
 	
 	if (!FJsonSerializer::Deserialize(Reader, jsonObject)) {
+		pipelineStats->Count(EPoseAIPipelineCounter::Malformed);
 		static const FName NAME_JsonError = "PoseAILiveLink_JsonError";
 		FLiveLinkSubjectKey failKey = FLiveLinkSubjectKey(GUID_Error, FName(endpointRecv.ToString()));
 		FLiveLinkLog::WarningOnce(NAME_JsonError, failKey, TEXT("PoseAI: failed to deserialize json object from %s, %s"), *endpointRecv.ToString(), *Reader->GetErrorMessage());
 		return;
 	}
 
-	bool sameAsCurrent = endpoint.IsValid() && (endpoint.ToString() == endpointRecv.ToString());
+	bool sameAsCurrent = IsCurrentEndpoint(endpointRecv);
 	if (HasValidConnection() && !sameAsCurrent) {
 		if (ExtractConnectionName(jsonObject, endpointRecv) == PoseAILiveLinkNetworkSource::GetConnectionName(port)) {
-				endpoint = endpointRecv; //port has changed but IP and phone nmae same so just update endpoint
+				endpoint = FPoseAIEndpoint(endpointRecv.Address->Clone()); //port has changed but IP and phone nmae same so just update endpoint
 				SendHandshake();
 		}
 		else { //reject
@@ -131,12 +183,8 @@ void PoseAILiveLinkServer::ProcessNetworkPacket(const FString& recvMessage, cons
 	} 
 	else {
 		if (PoseAIRig::IsFrameData(jsonObject)) {
-			lastConnection = FDateTime::Now();
-			if (source_.IsValid()) {
-				auto shared_ptr = source_.Pin();
-				shared_ptr->UpdatePose(jsonObject);
-				UPoseAIEventDispatcher::GetDispatcher()->BroadcastFrameReceived(shared_ptr->GetSubjectName());
-			}
+			// ProcessFramePacket publishes frames without a DOM, so only one with escaped keys, which the app never sends, gets here
+			pipelineStats->Count(EPoseAIPipelineCounter::Malformed);
 		}
 		else if (ExtractConnectionName(jsonObject, endpointRecv) == PoseAILiveLinkNetworkSource::GetConnectionName(port)) { //is likely a repeat hello message
 			SendHandshake();
@@ -144,6 +192,152 @@ void PoseAILiveLinkServer::ProcessNetworkPacket(const FString& recvMessage, cons
 	}
 }
 
+/*
+* The socket thread only tells frames from repeat hello messages and finds the event signature, both by searching for keys.  Tokenizing is left to the worker, which falls back to the DOM for packets the tokenizer rejects
+*/
+bool PoseAILiveLinkServer::ProcessFramePacket(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpointRecv) {
+	if (!IsCurrentEndpoint(endpointRecv) || !HasValidConnection())
+		return false;
+
+	const uint8* data = recvBytes.GetData();
+	const int32 len = recvBytes.Num();
+	if (!FPoseAIJsonTokenizer::FindValue(data, len, "Body") && !FPoseAIJsonTokenizer::FindValue(data, len, "LeftHand") &&
+		!FPoseAIJsonTokenizer::FindValue(data, len, "RightHand"))
+		return false;
+
+	uint32 eventSignature = 0;
+	if (!FPoseAICompactFrame::PeekEventSignature(data, len, eventSignature))
+		FPoseAIVerboseFrame::PeekEventSignature(data, len, eventSignature);
+	lastConnection = FDateTime::Now();
+	PublishFrame(recvBytes, eventSignature);
+	return true;
+}
+
+/*
+* Binary frames carry no hello information, so they are only accepted from an already connected endpoint
+*/
+void PoseAILiveLinkServer::ProcessBinaryPacket(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpointRecv) {
+	static const FGuid GUID_Error = FGuid();
+	if (cleaningUp) return;
+
+	if (!IsCurrentEndpoint(endpointRecv) || !HasValidConnection())
+		return;
+
+	FPoseAIBinaryPacket packet;
+	if (!packet.Parse(recvBytes.GetData(), recvBytes.Num())) {
+		pipelineStats->Count(EPoseAIPipelineCounter::Malformed);
+		static const FName NAME_BinaryError = "PoseAILiveLink_BinaryError";
+		FLiveLinkSubjectKey failKey = FLiveLinkSubjectKey(GUID_Error, FName(endpointRecv.ToString()));
+		FLiveLinkLog::WarningOnce(NAME_BinaryError, failKey, TEXT("PoseAI: malformed binary packet from %s"), *endpointRecv.ToString());
+		return;
+	}
+
+	if (packet.HasFrameData()) {
+		lastConnection = FDateTime::Now();
+		PublishFrame(recvBytes, packet.EventSignature());
+	}
+}
+
+/*
+* Frames are handed to a task graph worker through the mailbox, so decoding and the LiveLink push never delay the next receive.
+* Only one drain is in flight per server, which keeps the rig single threaded.
+*/
+void PoseAILiveLinkServer::PublishFrame(TArrayView<const uint8> recvBytes, uint32 eventSignature) {
+	mailbox->Publish(recvBytes, eventSignature, packetReceiveTime);
+	if (mailbox->TryScheduleDrain()) {
+		TSharedPtr<FPoseAIFrameMailbox, ESPMode::ThreadSafe> mailboxForTask = mailbox;
+		TWeakPtr<PoseAILiveLinkNetworkSource> sourceForTask = source_;
+		AsyncTask(ENamedThreads::AnyHiPriThreadHiPriTask, [mailboxForTask, sourceForTask]() {
+			DrainMailbox(*mailboxForTask, sourceForTask);
+		});
+	}
+}
+
+/*
+* Overwritten frames are scanned in publish order, each just before the frame which replaced it.  Ones queued after the latest was taken
+* are newer than it, so they wait for the next pass rather than being scanned after it.
+*/
+void PoseAILiveLinkServer::DrainMailbox(FPoseAIFrameMailbox& mailbox, TWeakPtr<PoseAILiveLinkNetworkSource> weakSource) {
+	do {
+		TSharedPtr<PoseAILiveLinkNetworkSource> source = weakSource.Pin();
+		const TArray<uint8>* latest = mailbox.TakeLatest();
+		const uint64 latestSequence = latest ? mailbox.LatestSequence() : MAX_uint64;
+		while (const TArray<uint8>* eventBytes = mailbox.PeekEventFrame(latestSequence)) {
+			if (source.IsValid())
+				ProcessQueuedFrame(*source, *eventBytes, true);
+			mailbox.PopEventFrame();
+		}
+		if (latest) {
+			if (source.IsValid()) {
+				source->BeginTrace(mailbox.LatestReceiveTime());
+				ProcessQueuedFrame(*source, *latest, false);
+			}
+		}
+	} while (mailbox.FinishDrain());
+}
+
+void PoseAILiveLinkServer::ProcessQueuedFrame(PoseAILiveLinkNetworkSource& source, TArrayView<const uint8> frameBytes, bool scanOnly) {
+	if (FPoseAIBinaryPacket::IsBinaryPacket(frameBytes.GetData(), frameBytes.Num())) {
+		FPoseAIBinaryPacket packet;
+		if (packet.Parse(frameBytes.GetData(), frameBytes.Num())) {
+			if (scanOnly) {
+				source.ScanPose(packet);
+			}
+			else {
+				source.MarkParsed();
+				source.UpdatePose(packet);
+			}
+		}
+		return;
+	}
+
+	FPoseAICompactFrame frame;
+	if (frame.Parse(frameBytes.GetData(), frameBytes.Num())) {
+		if (scanOnly) {
+			source.ScanPose(frame);
+		}
+		else {
+			source.MarkParsed();
+			source.UpdatePose(frame);
+		}
+		return;
+	}
+
+	FPoseAIVerboseFrame verboseFrame;
+	if (verboseFrame.Parse(frameBytes.GetData(), frameBytes.Num()) && verboseFrame.IsFrameData()) {
+		if (scanOnly) {
+			source.ScanPose(verboseFrame);
+		}
+		else {
+			source.MarkParsed();
+			source.UpdatePose(verboseFrame);
+		}
+		return;
+	}
+
+	TSharedPtr<FJsonObject> jsonObject = MakeShareable(new FJsonObject);
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FString(frameBytes.Num(), reinterpret_cast<const UTF8CHAR*>(frameBytes.GetData())));
+	if (!FJsonSerializer::Deserialize(Reader, jsonObject)) {
+		source.GetPipelineStats().Count(EPoseAIPipelineCounter::Malformed);
+	}
+	else if (scanOnly) {
+		source.ScanPose(jsonObject);
+	}
+	else {
+		source.MarkParsed();
+		source.UpdatePose(jsonObject);
+	}
+}
+
+FPoseAIMailboxStats PoseAILiveLinkServer::GetMailboxStats() const {
+	return mailbox->GetStats();
+}
+
+FPoseAIReceiveStats PoseAILiveLinkServer::GetReceiveStats() const {
+	TSharedPtr<FPoseAIUdpSocketReceiver> receiver = udpSocketReceiver;
+	return (receiver && receiver.IsValid()) ? receiver->GetStats() : FPoseAIReceiveStats();
+}
+
 void PoseAILiveLinkServer::InitiateConnection(TSharedPtr<FJsonObject> jsonObject, const FPoseAIEndpoint& endpointRecv) {
 	static const FGuid GUID_Error = FGuid();
 	FString version;
@@ -164,7 +358,8 @@ void PoseAILiveLinkServer::InitiateConnection(TSharedPtr<FJsonObject> jsonObject
 	UE_LOG(LogTemp, Display, TEXT("PoseAI: received new contact from %s on port %d"), *(connectionName.ToString()), endpointRecv.Port);
 	if (source_.IsValid()) {
 		source_.Pin()->SetConnectionName(connectionName);
-		endpoint = endpointRecv;
+		// the receiver reuses its address object between datagrams, so keep a copy
+		endpoint = FPoseAIEndpoint(endpointRecv.Address->Clone());
 		SendHandshake();
 		UPoseAIEventDispatcher::GetDispatcher()->BroadcastSubjectConnected(source_.Pin()->GetSubjectName());
 		lastConnection = FDateTime::Now();
@@ -174,12 +369,10 @@ void PoseAILiveLinkServer::InitiateConnection(TSharedPtr<FJsonObject> jsonObject
 	}
 }
 
-bool PoseAILiveLinkServer::SendString(FString& message) const {
+bool PoseAILiveLinkServer::SendString(FString& message, EPoseAISendKind kind) const {
 	if (endpoint.IsValid()) {
 		FTCHARToUTF8 byteConvert(*message);
-		TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> bytedata = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
-		bytedata->Append((uint8*)byteConvert.Get(), byteConvert.Length());;
-		return udpSocketSender->Send(bytedata, endpoint);
+		return udpSocketSender->Send(TArrayView<const uint8>((const uint8*)byteConvert.Get(), byteConvert.Length()), endpoint, kind);
 	}
 	else {
 		return false;
@@ -189,7 +382,7 @@ bool PoseAILiveLinkServer::SendString(FString& message) const {
 
 void PoseAILiveLinkServer::SendHandshake() const {
 	FString message_string = handshake.ToString();
-	if (SendString(message_string)) {
+	if (SendString(message_string, EPoseAISendKind::Handshake)) {
 		UE_LOG(LogTemp, Display, TEXT("PoseAI: Sent handshake %s to %s"), *message_string, *(endpoint.ToString()));
 	} else { //unsuccessful
 		static const FName NAME_HandshakeFail = "PoseAILiveLink_HandshakeFail";
@@ -201,6 +394,7 @@ void PoseAILiveLinkServer::SendHandshake() const {
 
 void PoseAILiveLinkServer::SetHandshake(const FPoseAIHandshake& newHandshake) {
 	handshake = newHandshake;
+	captureTap->SetHandshake(handshake.ToString());
 	if (endpoint.IsValid()) 
 		SendHandshake();
 }
@@ -210,9 +404,7 @@ void PoseAILiveLinkServer::SetHandshake(const FPoseAIHandshake& newHandshake) {
 void PoseAILiveLinkServer::Disconnect()  {
 	if (endpoint.IsValid()) {
 		FTCHARToUTF8 byteConvert(*disconnect);
-		TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> bytedata = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
-		bytedata->Append((uint8*)byteConvert.Get(), byteConvert.Length());;
-		if (udpSocketSender->Send(bytedata, endpoint)) {
+		if (udpSocketSender->Send(TArrayView<const uint8>((const uint8*)byteConvert.Get(), byteConvert.Length()), endpoint, EPoseAISendKind::Disconnect)) {
 			UE_LOG(LogTemp, Display, TEXT("PoseAI: Sent disconnect request to %s"), *(endpoint.ToString()));
 		}
 		else { //unsuccesful
@@ -255,17 +447,95 @@ bool PoseAILiveLinkServer::CheckAppVersion(FString version) const
 }
 
 
-uint32 PoseAILiveLinkReceiverRunnable::Run() {
-	FTimespan inWaitTime = FTimespan::FromMilliseconds(250);
-	FString receiverName = "PoseAILiveLink_Receiver_On_Port_" + FString::FromInt(port);
-	udpSocketReceiver = MakeShared<FPoseAIUdpSocketReceiver>(poseAILiveLinkServer->GetSocket(), inWaitTime, *receiverName);
-	udpSocketReceiver->OnDataReceived().BindSP(listener.ToSharedRef(), &PoseAILiveLinkServerListener::ReceiveUDPDelegate);
-	udpSocketReceiver->Start();
-	poseAILiveLinkServer->SetReceiver(udpSocketReceiver);
-	poseAILiveLinkServer = nullptr;
-	listener = nullptr;
-	thread = nullptr;
-	return 0;
+FPoseAISenderStats PoseAILiveLinkServer::GetSenderStats() const {
+	return udpSocketSender.IsValid() ? udpSocketSender->GetStats() : FPoseAISenderStats();
+}
+
+
+bool FPoseAISocketSender::Send(TArrayView<const uint8> Data, const FPoseAIEndpoint& Recipient, EPoseAISendKind Kind) {
+	if (!running || !Recipient.IsValid())
+		return false;
+
+	bool scheduleFlush = false;
+	{
+		FScopeLock scopeLock(&lock);
+		queued++;
+		FPendingSend* existing = nullptr;
+		if (Kind != EPoseAISendKind::Other) {
+			existing = pending.FindByPredicate([Kind, &Recipient](const FPendingSend& queuedSend) {
+				return queuedSend.Kind == Kind && *queuedSend.Recipient.Address == *Recipient.Address;
+			});
+		}
+		if (existing != nullptr) {
+			coalesced++;
+			existing->Bytes.Reset();
+			existing->Bytes.Append(Data.GetData(), Data.Num());
+		}
+		else {
+			FPendingSend& message = pending.AddDefaulted_GetRef();
+			if (freeBuffers.Num() > 0) {
+				// the pool keeps its slack, so popping a buffer never reallocates it
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+				message.Bytes = freeBuffers.Pop(false);
+#else
+				message.Bytes = freeBuffers.Pop(EAllowShrinking::No);
+#endif
+			}
+			message.Bytes.Reset();
+			message.Bytes.Append(Data.GetData(), Data.Num());
+			message.Recipient = Recipient;
+			message.Kind = Kind;
+		}
+		scheduleFlush = !flushScheduled;
+		flushScheduled = true;
+	}
+
+	if (scheduleFlush) {
+		TSharedRef<FPoseAISocketSender, ESPMode::ThreadSafe> sender = AsShared();
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [sender]() { sender->Flush(); });
+	}
+	return true;
+}
+
+void FPoseAISocketSender::Flush() {
+	while (true) {
+		{
+			FScopeLock scopeLock(&lock);
+			for (FPendingSend& message : sending)
+				freeBuffers.Add(MoveTemp(message.Bytes));
+			sending.Reset();
+			if (pending.Num() == 0) {
+				flushScheduled = false;
+				return;
+			}
+			Swap(sending, pending);
+		}
+
+		for (const FPendingSend& message : sending) {
+			int32 bytesOut = 0;
+			if (!Socket || !Socket->SendTo(message.Bytes.GetData(), message.Bytes.Num(), bytesOut, *message.Recipient.ToInternetAddr())) {
+				UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to send to %s"), *(message.Recipient.ToString()));
+				failed++;
+			}
+			else if (bytesOut != message.Bytes.Num()) {
+				failed++;
+			}
+			else {
+				sent++;
+				bytesSent += bytesOut;
+			}
+		}
+	}
+}
+
+FPoseAISenderStats FPoseAISocketSender::GetStats() const {
+	FPoseAISenderStats stats;
+	stats.Queued = queued;
+	stats.Sent = sent;
+	stats.Coalesced = coalesced;
+	stats.Failed = failed;
+	stats.BytesSent = bytesSent;
+	return stats;
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
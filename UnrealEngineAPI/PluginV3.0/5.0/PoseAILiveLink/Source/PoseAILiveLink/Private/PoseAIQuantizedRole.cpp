@@ -0,0 +1,179 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIQuantizedRole.h"
+#include "HAL/IConsoleManager.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "PoseAIRig.h"
+#include "PoseAILatencyTracker.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+static TAutoConsoleVariable<int32> CVarPoseAIQuantizedRole(
+	TEXT("PoseAI.QuantizedRole"),
+	0,
+	TEXT("1 streams PoseAI subjects with the quantized role, a tenth of the size of animation frames in LiveLink's buffers and recordings.  Read when a subject is created."),
+	ECVF_Default);
+
+static_assert(FLiveLinkPoseAIQuantizedFrameData::MaxJoints == FPoseAIDirectPoseFrame::MaxJoints, "quantized frames must fit every rig");
+static_assert(UE_ARRAY_COUNT(FLiveLinkPoseAIQuantizedFrameData::PackedRotations) == 3 * FLiveLinkPoseAIQuantizedFrameData::MaxJoints, "three words per joint");
+
+namespace {
+	// the three smaller components of a unit quaternion lie within +-1/sqrt(2)
+	constexpr double SmallestRange = 0.70710678118654752;
+	constexpr double QuantizeSteps = 32767.0;
+}
+
+
+void FPoseAIQuantizedRotation::Pack(const FQuat& rotation, uint16* outWords) {
+	const double components[4] = { rotation.X, rotation.Y, rotation.Z, rotation.W };
+	int32 largest = 0;
+	for (int32 i = 1; i < 4; ++i) {
+		if (FMath::Abs(components[i]) > FMath::Abs(components[largest]))
+			largest = i;
+	}
+	// q and -q are the same rotation, so the dropped component is made positive and rebuilt as such
+	const double sign = components[largest] < 0.0 ? -1.0 : 1.0;
+	for (int32 i = 0, word = 0; i < 4; ++i) {
+		if (i == largest)
+			continue;
+		const double unit = FMath::Clamp(0.5 + 0.5 * sign * components[i] / SmallestRange, 0.0, 1.0);
+		const uint16 value = (uint16)FMath::RoundToInt(unit * QuantizeSteps);
+		// the low bits of the first two words hold the dropped component's index
+		const uint16 indexBit = word < 2 ? (uint16)((largest >> word) & 1) : 0;
+		outWords[word++] = (uint16)(value << 1) | indexBit;
+	}
+}
+
+FQuat FPoseAIQuantizedRotation::Unpack(const uint16* words) {
+	const int32 largest = (words[0] & 1) | ((words[1] & 1) << 1);
+	double components[4];
+	double sumSquares = 0.0;
+	for (int32 i = 0, word = 0; i < 4; ++i) {
+		if (i == largest)
+			continue;
+		const double value = ((words[word++] >> 1) / QuantizeSteps * 2.0 - 1.0) * SmallestRange;
+		components[i] = value;
+		sumSquares += value * value;
+	}
+	components[largest] = FMath::Sqrt(FMath::Max(0.0, 1.0 - sumSquares));
+	FQuat rotation(components[0], components[1], components[2], components[3]);
+	rotation.Normalize();
+	return rotation;
+}
+
+
+void FLiveLinkPoseAIQuantizedFrameData::Pack(const FLiveLinkAnimationFrameData& frame) {
+	WorldTime = frame.WorldTime;
+	NumJoints = FMath::Min(frame.Transforms.Num(), MaxJoints);
+	RootTranslation = NumJoints > 0 ? frame.Transforms[0].GetTranslation() : FVector::ZeroVector;
+	for (int32 i = 0; i < NumJoints; ++i)
+		FPoseAIQuantizedRotation::Pack(frame.Transforms[i].GetRotation(), PackedRotations + 3 * i);
+}
+
+void FLiveLinkPoseAIQuantizedFrameData::Unpack(const FLiveLinkPoseAIQuantizedStaticData& staticData, TArray<FTransform>& outTransforms) const {
+	outTransforms.Reset(NumJoints);
+	for (int32 i = 0; i < NumJoints; ++i) {
+		const FVector translation = (i == 0) ? RootTranslation :
+			(staticData.BindTranslations.IsValidIndex(i) ? staticData.BindTranslations[i] : FVector::ZeroVector);
+		outTransforms.Emplace(FPoseAIQuantizedRotation::Unpack(PackedRotations + 3 * i), translation, FVector::OneVector);
+	}
+}
+
+
+UScriptStruct* ULiveLinkPoseAIQuantizedRole::GetStaticDataStruct() const {
+	return FLiveLinkPoseAIQuantizedStaticData::StaticStruct();
+}
+
+UScriptStruct* ULiveLinkPoseAIQuantizedRole::GetFrameDataStruct() const {
+	return FLiveLinkPoseAIQuantizedFrameData::StaticStruct();
+}
+
+FText ULiveLinkPoseAIQuantizedRole::GetDisplayName() const {
+	return LOCTEXT("QuantizedRole", "PoseAI Quantized");
+}
+
+bool ULiveLinkPoseAIQuantizedRole::IsStaticDataValid(const FLiveLinkStaticDataStruct& InStaticData, bool& bOutShouldLogWarning) const {
+	if (!Super::IsStaticDataValid(InStaticData, bOutShouldLogWarning))
+		return false;
+	const FLiveLinkPoseAIQuantizedStaticData* staticData = InStaticData.Cast<FLiveLinkPoseAIQuantizedStaticData>();
+	return staticData != nullptr
+		&& staticData->BoneNames.Num() == staticData->BoneParents.Num()
+		&& staticData->BoneNames.Num() == staticData->BindTranslations.Num();
+}
+
+bool ULiveLinkPoseAIQuantizedRole::IsFrameDataValid(const FLiveLinkStaticDataStruct& InStaticData, const FLiveLinkFrameDataStruct& InFrameData, bool& bOutShouldLogWarning) const {
+	if (!Super::IsFrameDataValid(InStaticData, InFrameData, bOutShouldLogWarning))
+		return false;
+	const FLiveLinkPoseAIQuantizedStaticData* staticData = InStaticData.Cast<FLiveLinkPoseAIQuantizedStaticData>();
+	const FLiveLinkPoseAIQuantizedFrameData* frameData = InFrameData.Cast<FLiveLinkPoseAIQuantizedFrameData>();
+	return staticData != nullptr && frameData != nullptr && frameData->NumJoints == staticData->BoneNames.Num();
+}
+
+bool ULiveLinkPoseAIQuantizedRole::IsEnabled() {
+	return CVarPoseAIQuantizedRole.GetValueOnGameThread() != 0;
+}
+
+ULiveLinkSubjectSettings* ULiveLinkPoseAIQuantizedRole::MakeSubjectSettings() {
+	check(IsInGameThread());
+	ULiveLinkSubjectSettings* settings = NewObject<ULiveLinkSubjectSettings>(GetTransientPackage());
+	settings->Role = ULiveLinkPoseAIQuantizedRole::StaticClass();
+	settings->Translators.Add(NewObject<ULiveLinkPoseAIQuantizedToAnimation>(settings));
+	return settings;
+}
+
+
+TSubclassOf<ULiveLinkRole> ULiveLinkPoseAIQuantizedToAnimation::FPoseAIQuantizedToAnimationWorker::GetFromRole() const {
+	return ULiveLinkPoseAIQuantizedRole::StaticClass();
+}
+
+TSubclassOf<ULiveLinkRole> ULiveLinkPoseAIQuantizedToAnimation::FPoseAIQuantizedToAnimationWorker::GetToRole() const {
+	return ULiveLinkAnimationRole::StaticClass();
+}
+
+void ULiveLinkPoseAIQuantizedToAnimation::FPoseAIQuantizedToAnimationWorker::Translate(const FLiveLinkStaticDataStruct& InStaticData, const FLiveLinkFrameDataStruct& InFrameData, FLiveLinkSubjectFrameData& OutTranslatedFrame) const {
+	const FLiveLinkPoseAIQuantizedStaticData* staticData = InStaticData.Cast<FLiveLinkPoseAIQuantizedStaticData>();
+	const FLiveLinkPoseAIQuantizedFrameData* frameData = InFrameData.Cast<FLiveLinkPoseAIQuantizedFrameData>();
+	if (staticData == nullptr || frameData == nullptr)
+		return;
+
+	// a frame kept by its caller between evaluations keeps its skeleton and transform buffer, so only the rotations are unpacked again
+	FLiveLinkSkeletonStaticData* skeletonData = OutTranslatedFrame.StaticData.GetStruct() == FLiveLinkSkeletonStaticData::StaticStruct() ?
+		OutTranslatedFrame.StaticData.Cast<FLiveLinkSkeletonStaticData>() : nullptr;
+	if (skeletonData == nullptr || skeletonData->GetBoneNames() != staticData->GetBoneNames() ||
+		skeletonData->GetBoneParents() != staticData->GetBoneParents() || skeletonData->PropertyNames != staticData->PropertyNames) {
+		OutTranslatedFrame.StaticData.InitializeWith(FLiveLinkSkeletonStaticData::StaticStruct(), nullptr);
+		skeletonData = OutTranslatedFrame.StaticData.Cast<FLiveLinkSkeletonStaticData>();
+		skeletonData->PropertyNames = staticData->PropertyNames;
+		skeletonData->SetBoneNames(staticData->GetBoneNames());
+		skeletonData->SetBoneParents(staticData->GetBoneParents());
+	}
+
+	if (OutTranslatedFrame.FrameData.GetStruct() != FLiveLinkAnimationFrameData::StaticStruct())
+		OutTranslatedFrame.FrameData.InitializeWith(FLiveLinkAnimationFrameData::StaticStruct(), nullptr);
+	FLiveLinkAnimationFrameData* animationData = OutTranslatedFrame.FrameData.Cast<FLiveLinkAnimationFrameData>();
+	animationData->WorldTime = frameData->WorldTime;
+	animationData->MetaData = frameData->MetaData;
+	animationData->PropertyValues = frameData->PropertyValues;
+	frameData->Unpack(*staticData, animationData->Transforms);
+	// quantized subjects are translated as they are evaluated, whichever retarget asset the LiveLink Pose node uses
+	if (FPoseAILatencyTracker::IsEnabled())
+		FPoseAILatencyTracker::Get().MarkEvaluated(frameData->WorldTime.GetSourceTime());
+}
+
+
+TSubclassOf<ULiveLinkRole> ULiveLinkPoseAIQuantizedToAnimation::GetFromRole() const {
+	return ULiveLinkPoseAIQuantizedRole::StaticClass();
+}
+
+TSubclassOf<ULiveLinkRole> ULiveLinkPoseAIQuantizedToAnimation::GetToRole() const {
+	return ULiveLinkAnimationRole::StaticClass();
+}
+
+ULiveLinkFrameTranslator::FWorkerSharedPtr ULiveLinkPoseAIQuantizedToAnimation::FetchWorker() {
+	if (!worker.IsValid())
+		worker = MakeShared<FPoseAIQuantizedToAnimationWorker, ESPMode::ThreadSafe>();
+	return worker;
+}
+
+#undef LOCTEXT_NAMESPACE
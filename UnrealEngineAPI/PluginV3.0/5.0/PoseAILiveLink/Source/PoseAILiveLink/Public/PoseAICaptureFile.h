@@ -0,0 +1,217 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+#include <atomic>
+
+
+/**
+ * Layout of a .paicap capture file, little endian throughout.
+ * A 32 byte file header is followed by fixed size blocks.  Each block starts with a block header holding the arrival and device
+ * times of its first record, so a reader can binary search the blocks by time without any index at the end of the file, and a
+ * capture cut short by a crash stays readable up to its last flushed block.  Records never straddle blocks: one which does not fit
+ * in the rest of a block is written at the start of the next and the gap is left zeroed, which reads as an End record.
+ * Each record is a 24 byte header and its payload, padded to 8 bytes so the headers stay aligned in the mapped file.
+ */
+namespace PoseAICapture
+{
+	static constexpr uint32 FileMagic = 0x43494150;		// "PAIC"
+	static constexpr uint32 BlockMagic = 0x42494150;	// "PAIB"
+	static constexpr uint16 Version = 1;
+	static constexpr int64 BlockSize = 256 * 1024;
+	static constexpr int64 Alignment = 8;
+	static constexpr TCHAR Extension[] = TEXT(".paicap");
+
+	enum class ERecordType : uint8
+	{
+		// zeroed space to the end of the block
+		End = 0,
+		// a datagram as received from the camera
+		Datagram = 1,
+		// the handshake json the capturing source was configured with, written before the first datagram and whenever it changes
+		Handshake = 2,
+	};
+
+	// the record's payload is a frame with a device timestamp, rather than a hello or other control message
+	static constexpr uint8 FlagHasTimestamp = 1 << 0;
+
+	struct FFileHeader
+	{
+		uint32 Magic = FileMagic;
+		uint16 Version = PoseAICapture::Version;
+		uint16 HeaderSize = sizeof(FFileHeader);
+		uint32 BlockSize = (uint32)PoseAICapture::BlockSize;
+		uint32 Reserved = 0;
+		// wall clock start of the capture, as FDateTime ticks in UTC
+		int64 StartUtcTicks = 0;
+		int64 Reserved2 = 0;
+	};
+	static_assert(sizeof(FFileHeader) == 32, "capture file header layout");
+
+	struct FBlockHeader
+	{
+		uint32 Magic = BlockMagic;
+		uint32 BlockIndex = 0;
+		double FirstArrival = 0.0;
+		double FirstDeviceTimestamp = 0.0;
+	};
+	static_assert(sizeof(FBlockHeader) == 24, "capture block header layout");
+
+	struct FRecordHeader
+	{
+		// seconds since the start of the capture
+		double Arrival = 0.0;
+		// the device Timestamp field of the packet, 0 if it has none
+		double DeviceTimestamp = 0.0;
+		uint32 Length = 0;
+		ERecordType Type = ERecordType::End;
+		uint8 Flags = 0;
+		uint16 Reserved = 0;
+	};
+	static_assert(sizeof(FRecordHeader) == 24, "capture record header layout");
+
+	/* reads the Timestamp of a binary or json frame without parsing the rest of the packet */
+	POSEAILIVELINK_API bool PeekDeviceTimestamp(TArrayView<const uint8> bytes, double& outTimestamp);
+}
+
+
+/* appends records to a capture file.  Not thread safe, the writers of the taps belong to the capture's write task */
+class POSEAILIVELINK_API FPoseAICaptureWriter
+{
+public:
+	/* creates the file and writes its header, or returns null if it can not be created */
+	static TUniquePtr<FPoseAICaptureWriter> Create(const FString& path);
+	~FPoseAICaptureWriter();
+
+	/* arrival times are FPlatformTime::Seconds() and stored relative to the first record */
+	void WriteDatagram(TArrayView<const uint8> bytes, double arrivalTime);
+	void WriteHandshake(const FString& handshakeJson, double arrivalTime);
+
+	const FString& GetPath() const { return path; }
+	uint64 GetRecordCount() const { return recordCount; }
+
+private:
+	FPoseAICaptureWriter(TUniquePtr<FArchive>&& file, const FString& path) : file(MoveTemp(file)), path(path) {}
+
+	void WriteRecord(PoseAICapture::ERecordType type, uint8 flags, double arrivalTime, double deviceTimestamp, TArrayView<const uint8> payload);
+
+	TUniquePtr<FArchive> file;
+	FString path;
+	double startTime = -1.0;
+	double lastFlush = 0.0;
+	// bytes used in the current block, 0 before its header is written
+	int64 blockUsed = 0;
+	uint32 blockIndex = 0;
+	uint64 recordCount = 0;
+};
+
+
+/**
+ * Capture point of a server or native source.  While a capture is running, every datagram the source receives is appended to a
+ * file of its own in the capture directory, together with its arrival time and device timestamp.  Captures are started and stopped
+ * for all sources at once with StartAll and StopAll, or the PoseAI.CaptureStart and PoseAI.CaptureStop console commands.  The
+ * receiving thread only copies each datagram into a pooled buffer on a queue shared by all taps, which a task graph task writes
+ * out, so the receive path never waits on the disk and takes no lock while no capture is running.
+ */
+class POSEAILIVELINK_API FPoseAICaptureTap
+{
+public:
+	explicit FPoseAICaptureTap(FName source);
+	/* closes the tap's file if a capture is running */
+	~FPoseAICaptureTap();
+
+	/* any thread: the handshake written at the start of each capture file, so a replay can configure its rig */
+	void SetHandshake(const FString& handshakeJson);
+
+	/* the source's receiving thread: whether Capture has anything to do, for callers which must convert the packet first */
+	bool IsActive() const { return tapGeneration != 0 || IsCapturing(); }
+
+	/* the source's receiving thread */
+	void Capture(TArrayView<const uint8> bytes, double arrivalTime) {
+		if (IsActive())
+			CaptureSlow(bytes, arrivalTime);
+	}
+
+	/* captures all sources into directory, by default Saved/PoseAI/Captures, until StopAll */
+	static void StartAll(const FString& directory = FString());
+	/* writes out what is queued and closes the files of every tap before returning */
+	static void StopAll();
+	static bool IsCapturing() { return captureGeneration.load(std::memory_order_acquire) != 0; }
+
+private:
+	void CaptureSlow(TArrayView<const uint8> bytes, double arrivalTime);
+
+	FName source;
+	// identifies the tap's file to the write task, which may still hold records of a tap that has been destroyed
+	uint64 id;
+	// the capture the tap last queued records for, so it queues its handshake at the start of each
+	uint32 tapGeneration = 0;
+
+	FCriticalSection handshakeLock;
+	FString handshake;
+	bool bHandshakeChanged = false;
+
+	// 0 while no capture is running, otherwise changes with every StartAll so taps start a new file
+	static std::atomic<uint32> captureGeneration;
+};
+
+
+/* one record read from a mapped capture file.  Payload points into the mapping, so it is valid while the reader is */
+struct FPoseAICaptureRecord
+{
+	PoseAICapture::FRecordHeader Header;
+	TArrayView<const uint8> Payload;
+
+	bool IsFrame() const {
+		return Header.Type == PoseAICapture::ERecordType::Datagram && (Header.Flags & PoseAICapture::FlagHasTimestamp) != 0;
+	}
+};
+
+
+/**
+ * Memory maps a capture file for replay and benchmarks.  Records are read in place and blocks are found by binary search over their
+ * headers, so seeking anywhere in a long capture costs a handful of page faults.
+ */
+class POSEAILIVELINK_API FPoseAICaptureReader
+{
+public:
+	/* maps the file and checks its header.  Returns null if it is missing or not a capture */
+	static TUniquePtr<FPoseAICaptureReader> Open(const FString& path);
+
+	/* the next record in file order, false at the end of the capture */
+	bool Next(FPoseAICaptureRecord& outRecord);
+
+	/* moves to the first block that could hold records arriving at or after seconds into the capture */
+	void SeekToArrival(double seconds);
+	void Rewind() { offset = firstBlock; }
+	/* moves to the start of a block, so several readers of one file can each take a range of blocks */
+	void SeekToBlock(int64 index) { offset = firstBlock + FMath::Clamp<int64>(index, 0, numBlocks) * blockSize; }
+
+	/* the first handshake in the capture, or an empty string */
+	FString FindHandshake() const;
+
+	double GetDuration() const { return duration; }
+	FDateTime GetStartTime() const { return FDateTime(header.StartUtcTicks); }
+	int64 GetNumBlocks() const { return numBlocks; }
+
+private:
+	FPoseAICaptureReader() = default;
+
+	const PoseAICapture::FBlockHeader* GetBlock(int64 index) const;
+
+	TUniquePtr<IMappedFileHandle> mappedFile;
+	TUniquePtr<IMappedFileRegion> mappedRegion;
+	const uint8* data = nullptr;
+	int64 size = 0;
+
+	PoseAICapture::FFileHeader header;
+	int64 firstBlock = 0;
+	int64 blockSize = PoseAICapture::BlockSize;
+	int64 numBlocks = 0;
+	double duration = 0.0;
+	int64 offset = 0;
+};
@@ -0,0 +1,97 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+
+struct FPoseAIMailboxStats
+{
+	uint64 Published = 0;
+	// frames replaced by a newer one before the worker took them
+	uint64 Overwritten = 0;
+	// overwritten frames with event or visibility changes which were queued for scanning, and those dropped as the queue was full
+	uint64 EventFramesQueued = 0;
+	uint64 EventFramesDropped = 0;
+	int32 EventQueueDepth = 0;
+	int32 MaxEventQueueDepth = 0;
+};
+
+
+/**
+ * Hands raw frame packets from the socket thread to a worker, keeping only the latest.  Single producer, single consumer, lock-free.
+ * The latest packet is triple buffered: the producer fills its back slot and swaps it in, the consumer swaps out the newest slot when it
+ * is ready, so neither waits on the other and slots are reused without allocating once they have grown to the packet size.
+ * An overwritten packet whose event signature differs from the one before it carries event counts or visibility changes the newest
+ * frame may not show on its own, so it is copied to a small ring of preallocated slots to be scanned before the frame which replaced it.
+ */
+class POSEAILIVELINK_API FPoseAIFrameMailbox
+{
+public:
+	FPoseAIFrameMailbox();
+
+	/* producer: stores a copy of the packet as the latest, signature being a hash of its event and visibility fields */
+	void Publish(TArrayView<const uint8> bytes, uint32 signature, double receiveTime = 0.0);
+
+	/* consumer: returns the latest packet if one was published since the last call.  Valid until the next call */
+	const TArray<uint8>* TakeLatest();
+	/* consumer: FPlatformTime::Seconds() when the packet last returned by TakeLatest was received */
+	double LatestReceiveTime() const { return slots[frontIndex].receiveTime; }
+	/* consumer: publish order of the packet last returned by TakeLatest */
+	uint64 LatestSequence() const { return slots[frontIndex].sequence; }
+
+	/* consumer: the oldest queued packet carrying event changes if it was published before sequence, else nullptr.  Valid until PopEventFrame */
+	const TArray<uint8>* PeekEventFrame(uint64 sequence = MAX_uint64) const;
+	/* consumer: releases the packet returned by PeekEventFrame */
+	void PopEventFrame();
+
+	/* producer: returns true if the caller should schedule a drain, i.e. no drain was pending */
+	bool TryScheduleDrain() { return !drainScheduled.exchange(true); }
+
+	/* consumer: call after draining.  Returns true if more arrived while draining, in which case the caller keeps the drain */
+	bool FinishDrain();
+
+	FPoseAIMailboxStats GetStats() const;
+
+	static constexpr int32 EVENT_QUEUE_CAPACITY = 16;
+
+private:
+	static constexpr uint32 DIRTY = 4;
+	static constexpr uint32 INDEX_MASK = 3;
+
+	struct FSlot
+	{
+		TArray<uint8> bytes;
+		uint32 signature = 0;
+		double receiveTime = 0.0;
+		uint64 sequence = 0;
+		bool bHasEventChange = false;
+	};
+	FSlot slots[3];
+
+	struct FEventSlot
+	{
+		TArray<uint8> bytes;
+		uint64 sequence = 0;
+	};
+	// single producer, single consumer ring: the producer fills eventSlots[eventTail % capacity], the consumer reads from eventHead
+	FEventSlot eventSlots[EVENT_QUEUE_CAPACITY];
+	std::atomic<uint64> eventHead{ 0 };
+	std::atomic<uint64> eventTail{ 0 };
+
+	// producer's slot, the shared slot with the DIRTY bit set while unread, and the consumer's slot
+	uint32 backIndex = 0;
+	std::atomic<uint32> latest{ 1 };
+	uint32 frontIndex = 2;
+
+	uint32 lastSignature = 0;
+	std::atomic<bool> drainScheduled{ false };
+
+	std::atomic<uint64> published{ 0 };
+	std::atomic<uint64> overwritten{ 0 };
+	std::atomic<uint64> eventFramesQueued{ 0 };
+	std::atomic<uint64> eventFramesDropped{ 0 };
+	std::atomic<int32> maxEventQueueDepth{ 0 };
+};
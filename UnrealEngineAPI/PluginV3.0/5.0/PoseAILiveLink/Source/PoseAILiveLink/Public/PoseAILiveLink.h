@@ -15,6 +15,7 @@ public:
 	virtual void ShutdownModule() override;
     
 private:
-	
+	FDelegateHandle beginFrameHandle;
+	FDelegateHandle statsFrameHandle;
 };
 
@@ -0,0 +1,70 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "PoseAIUdpSocketReceiver.h"
+
+
+/**
+ * Services the sockets of every PoseAI network source from a small fixed pool of threads, instead of a receiver thread per port.
+ * Each worker sweeps its sockets without blocking, reading a batch from each one with pending data, and when all are idle waits on
+ * the one with the latest traffic, for PoseAI.NetworkIdleWaitMs when it has several and longer when that is its only socket.
+ * Sockets are assigned to the worker with the fewest.  The pool size is read from PoseAI.NetworkThreads when the first socket is
+ * registered.
+ *
+ * The engine's socket layer does not expose native descriptors, so this is a sweep over FSocket rather than epoll or kqueue.
+ */
+class POSEAILIVELINK_API FPoseAINetworkReactor
+{
+public:
+	static FPoseAINetworkReactor& Get();
+
+	/* starts delivering the receiver's packets on a reactor thread.  Its delegates must already be bound */
+	void Register(TSharedPtr<FPoseAIUdpSocketReceiver> receiver);
+
+	/* stops servicing the receiver, blocking until it is no longer in use so its delegates are not called after this returns */
+	void Unregister(TSharedPtr<FPoseAIUdpSocketReceiver> receiver);
+
+	/* stops and joins the worker threads, called on module shutdown */
+	void Shutdown();
+
+	int32 NumWorkers() const { return workers.Num(); }
+	int32 NumSockets() const;
+
+private:
+	class FWorker : public FRunnable
+	{
+	public:
+		FWorker(int32 index);
+		virtual ~FWorker();
+
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+		void Add(TSharedPtr<FPoseAIUdpSocketReceiver> receiver);
+		bool Remove(TSharedPtr<FPoseAIUdpSocketReceiver> receiver);
+		int32 Num() const;
+
+	private:
+		mutable FCriticalSection lock;
+		TArray<TSharedPtr<FPoseAIUdpSocketReceiver>> receivers;
+		// one batch buffer serves every socket on the thread
+		TArray<uint8> buffer;
+		FEvent* wakeEvent = nullptr;
+		FRunnableThread* thread = nullptr;
+		// the receiver that last had data, waited on while all are idle
+		TSharedPtr<FPoseAIUdpSocketReceiver> lastActive;
+		int32 nextWait = 0;
+		std::atomic<bool> running{ true };
+	};
+
+	mutable FCriticalSection lock;
+	TArray<TUniquePtr<FWorker>> workers;
+
+	// how long an idle worker with a single socket waits on it, which only delays noticing a new socket or Stop
+	static constexpr double SINGLE_SOCKET_WAIT_MS = 10.0;
+};
@@ -0,0 +1,110 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkFrameTranslator.h"
+#include "LiveLinkSubjectSettings.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Roles/LiveLinkBasicRole.h"
+#include "PoseAIQuantizedRole.generated.h"
+
+
+/* smallest three quaternion packing in three 16 bit words: the three smaller components at 15 bits each and the index of the dropped one */
+struct POSEAILIVELINK_API FPoseAIQuantizedRotation
+{
+	static void Pack(const FQuat& rotation, uint16* outWords);
+	static FQuat Unpack(const uint16* words);
+};
+
+
+/** Skeleton of a PoseAI subject streamed with the quantized role, with the bind translations every frame shares. */
+USTRUCT(BlueprintType)
+struct POSEAILIVELINK_API FLiveLinkPoseAIQuantizedStaticData : public FLiveLinkSkeletonStaticData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "LiveLink")
+	TArray<FVector> BindTranslations;
+};
+
+
+/**
+ * A PoseAI frame holding only what changes per frame: the root translation and a packed rotation per joint, in a fixed array so
+ * pushing a frame makes no allocation beyond the frame itself.  Joint translations come from the static data and scales are one.
+ */
+USTRUCT(BlueprintType)
+struct POSEAILIVELINK_API FLiveLinkPoseAIQuantizedFrameData : public FLiveLinkBaseFrameData
+{
+	GENERATED_BODY()
+
+	// FPoseAIDirectPoseFrame::MaxJoints, the joints of the largest rig
+	static constexpr int32 MaxJoints = 70;
+
+	UPROPERTY()
+	int32 NumJoints = 0;
+
+	UPROPERTY()
+	FVector RootTranslation = FVector::ZeroVector;
+
+	// 3 * MaxJoints, spelled out for the header tool
+	UPROPERTY()
+	uint16 PackedRotations[210];
+
+	/* packs the local transforms of a processed frame, taking its world time */
+	void Pack(const FLiveLinkAnimationFrameData& frame);
+	/* expands into local transforms, with the bind translations of the static data */
+	void Unpack(const FLiveLinkPoseAIQuantizedStaticData& staticData, TArray<FTransform>& outTransforms) const;
+};
+
+
+/**
+ * Role of PoseAI subjects streamed quantized, enabled with PoseAI.QuantizedRole.  A frame is about a tenth of an animation role frame
+ * in the LiveLink client's buffers and in recordings.  Subjects are created with a translator to the animation role, so the LiveLink
+ * Pose node and retarget assets expand the frame only when they evaluate it.
+ */
+UCLASS(BlueprintType, meta = (DisplayName = "PoseAI Quantized Role"))
+class POSEAILIVELINK_API ULiveLinkPoseAIQuantizedRole : public ULiveLinkBasicRole
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin ULiveLinkRole interface
+	virtual UScriptStruct* GetStaticDataStruct() const override;
+	virtual UScriptStruct* GetFrameDataStruct() const override;
+	virtual FText GetDisplayName() const override;
+	virtual bool IsStaticDataValid(const FLiveLinkStaticDataStruct& InStaticData, bool& bOutShouldLogWarning) const override;
+	virtual bool IsFrameDataValid(const FLiveLinkStaticDataStruct& InStaticData, const FLiveLinkFrameDataStruct& InFrameData, bool& bOutShouldLogWarning) const override;
+	//~ End ULiveLinkRole interface
+
+	/* game thread: whether sources create their subjects with this role, from PoseAI.QuantizedRole */
+	static bool IsEnabled();
+	/* game thread: subject settings holding the translator to the animation role */
+	static ULiveLinkSubjectSettings* MakeSubjectSettings();
+};
+
+
+/** Expands PoseAI quantized frames into animation role frames when a subject is evaluated as an animation. */
+UCLASS(meta = (DisplayName = "PoseAI Quantized To Animation"))
+class POSEAILIVELINK_API ULiveLinkPoseAIQuantizedToAnimation : public ULiveLinkFrameTranslator
+{
+	GENERATED_BODY()
+
+public:
+	class FPoseAIQuantizedToAnimationWorker : public ILiveLinkFrameTranslatorWorker
+	{
+	public:
+		virtual TSubclassOf<ULiveLinkRole> GetFromRole() const override;
+		virtual TSubclassOf<ULiveLinkRole> GetToRole() const override;
+		virtual void Translate(const FLiveLinkStaticDataStruct& InStaticData, const FLiveLinkFrameDataStruct& InFrameData, FLiveLinkSubjectFrameData& OutTranslatedFrame) const override;
+	};
+
+	//~ Begin ULiveLinkFrameTranslator interface
+	virtual TSubclassOf<ULiveLinkRole> GetFromRole() const override;
+	virtual TSubclassOf<ULiveLinkRole> GetToRole() const override;
+	virtual FWorkerSharedPtr FetchWorker() override;
+	//~ End ULiveLinkFrameTranslator interface
+
+private:
+	TSharedPtr<FPoseAIQuantizedToAnimationWorker, ESPMode::ThreadSafe> worker;
+};
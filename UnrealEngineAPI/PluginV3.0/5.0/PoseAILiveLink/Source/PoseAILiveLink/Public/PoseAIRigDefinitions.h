@@ -0,0 +1,399 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/* one joint of a streamed rig: its parent's index in the same table (-1 for the root) and its bind translation relative to the parent */
+struct FPoseAIJointDef
+{
+	const TCHAR* Name;
+	int32 Parent;
+	double X;
+	double Y;
+	double Z;
+};
+
+
+/*
+* Compile-time layouts of the rigs streamed by Pose AI, matching the default skeleton of each (i.e. UE4 Mannequin or male MetaHuman)
+* so a sensible animation is produced even without retargeting.  Body joints come first, then the left hand, then the right hand,
+* in the order the camera sends rotations.  Parents always precede their children.
+*/
+struct FPoseAIRigTraitsUE4
+{
+	static constexpr int32 NumBodyJoints = 21;
+	static constexpr int32 NumHandJoints = 17;
+	static constexpr int32 RShinJoint = 3;
+	static constexpr int32 LShinJoint = 7;
+	static constexpr int32 LowerBodyNumOfJoints = 8;
+	static constexpr FPoseAIJointDef Joints[] = {
+		{ TEXT("root"), -1, 0.0, 0, 0.0 },
+		{ TEXT("pelvis"), 0, 0.0, 0, 0.0 },
+		{ TEXT("thigh_r"), 1, -1.448829, 0.531424, 9.00581 },
+		{ TEXT("calf_r"), 2, 42.572037, 0, 0 },
+		{ TEXT("foot_r"), 3, 40.19669, 0, 0 },
+		{ TEXT("ball_r"), 4, 10.453837, -16.577854, 0.080156 },
+		{ TEXT("thigh_l"), 1, -1.448829, 0.531424, -9.00581 },
+		{ TEXT("calf_l"), 6, -42.572037, 0, 0 },
+		{ TEXT("foot_l"), 7, -40.19669, 0, 0 },
+		{ TEXT("ball_l"), 8, -10.453837, 16.577854, 0.080156 },
+		{ TEXT("spine_01"), 1, 10.808878, 0.851415, 0 },
+		{ TEXT("spine_02"), 10, 18.875349, -3.801159, 0 },
+		{ TEXT("spine_03"), 11, 13.407329, -0.420477, 0 },
+		{ TEXT("neck_01"), 12, 16.558783, 0.355318, 0 },
+		{ TEXT("head"), 13, 9.283613, -0.364157, 0 },
+		{ TEXT("clavicle_l"), 12, 11.883688, 2.732088, -3.781983 },
+		{ TEXT("upperarm_l"), 15, 15.784872, 0, 0 },
+		{ TEXT("lowerarm_l"), 16, 30.33993, 0, 0 },
+		{ TEXT("clavicle_r"), 12, 11.883688, 2.732102, 3.782003 },
+		{ TEXT("upperarm_r"), 18, -15.784872, 0, 0 },
+		{ TEXT("lowerarm_r"), 19, -30.33993, 0, 0 },
+		// left hand, then right hand
+		{ TEXT("hand_l"), 17, 26.975143, 0, 0 },
+		{ TEXT("lowerarm_twist_01_l"), 17, 14.0, 0, 0 },
+		{ TEXT("index_01_l"), 21, 12.068114, -1.763462, -2.109398 },
+		{ TEXT("index_02_l"), 23, 4.287498, 0, 0 },
+		{ TEXT("index_03_l"), 24, 3.39379, 0, 0 },
+		{ TEXT("middle_01_l"), 21, 12.244281, -1.293644, 0.571162 },
+		{ TEXT("middle_02_l"), 26, 4.640374, 0, 0 },
+		{ TEXT("middle_03_l"), 27, 3.648844, 0, 0 },
+		{ TEXT("ring_01_l"), 21, 11.497885, -1.753527, 2.846912 },
+		{ TEXT("ring_02_l"), 29, 4.430177, 0, 0 },
+		{ TEXT("ring_03_l"), 30, 3.476652, 0, 0 },
+		{ TEXT("pinky_01_l"), 21, 10.140665, -2.263151, 4.643148 },
+		{ TEXT("pinky_02_l"), 32, 3.570981, 0, 0 },
+		{ TEXT("pinky_03_l"), 33, 2.985631, 0, 0 },
+		{ TEXT("thumb_01_l"), 21, 4.762036, -2.374981, -2.53782 },
+		{ TEXT("thumb_02_l"), 35, 3.869672, 0, 0 },
+		{ TEXT("thumb_03_l"), 36, 4.062171, 0, 0 },
+		{ TEXT("hand_r"), 20, -26.975143, 0, 0 },
+		{ TEXT("lowerarm_twist_01_r"), 20, -14.0, 0, 0 },
+		{ TEXT("index_01_r"), 38, -12.068114, 1.763462, 2.109398 },
+		{ TEXT("index_02_r"), 40, -4.287498, 0, 0 },
+		{ TEXT("index_03_r"), 41, -3.39379, 0, 0 },
+		{ TEXT("middle_01_r"), 38, -12.244281, 1.293644, -0.571162 },
+		{ TEXT("middle_02_r"), 43, -4.640374, 0, 0 },
+		{ TEXT("middle_03_r"), 44, -3.648844, 0, 0 },
+		{ TEXT("ring_01_r"), 38, -11.497885, 1.753527, -2.846912 },
+		{ TEXT("ring_02_r"), 46, -4.430177, 0, 0 },
+		{ TEXT("ring_03_r"), 47, -3.476652, 0, 0 },
+		{ TEXT("pinky_01_r"), 38, -10.140665, 2.263151, -4.643148 },
+		{ TEXT("pinky_02_r"), 49, -3.570981, 0, 0 },
+		{ TEXT("pinky_03_r"), 50, -2.985631, 0, 0 },
+		{ TEXT("thumb_01_r"), 38, -4.762036, 2.374981, 2.53782 },
+		{ TEXT("thumb_02_r"), 52, -3.869672, 0, 0 },
+		{ TEXT("thumb_03_r"), 53, -4.062171, 0, 0 },
+	};
+};
+
+struct FPoseAIRigTraitsMixamo
+{
+	static constexpr int32 NumBodyJoints = 21;
+	static constexpr int32 NumHandJoints = 17;
+	static constexpr int32 RShinJoint = 3;
+	static constexpr int32 LShinJoint = 7;
+	static constexpr int32 LowerBodyNumOfJoints = 8;
+	static constexpr FPoseAIJointDef Joints[] = {
+		{ TEXT("root"), -1, 0.0, 0, 0.0 },
+		{ TEXT("hips"), 0, 0.0, 0, 0.0 },
+		{ TEXT("RightUpLeg"), 1, -9.4, 5.0, 0 },
+		{ TEXT("RightLeg"), 2, 0, -44.5, 0 },
+		{ TEXT("RightFoot"), 3, 0.7, -35.0, -2.4 },
+		{ TEXT("RightToeBase"), 4, -0.7, -17.8, -5.8 },
+		{ TEXT("LeftUpLeg"), 1, 9.4, 5.0, 0 },
+		{ TEXT("LeftLeg"), 6, -0, -44.5, 0 },
+		{ TEXT("LeftFoot"), 7, -0.7, -35.0, -2.4 },
+		{ TEXT("LeftToeBase"), 8, 0.7, -17.8, -5.8 },
+		{ TEXT("Spine"), 1, 0, -9.0, -0.3 },
+		{ TEXT("Spine1"), 10, 0, -10.5, 0 },
+		{ TEXT("Spine2"), 11, 0, -12.0, 0 },
+		{ TEXT("Neck"), 12, 0, -13.5, 0 },
+		{ TEXT("Head"), 13, 0, -8.2, 2.1 },
+		{ TEXT("LeftShoulder"), 12, 5.7, -11.8, 0 },
+		{ TEXT("LeftArm"), 15, 0, -12.0, 0 },
+		{ TEXT("LeftForeArm"), 16, 0, -25.7, 0 },
+		{ TEXT("RightShoulder"), 12, -5.7, -11.8, 0 },
+		{ TEXT("RightArm"), 18, 0, -12.0, 0 },
+		{ TEXT("RightForeArm"), 19, 0, -25.7, 0 },
+		// left hand, then right hand
+		{ TEXT("LeftHand"), 17, 0, -23.0, 0 },
+		{ TEXT("LeftForeArmTwist"), 17, 0, -14.0, 0 },
+		{ TEXT("LeftHandIndex1"), 21, -3.3, -8.3, 0.1 },
+		{ TEXT("LeftHandIndex2"), 23, 0, -3.1, 0 },
+		{ TEXT("LeftHandIndex3"), 24, 0, -2.9, 0 },
+		{ TEXT("LeftHandMiddle1"), 21, -0.9, -8.5, -0.1 },
+		{ TEXT("LeftHandMiddle2"), 26, 0, -3.3, 0 },
+		{ TEXT("LeftHandMiddle3"), 27, 0, -3.1, 0 },
+		{ TEXT("LeftHandRing1"), 21, 1.1, -8.7, 0.2 },
+		{ TEXT("LeftHandRing2"), 29, 0, -2.7, 0 },
+		{ TEXT("LeftHandRing3"), 30, 0, -2.7, 0 },
+		{ TEXT("LeftHandPinky1"), 21, 3.1, -8.0, 0.2 },
+		{ TEXT("LeftHandPinky2"), 32, 0, -2.5, 0 },
+		{ TEXT("LeftHandPinky3"), 33, 0, -2.0, 0 },
+		{ TEXT("LeftHandThumb1"), 21, -2.9, -2.6, 1.2 },
+		{ TEXT("LeftHandThumb2"), 35, -0.7, -3.2, 0 },
+		{ TEXT("LeftHandThumb3"), 36, 0.2, -3.0, 0 },
+		{ TEXT("RightHand"), 20, 0, -23.0, 0 },
+		{ TEXT("RightForeArmTwist"), 20, 0, -14.0, 0 },
+		{ TEXT("RightHandIndex1"), 38, 3.3, -8.3, 0.1 },
+		{ TEXT("RightHandIndex2"), 40, 0, -3.1, 0 },
+		{ TEXT("RightHandIndex3"), 41, 0, -2.9, 0 },
+		{ TEXT("RightHandMiddle1"), 38, 0.9, -8.5, -0.1 },
+		{ TEXT("RightHandMiddle2"), 43, 0, -3.3, 0 },
+		{ TEXT("RightHandMiddle3"), 44, 0, -3.1, 0 },
+		{ TEXT("RightHandRing1"), 38, -1.1, -8.7, 0.2 },
+		{ TEXT("RightHandRing2"), 46, 0, -2.7, 0 },
+		{ TEXT("RightHandRing3"), 47, 0, -2.7, 0 },
+		{ TEXT("RightHandPinky1"), 38, -3.1, -8.0, 0.2 },
+		{ TEXT("RightHandPinky2"), 49, 0, -2.5, 0 },
+		{ TEXT("RightHandPinky3"), 50, 0, -2.0, 0 },
+		{ TEXT("RightHandThumb1"), 38, 2.9, -2.6, 1.2 },
+		{ TEXT("RightHandThumb2"), 52, 0.7, -3.2, 0 },
+		{ TEXT("RightHandThumb3"), 53, -0.2, -3.0, 0 },
+	};
+};
+
+struct FPoseAIRigTraitsMixamoAlt
+{
+	static constexpr int32 NumBodyJoints = 21;
+	static constexpr int32 NumHandJoints = 17;
+	static constexpr int32 RShinJoint = 3;
+	static constexpr int32 LShinJoint = 7;
+	static constexpr int32 LowerBodyNumOfJoints = 8;
+	static constexpr FPoseAIJointDef Joints[] = {
+		{ TEXT("root"), -1, 0.0, 0, 0.0 },
+		{ TEXT("hips"), 0, 0.0, 0, 0.0 },
+		{ TEXT("RightUpLeg"), 1, -9.4, 5.0, 0 },
+		{ TEXT("RightLeg"), 2, 0, 44.5, 0 },
+		{ TEXT("RightFoot"), 3, 0.7, 35.0, -2.4 },
+		{ TEXT("RightToeBase"), 4, 0, 11.0, 13.0 },
+		{ TEXT("LeftUpLeg"), 1, 9.4, 5.0, 0 },
+		{ TEXT("LeftLeg"), 6, -0, 44.5, 0 },
+		{ TEXT("LeftFoot"), 7, -0.7, 35.0, -2.4 },
+		{ TEXT("LeftToeBase"), 8, 0, 11.0, 13.0 },
+		{ TEXT("Spine"), 1, 0, -9.0, -0.3 },
+		{ TEXT("Spine1"), 10, 0, -10.5, 0 },
+		{ TEXT("Spine2"), 11, 0, -12.0, 0 },
+		{ TEXT("Neck"), 12, 0, -13.5, 0 },
+		{ TEXT("Head"), 13, 0, -8.2, 2.1 },
+		{ TEXT("LeftShoulder"), 12, 5.7, -11.8, 0 },
+		{ TEXT("LeftArm"), 15, 12.0, 0, 0 },
+		{ TEXT("LeftForeArm"), 16, 25.7, 0, 0 },
+		{ TEXT("RightShoulder"), 12, -5.7, -11.8, 0 },
+		{ TEXT("RightArm"), 18, -12.0, 0, 0 },
+		{ TEXT("RightForeArm"), 19, -25.7, 0, 0 },
+		// left hand, then right hand
+		{ TEXT("LeftHand"), 17, 23.0, 0, 0 },
+		{ TEXT("LeftForeArmTwist"), 17, 14.0, 0, 0 },
+		{ TEXT("LeftHandIndex1"), 21, -3.3, -8.3, 0.1 },
+		{ TEXT("LeftHandIndex2"), 23, 0, -3.1, 0 },
+		{ TEXT("LeftHandIndex3"), 24, 0, -2.9, 0 },
+		{ TEXT("LeftHandMiddle1"), 21, -0.9, -8.5, -0.1 },
+		{ TEXT("LeftHandMiddle2"), 26, 0, -3.3, 0 },
+		{ TEXT("LeftHandMiddle3"), 27, 0, -3.1, 0 },
+		{ TEXT("LeftHandRing1"), 21, 1.1, -8.7, 0.2 },
+		{ TEXT("LeftHandRing2"), 29, 0, -2.7, 0 },
+		{ TEXT("LeftHandRing3"), 30, 0, -2.7, 0 },
+		{ TEXT("LeftHandPinky1"), 21, 3.1, -8.0, 0.2 },
+		{ TEXT("LeftHandPinky2"), 32, 0, -2.5, 0 },
+		{ TEXT("LeftHandPinky3"), 33, 0, -2.0, 0 },
+		{ TEXT("LeftHandThumb1"), 21, -2.9, -2.6, 1.2 },
+		{ TEXT("LeftHandThumb2"), 35, -0.7, -3.2, 0 },
+		{ TEXT("LeftHandThumb3"), 36, 0.2, -3.0, 0 },
+		{ TEXT("RightHand"), 20, -23.0, 0, 0 },
+		{ TEXT("RightForeArmTwist"), 20, -14.0, 0, 0 },
+		{ TEXT("RightHandIndex1"), 38, 3.3, -8.3, 0.1 },
+		{ TEXT("RightHandIndex2"), 40, 0, -3.1, 0 },
+		{ TEXT("RightHandIndex3"), 41, 0, -2.9, 0 },
+		{ TEXT("RightHandMiddle1"), 38, 0.9, -8.5, -0.1 },
+		{ TEXT("RightHandMiddle2"), 43, 0, -3.3, 0 },
+		{ TEXT("RightHandMiddle3"), 44, 0, -3.1, 0 },
+		{ TEXT("RightHandRing1"), 38, -1.1, -8.7, 0.2 },
+		{ TEXT("RightHandRing2"), 46, 0, -2.7, 0 },
+		{ TEXT("RightHandRing3"), 47, 0, -2.7, 0 },
+		{ TEXT("RightHandPinky1"), 38, -3.1, -8.0, 0.2 },
+		{ TEXT("RightHandPinky2"), 49, 0, -2.5, 0 },
+		{ TEXT("RightHandPinky3"), 50, 0, -2.0, 0 },
+		{ TEXT("RightHandThumb1"), 38, 2.9, -2.6, 1.2 },
+		{ TEXT("RightHandThumb2"), 52, 0.7, -3.2, 0 },
+		{ TEXT("RightHandThumb3"), 53, -0.2, -3.0, 0 },
+	};
+};
+
+struct FPoseAIRigTraitsMetaHuman
+{
+	static constexpr int32 NumBodyJoints = 24;
+	static constexpr int32 NumHandJoints = 22;
+	static constexpr int32 RShinJoint = 3;
+	static constexpr int32 LShinJoint = 7;
+	static constexpr int32 LowerBodyNumOfJoints = 8;
+	static constexpr FPoseAIJointDef Joints[] = {
+		{ TEXT("root"), -1, 0.0, 0, 0.0 },
+		{ TEXT("pelvis"), 0, 0.0, 0, 0.0 },
+		{ TEXT("thigh_r"), 1, -2.3, 0.4, 9.27 },
+		{ TEXT("calf_r"), 2, 41.2, 0, 0 },
+		{ TEXT("foot_r"), 3, 40.0, 0, 0 },
+		{ TEXT("ball_r"), 4, 7.1, -14.4, -0.4 },
+		{ TEXT("thigh_l"), 1, -2.3, 0.4, -9.27 },
+		{ TEXT("calf_l"), 6, -41.2, 0, 0 },
+		{ TEXT("foot_l"), 7, -40.0, 0, 0 },
+		{ TEXT("ball_l"), 8, -7.1, 14.4, 0.4 },
+		{ TEXT("spine_01"), 1, 3.4, 0.0, 0 },
+		{ TEXT("spine_02"), 10, 6.3, 0.0, 0 },
+		{ TEXT("spine_03"), 11, 6.9, 0.0, 0 },
+		{ TEXT("spine_04"), 12, 8.1, 0.0, 0 },
+		{ TEXT("spine_05"), 13, 18.3, 0.0, 0 },
+		{ TEXT("neck_01"), 14, 11.6, 1.0, 0 },
+		{ TEXT("neck_02"), 15, 5.0, 0, 0 },
+		{ TEXT("head"), 16, 5.0, 0, 0 },
+		{ TEXT("clavicle_l"), 14, 5.5, -0.7, -1.2 },
+		{ TEXT("upperarm_l"), 18, 17.0, 0, 0 },
+		{ TEXT("lowerarm_l"), 19, 27.0, 0, 0 },
+		{ TEXT("clavicle_r"), 14, 5.5, -0.7, 1.2 },
+		{ TEXT("upperarm_r"), 21, -17.0, 0, 0 },
+		{ TEXT("lowerarm_r"), 22, -27.0, 0, 0 },
+		// left hand, then right hand
+		{ TEXT("hand_l"), 20, 25.2, 0, 0 },
+		{ TEXT("lowerarm_twist_01_l"), 20, 14.0, 0, 0 },
+		{ TEXT("lowerarm_twist_02_l"), 20, 7.0, 0, 0 },
+		{ TEXT("index_metacarpal_l"), 24, 3.5, 0.4, -2.1 },
+		{ TEXT("index_01_l"), 27, 5.9, 0.1, 0.3 },
+		{ TEXT("index_02_l"), 28, 3.6, 0, 0 },
+		{ TEXT("index_03_l"), 29, 2.4, 0, 0 },
+		{ TEXT("middle_metacarpal_l"), 24, 3.3, 0.3, -0.1 },
+		{ TEXT("middle_01_l"), 31, 6.1, 0, 0.2 },
+		{ TEXT("middle_02_l"), 32, 4.3, 0, 0 },
+		{ TEXT("middle_03_l"), 33, 2.6, 0, 0 },
+		{ TEXT("ring_metacarpal_l"), 24, 3.2, -0.2, 1.2 },
+		{ TEXT("ring_01_l"), 35, 6.0, 0.2, 0.4 },
+		{ TEXT("ring_02_l"), 36, 3.6, 0, 0 },
+		{ TEXT("ring_03_l"), 37, 2.5, 0, 0 },
+		{ TEXT("pinky_metacarpal_l"), 24, 3.1, -0.7, 2.4 },
+		{ TEXT("pinky_01_l"), 39, 5.1, 0.1, 0.1 },
+		{ TEXT("pinky_02_l"), 40, 3.3, 0, 0 },
+		{ TEXT("pinky_03_l"), 41, 1.8, 0, 0 },
+		{ TEXT("thumb_01_l"), 24, 2.0, -1.0, -2.6 },
+		{ TEXT("thumb_02_l"), 43, 4.4, 0, 0 },
+		{ TEXT("thumb_03_l"), 44, 2.7, 0, 0 },
+		{ TEXT("hand_r"), 23, -25.2, 0, 0 },
+		{ TEXT("lowerarm_twist_01_r"), 23, -14.0, 0, 0 },
+		{ TEXT("lowerarm_twist_02_r"), 23, -7.0, 0, 0 },
+		{ TEXT("index_metacarpal_r"), 46, -3.5, -0.4, 2.1 },
+		{ TEXT("index_01_r"), 49, -5.9, 0.1, 0.3 },
+		{ TEXT("index_02_r"), 50, -3.6, 0, 0 },
+		{ TEXT("index_03_r"), 51, -2.4, 0, 0 },
+		{ TEXT("middle_metacarpal_r"), 46, -3.3, -0.3, 0.1 },
+		{ TEXT("middle_01_r"), 53, -6.1, 0, 0.2 },
+		{ TEXT("middle_02_r"), 54, -4.3, 0, 0 },
+		{ TEXT("middle_03_r"), 55, -2.6, 0, 0 },
+		{ TEXT("ring_metacarpal_r"), 46, -3.2, 0.2, -1.2 },
+		{ TEXT("ring_01_r"), 57, -6.0, 0.2, 0.4 },
+		{ TEXT("ring_02_r"), 58, -3.6, 0, 0 },
+		{ TEXT("ring_03_r"), 59, -2.5, 0, 0 },
+		{ TEXT("pinky_metacarpal_r"), 46, -3.1, 0.7, -2.4 },
+		{ TEXT("pinky_01_r"), 61, -5.1, 0.1, 0.1 },
+		{ TEXT("pinky_02_r"), 62, -3.3, 0, 0 },
+		{ TEXT("pinky_03_r"), 63, -1.8, 0, 0 },
+		{ TEXT("thumb_01_r"), 46, -2.0, 1.0, 2.6 },
+		{ TEXT("thumb_02_r"), 65, -4.4, 0, 0 },
+		{ TEXT("thumb_03_r"), 66, -2.7, 0, 0 },
+	};
+};
+
+struct FPoseAIRigTraitsDazUE
+{
+	static constexpr int32 NumBodyJoints = 28;
+	static constexpr int32 NumHandJoints = 21;
+	static constexpr int32 RShinJoint = 5;
+	static constexpr int32 LShinJoint = 10;
+	static constexpr int32 LowerBodyNumOfJoints = 11;
+	static constexpr FPoseAIJointDef Joints[] = {
+		{ TEXT("root"), -1, 0.0, 0, 0.0 },
+		{ TEXT("hip"), 0, 0.0, -105.0, 0.0 },
+		{ TEXT("pelvis"), 1, 0.0, -1.8, 0.0 },
+		{ TEXT("rThighBend"), 2, -7.9, 10.6, -1.5 },
+		{ TEXT("rThighTwist"), 3, 0.0, 21, 0 },
+		{ TEXT("rShin"), 4, 0.0, 25.3, -1.2 },
+		{ TEXT("rFoot"), 5, 0.0, 42.8, 1 },
+		{ TEXT("rToe"), 6, 0.0, 0, 14.0 },
+		{ TEXT("lThighBend"), 2, 7.9, 10.6, -1.5 },
+		{ TEXT("lThighTwist"), 8, 0.0, 21, 0 },
+		{ TEXT("lShin"), 9, 0.0, 25.3, -1.2 },
+		{ TEXT("lFoot"), 10, 0.0, 42.8, 1 },
+		{ TEXT("lToe"), 11, 0.0, 0.0, 14.0 },
+		{ TEXT("abdomenLower"), 1, 0.0, -1.7, -1.5 },
+		{ TEXT("abdomenUpper"), 13, 0.0, -8.2, 1.2 },
+		{ TEXT("chestLower"), 14, 0.0, -7.9, -0.4 },
+		{ TEXT("chestUpper"), 15, 0.0, -13.1, -3.6 },
+		{ TEXT("neckLower"), 16, 0.0, -18.3, -1.5 },
+		{ TEXT("neckUpper"), 17, 0.0, -3.5, 1.5 },
+		{ TEXT("head"), 18, 0.0, -4.9, -0.5 },
+		{ TEXT("lCollar"), 16, 3.5, -10.9, -1.6 },
+		{ TEXT("lShldrBend"), 20, 11.9, 1.7, 0 },
+		{ TEXT("lShldrTwist"), 21, 11.6, 0, 0 },
+		{ TEXT("lForearmBend"), 22, 14.4, -0.2, -0.5 },
+		{ TEXT("rCollar"), 16, -3.5, -10.9, -1.6 },
+		{ TEXT("rShldrBend"), 24, -11.9, 1.7, 0 },
+		{ TEXT("rShldrTwist"), 25, -11.6, 0, 0 },
+		{ TEXT("rForearmBend"), 26, -14.4, -0.2, -0.5 },
+		// left hand, then right hand
+		{ TEXT("lForearmTwist"), 23, 12.1, 0, 0 },
+		{ TEXT("lHand"), 28, 14.2, 0, -0.3 },
+		{ TEXT("lCarpal1"), 29, 0.4, -0.4, 1.1 },
+		{ TEXT("lIndex1"), 30, 7.6, -0.2, 0.1 },
+		{ TEXT("lIndex2"), 31, 3.9, 0, 0 },
+		{ TEXT("lIndex3"), 32, 2.1, 0, 0 },
+		{ TEXT("lCarpal2"), 29, 0.7, -0.4, 0.2 },
+		{ TEXT("lMid1"), 34, 7.5, -0.3, 0 },
+		{ TEXT("lMid2"), 35, 4.3, 0, 0 },
+		{ TEXT("lMid3"), 36, 2.5, 0, 0 },
+		{ TEXT("lCarpal3"), 29, 0.8, -0.4, -0.8 },
+		{ TEXT("lRing1"), 38, 6.9, -0.2, 0.0 },
+		{ TEXT("lRing2"), 39, 4.0, 0, 0 },
+		{ TEXT("lRing3"), 40, 2.2, 0, 0 },
+		{ TEXT("lCarpal4"), 29, 0.7, -0.4, 1.7 },
+		{ TEXT("lPinky1"), 42, 6.5, 0.2, 0 },
+		{ TEXT("lPinky2"), 43, 2.8, 0, 0 },
+		{ TEXT("lPinky3"), 44, 1.7, 0, 0 },
+		{ TEXT("lThumb1"), 29, 1.4, 0.7, 1.6 },
+		{ TEXT("lThumb2"), 46, 4.1, 0, 0 },
+		{ TEXT("lThumb3"), 47, 3.0, 0, 0 },
+		{ TEXT("rForearmTwist"), 27, -12.1, 0, 0 },
+		{ TEXT("rHand"), 49, -14.2, 0, -0.3 },
+		{ TEXT("rCarpal1"), 50, -0.4, -0.4, 1.1 },
+		{ TEXT("rIndex1"), 51, -7.6, -0.2, 0.1 },
+		{ TEXT("rIndex2"), 52, -3.9, 0, 0 },
+		{ TEXT("rIndex3"), 53, -2.1, 0, 0 },
+		{ TEXT("rCarpal2"), 50, 0.7, -0.4, 0.2 },
+		{ TEXT("rMid1"), 55, -7.5, -0.3, 0 },
+		{ TEXT("rMid2"), 56, -4.3, 0, 0 },
+		{ TEXT("rMid3"), 57, -2.5, 0, 0 },
+		{ TEXT("rCarpal3"), 50, -0.8, -0.4, 0.8 },
+		{ TEXT("rRing1"), 59, -6.9, -0.2, 0 },
+		{ TEXT("rRing2"), 60, -4.0, 0, 0 },
+		{ TEXT("rRing3"), 61, -2.2, 0, 0 },
+		{ TEXT("rCarpal4"), 50, -0.7, -0.4, 1.7 },
+		{ TEXT("rPinky1"), 63, -6.5, 0.2, 0 },
+		{ TEXT("rPinky2"), 64, -2.8, 0, 0 },
+		{ TEXT("rPinky3"), 65, -1.7, 0, 0 },
+		{ TEXT("rThumb1"), 50, -1.4, 0.7, 1.6 },
+		{ TEXT("rThumb2"), 67, -4.1, 0, 0 },
+		{ TEXT("rThumb3"), 68, -3.0, 0, 0 },
+	};
+};
+
+
+/* joints a rig streams: its body and both hands */
+template <typename TRigTraits>
+constexpr int32 PoseAIRigNumJoints() {
+	return TRigTraits::NumBodyJoints + 2 * TRigTraits::NumHandJoints;
+}
+
+/* joints of the largest rig above, for buffers sized to fit any of them */
+constexpr int32 PoseAIMaxRigJoints() {
+	return FMath::Max(FMath::Max(FMath::Max(PoseAIRigNumJoints<FPoseAIRigTraitsUE4>(), PoseAIRigNumJoints<FPoseAIRigTraitsMixamo>()),
+		FMath::Max(PoseAIRigNumJoints<FPoseAIRigTraitsMixamoAlt>(), PoseAIRigNumJoints<FPoseAIRigTraitsMetaHuman>())),
+		PoseAIRigNumJoints<FPoseAIRigTraitsDazUE>());
+}
@@ -0,0 +1,81 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+
+/**
+ * Single writer, many reader snapshot of a plain struct, lock-free on both sides.  The value is double buffered under a sequence number:
+ * the writer fills the buffer readers are not directed to and then publishes it by bumping the sequence.  Each buffer also has its own
+ * seqlock count, odd while the buffer is written, so a reader still copying a buffer the writer came back around to retries rather than
+ * accept a torn value, on weakly ordered CPUs too.  Neither side ever waits on the other, which suits a worker publishing at packet
+ * rate to readers polling once per tick, or the reverse.  T must be safe to copy while being overwritten, i.e. hold no pointers or containers.
+ */
+template <typename T>
+class TPoseAISeqLock
+{
+public:
+	TPoseAISeqLock() = default;
+	explicit TPoseAISeqLock(const T& initial) {
+		buffers[0] = initial;
+		buffers[1] = initial;
+	}
+
+	/* writer: must only be called from one thread at a time */
+	void Write(const T& value) {
+		WriteInPlace([&value](T& buffer) { buffer = value; });
+	}
+
+	/* reader: copies the most recently published value */
+	void Read(T& outValue) const {
+		ReadInPlace([&outValue](const T& value) { outValue = value; });
+	}
+
+	T Read() const {
+		T value;
+		Read(value);
+		return value;
+	}
+
+	/* writer: fills the unpublished buffer in place with fill(T&), for values too large to build and then copy */
+	template <typename FillFn>
+	void WriteInPlace(FillFn&& fill) {
+		const uint32 next = sequence.load(std::memory_order_relaxed) + 1;
+		std::atomic<uint32>& bufferSequence = bufferSequences[next & 1];
+		const uint32 written = bufferSequence.load(std::memory_order_relaxed);
+		// odd while the buffer is being overwritten, and ordered before any of the data stores
+		bufferSequence.store(written + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		fill(buffers[next & 1]);
+		bufferSequence.store(written + 2, std::memory_order_release);
+		sequence.store(next, std::memory_order_release);
+	}
+
+	/* reader: calls visit(const T&) on the most recently published value, again if it was overwritten meanwhile, so visit must only copy out */
+	template <typename VisitFn>
+	void ReadInPlace(VisitFn&& visit) const {
+		for (;;) {
+			const uint32 index = sequence.load(std::memory_order_acquire) & 1;
+			const uint32 before = bufferSequences[index].load(std::memory_order_acquire);
+			if (before & 1)
+				continue;
+			visit(buffers[index]);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// unchanged and even, so the writer did not touch the buffer while it was visited
+			if (bufferSequences[index].load(std::memory_order_relaxed) == before)
+				return;
+		}
+	}
+
+	/* number of values written, so readers can skip work if nothing new was published */
+	uint32 GetSequence() const { return sequence.load(std::memory_order_acquire); }
+
+private:
+	T buffers[2];
+	std::atomic<uint32> sequence{ 0 };
+	// per buffer seqlock counts, odd while the writer fills that buffer
+	std::atomic<uint32> bufferSequences[2] = { 0, 0 };
+};
@@ -0,0 +1,36 @@
+// Copyright Pose AI Ltd. All Rights Reserved.
+
+#include "AnimGraphNode_PoseAIDirectPose.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+/////////////////////////////////////////////////////
+// UAnimGraphNode_PoseAIDirectPose
+
+
+UAnimGraphNode_PoseAIDirectPose::UAnimGraphNode_PoseAIDirectPose(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+FText UAnimGraphNode_PoseAIDirectPose::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("AnimGraphNode_PoseAIDirectPose_Title", "PoseAI Direct Pose");
+}
+
+FText UAnimGraphNode_PoseAIDirectPose::GetTooltipText() const
+{
+	return LOCTEXT("AnimGraphNode_PoseAIDirectPose_Tooltip", "Poses the skeleton from a PoseAI subject without going through LiveLink, latching the newest frame when the node is evaluated.");
+}
+
+FLinearColor UAnimGraphNode_PoseAIDirectPose::GetNodeTitleColor() const
+{
+	return FLinearColor(0.75f, 0.75f, 0.1f);
+}
+
+FString UAnimGraphNode_PoseAIDirectPose::GetNodeCategory() const
+{
+	return TEXT("PoseAI");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,37 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeleton;
+
+
+struct FPoseAIBakeSettings
+{
+	/* .paicap files written by PoseAI.CaptureStart */
+	TArray<FString> Files;
+	/* the skeleton of the rig the captures streamed, whose bones the rig's joints are matched to by name */
+	USkeleton* Skeleton = nullptr;
+	/* long package path the sequences are saved under, one per file named after it */
+	FString OutputPath = TEXT("/Game/PoseAI/Bakes");
+	int32 FrameRate = 30;
+	/* capture blocks decoded per parallel task.  At 256 KiB each, 4 blocks hold from a few seconds of verbose to a minute of binary frames */
+	int32 ChunkBlocks = 4;
+};
+
+
+/**
+ * Bakes captures into animation sequences offline: body and hand bone tracks, root motion on the root bone and the face blend shapes
+ * as curves.  Frames are decoded by the same rig and face code as the live sources, configured from the captured handshake, and
+ * sampled at a fixed frame rate by interpolating between the two frames around each key.
+ * Every file is cut into chunks of capture blocks which are decoded in parallel, each by a rig of its own.  A chunk first runs
+ * the block before its own through its rig without keeping the output, so poses cached for joints missing from a frame match
+ * those of a rig which had processed the file from its start.
+ */
+class POSEAILIVELINKED_API FPoseAICaptureBaker
+{
+public:
+	/* game thread: bakes and saves every file, returning the number of sequences written */
+	static int32 Bake(const FPoseAIBakeSettings& settings);
+};
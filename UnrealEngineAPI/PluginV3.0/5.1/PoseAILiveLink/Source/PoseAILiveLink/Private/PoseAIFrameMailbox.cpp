@@ -0,0 +1,86 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIFrameMailbox.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+FPoseAIFrameMailbox::FPoseAIFrameMailbox() {
+}
+
+void FPoseAIFrameMailbox::Publish(TArrayView<const uint8> bytes, uint32 signature, double receiveTime) {
+	FSlot& back = slots[backIndex];
+	back.bytes.Reset();
+	back.bytes.Append(bytes.GetData(), bytes.Num());
+	back.signature = signature;
+	back.receiveTime = receiveTime;
+	back.sequence = published;
+	back.bHasEventChange = signature != lastSignature;
+	lastSignature = signature;
+
+	const uint32 previous = latest.exchange(backIndex | DIRTY);
+	backIndex = previous & INDEX_MASK;
+	published++;
+
+	// the consumer never took the previous packet, so the producer owns it again
+	if (previous & DIRTY) {
+		overwritten++;
+		FSlot& lost = slots[backIndex];
+		if (lost.bHasEventChange) {
+			const uint64 tail = eventTail.load(std::memory_order_relaxed);
+			const int32 depth = (int32)(tail - eventHead.load(std::memory_order_acquire));
+			if (depth < EVENT_QUEUE_CAPACITY) {
+				// the slots keep their allocations, so once grown to the packet size queuing does not allocate
+				FEventSlot& slot = eventSlots[tail % EVENT_QUEUE_CAPACITY];
+				slot.bytes.Reset();
+				slot.bytes.Append(lost.bytes);
+				slot.sequence = lost.sequence;
+				eventTail.store(tail + 1, std::memory_order_release);
+				eventFramesQueued++;
+				if (depth + 1 > maxEventQueueDepth)
+					maxEventQueueDepth = depth + 1;
+			}
+			else {
+				eventFramesDropped++;
+			}
+		}
+	}
+}
+
+const TArray<uint8>* FPoseAIFrameMailbox::PeekEventFrame(uint64 sequence) const {
+	const uint64 head = eventHead.load(std::memory_order_relaxed);
+	if (head == eventTail.load(std::memory_order_acquire))
+		return nullptr;
+	const FEventSlot& slot = eventSlots[head % EVENT_QUEUE_CAPACITY];
+	return slot.sequence < sequence ? &slot.bytes : nullptr;
+}
+
+void FPoseAIFrameMailbox::PopEventFrame() {
+	eventHead.store(eventHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+const TArray<uint8>* FPoseAIFrameMailbox::TakeLatest() {
+	if (!(latest.load() & DIRTY))
+		return nullptr;
+	frontIndex = latest.exchange(frontIndex) & INDEX_MASK;
+	return &slots[frontIndex].bytes;
+}
+
+bool FPoseAIFrameMailbox::FinishDrain() {
+	drainScheduled = false;
+	const bool hasWork = (latest.load() & DIRTY) || eventHead.load() != eventTail.load();
+	return hasWork && TryScheduleDrain();
+}
+
+FPoseAIMailboxStats FPoseAIFrameMailbox::GetStats() const {
+	FPoseAIMailboxStats stats;
+	stats.Published = published;
+	stats.Overwritten = overwritten;
+	stats.EventFramesQueued = eventFramesQueued;
+	stats.EventFramesDropped = eventFramesDropped;
+	stats.EventQueueDepth = (int32)(eventTail.load() - eventHead.load());
+	stats.MaxEventQueueDepth = maxEventQueueDepth;
+	return stats;
+}
+
+#undef LOCTEXT_NAMESPACE
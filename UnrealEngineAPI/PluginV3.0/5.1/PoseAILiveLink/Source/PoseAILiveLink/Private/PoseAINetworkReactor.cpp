@@ -0,0 +1,148 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAINetworkReactor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+static TAutoConsoleVariable<int32> CVarPoseAINetworkThreads(
+	TEXT("PoseAI.NetworkThreads"),
+	1,
+	TEXT("Number of threads receiving for all PoseAI network sources.  One suits a few phones, installations with many booths per machine may want 2 to 4.  Read when the first source opens."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPoseAINetworkIdleWait(
+	TEXT("PoseAI.NetworkIdleWaitMs"),
+	0.5f,
+	TEXT("How long an idle network thread serving several sockets waits on the socket with the latest traffic before checking the others.  This bounds the delay added to a packet arriving on any other socket of the thread, at the cost of up to 1000 / value wakeups a second while all are idle.  Threads with a single socket wait on it for up to 10 ms, as its packets wake them at once."),
+	ECVF_Default);
+
+
+FPoseAINetworkReactor& FPoseAINetworkReactor::Get() {
+	static FPoseAINetworkReactor reactor;
+	return reactor;
+}
+
+void FPoseAINetworkReactor::Register(TSharedPtr<FPoseAIUdpSocketReceiver> receiver) {
+	if (!receiver.IsValid())
+		return;
+
+	FScopeLock scopeLock(&lock);
+	if (workers.Num() == 0) {
+		const int32 numWorkers = FMath::Clamp(CVarPoseAINetworkThreads.GetValueOnAnyThread(), 1, 8);
+		for (int32 i = 0; i < numWorkers; ++i)
+			workers.Add(MakeUnique<FWorker>(i));
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: started %d network thread(s)"), numWorkers);
+	}
+
+	FWorker* leastLoaded = workers[0].Get();
+	for (const TUniquePtr<FWorker>& worker : workers) {
+		if (worker->Num() < leastLoaded->Num())
+			leastLoaded = worker.Get();
+	}
+	leastLoaded->Add(receiver);
+}
+
+void FPoseAINetworkReactor::Unregister(TSharedPtr<FPoseAIUdpSocketReceiver> receiver) {
+	if (!receiver.IsValid())
+		return;
+
+	receiver->Stop();
+	FScopeLock scopeLock(&lock);
+	for (const TUniquePtr<FWorker>& worker : workers) {
+		if (worker->Remove(receiver))
+			return;
+	}
+}
+
+void FPoseAINetworkReactor::Shutdown() {
+	FScopeLock scopeLock(&lock);
+	workers.Reset();
+}
+
+int32 FPoseAINetworkReactor::NumSockets() const {
+	FScopeLock scopeLock(&lock);
+	int32 total = 0;
+	for (const TUniquePtr<FWorker>& worker : workers)
+		total += worker->Num();
+	return total;
+}
+
+
+FPoseAINetworkReactor::FWorker::FWorker(int32 index) {
+	wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	const FString threadName = TEXT("PoseAILiveLink_Network_") + FString::FromInt(index);
+	thread = FRunnableThread::Create(this, *threadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
+}
+
+FPoseAINetworkReactor::FWorker::~FWorker() {
+	if (thread != nullptr) {
+		thread->Kill(true);
+		delete thread;
+		thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+	wakeEvent = nullptr;
+}
+
+uint32 FPoseAINetworkReactor::FWorker::Run() {
+	while (running) {
+		bool readAny = false;
+		TSharedPtr<FPoseAIUdpSocketReceiver> waitOn;
+		FTimespan idleWait;
+		{
+			// held while delegates run, so Remove only returns once its receiver is out of use
+			FScopeLock scopeLock(&lock);
+			for (const TSharedPtr<FPoseAIUdpSocketReceiver>& receiver : receivers) {
+				if (receiver->Poll(buffer)) {
+					readAny = true;
+					lastActive = receiver;
+				}
+			}
+			if (!readAny && receivers.Num() > 0) {
+				// the socket with the latest traffic is the likeliest to deliver next
+				waitOn = lastActive.IsValid() ? lastActive : receivers[nextWait++ % receivers.Num()];
+				idleWait = receivers.Num() == 1 ? FTimespan::FromMilliseconds(SINGLE_SOCKET_WAIT_MS) :
+					FTimespan::FromMilliseconds(FMath::Clamp(CVarPoseAINetworkIdleWait.GetValueOnAnyThread(), 0.05f, 10.0f));
+			}
+		}
+
+		if (readAny)
+			continue;
+		if (waitOn.IsValid())
+			// a packet on this socket wakes us at once, the others are picked up by the next sweep
+			waitOn->WaitForRead(idleWait);
+		else
+			wakeEvent->Wait();
+	}
+	return 0;
+}
+
+void FPoseAINetworkReactor::FWorker::Stop() {
+	running = false;
+	wakeEvent->Trigger();
+}
+
+void FPoseAINetworkReactor::FWorker::Add(TSharedPtr<FPoseAIUdpSocketReceiver> receiver) {
+	{
+		FScopeLock scopeLock(&lock);
+		receivers.AddUnique(receiver);
+	}
+	wakeEvent->Trigger();
+}
+
+bool FPoseAINetworkReactor::FWorker::Remove(TSharedPtr<FPoseAIUdpSocketReceiver> receiver) {
+	FScopeLock scopeLock(&lock);
+	if (lastActive == receiver)
+		lastActive.Reset();
+	return receivers.Remove(receiver) > 0;
+}
+
+int32 FPoseAINetworkReactor::FWorker::Num() const {
+	FScopeLock scopeLock(&lock);
+	return receivers.Num();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,27 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Vectorized decoding of the compact (PF=1) base64 fixed point encoding, where each value is two base64 characters holding 12 bits.
+ * Characters are mapped to 6 bit values with a shuffle based lookup (AVX2, SSE4.1 or NEON depending on the platform, with a scalar fallback)
+ * and converted to floats through two 64 entry tables built from FixedB64pairToFloat, so results are bit-exact with the original decoder.
+ * Strings with characters outside the standard base64 alphabet fall back to FixedB64pairToFloat.
+ */
+
+/* float for a 12 bit fixed point value, equal to FixedB64pairToFloat of the corresponding base64 pair */
+POSEAILIVELINK_API float Fixed12ToFloat(uint32 value);
+
+/* decodes numChars characters (two per value) into out, which must hold numChars / 2 floats. Returns number of floats written */
+POSEAILIVELINK_API int32 Fixed12DecodeFloats(const UTF8CHAR* chars, int32 numChars, float* out);
+POSEAILIVELINK_API int32 Fixed12DecodeFloats(const TCHAR* chars, int32 numChars, float* out);
+
+/* decodes numChars characters (eight per quaternion) into normalized quaternions appended to quatArray. Returns number appended */
+POSEAILIVELINK_API int32 Fixed12DecodeQuats(const UTF8CHAR* chars, int32 numChars, TArray<FQuat>& quatArray);
+POSEAILIVELINK_API int32 Fixed12DecodeQuats(const TCHAR* chars, int32 numChars, TArray<FQuat>& quatArray);
+
+/* the instruction set used by the character mapping, for logs and the PoseAI.Fixed12Benchmark console command */
+POSEAILIVELINK_API const TCHAR* Fixed12DecoderPath();
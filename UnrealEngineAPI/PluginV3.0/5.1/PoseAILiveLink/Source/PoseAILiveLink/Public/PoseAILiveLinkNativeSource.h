@@ -17,8 +17,13 @@
 #include "HAL/RunnableThread.h"
 #include "Json.h"
 #include "PoseAIRig.h"
+#include "PoseAIQuantizedRole.h"
 #include "PoseAIStructs.h"
 #include "PoseAILiveLinkFaceSubSource.h"
+#include "PoseAISubjectPublisher.h"
+#include "PoseAILatencyTracker.h"
+#include "PoseAIPipelineStats.h"
+#include "PoseAICaptureFile.h"
 
 
 /**
@@ -37,6 +42,11 @@ public:
 	static TWeakPtr<PoseAILiveLinkNativeSource> AddSource(FName subjectName, const FPoseAIHandshake& handshake);
 	bool AddSubject();
 	void ReceivePacket(const FString& recvMessage);
+	// UTF-8 json or binary packet bytes straight from the camera, avoiding the FString conversion for compact and binary frames
+	void ReceivePacket(TArrayView<const uint8> recvBytes);
+	/* keeps the source out of PoseAI.CaptureStart captures, for sources fed from a capture */
+	void DisableCapture() { captureTap.Reset(); }
+	FGuid GetSourceGuid() const { return sourceGuid; }
 
 	PoseAILiveLinkNativeSource(FName subjectName, const FPoseAIHandshake& handshake);
 
@@ -51,12 +61,16 @@ public:
 	virtual void OnSettingsChanged(ULiveLinkSourceSettings* Settings, const FPropertyChangedEvent& PropertyChangedEvent) {}
 	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
 	virtual bool RequestSourceShutdown();
-	virtual void Update() override {};
+	/* creates and removes the derived subjects set with PoseAIRig::SetDerivedSubject.  Called by the LiveLink client on the game thread */
+	virtual void Update() override;
 	
 public:
 	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rig;
 	void disable();
 	void UpdatePose(TSharedPtr<FJsonObject> jsonPose);
+	void UpdatePose(const FPoseAIBinaryPacket& packet);
+	void UpdatePose(const FPoseAICompactFrame& frame);
+	void UpdatePose(const FPoseAIVerboseFrame& frame);
 
 private:
 	FGuid sourceGuid ;
@@ -66,7 +80,26 @@ private:
 	FCriticalSection InSynchObject;
 	FPoseAIHandshake handshake;
 	TUniquePtr<PoseAILiveLinkFaceSubSource> faceSubSource;
+	FPoseAIFrameTrace latencyTrace;
+	uint64 parseStartCycles = 0;
 
 	mutable FText status;
+	FPoseAIPipelineStats* pipelineStats;
+	TUniquePtr<FPoseAICaptureTap> captureTap;
+
+	void BeginTrace() {
+		latencyTrace = FPoseAIFrameTrace();
+		latencyTrace.Received = FPlatformTime::Seconds();
+		parseStartCycles = FPlatformTime::Cycles64();
+	}
+	/* stamps the latency trace and times the parse since BeginTrace */
+	void MarkParsed() {
+		latencyTrace.Parsed = FPlatformTime::Seconds();
+		pipelineStats->AddTime(EPoseAIPipelineTimer::Parse, FPlatformTime::Cycles64() - parseStartCycles);
+	}
+	/* parses a json packet without restarting the latency trace, for the byte path's fallback */
+	void ReceiveText(const FString& recvMessage);
+	// pushes the rig's frames to the subject and its derived subjects, created with the client in ReceiveClient
+	TUniquePtr<FPoseAISubjectPublisher> publisher;
 	
 };
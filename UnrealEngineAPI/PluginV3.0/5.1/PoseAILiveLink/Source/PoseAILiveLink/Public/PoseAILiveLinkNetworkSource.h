@@ -17,9 +17,13 @@
 #include "HAL/RunnableThread.h"
 #include "Json.h"
 #include "PoseAIRig.h"
+#include "PoseAIQuantizedRole.h"
+#include "PoseAILatencyTracker.h"
+#include "PoseAIPipelineStats.h"
 #include "PoseAILiveLinkServer.h"
 #include "PoseAIStructs.h"
 #include "PoseAILiveLinkFaceSubSource.h"
+#include "PoseAISubjectPublisher.h"
 
 
 
@@ -34,7 +38,8 @@ class PoseAILiveLinkSingleSourceListener;
 
 /**
  * Redesigned so that each phone is associated with a single source, on a single port, for simplicity. 
- * Each source maintains its own "server" object, which generates the UDP socket, a listener and a sender class on their own threads.
+ * Each source maintains its own "server" object, which generates the UDP socket, a listener and a sender class.  Listeners of all sources
+ * share the threads of FPoseAINetworkReactor.
  * The server feeds into the EventDispatcher system to trigger connection events.  Incoming packets are processed by the Rig class to 
  * trigger frame events and update the LiveLink pose source information.
  */
@@ -63,7 +68,8 @@ public:
 	virtual void OnSettingsChanged(ULiveLinkSourceSettings* Settings, const FPropertyChangedEvent& PropertyChangedEvent) {}
 	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
 	virtual bool RequestSourceShutdown();
-	virtual void Update() override {}
+	/* creates and removes the derived subjects set with PoseAIRig::SetDerivedSubject.  Called by the LiveLink client on the game thread */
+	virtual void Update() override;
 	
 	// custom methods
 	static bool GetPortGuid(int32 port, FGuid& fguid);
@@ -79,6 +85,27 @@ public:
 
 	/* Main processing method */
 	void UpdatePose(TSharedPtr<FJsonObject> jsonPose);
+	void UpdatePose(const FPoseAIBinaryPacket& packet);
+	void UpdatePose(const FPoseAICompactFrame& frame);
+	void UpdatePose(const FPoseAIVerboseFrame& frame);
+
+	/* latency tracing and parse timing of the next frame passed to UpdatePose, called by the server's worker */
+	void BeginTrace(double receiveTime) {
+		latencyTrace = FPoseAIFrameTrace();
+		latencyTrace.Received = receiveTime;
+		parseStartCycles = FPlatformTime::Cycles64();
+	}
+	void MarkParsed() {
+		latencyTrace.Parsed = FPlatformTime::Seconds();
+		pipelineStats->AddTime(EPoseAIPipelineTimer::Parse, FPlatformTime::Cycles64() - parseStartCycles);
+	}
+	FPoseAIPipelineStats& GetPipelineStats() const { return *pipelineStats; }
+
+	/* Frames the mailbox overwrote before the worker took them only update live values and events, as LiveLink would discard their pose */
+	void ScanPose(const FPoseAIBinaryPacket& packet);
+	void ScanPose(const FPoseAICompactFrame& frame);
+	void ScanPose(const FPoseAIVerboseFrame& frame);
+	void ScanPose(TSharedPtr<FJsonObject> jsonPose);
 	
 private:
 	// We use a sharedref so that bindSP can be used to create weak references.  This is only owner outside of the delegate system.
@@ -100,8 +127,13 @@ private:
 	TUniquePtr<PoseAILiveLinkFaceSubSource> faceSubSource;
 	mutable FText status;
 	FCriticalSection InSynchObject;
+	FPoseAIFrameTrace latencyTrace;
+	uint64 parseStartCycles = 0;
+	FPoseAIPipelineStats* pipelineStats;
 
 	void AddSubject();
+	// pushes the rig's frames to the subject and its derived subjects, created with the client in ReceiveClient
+	TUniquePtr<FPoseAISubjectPublisher> publisher;
 
 };
 
@@ -136,7 +168,7 @@ public:
 	void SendConfig(const FLiveLinkSubjectName& target, FPoseAIModelConfig config) {
 		if (isMe(target)) {
 			FString message_string = config.ToString();
-			if (parent->udpServer.SendString(message_string))
+			if (parent->udpServer.SendString(message_string, EPoseAISendKind::Config))
 				UE_LOG(LogTemp, Display, TEXT("PoseAI: Sent config %s"), *message_string);
 		}
 	}
@@ -3,6 +3,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "LiveLinkRetargetAsset.h"
+#include "BoneIndices.h"
 #include "PoseAILiveLinkRetargetRotations.generated.h"
 
 // Rretarget asset for data coming from Live Link. Remaps rotations onto all bones and only translations for root and pelvis/hip.
@@ -29,6 +30,17 @@ private:
 	
 	void OnBlueprintClassCompiled(UBlueprint* TargetBlueprint);
 
+	/* maps the subject's bones to the compact pose and caches their reference translations and scales */
+	void RebuildBoneMap(const FLiveLinkSkeletonStaticData* InSkeletonData, const FCompactPose& OutPose);
+
+	// indexed by LiveLink bone, rebuilt when the required bones or the subject's bones change
+	TArray<FCompactPoseBoneIndex> compactIndices;
+	TArray<FVector> refTranslations;
+	TArray<FVector> refScales;
+	TArray<FName> cachedBoneNames;
+	const FBoneContainer* cachedBoneContainer = nullptr;
+	uint16 cachedSerialNumber = 0;
+
 
 #if WITH_EDITOR
 	/** Blueprint.OnCompiled delegate handle */
@@ -9,15 +9,111 @@
 #include "Roles/LiveLinkAnimationTypes.h"
 #include "Json.h"
 #include "PoseAIStructs.h"
+#include "PoseAIBinaryPacket.h"
+#include "PoseAICompactFrame.h"
+#include "PoseAIVerboseFrame.h"
+#include "PoseAIRigDefinitions.h"
+#include "PoseAIEventRecord.h"
+#include "HAL/CriticalSection.h"
+#include "PoseAISeqLock.h"
+#include "PoseAIPipelineStats.h"
 
 struct POSEAILIVELINK_API Remapping
 {
 	FName TargetJointName;
 	FQuat RotAdj;
+	// translation of the target joint relative to its parent in the target's reference pose
+	FVector BindTranslation = FVector::ZeroVector;
 	Remapping(FName TargetJointName, FQuat RotAdj) : TargetJointName(TargetJointName), RotAdj(RotAdj) {};
+	Remapping(FName TargetJointName, FQuat RotAdj, FVector BindTranslation) : TargetJointName(TargetJointName), RotAdj(RotAdj), BindTranslation(BindTranslation) {};
 };
 
 
+/**
+ * A rig's remapping onto a target skeleton, one entry per rig joint in rig order.  A joint's target component rotation is its rig
+ * component rotation times RotAdj, so its local rotation is the parent's inverse RotAdj, times its rig local rotation, times its own RotAdj.
+ * Immutable once built, so the worker and the game thread can share it.
+ */
+struct FPoseAIRemapTable
+{
+	TArray<Remapping> Joints;
+	TArray<FQuat> ParentRotAdjInverse;
+	TArray<FName> TargetNames;
+	int32 Generation = 0;
+};
+
+
+/* another LiveLink subject published from every frame of a rig, converted through its own remap table or copied if it has none */
+struct FPoseAIDerivedSubject
+{
+	FLiveLinkSubjectName SubjectName;
+	TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> Remap;
+};
+
+
+/* root motion settings owned by the game thread.  Published to the rig as a whole, so a frame never sees a half updated set */
+struct FPoseAIMotionConfig
+{
+	//ankle to head top height for scaling PoseAI root motion.
+	float rigHeight = 170.0f;
+	FVector rootOffset = FVector(0.0f, 0.0f, 0.0f);
+	FRotator cameraRotation = FRotator(0.0f, 0.0f, 0.0f);
+	FVector scaleMotion = FVector(1.0f, 0.0f, 1.0f);
+};
+
+
+/**
+ * The latest pose decoded by a rig, published for FAnimNode_PoseAIDirectPose to latch at evaluation time without going through LiveLink.
+ * Holds both the local rotations sent to LiveLink and the component space rotations they were converted from, as the camera sends them,
+ * both remapped onto the target skeleton if the subject has a retarget asset.
+ * Fixed size, so it can be published through TPoseAISeqLock.
+ */
+struct FPoseAIDirectPoseFrame
+{
+	// joints of the largest rig in PoseAIRigDefinitions.h, currently DazUE at 28 body and 2 * 21 hand joints
+	static constexpr int32 MaxJoints = PoseAIMaxRigJoints();
+
+	int32 NumJoints = 0;
+	// FPoseAIRemapTable::Generation of the remapping applied to the rotations, 0 if none
+	int32 RemapGeneration = 0;
+	// the frame's device timestamp
+	double Timestamp = 0.0;
+	// the frame's LiveLink world time, by which FPoseAILatencyTracker matches evaluations to frames
+	double WorldTime = 0.0;
+	// root motion, as assigned to the root joint's translation for LiveLink
+	FVector RootTranslation = FVector::ZeroVector;
+	FQuat LocalRotations[MaxJoints];
+	FQuat ComponentRotations[MaxJoints];
+};
+
+
+/**
+ * Joint name to joint index lookup for the verbose format, built once when the rig is configured.  Names are stored and hashed
+ * lowercased as UTF-8, so packet keys are matched in place, case insensitively like FName, without converting them to FName or FString.
+ */
+class POSEAILIVELINK_API FPoseAIJointNameIndex
+{
+public:
+	void Build(const TArray<FName>& jointNames);
+	/* joint index, or INDEX_NONE */
+	int32 Find(FUtf8StringView name) const;
+	int32 Find(FStringView name) const;
+
+private:
+	struct FSlot
+	{
+		int32 KeyOffset = 0;
+		int32 KeyLen = 0;
+		int32 Joint = INDEX_NONE;
+	};
+	TArray<UTF8CHAR> keys;
+	TArray<FSlot> slots;
+	uint32 slotMask = 0;
+
+	template <typename CharType>
+	int32 FindChars(const CharType* chars, int32 len) const;
+};
+
 
 /**
  * Abstract base class for the different rig formats streamable by Pose AI
@@ -26,22 +122,85 @@ class POSEAILIVELINK_API PoseAIRig
 {
   public:
 	FLiveLinkStaticDataStruct MakeStaticData();
+	/* static data for ULiveLinkPoseAIQuantizedRole, the skeleton with its bind translations */
+	FLiveLinkStaticDataStruct MakeQuantizedStaticData() const;
 	bool ProcessFrame(const TSharedPtr<FJsonObject>, FLiveLinkAnimationFrameData& data);
+	bool ProcessFrame(const FPoseAIBinaryPacket& packet, FLiveLinkAnimationFrameData& data);
+	bool ProcessFrame(const FPoseAICompactFrame& frame, FLiveLinkAnimationFrameData& data);
+	bool ProcessFrame(const FPoseAIVerboseFrame& frame, FLiveLinkAnimationFrameData& data);
+	/* for frames overwritten in the mailbox by a newer one: updates live values, events and visibility but skips the rotations */
+	bool ScanFrame(const FPoseAIBinaryPacket& packet);
+	bool ScanFrame(const FPoseAICompactFrame& frame);
+	bool ScanFrame(const FPoseAIVerboseFrame& frame);
+	bool ScanFrame(const TSharedPtr<FJsonObject> jsonObject);
 	static bool IsFrameData(const TSharedPtr<FJsonObject> jsonObject);
 	static TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRigFactory(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake);
+	/* a rig for console diagnostics which leaves no global state: it is not registered under its name, keeps its stats to itself and
+	   neither queues events nor notifies stream listeners */
+	static TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> MakeDetachedRig(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake);
 	static TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> GetRigFromSubjectName(const FLiveLinkSubjectName& name);
 	FName RigType() { return rigType; }
+	int32 NumBodyJoints() const { return numBodyJoints; }
+	int32 NumHandJoints() const { return numHandJoints; }
+
+	/* number of times a scratch or cached pose buffer had to grow after ReserveScratch.  Stays at 0 in steady state */
+	int32 GetScratchGrowths() const { return scratchGrowths; }
 	
+	/* the live values of the last processed frame.  Safe to call from any thread, without waiting on the worker */
+	FPoseAILiveValues GetLatestLiveValues() const { return liveValuesSnapshot.Read(); }
+	static bool GetLatestLiveValues(const FLiveLinkSubjectName& name, FPoseAILiveValues& outValues);
+
+	/* the pose of the last processed frame, read lock-free.  Empty until the first frame with rotations */
+	const TPoseAISeqLock<FPoseAIDirectPoseFrame>& GetDirectPose() const { return directPose; }
+	/* joint names by pose index, fixed once the rig is configured */
+	const TArray<FName>& GetJointNames() const { return jointNames; }
+
+	/**
+	 * game thread: remaps the subject's rig onto a target skeleton, from the next processed frame and for rigs created for the subject
+	 * later.  Keyed by rig joint name, joints left out keep their name and pose.  An empty map removes the remapping.
+	 * Remappings authored for another sourceRig than the subject's rig are refused with a warning, now or when the rig is created.
+	 */
+	static void SetRemapping(const FLiveLinkSubjectName& name, const TMap<FName, Remapping>& remappings, TOptional<EPoseAiRigPresets> sourceRig = {});
+	/* game thread: the joint names frames are output with, the target's once a remapping is set, and the remapping's generation */
+	const TArray<FName>& GetOutputJointNames() const { return gameRemap.IsValid() ? gameRemap->TargetNames : jointNames; }
+	int32 GetRemapGeneration() const { return gameRemap.IsValid() ? gameRemap->Generation : 0; }
+	/* worker: whether the bones changed since the last call, as a remapping was applied or removed, so the static data must be pushed again */
+	bool TakeStaticDataChanged() { return staticDataChanged.exchange(false, std::memory_order_relaxed); }
+
+	/**
+	 * game thread: publishes the subject's frames again as derivedName, converted with remappings keyed by rig joint name (for instance
+	 * those of a UPoseAIRetargetAsset onto another rig's skeleton), so one stream drives skeletons of different rigs without decoding twice.
+	 * Sources create the derived subjects when they see a new generation, then call ApplyDerivedSubjects on their rig.  Remappings
+	 * authored for another sourceRig are refused as with SetRemapping.
+	 */
+	static void SetDerivedSubject(const FLiveLinkSubjectName& name, const FLiveLinkSubjectName& derivedName, const TMap<FName, Remapping>& remappings,
+		TOptional<EPoseAiRigPresets> sourceRig = {});
+	static void RemoveDerivedSubject(const FLiveLinkSubjectName& name, const FLiveLinkSubjectName& derivedName);
+	/* game thread: changes whenever a derived subject is set or removed for any subject */
+	static int32 GetDerivedSubjectsGeneration() { return DerivedSubjectsGeneration; }
+	/* game thread: names of the subjects derived from this rig's subject, as set */
+	TArray<FLiveLinkSubjectName> GetDerivedSubjectNames() const;
+	/* game thread: builds the remap tables of the derived subjects and posts them to the worker, from the next processed frame */
+	void ApplyDerivedSubjects();
+	/* worker: the derived subjects converted by the last processed frame, and whether they changed since the last call */
+	int32 NumDerivedSubjects() const { return activeDerived.IsValid() ? activeDerived->Num() : 0; }
+	const FLiveLinkSubjectName& GetDerivedSubjectName(int32 index) const { return (*activeDerived)[index].SubjectName; }
+	const FLiveLinkAnimationFrameData& GetDerivedFrame(int32 index) const { return derivedFrames[index]; }
+	FLiveLinkStaticDataStruct MakeDerivedStaticData(int32 index, bool quantized) const;
+	bool TakeDerivedSubjectsChanged() { return derivedChanged.exchange(false, std::memory_order_relaxed); }
+
+	/* game thread: the root motion settings, applied from the next processed frame */
+	FPoseAIMotionConfig GetMotionConfig() const { return motionConfig.Read(); }
+	void SetMotionConfig(const FPoseAIMotionConfig& config) { motionConfig.Write(config); }
+
+	/* worker: forgets the latest frame's timestamp, so a replay looping back to the start of a capture is not dropped as stale */
+	void ResetTimestamp() { liveValues.timestamp = 0.0; }
+
+	// written and read by the worker processing this rig's frames.  Other threads use the snapshot and config accessors above
 	FPoseAIVisibilityFlags visibilityFlags;
     FPoseAILiveValues liveValues;
 	FPoseAIScalarStruct scalars;
 	FPoseAIEventStruct events;
-  
-	bool useNextRootAsOffset = false;
-	//ankle to head top height for scaling PoseAI root motion.
-	float rigHeight = 170.0f;
-
-	float CameraTilt = 0.0f;
 
   protected:
     FLiveLinkStaticDataStruct rig;
@@ -66,11 +225,17 @@ class POSEAILIVELINK_API PoseAIRig
 	
 	FLiveLinkSubjectName name;
 	FName rigType;
+	EPoseAiRigPresets rigPreset;
 	
 	bool includeHands;
 	bool isMirrored;
 	bool isLowerBodyRotated;
 	bool isDesktop;
+	// stale and rig mismatch counts and rig timing of the subject
+	FPoseAIPipelineStats* pipelineStats = nullptr;
+	// set for rigs from MakeDetachedRig, which own their stats
+	bool isDetached = false;
+	TUniquePtr<FPoseAIPipelineStats> detachedStats;
 	int32 numBodyJoints = 21;
 	int32 numHandJoints = 17;
 	// number of joints to insert in desktop mode (as camera omits quaternions for unused joints)
@@ -83,69 +248,149 @@ class POSEAILIVELINK_API PoseAIRig
 	int32 handZoneL = 5;
 	int32 handZoneR = 5;
 	int32 stableFeet = 0;
+	// device timestamp of the newest frame whose events were triggered
+	double eventTimestamp = 0.0;
+	// reused by TriggerEvents, so queuing a packet's events does not allocate
+	FPoseAIEventRecord eventRecord;
+	// published by TriggerEvents for every processed or scanned frame
+	TPoseAISeqLock<FPoseAILiveValues> liveValuesSnapshot;
+	TPoseAISeqLock<FPoseAIMotionConfig> motionConfig;
+	// published by FinishFrame for every frame with rotations
+	TPoseAISeqLock<FPoseAIDirectPoseFrame> directPose;
+	// the remapping applied by the worker, the one posted by the game thread for the worker to take up, and the game thread's view
+	TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> activeRemap;
+	TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> pendingRemap;
+	TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> gameRemap;
+	// also guards pendingDerived
+	FCriticalSection pendingRemapLock;
+	std::atomic<bool> remapPending{ false };
+	std::atomic<bool> staticDataChanged{ false };
+	// the derived subjects converted by the worker and the set posted by ApplyDerivedSubjects, as pendingRemap
+	TSharedPtr<const TArray<FPoseAIDerivedSubject>, ESPMode::ThreadSafe> activeDerived;
+	TSharedPtr<const TArray<FPoseAIDerivedSubject>, ESPMode::ThreadSafe> pendingDerived;
+	std::atomic<bool> derivedPending{ false };
+	std::atomic<bool> derivedChanged{ false };
+	// worker: one reused frame per derived subject
+	TArray<FLiveLinkAnimationFrameData> derivedFrames;
 	FVector prevRootTranslation = FVector::ZeroVector;
-	// store translations of deployed rig
-	TMap<FName, FVector> boneVectors;
+	// hierarchy and bind translations of the deployed rig, indexed by joint
 	TArray<FName> jointNames;
 	TArray<int32> parentIndices;
-	TArray<FTransform> cachedPose = {};
-	
-	//temporary variable used for convenience in rig construction
-	FName lastBoneAdded;
+	TArray<FVector> boneTranslations;
+	FPoseAIJointNameIndex jointNameIndex;
+	// double buffered, so the previous pose stays readable while the new one is cached and neither is reallocated
+	TArray<FTransform> cachedPoses[2];
+	int32 cachedPoseFront = 0;
+	const TArray<FTransform>& CachedPose() const { return cachedPoses[cachedPoseFront]; }
+
+	// reused by every frame so steady state processing does not allocate
+	TArray<FQuat> scratchComponentRotations;
+	TArray<FQuat> scratchQuats;
+	// verbose rotations gathered by joint index, and whether each joint was in the frame
+	TArray<FQuat> scratchVerboseRotations;
+	TArray<bool> scratchVerboseFound;
+	int64 scratchCapacity = 0;
+	int32 scratchGrowths = 0;
 	
 	//extra offset for hip bone to accomodate mesh thickness from bone sockets.
 	float rootHipOffsetZ = 2.0f;
 
-	void AddBone(FName boneName, FName parentName, FVector translation);
-	void AddBoneToLast(FName boneName, FVector translation);
+	/* keeps the pose for joints missing from later frames */
 	void CachePose(const TArray<FTransform>& transforms);
+	/* shared end of the ProcessFrame overloads: takes up a posted remapping, applies it and publishes the direct pose */
+	bool FinishFrame(bool processed, FLiveLinkAnimationFrameData& data);
+	/* builds this rig's table from remappings keyed by joint name, null if empty */
+	TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> MakeRemapTable(const TMap<FName, Remapping>& remappings) const;
+	/* static data of the rig's bones through a remap table, or as they are if null */
+	FLiveLinkStaticDataStruct MakeStaticData(const FPoseAIRemapTable* remap) const;
+	FLiveLinkStaticDataStruct MakeQuantizedStaticData(const FPoseAIRemapTable* remap) const;
+	/* sizes the scratch and cached pose buffers from the joint counts set by Configure */
+	void ReserveScratch();
+	int64 ScratchCapacity() const;
+	void CheckScratchGrowth();
+	/* converts camera component space rotations to local transforms, in batches through PoseAIAppendLocalTransforms */
 	void AppendQuatArray(const TArray<FQuat>& quatArray, int32 begin, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data);
-	void AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data);
+	/* rebuilds joints missing from the frame from the cached pose.  Overridden by TPoseAIRig with a loop over the compile-time layout */
+	virtual void AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data);
 	void AssignCharacterMotion(FLiveLinkAnimationFrameData& data);
 	bool ProcessVerboseRotations(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data);
-	bool ProcessCompactRotations(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data);
+	bool ProcessVerboseRotations(const FPoseAIVerboseFrame& frame, FLiveLinkAnimationFrameData& data);
+	/* converts the gathered verbose rotations, filling joints missing from the frame from the cached pose */
+	bool ApplyVerboseRotations(bool hasBodyRotations, FLiveLinkAnimationFrameData& data);
+	void ResetVerboseRotations();
+	bool ProcessCompactRotations(const FPoseAICompactFrame& frame, FLiveLinkAnimationFrameData& data);
 	void ProcessVerboseSupplementaryData(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data);
-	void ProcessCompactSupplementaryData(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data);
-	void TriggerEvents();
+	void ProcessVerboseSupplementaryData(const FPoseAIVerboseFrame& frame);
+	void ProcessCompactSupplementaryData(const FPoseAICompactFrame& frame);
+	bool ProcessBinaryRotations(const FPoseAIBinaryPacket& packet, FLiveLinkAnimationFrameData& data);
+	void ProcessBinarySupplementaryData(const FPoseAIBinaryPacket& packet);
+	/* frameReceived marks the record for onFrameReceived, set for processed frames but not for scanned ones */
+	void TriggerEvents(bool frameReceived);
+	bool AcceptTimestamp(double timestamp);
+	/* the staleness check of scanned frames, which only covers their events so an overwritten frame never moves the pose's timestamp */
+	bool AcceptEventTimestamp(double timestamp);
 	void RotateLowerBody180(TArray<FQuat>& quatArray);
 
 
 private:
 	static TMap<FLiveLinkSubjectName, TWeakPtr<PoseAIRig, ESPMode::ThreadSafe>> RigMap;
+	/* the configured rig for the handshake's preset, shared by both factories */
+	static TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> MakeRig(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake);
+	/* remappings as set, with the rig they were authored for when known */
+	struct FSubjectRemapping
+	{
+		TMap<FName, Remapping> Joints;
+		TOptional<EPoseAiRigPresets> SourceRig;
+	};
+	/* whether the remapping was authored for this rig, or for no particular rig */
+	bool MatchesSourceRig(const FSubjectRemapping& remapping) const;
+	/* MatchesSourceRig, warning that the remapping for subject is not applied when it does not */
+	bool AcceptsRemapping(const FSubjectRemapping& remapping, const FLiveLinkSubjectName& subject) const;
+	// remappings set per subject, applied to the subject's rigs as they are created
+	static TMap<FLiveLinkSubjectName, FSubjectRemapping> RemappingMap;
+	// derived subjects set per subject, keyed by derived subject name
+	static TMap<FLiveLinkSubjectName, TMap<FLiveLinkSubjectName, FSubjectRemapping>> DerivedSubjectMap;
+	static int32 DerivedSubjectsGeneration;
 };
 
-class POSEAILIVELINK_API PoseAIRigUE4 : public PoseAIRig {
-  public:
-	PoseAIRigUE4(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : PoseAIRig(name, handshake) {};
+/**
+ * Rig whose layout is fixed at compile time by a traits struct from PoseAIRigDefinitions.h, so joints rebuilt from the cached pose
+ * read parents and bind translations from constant tables with known bounds.
+ */
+template <typename TRigTraits>
+class TPoseAIRig : public PoseAIRig {
+public:
+	static constexpr int32 NumJoints = PoseAIRigNumJoints<TRigTraits>();
+	static constexpr int32 LeftHandBegin = TRigTraits::NumBodyJoints;
+	static constexpr int32 RightHandBegin = TRigTraits::NumBodyJoints + TRigTraits::NumHandJoints;
+
+	TPoseAIRig(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : PoseAIRig(name, handshake) {};
 protected:
-	void Configure();
+	virtual void Configure() override;
+	virtual void AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data) override;
 };
 
-class POSEAILIVELINK_API PoseAIRigMixamo : public PoseAIRig {
-  public:
-	PoseAIRigMixamo(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) :	PoseAIRig(name, handshake) {};
-protected:
-	void Configure();
+class POSEAILIVELINK_API PoseAIRigUE4 : public TPoseAIRig<FPoseAIRigTraitsUE4> {
+public:
+	PoseAIRigUE4(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : TPoseAIRig(name, handshake) {};
 };
 
-class POSEAILIVELINK_API PoseAIRigMixamoAlt : public PoseAIRig {
+class POSEAILIVELINK_API PoseAIRigMixamo : public TPoseAIRig<FPoseAIRigTraitsMixamo> {
 public:
-	PoseAIRigMixamoAlt(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : PoseAIRig(name, handshake) {};
-protected:
-	void Configure();
+	PoseAIRigMixamo(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : TPoseAIRig(name, handshake) {};
 };
 
+class POSEAILIVELINK_API PoseAIRigMixamoAlt : public TPoseAIRig<FPoseAIRigTraitsMixamoAlt> {
+public:
+	PoseAIRigMixamoAlt(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : TPoseAIRig(name, handshake) {};
+};
 
-class POSEAILIVELINK_API PoseAIRigMetaHuman : public PoseAIRig {
+class POSEAILIVELINK_API PoseAIRigMetaHuman : public TPoseAIRig<FPoseAIRigTraitsMetaHuman> {
 public:
-	PoseAIRigMetaHuman(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : PoseAIRig(name, handshake) {};
-protected:
-	void Configure();
+	PoseAIRigMetaHuman(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : TPoseAIRig(name, handshake) {};
 };
 
-class POSEAILIVELINK_API PoseAIRigDazUE : public PoseAIRig {
+class POSEAILIVELINK_API PoseAIRigDazUE : public TPoseAIRig<FPoseAIRigTraitsDazUE> {
 public:
-	PoseAIRigDazUE(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : PoseAIRig(name, handshake) {};
-protected:
-	void Configure();
+	PoseAIRigDazUE(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) : TPoseAIRig(name, handshake) {};
 };
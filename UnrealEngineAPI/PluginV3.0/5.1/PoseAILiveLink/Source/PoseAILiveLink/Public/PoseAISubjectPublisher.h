@@ -0,0 +1,63 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ILiveLinkClient.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "LiveLinkTypes.h"
+#include "PoseAIRig.h"
+#include "PoseAIQuantizedRole.h"
+#include "PoseAILatencyTracker.h"
+#include "PoseAIPipelineStats.h"
+
+
+/**
+ * Publishes a rig's frames to LiveLink for the network and native sources, which own one each: the source's subject, created with the
+ * animation or the quantized role, and the subjects derived from it with PoseAIRig::SetDerivedSubject.
+ * The game thread creates and removes subjects, the thread processing the source's frames pushes them.
+ */
+class POSEAILIVELINK_API FPoseAISubjectPublisher
+{
+public:
+	FPoseAISubjectPublisher(const FLiveLinkSubjectKey& subjectKey, ILiveLinkClient* liveLinkClient, FPoseAIPipelineStats& pipelineStats) :
+		subjectKey(subjectKey), liveLinkClient(liveLinkClient), pipelineStats(&pipelineStats) {}
+
+	/* game thread: creates the subject for a new rig, with the role set by PoseAI.QuantizedRole, replacing the subject and derived subjects of the last */
+	bool CreateSubject(PoseAIRig& rig, FCriticalSection& synchObject);
+	/* game thread: removes the derived subjects, the source removes its own subject */
+	void RemoveDerivedSubjects();
+	/* game thread: creates and removes the derived subjects set since the last call.  Called from the source's Update */
+	void Update(PoseAIRig& rig, FCriticalSection& synchObject);
+
+	/* the rig processes every frame into this, so its transforms are not reallocated per frame */
+	FLiveLinkAnimationFrameData& BeginFrame() {
+		scratchFrame.Transforms.Reset();
+		return scratchFrame;
+	}
+	/* pushes a processed frame to LiveLink, then the frames of the derived subjects, and records and resets its latency trace */
+	void PushFrame(PoseAIRig& rig, const FLiveLinkAnimationFrameData& data, FPoseAIFrameTrace& latencyTrace);
+
+private:
+	/* copies a frame into the struct LiveLink buffers, quantized or at its exact size */
+	void PushFrameData(const FLiveLinkSubjectKey& key, const FLiveLinkAnimationFrameData& data);
+	/* creates the derived subjects of the rig's subject that are missing, posts their tables to the rig and removes the ones no longer set */
+	void UpdateDerivedSubjects(PoseAIRig& rig, FCriticalSection& synchObject);
+	TSubclassOf<ULiveLinkRole> GetSubjectRole() const {
+		return quantized ? TSubclassOf<ULiveLinkRole>(ULiveLinkPoseAIQuantizedRole::StaticClass()) : TSubclassOf<ULiveLinkRole>(ULiveLinkAnimationRole::StaticClass());
+	}
+	FLiveLinkSubjectPreset MakeSubjectPreset(FName subjectName) const;
+
+	FLiveLinkSubjectKey subjectKey;
+	ILiveLinkClient* liveLinkClient;
+	FPoseAIPipelineStats* pipelineStats;
+
+	// whether the subject was created with ULiveLinkPoseAIQuantizedRole
+	bool quantized = false;
+	FLiveLinkAnimationFrameData scratchFrame;
+
+	// game thread: the derived subjects created in LiveLink, and the PoseAIRig::GetDerivedSubjectsGeneration they were created for
+	TArray<FLiveLinkSubjectName> derivedSubjects;
+	int32 derivedSubjectsGeneration = INDEX_NONE;
+};
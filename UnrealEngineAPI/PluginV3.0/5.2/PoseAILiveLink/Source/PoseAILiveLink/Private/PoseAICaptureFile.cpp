@@ -0,0 +1,481 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAICaptureFile.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "PoseAIBinaryPacket.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+using namespace PoseAICapture;
+
+
+namespace {
+	const uint8 zeroes[4096] = {};
+
+	void WriteZeroes(FArchive& file, int64 count) {
+		while (count > 0) {
+			const int64 chunk = FMath::Min<int64>(count, sizeof(zeroes));
+			file.Serialize(const_cast<uint8*>(zeroes), chunk);
+			count -= chunk;
+		}
+	}
+}
+
+
+bool PoseAICapture::PeekDeviceTimestamp(TArrayView<const uint8> bytes, double& outTimestamp) {
+	if (FPoseAIBinaryPacket::IsBinaryPacket(bytes.GetData(), bytes.Num())) {
+		FPoseAIBinaryPacket packet;
+		if (!packet.Parse(bytes.GetData(), bytes.Num()))
+			return false;
+		outTimestamp = packet.GetTimestamp();
+		return true;
+	}
+
+	// verbose frames match their keys case insensitively
+	static const char key[] = "\"timestamp\"";
+	const int32 keyLength = sizeof(key) - 1;
+	for (int32 i = 0; i + keyLength < bytes.Num(); ++i) {
+		if (bytes[i] != '"' || FCStringAnsi::Strnicmp(reinterpret_cast<const ANSICHAR*>(bytes.GetData() + i), key, keyLength) != 0)
+			continue;
+		int32 at = i + keyLength;
+		while (at < bytes.Num() && (bytes[at] == ' ' || bytes[at] == ':'))
+			++at;
+		ANSICHAR number[32];
+		int32 length = 0;
+		while (at < bytes.Num() && length < UE_ARRAY_COUNT(number) - 1 &&
+			(FChar::IsDigit(bytes[at]) || bytes[at] == '.' || bytes[at] == '-' || bytes[at] == '+' || bytes[at] == 'e' || bytes[at] == 'E'))
+			number[length++] = (ANSICHAR)bytes[at++];
+		if (length == 0)
+			return false;
+		number[length] = 0;
+		outTimestamp = FCStringAnsi::Atod(number);
+		return true;
+	}
+	return false;
+}
+
+
+TUniquePtr<FPoseAICaptureWriter> FPoseAICaptureWriter::Create(const FString& path) {
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(path), true);
+	TUniquePtr<FArchive> file(IFileManager::Get().CreateFileWriter(*path));
+	if (!file.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create capture file %s"), *path);
+		return nullptr;
+	}
+	FFileHeader header;
+	header.StartUtcTicks = FDateTime::UtcNow().GetTicks();
+	file->Serialize(&header, sizeof(header));
+	file->Flush();
+	return TUniquePtr<FPoseAICaptureWriter>(new FPoseAICaptureWriter(MoveTemp(file), path));
+}
+
+FPoseAICaptureWriter::~FPoseAICaptureWriter() {
+	if (file.IsValid())
+		file->Close();
+}
+
+void FPoseAICaptureWriter::WriteDatagram(TArrayView<const uint8> bytes, double arrivalTime) {
+	double deviceTimestamp = 0.0;
+	const uint8 flags = PeekDeviceTimestamp(bytes, deviceTimestamp) ? FlagHasTimestamp : 0;
+	WriteRecord(ERecordType::Datagram, flags, arrivalTime, deviceTimestamp, bytes);
+}
+
+void FPoseAICaptureWriter::WriteHandshake(const FString& handshakeJson, double arrivalTime) {
+	FTCHARToUTF8 utf8(*handshakeJson, handshakeJson.Len());
+	WriteRecord(ERecordType::Handshake, 0, arrivalTime, 0.0, TArrayView<const uint8>(reinterpret_cast<const uint8*>(utf8.Get()), utf8.Length()));
+}
+
+void FPoseAICaptureWriter::WriteRecord(ERecordType type, uint8 flags, double arrivalTime, double deviceTimestamp, TArrayView<const uint8> payload) {
+	const int64 recordSize = Align((int64)sizeof(FRecordHeader) + payload.Num(), Alignment);
+	if (recordSize > BlockSize - (int64)sizeof(FBlockHeader)) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %d byte packet is too large for capture file %s"), payload.Num(), *path);
+		return;
+	}
+	if (startTime < 0.0) {
+		startTime = arrivalTime;
+		lastFlush = arrivalTime;
+	}
+	const double arrival = arrivalTime - startTime;
+
+	if (blockUsed > 0 && blockUsed + recordSize > BlockSize) {
+		// the rest of the block reads as an End record
+		WriteZeroes(*file, BlockSize - blockUsed);
+		++blockIndex;
+		blockUsed = 0;
+		file->Flush();
+		lastFlush = arrivalTime;
+	}
+	if (blockUsed == 0) {
+		FBlockHeader block;
+		block.BlockIndex = blockIndex;
+		block.FirstArrival = arrival;
+		block.FirstDeviceTimestamp = deviceTimestamp;
+		file->Serialize(&block, sizeof(block));
+		blockUsed = sizeof(block);
+	}
+
+	FRecordHeader record;
+	record.Arrival = arrival;
+	record.DeviceTimestamp = deviceTimestamp;
+	record.Length = payload.Num();
+	record.Type = type;
+	record.Flags = flags;
+	file->Serialize(&record, sizeof(record));
+	file->Serialize(const_cast<uint8*>(payload.GetData()), payload.Num());
+	WriteZeroes(*file, recordSize - sizeof(record) - payload.Num());
+	blockUsed += recordSize;
+	++recordCount;
+
+	// bounds what a crash loses without a flush per packet
+	if (arrivalTime - lastFlush >= 1.0) {
+		file->Flush();
+		lastFlush = arrivalTime;
+	}
+}
+
+
+namespace {
+	enum class EPendingKind : uint8
+	{
+		Datagram,
+		Handshake,
+		// the tap was destroyed, so its file is closed
+		Close,
+	};
+
+	struct FPendingRecord
+	{
+		EPendingKind Kind = EPendingKind::Datagram;
+		uint64 TapId = 0;
+		FName Source;
+		uint32 Generation = 0;
+		double ArrivalTime = 0.0;
+		TArray<uint8> Bytes;
+		FString Handshake;
+	};
+
+	/*
+	* The records of all taps, queued by the receiving threads and written by a task graph task scheduled when the queue goes from empty
+	* to non empty, as FPoseAISocketSender sends.  The write task also opens and closes the files, so nothing on the receive path
+	* touches the disk.  Buffers are pooled.
+	*/
+	struct FCaptureQueue
+	{
+		FCriticalSection queueLock;
+		TArray<FPendingRecord> pending;
+		TArray<TArray<uint8>> freeBuffers;
+		int64 pendingBytes = 0;
+		bool writeScheduled = false;
+
+		// held while records are written, by the write task or by StartAll and StopAll
+		FCriticalSection writeLock;
+		TArray<FPendingRecord> writing;
+		TMap<uint64, TUniquePtr<FPoseAICaptureWriter>> writers;
+		FString directory;
+		// the capture being written, records queued for an earlier one are dropped
+		uint32 activeGeneration = 0;
+		uint32 lastGeneration = 0;
+	};
+	FCaptureQueue captureQueue;
+
+	std::atomic<uint64> nextTapId{ 1 };
+	std::atomic<uint64> droppedRecords{ 0 };
+	// bounds the memory held for a disk that can not keep up, beyond which datagrams are dropped from the capture
+	constexpr int64 MaxPendingBytes = 64 * 1024 * 1024;
+
+	void WriteDrained();
+
+	void QueueRecord(EPendingKind kind, uint64 tapId, FName source, uint32 generation, double arrivalTime, TArrayView<const uint8> bytes, FString&& handshake = FString()) {
+		bool scheduleWrite = false;
+		{
+			FScopeLock scopeLock(&captureQueue.queueLock);
+			if (kind == EPendingKind::Datagram && captureQueue.pendingBytes + bytes.Num() > MaxPendingBytes) {
+				droppedRecords.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			FPendingRecord& record = captureQueue.pending.AddDefaulted_GetRef();
+			if (captureQueue.freeBuffers.Num() > 0) {
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+				record.Bytes = captureQueue.freeBuffers.Pop(false);
+#else
+				record.Bytes = captureQueue.freeBuffers.Pop(EAllowShrinking::No);
+#endif
+			}
+			record.Bytes.Reset();
+			record.Bytes.Append(bytes.GetData(), bytes.Num());
+			record.Kind = kind;
+			record.TapId = tapId;
+			record.Source = source;
+			record.Generation = generation;
+			record.ArrivalTime = arrivalTime;
+			record.Handshake = MoveTemp(handshake);
+			captureQueue.pendingBytes += bytes.Num();
+			scheduleWrite = !captureQueue.writeScheduled;
+			captureQueue.writeScheduled = true;
+		}
+		if (scheduleWrite)
+			AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, []() { WriteDrained(); });
+	}
+
+	void CloseWriter(TUniquePtr<FPoseAICaptureWriter>& writer) {
+		if (!writer.IsValid())
+			return;
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: closed capture %s with %llu records"), *writer->GetPath(), writer->GetRecordCount());
+		writer.Reset();
+	}
+
+	/* with the write lock held: closes every file, after the last records queued for them */
+	void CloseAllWriters() {
+		for (TPair<uint64, TUniquePtr<FPoseAICaptureWriter>>& writer : captureQueue.writers)
+			CloseWriter(writer.Value);
+		captureQueue.writers.Reset();
+		const uint64 dropped = droppedRecords.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0)
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %llu packets were left out of the capture as the disk fell behind"), dropped);
+	}
+
+	/* with the write lock held: writes one record, opening the tap's file with its first record of a capture */
+	void WritePending(FPendingRecord& record) {
+		if (record.Kind == EPendingKind::Close) {
+			if (TUniquePtr<FPoseAICaptureWriter>* writer = captureQueue.writers.Find(record.TapId)) {
+				CloseWriter(*writer);
+				captureQueue.writers.Remove(record.TapId);
+			}
+			return;
+		}
+		if (record.Generation != captureQueue.activeGeneration)
+			return;
+
+		TUniquePtr<FPoseAICaptureWriter>* writer = captureQueue.writers.Find(record.TapId);
+		if (writer == nullptr) {
+			const FString fileName = FPaths::MakeValidFileName(record.Source.ToString(), TEXT('_')) + TEXT("_") + FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")) + Extension;
+			// a file that could not be created stays null, so it is not retried until the next capture
+			writer = &captureQueue.writers.Add(record.TapId, FPoseAICaptureWriter::Create(FPaths::Combine(captureQueue.directory, fileName)));
+		}
+		if (!writer->IsValid())
+			return;
+		if (record.Kind == EPendingKind::Handshake)
+			(*writer)->WriteHandshake(record.Handshake, record.ArrivalTime);
+		else
+			(*writer)->WriteDatagram(record.Bytes, record.ArrivalTime);
+	}
+
+	/* with the write lock held: writes everything queued.  Only the write task ends the scheduled write, so another is queued after it */
+	void DrainQueue(bool bWriteTask) {
+		while (true) {
+			{
+				FScopeLock scopeLock(&captureQueue.queueLock);
+				for (FPendingRecord& record : captureQueue.writing) {
+					captureQueue.pendingBytes -= record.Bytes.Num();
+					captureQueue.freeBuffers.Add(MoveTemp(record.Bytes));
+				}
+				captureQueue.writing.Reset();
+				if (captureQueue.pending.Num() == 0) {
+					if (bWriteTask)
+						captureQueue.writeScheduled = false;
+					return;
+				}
+				Swap(captureQueue.writing, captureQueue.pending);
+			}
+			for (FPendingRecord& record : captureQueue.writing)
+				WritePending(record);
+		}
+	}
+
+	void WriteDrained() {
+		FScopeLock scopeLock(&captureQueue.writeLock);
+		DrainQueue(true);
+	}
+}
+
+
+std::atomic<uint32> FPoseAICaptureTap::captureGeneration{ 0 };
+
+FPoseAICaptureTap::FPoseAICaptureTap(FName source) : source(source), id(nextTapId.fetch_add(1, std::memory_order_relaxed)) {}
+
+FPoseAICaptureTap::~FPoseAICaptureTap() {
+	if (tapGeneration != 0 && IsCapturing())
+		QueueRecord(EPendingKind::Close, id, source, tapGeneration, 0.0, TArrayView<const uint8>());
+}
+
+void FPoseAICaptureTap::SetHandshake(const FString& handshakeJson) {
+	FScopeLock scopeLock(&handshakeLock);
+	if (handshake != handshakeJson) {
+		handshake = handshakeJson;
+		bHandshakeChanged = true;
+	}
+}
+
+void FPoseAICaptureTap::StartAll(const FString& directory) {
+	const FString fullDirectory = FPaths::ConvertRelativePathToFull(
+		directory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PoseAI"), TEXT("Captures")) : directory);
+	FScopeLock scopeLock(&captureQueue.writeLock);
+	// the files of a running capture are finished before the next starts
+	DrainQueue(false);
+	CloseAllWriters();
+	captureQueue.directory = fullDirectory;
+	// 0 means stopped, so the generation skips it when it wraps
+	captureQueue.lastGeneration = captureQueue.lastGeneration + 1 == 0 ? 1 : captureQueue.lastGeneration + 1;
+	captureQueue.activeGeneration = captureQueue.lastGeneration;
+	captureGeneration.store(captureQueue.lastGeneration, std::memory_order_release);
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: capturing received packets to %s"), *fullDirectory);
+}
+
+void FPoseAICaptureTap::StopAll() {
+	if (captureGeneration.exchange(0, std::memory_order_acq_rel) == 0)
+		return;
+	FScopeLock scopeLock(&captureQueue.writeLock);
+	// records a tap queues after this, having read the generation before it changed, are dropped by the write task
+	DrainQueue(false);
+	captureQueue.activeGeneration = 0;
+	CloseAllWriters();
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: stopped capturing"));
+}
+
+void FPoseAICaptureTap::CaptureSlow(TArrayView<const uint8> bytes, double arrivalTime) {
+	const uint32 generation = captureGeneration.load(std::memory_order_acquire);
+	const bool bNewCapture = generation != tapGeneration;
+	tapGeneration = generation;
+	if (generation == 0)
+		return;
+
+	{
+		FScopeLock scopeLock(&handshakeLock);
+		if ((bNewCapture || bHandshakeChanged) && !handshake.IsEmpty())
+			QueueRecord(EPendingKind::Handshake, id, source, generation, arrivalTime, TArrayView<const uint8>(), CopyTemp(handshake));
+		bHandshakeChanged = false;
+	}
+	QueueRecord(EPendingKind::Datagram, id, source, generation, arrivalTime, bytes);
+}
+
+
+TUniquePtr<FPoseAICaptureReader> FPoseAICaptureReader::Open(const FString& path) {
+	TUniquePtr<FPoseAICaptureReader> reader(new FPoseAICaptureReader());
+	reader->mappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*path));
+	if (!reader->mappedFile.IsValid() || reader->mappedFile->GetFileSize() < (int64)sizeof(FFileHeader)) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to map capture file %s"), *path);
+		return nullptr;
+	}
+	reader->mappedRegion.Reset(reader->mappedFile->MapRegion(0, reader->mappedFile->GetFileSize()));
+	if (!reader->mappedRegion.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to map capture file %s"), *path);
+		return nullptr;
+	}
+	reader->data = reader->mappedRegion->GetMappedPtr();
+	reader->size = reader->mappedRegion->GetMappedSize();
+
+	FMemory::Memcpy(&reader->header, reader->data, sizeof(FFileHeader));
+	if (reader->header.Magic != FileMagic || reader->header.Version > Version ||
+		reader->header.HeaderSize < sizeof(FFileHeader) || reader->header.BlockSize <= sizeof(FBlockHeader)) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %s is not a capture file this version can read"), *path);
+		return nullptr;
+	}
+	reader->firstBlock = reader->header.HeaderSize;
+	reader->blockSize = reader->header.BlockSize;
+	reader->numBlocks = FMath::DivideAndRoundUp(FMath::Max<int64>(reader->size - reader->firstBlock, 0), reader->blockSize);
+	while (reader->numBlocks > 0 && reader->GetBlock(reader->numBlocks - 1) == nullptr)
+		--reader->numBlocks;
+
+	// the duration is the arrival of the last record, found by walking the last block only
+	if (reader->numBlocks > 0) {
+		reader->offset = reader->firstBlock + (reader->numBlocks - 1) * reader->blockSize;
+		FPoseAICaptureRecord record;
+		while (reader->Next(record))
+			reader->duration = record.Header.Arrival;
+	}
+	reader->Rewind();
+	return reader;
+}
+
+const FBlockHeader* FPoseAICaptureReader::GetBlock(int64 index) const {
+	const int64 blockStart = firstBlock + index * blockSize;
+	if (index < 0 || blockStart + (int64)sizeof(FBlockHeader) > size)
+		return nullptr;
+	const FBlockHeader* block = reinterpret_cast<const FBlockHeader*>(data + blockStart);
+	return block->Magic == BlockMagic ? block : nullptr;
+}
+
+bool FPoseAICaptureReader::Next(FPoseAICaptureRecord& outRecord) {
+	while (offset < size) {
+		const int64 index = (offset - firstBlock) / blockSize;
+		const int64 blockStart = firstBlock + index * blockSize;
+		const int64 blockEnd = FMath::Min(blockStart + blockSize, size);
+		if (offset == blockStart) {
+			// a block torn by a crash ends the capture
+			if (GetBlock(index) == nullptr)
+				break;
+			offset += sizeof(FBlockHeader);
+		}
+		if (offset + (int64)sizeof(FRecordHeader) > blockEnd) {
+			offset = blockStart + blockSize;
+			continue;
+		}
+		FMemory::Memcpy(&outRecord.Header, data + offset, sizeof(FRecordHeader));
+		if (outRecord.Header.Type == ERecordType::End) {
+			offset = blockStart + blockSize;
+			continue;
+		}
+		if (offset + (int64)sizeof(FRecordHeader) + outRecord.Header.Length > blockEnd)
+			break;
+		outRecord.Payload = TArrayView<const uint8>(data + offset + sizeof(FRecordHeader), outRecord.Header.Length);
+		offset += Align((int64)sizeof(FRecordHeader) + outRecord.Header.Length, Alignment);
+		return true;
+	}
+	offset = size;
+	return false;
+}
+
+void FPoseAICaptureReader::SeekToArrival(double seconds) {
+	// last block whose first record arrived no later than seconds
+	int64 low = 0;
+	int64 high = numBlocks - 1;
+	int64 found = 0;
+	while (low <= high) {
+		const int64 mid = low + (high - low) / 2;
+		const FBlockHeader* block = GetBlock(mid);
+		if (block != nullptr && block->FirstArrival <= seconds) {
+			found = mid;
+			low = mid + 1;
+		}
+		else {
+			high = mid - 1;
+		}
+	}
+	offset = firstBlock + found * blockSize;
+}
+
+FString FPoseAICaptureReader::FindHandshake() const {
+	FPoseAICaptureReader& self = const_cast<FPoseAICaptureReader&>(*this);
+	const int64 savedOffset = offset;
+	self.Rewind();
+	FString handshakeJson;
+	FPoseAICaptureRecord record;
+	while (self.Next(record)) {
+		if (record.Header.Type == ERecordType::Handshake) {
+			handshakeJson = FString(record.Payload.Num(), reinterpret_cast<const UTF8CHAR*>(record.Payload.GetData()));
+			break;
+		}
+	}
+	self.offset = savedOffset;
+	return handshakeJson;
+}
+
+
+static FAutoConsoleCommand CaptureStartCommand(
+	TEXT("PoseAI.CaptureStart"),
+	TEXT("Captures every packet received by each PoseAI source to its own .paicap file.  Optional argument: directory, default Saved/PoseAI/Captures"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		FPoseAICaptureTap::StartAll(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand CaptureStopCommand(
+	TEXT("PoseAI.CaptureStop"),
+	TEXT("Stops capturing packets"),
+	FConsoleCommandDelegate::CreateStatic(&FPoseAICaptureTap::StopAll));
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,163 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAICompactFrame.h"
+#include "PoseAIJsonTokenizer.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+bool FPoseAICompactFrame::Parse(const uint8* data, int32 len) {
+	*this = FPoseAICompactFrame();
+	FPoseAIJsonTokenizer tokens(data, len);
+	int32 packetFormat = -1;
+
+	auto readHand = [&tokens](FPoseAICompactHand& hand) {
+		hand.bPresent = true;
+		return tokens.ReadObject([&tokens, &hand](FUtf8StringView key) {
+			if (FPoseAIJsonTokenizer::KeyIs(key, "RotA"))
+				return tokens.ReadString(hand.RotA);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "Point"))
+				return tokens.ReadString(hand.Point);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "Open")) {
+				double open;
+				hand.bHasOpen = tokens.ReadNumber(open);
+				hand.Open = (float)open;
+				return hand.bHasOpen;
+			}
+			return tokens.SkipValue();
+		});
+	};
+
+	auto readBody = [&tokens, this]() {
+		bHasBody = true;
+		return tokens.ReadObject([&tokens, this](FUtf8StringView key) {
+			if (FPoseAIJsonTokenizer::KeyIs(key, "RotA"))
+				return tokens.ReadString(RotA);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "VisA"))
+				return tokens.ReadString(VisA);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "ScaA"))
+				return tokens.ReadString(ScaA);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "VecA"))
+				return tokens.ReadString(VecA);
+			if (FPoseAIJsonTokenizer::KeyIs(key, "EveA"))
+				return tokens.ReadString(EveA);
+			return tokens.SkipValue();
+		});
+	};
+
+	const bool parsed = tokens.ReadObject([&](FUtf8StringView key) {
+		double number;
+		if (FPoseAIJsonTokenizer::KeyIs(key, "PF")) {
+			if (!tokens.ReadNumber(number))
+				return false;
+			packetFormat = (int32)number;
+			return true;
+		}
+		if (FPoseAIJsonTokenizer::KeyIs(key, "Timestamp"))
+			return tokens.ReadNumber(Timestamp);
+		if (FPoseAIJsonTokenizer::KeyIs(key, "ModelLatency")) {
+			bHasModelLatency = tokens.ReadNumber(number);
+			ModelLatency = (int32)number;
+			return bHasModelLatency;
+		}
+		if (FPoseAIJsonTokenizer::KeyIs(key, "Rig"))
+			return tokens.ReadString(Rig);
+		if (FPoseAIJsonTokenizer::KeyIs(key, "Body"))
+			return readBody();
+		if (FPoseAIJsonTokenizer::KeyIs(key, "LeftHand"))
+			return readHand(LeftHand);
+		if (FPoseAIJsonTokenizer::KeyIs(key, "RightHand"))
+			return readHand(RightHand);
+		if (FPoseAIJsonTokenizer::KeyIs(key, "Face")) {
+			bHasFace = true;
+			return tokens.ReadString(Face);
+		}
+		return tokens.SkipValue();
+	});
+
+	return parsed && tokens.AtEnd() && packetFormat == 1;
+}
+
+
+bool FPoseAICompactFrame::ParseJsonObject(const TSharedPtr<FJsonObject>& jsonObject, TArray<UTF8CHAR>& storage) {
+	*this = FPoseAICompactFrame();
+	uint32 packetFormat = 0;
+	if (!jsonObject.IsValid() || !jsonObject->TryGetNumberField("PF", packetFormat) || packetFormat != 1)
+		return false;
+
+	jsonObject->TryGetNumberField("Timestamp", Timestamp);
+	bHasModelLatency = jsonObject->TryGetNumberField("ModelLatency", ModelLatency);
+
+	// views are only set once all strings are in storage, as appending may reallocate
+	struct FPendingView { FUtf8StringView* view; int32 offset; int32 len; };
+	TArray<FPendingView, TInlineAllocator<12>> pending;
+	storage.Reset();
+	auto addString = [&pending, &storage](const TSharedPtr<FJsonObject>& obj, const FString& field, FUtf8StringView& view) {
+		FString value;
+		if (!obj->TryGetStringField(field, value))
+			return false;
+		FTCHARToUTF8 converted(*value, value.Len());
+		pending.Add({ &view, storage.Num(), converted.Length() });
+		storage.Append(reinterpret_cast<const UTF8CHAR*>(converted.Get()), converted.Length());
+		return true;
+	};
+
+	addString(jsonObject, "Rig", Rig);
+	const TSharedPtr<FJsonObject>* objBody;
+	if (jsonObject->TryGetObjectField("Body", objBody)) {
+		bHasBody = true;
+		addString(*objBody, "RotA", RotA);
+		addString(*objBody, "VisA", VisA);
+		addString(*objBody, "ScaA", ScaA);
+		addString(*objBody, "VecA", VecA);
+		addString(*objBody, "EveA", EveA);
+	}
+	auto addHand = [&addString, &jsonObject](const FString& field, FPoseAICompactHand& hand) {
+		const TSharedPtr<FJsonObject>* objHand;
+		if (!jsonObject->TryGetObjectField(field, objHand))
+			return;
+		hand.bPresent = true;
+		addString(*objHand, "RotA", hand.RotA);
+		addString(*objHand, "Point", hand.Point);
+		double open;
+		hand.bHasOpen = (*objHand)->TryGetNumberField("Open", open);
+		if (hand.bHasOpen)
+			hand.Open = (float)open;
+	};
+	addHand("LeftHand", LeftHand);
+	addHand("RightHand", RightHand);
+	bHasFace = addString(jsonObject, "Face", Face);
+
+	for (const FPendingView& entry : pending)
+		*entry.view = FUtf8StringView(storage.GetData() + entry.offset, entry.len);
+	return true;
+}
+
+
+bool FPoseAICompactFrame::PeekEventSignature(const uint8* data, int32 len, uint32& outSignature) {
+	double packetFormat;
+	if (!FPoseAIJsonTokenizer::FindNumber(data, len, "PF", packetFormat) || packetFormat != 1.0)
+		return false;
+	FUtf8StringView eveA, visA, scaA;
+	FPoseAIJsonTokenizer::FindString(data, len, "EveA", eveA);
+	FPoseAIJsonTokenizer::FindString(data, len, "VisA", visA);
+	FPoseAIJsonTokenizer::FindString(data, len, "ScaA", scaA);
+	outSignature = MakeEventSignature(eveA, visA, scaA);
+	return true;
+}
+
+
+uint32 FPoseAICompactFrame::MakeEventSignature(FUtf8StringView eveA, FUtf8StringView visA, FUtf8StringView scaA) {
+	// the integer scalars follow the three fixed point values at the start of ScaA
+	const FUtf8StringView scalarInts = scaA.Mid(6);
+	uint32 crc = FCrc::MemCrc32(eveA.GetData(), eveA.Len());
+	crc = FCrc::MemCrc32(visA.GetData(), visA.Len(), crc);
+	return FCrc::MemCrc32(scalarInts.GetData(), scalarInts.Len(), crc);
+}
+
+
+bool FPoseAICompactFrame::IsRig(FName rigType) const {
+	return FPoseAIJsonTokenizer::NameIs(Rig, rigType);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,193 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAILatencyTracker.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+std::atomic<bool> FPoseAILatencyTracker::bEnabled{ false };
+
+static TAutoConsoleVariable<int32> CVarPoseAILatencyTracking(
+	TEXT("PoseAI.LatencyTracking"),
+	0,
+	TEXT("1 records the per source latency histograms of PoseAI.Latency and PoseAI.LatencyDump, at the cost of a lock per pushed frame and per animation evaluation of a PoseAI subject."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* variable) { FPoseAILatencyTracker::SetEnabled(variable->GetInt() != 0); }),
+	ECVF_Default);
+
+
+void FPoseAILatencyHistogram::Add(double seconds) {
+	seconds = FMath::Max(seconds, 0.0);
+	const double micros = seconds * 1.0e6;
+	const int32 bucket = micros <= 1.0 ? 0 : FMath::Clamp((int32)(4.0 * FMath::Log2(micros)), 0, NUM_BUCKETS - 1);
+	buckets[bucket]++;
+	count++;
+	sum += seconds;
+	maxSeconds = FMath::Max(maxSeconds, seconds);
+}
+
+double FPoseAILatencyHistogram::Percentile(double p) const {
+	if (count == 0)
+		return 0.0;
+	const double target = FMath::Clamp(p, 0.0, 1.0) * (double)count;
+	uint64 below = 0;
+	for (int32 i = 0; i < NUM_BUCKETS; ++i) {
+		if (buckets[i] == 0)
+			continue;
+		if ((double)(below + buckets[i]) >= target) {
+			// bucket i spans [2^(i/4), 2^((i+1)/4)) microseconds, interpolated geometrically
+			const double fraction = FMath::Clamp((target - (double)below) / (double)buckets[i], 0.0, 1.0);
+			const double micros = FMath::Pow(2.0, ((double)i + fraction) / 4.0);
+			return FMath::Min(micros / 1000.0, MaxMs());
+		}
+		below += buckets[i];
+	}
+	return MaxMs();
+}
+
+
+FPoseAILatencyTracker& FPoseAILatencyTracker::Get() {
+	static FPoseAILatencyTracker tracker;
+	return tracker;
+}
+
+const TCHAR* FPoseAILatencyTracker::StageName(EPoseAILatencyStage stage) {
+	switch (stage) {
+	case EPoseAILatencyStage::Parse: return TEXT("Parse");
+	case EPoseAILatencyStage::Rig: return TEXT("Rig");
+	case EPoseAILatencyStage::Push: return TEXT("Push");
+	case EPoseAILatencyStage::Anim: return TEXT("Anim");
+	case EPoseAILatencyStage::Total: return TEXT("Total");
+	case EPoseAILatencyStage::Camera: return TEXT("Camera");
+	default: return TEXT("Unknown");
+	}
+}
+
+void FPoseAILatencyTracker::RecordFrame(FName source, const FPoseAIFrameTrace& trace) {
+	FScopeLock scopeLock(&lock);
+	FSourceLatency& latency = sources.FindOrAdd(source);
+	auto addInterval = [&latency](EPoseAILatencyStage stage, double from, double to) {
+		if (from > 0.0 && to >= from)
+			latency.Stages[(int32)stage].Add(to - from);
+	};
+	addInterval(EPoseAILatencyStage::Parse, trace.Received, trace.Parsed);
+	addInterval(EPoseAILatencyStage::Rig, trace.Parsed, trace.RigDone);
+	addInterval(EPoseAILatencyStage::Push, trace.RigDone, trace.Pushed);
+	if (trace.ModelLatencyMs > 0)
+		latency.Stages[(int32)EPoseAILatencyStage::Camera].Add(trace.ModelLatencyMs / 1000.0);
+
+	latency.Pending[latency.NextPending] = trace;
+	latency.NextPending = (latency.NextPending + 1) % PENDING_FRAMES;
+}
+
+void FPoseAILatencyTracker::MarkEvaluated(double worldTime) {
+	const double now = FPlatformTime::Seconds();
+	FScopeLock scopeLock(&lock);
+	// sources buffer a single frame, so the evaluated world time is exactly that of a pushed frame, and unique across sources
+	for (TPair<FName, FSourceLatency>& source : sources) {
+		for (FPoseAIFrameTrace& pending : source.Value.Pending) {
+			if (pending.WorldTime != worldTime || pending.Pushed <= 0.0)
+				continue;
+			source.Value.Stages[(int32)EPoseAILatencyStage::Anim].Add(now - pending.Pushed);
+			if (pending.Received > 0.0)
+				source.Value.Stages[(int32)EPoseAILatencyStage::Total].Add(now - pending.Received);
+			pending = FPoseAIFrameTrace();
+			return;
+		}
+	}
+}
+
+void FPoseAILatencyTracker::Reset() {
+	FScopeLock scopeLock(&lock);
+	sources.Reset();
+}
+
+FString FPoseAILatencyTracker::ToCsv() const {
+	FScopeLock scopeLock(&lock);
+	FString csv = TEXT("source,stage,count,p50_ms,p95_ms,p99_ms,mean_ms,max_ms\n");
+	for (const TPair<FName, FSourceLatency>& source : sources) {
+		for (int32 stage = 0; stage < (int32)EPoseAILatencyStage::Num; ++stage) {
+			const FPoseAILatencyHistogram& histogram = source.Value.Stages[stage];
+			csv += FString::Printf(TEXT("%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n"), *source.Key.ToString(), StageName((EPoseAILatencyStage)stage),
+				histogram.Count(), histogram.Percentile(0.5), histogram.Percentile(0.95), histogram.Percentile(0.99), histogram.MeanMs(), histogram.MaxMs());
+		}
+	}
+	return csv;
+}
+
+FString FPoseAILatencyTracker::ToJson() const {
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	{
+		FScopeLock scopeLock(&lock);
+		for (const TPair<FName, FSourceLatency>& source : sources) {
+			TSharedRef<FJsonObject> sourceObject = MakeShared<FJsonObject>();
+			for (int32 stage = 0; stage < (int32)EPoseAILatencyStage::Num; ++stage) {
+				const FPoseAILatencyHistogram& histogram = source.Value.Stages[stage];
+				TSharedRef<FJsonObject> stageObject = MakeShared<FJsonObject>();
+				stageObject->SetNumberField(TEXT("count"), (double)histogram.Count());
+				stageObject->SetNumberField(TEXT("p50_ms"), histogram.Percentile(0.5));
+				stageObject->SetNumberField(TEXT("p95_ms"), histogram.Percentile(0.95));
+				stageObject->SetNumberField(TEXT("p99_ms"), histogram.Percentile(0.99));
+				stageObject->SetNumberField(TEXT("mean_ms"), histogram.MeanMs());
+				stageObject->SetNumberField(TEXT("max_ms"), histogram.MaxMs());
+				sourceObject->SetObjectField(StageName((EPoseAILatencyStage)stage), stageObject);
+			}
+			root->SetObjectField(source.Key.ToString(), sourceObject);
+		}
+	}
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+	return json;
+}
+
+void FPoseAILatencyTracker::LogSummary() const {
+	FScopeLock scopeLock(&lock);
+	if (sources.Num() == 0) {
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: no latency traces recorded%s"), IsEnabled() ? TEXT("") : TEXT(", set PoseAI.LatencyTracking 1 to record them"));
+		return;
+	}
+	for (const TPair<FName, FSourceLatency>& source : sources) {
+		for (int32 stage = 0; stage < (int32)EPoseAILatencyStage::Num; ++stage) {
+			const FPoseAILatencyHistogram& histogram = source.Value.Stages[stage];
+			if (histogram.Count() == 0)
+				continue;
+			UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: %s %-6s %8llu frames, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms"),
+				*source.Key.ToString(), StageName((EPoseAILatencyStage)stage), histogram.Count(),
+				histogram.Percentile(0.5), histogram.Percentile(0.95), histogram.Percentile(0.99), histogram.MaxMs());
+		}
+	}
+}
+
+
+static void DumpLatency(const TArray<FString>& Args) {
+	const FString basePath = Args.Num() > 0 ? Args[0] : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PoseAI"), TEXT("Latency"));
+	const FPoseAILatencyTracker& tracker = FPoseAILatencyTracker::Get();
+	const bool savedCsv = FFileHelper::SaveStringToFile(tracker.ToCsv(), *(basePath + TEXT(".csv")));
+	const bool savedJson = FFileHelper::SaveStringToFile(tracker.ToJson(), *(basePath + TEXT(".json")));
+	if (savedCsv && savedJson)
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: wrote latency histograms to %s.csv and .json"), *basePath);
+	else
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to write latency histograms to %s"), *basePath);
+}
+
+static FAutoConsoleCommand LatencyCommand(
+	TEXT("PoseAI.Latency"),
+	TEXT("Logs p50/p95/p99 latency per source for each stage from socket receive to animation evaluation"),
+	FConsoleCommandDelegate::CreateLambda([]() { FPoseAILatencyTracker::Get().LogSummary(); }));
+
+static FAutoConsoleCommand LatencyResetCommand(
+	TEXT("PoseAI.LatencyReset"),
+	TEXT("Clears the latency histograms"),
+	FConsoleCommandDelegate::CreateLambda([]() { FPoseAILatencyTracker::Get().Reset(); }));
+
+static FAutoConsoleCommand LatencyDumpCommand(
+	TEXT("PoseAI.LatencyDump"),
+	TEXT("Writes the latency histograms as <path>.csv and <path>.json.  Optional argument: path without extension, default Saved/PoseAI/Latency"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DumpLatency));
+
+#undef LOCTEXT_NAMESPACE
@@ -3,16 +3,35 @@
 #include "PoseAILiveLink.h"
 #include "Core.h"
 #include "Interfaces/IPluginManager.h"
+#include "PoseAINetworkReactor.h"
+#include "PoseAIEventDispatcher.h"
+#include "PoseAIPipelineStats.h"
+#include "PoseAICaptureReplay.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/CommandLine.h"
 
 
 void FPoseAILiveLinkModule::StartupModule()
 {
+	// events queued by the rigs are dispatched to movement components once per engine frame, ahead of the world ticks
+	beginFrameHandle = FCoreDelegates::OnBeginFrame.AddStatic(&UPoseAIEventDispatcher::DrainPendingEvents);
+	statsFrameHandle = FCoreDelegates::OnBeginFrame.AddStatic(&FPoseAIPipelineStats::PublishAll);
 
+#if UE_TRACE_ENABLED
+	// the pipeline scopes are CPU events, which are only traced with the cpu channel on as well, so -trace=poseai turns it on
+	FString traceChannels;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-trace="), traceChannels, false) && traceChannels.Contains(TEXT("poseai")))
+		UE::Trace::ToggleChannel(TEXT("Cpu"), true);
+#endif
 }
 
 void FPoseAILiveLinkModule::ShutdownModule()
 {
-	
+	FCoreDelegates::OnBeginFrame.Remove(beginFrameHandle);
+	FCoreDelegates::OnBeginFrame.Remove(statsFrameHandle);
+	FPoseAICaptureReplay::StopAll();
+	FPoseAICaptureTap::StopAll();
+	FPoseAINetworkReactor::Get().Shutdown();
 }
 
 
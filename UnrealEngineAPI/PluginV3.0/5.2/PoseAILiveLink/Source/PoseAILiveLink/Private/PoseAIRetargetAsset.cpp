@@ -0,0 +1,116 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIRetargetAsset.h"
+#include "Animation/Skeleton.h"
+#include "PoseAIRigDefinitions.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+namespace {
+	template <typename TRigTraits>
+	TArrayView<const FPoseAIJointDef> RigJoints() {
+		return MakeArrayView(TRigTraits::Joints, UE_ARRAY_COUNT(TRigTraits::Joints));
+	}
+
+	TArrayView<const FPoseAIJointDef> RigJointsFor(EPoseAiRigPresets rig) {
+		switch (rig) {
+		case EPoseAiRigPresets::MetaHuman:
+			return RigJoints<FPoseAIRigTraitsMetaHuman>();
+		case EPoseAiRigPresets::Mixamo:
+			return RigJoints<FPoseAIRigTraitsMixamo>();
+		case EPoseAiRigPresets::MixamoAlt:
+			return RigJoints<FPoseAIRigTraitsMixamoAlt>();
+		case EPoseAiRigPresets::DazUE:
+			return RigJoints<FPoseAIRigTraitsDazUE>();
+		case EPoseAiRigPresets::UE4:
+		default:
+			return RigJoints<FPoseAIRigTraitsUE4>();
+		}
+	}
+
+	FQuat RefComponentRotation(const FReferenceSkeleton& skeleton, int32 bone) {
+		const TArray<FTransform>& refPose = skeleton.GetRefBonePose();
+		FQuat rotation = FQuat::Identity;
+		for (; bone != INDEX_NONE; bone = skeleton.GetParentIndex(bone))
+			rotation = refPose[bone].GetRotation() * rotation;
+		return rotation;
+	}
+}
+
+
+void UPoseAIRetargetAsset::GenerateFromSkeletons() {
+	const USkeleton* source = SourceSkeleton.LoadSynchronous();
+	const USkeleton* target = TargetSkeleton.LoadSynchronous();
+	if (source == nullptr || target == nullptr) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %s needs a source and a target skeleton to generate its joints"), *GetName());
+		return;
+	}
+
+	const TArrayView<const FPoseAIJointDef> rigJoints = RigJointsFor(SourceRig);
+	TMap<FName, int32> rigIndices;
+	for (int32 i = 0; i < rigJoints.Num(); ++i)
+		rigIndices.Add(FName(rigJoints[i].Name), i);
+
+	if (Joints.Num() == 0) {
+		Joints.Reserve(rigJoints.Num());
+		for (const FPoseAIJointDef& rigJoint : rigJoints) {
+			FPoseAIRetargetJoint& joint = Joints.AddDefaulted_GetRef();
+			joint.SourceJoint = FName(rigJoint.Name);
+			joint.TargetJoint = joint.SourceJoint;
+		}
+	}
+
+	const FReferenceSkeleton& sourceRef = source->GetReferenceSkeleton();
+	const FReferenceSkeleton& targetRef = target->GetReferenceSkeleton();
+	// adjustments by rig joint, with the joints listed here but missing from a skeleton marked to inherit their parent's
+	TArray<FQuat> rigAdjustments;
+	rigAdjustments.Init(FQuat::Identity, rigJoints.Num());
+	TBitArray<> inherits(false, rigJoints.Num());
+	TArray<int32> missing;
+	for (int32 i = 0; i < Joints.Num(); ++i) {
+		FPoseAIRetargetJoint& joint = Joints[i];
+		const FName targetName = joint.TargetJoint.IsNone() ? joint.SourceJoint : joint.TargetJoint;
+		const int32 sourceBone = sourceRef.FindBoneIndex(joint.SourceJoint);
+		const int32 targetBone = targetRef.FindBoneIndex(targetName);
+		const int32* rigIndex = rigIndices.Find(joint.SourceJoint);
+		if (sourceBone != INDEX_NONE && targetBone != INDEX_NONE) {
+			joint.RotAdj = RefComponentRotation(sourceRef, sourceBone).Inverse() * RefComponentRotation(targetRef, targetBone);
+			joint.RotAdj.Normalize();
+			joint.BindTranslation = targetRef.GetRefBonePose()[targetBone].GetTranslation();
+			if (rigIndex)
+				rigAdjustments[*rigIndex] = joint.RotAdj;
+		} else {
+			joint.BindTranslation = rigIndex ? FVector(rigJoints[*rigIndex].X, rigJoints[*rigIndex].Y, rigJoints[*rigIndex].Z) : FVector::ZeroVector;
+			if (rigIndex)
+				inherits[*rigIndex] = true;
+			missing.Add(i);
+		}
+	}
+	// as the Unity retargeter, a missing joint inherits its nearest ancestor's adjustment so its children stay consistent.  Ancestors are
+	// resolved by rig index once every joint is filled, so the order of Joints does not matter
+	for (int32 i : missing) {
+		FPoseAIRetargetJoint& joint = Joints[i];
+		const int32* rigIndex = rigIndices.Find(joint.SourceJoint);
+		int32 parent = rigIndex ? rigJoints[*rigIndex].Parent : INDEX_NONE;
+		while (parent >= 0 && inherits[parent])
+			parent = rigJoints[parent].Parent;
+		joint.RotAdj = parent >= 0 ? rigAdjustments[parent] : FQuat::Identity;
+	}
+	if (missing.Num() > 0)
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %d joints of %s are missing from its source or target skeleton"), missing.Num(), *GetName());
+	MarkPackageDirty();
+}
+
+TMap<FName, Remapping> UPoseAIRetargetAsset::MakeRemappings() const {
+	TMap<FName, Remapping> remappings;
+	remappings.Reserve(Joints.Num());
+	for (const FPoseAIRetargetJoint& joint : Joints) {
+		if (joint.SourceJoint.IsNone())
+			continue;
+		remappings.Add(joint.SourceJoint, Remapping(joint.TargetJoint.IsNone() ? joint.SourceJoint : joint.TargetJoint, joint.RotAdj.GetNormalized(), joint.BindTranslation));
+	}
+	return remappings;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,129 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAISubjectPublisher.h"
+#include "Misc/ScopeLock.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+FLiveLinkSubjectPreset FPoseAISubjectPublisher::MakeSubjectPreset(FName subjectName) const
+{
+	FLiveLinkSubjectPreset subject;
+	subject.bEnabled = true;
+	subject.Key = FLiveLinkSubjectKey(subjectKey.Source, subjectName);
+	subject.Role = GetSubjectRole();
+	subject.Settings = quantized ? ULiveLinkPoseAIQuantizedRole::MakeSubjectSettings() : nullptr;
+	subject.VirtualSubject = nullptr;
+	return subject;
+}
+
+
+bool FPoseAISubjectPublisher::CreateSubject(PoseAIRig& rig, FCriticalSection& synchObject)
+{
+	check(IsInGameThread());
+	liveLinkClient->RemoveSubject_AnyThread(subjectKey);
+	// the new rig has no derived subjects yet, so the next Update creates them again with the subject's role
+	RemoveDerivedSubjects();
+	quantized = ULiveLinkPoseAIQuantizedRole::IsEnabled();
+	FLiveLinkSubjectPreset subject = MakeSubjectPreset(subjectKey.SubjectName);
+
+	FScopeLock ScopeLock(&synchObject);
+	if (!liveLinkClient->CreateSubject(subject)) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create subject %s"), *(subjectKey.SubjectName.Name.ToString()));
+		return false;
+	}
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: created subject %s"), *(subjectKey.SubjectName.Name.ToString()));
+	FLiveLinkStaticDataStruct rigDefinition = quantized ? rig.MakeQuantizedStaticData() : rig.MakeStaticData();
+	liveLinkClient->PushSubjectStaticData_AnyThread(subject.Key, subject.Role, MoveTemp(rigDefinition));
+	return true;
+}
+
+
+void FPoseAISubjectPublisher::PushFrame(PoseAIRig& rig, const FLiveLinkAnimationFrameData& data, FPoseAIFrameTrace& latencyTrace)
+{
+	latencyTrace.RigDone = FPlatformTime::Seconds();
+	latencyTrace.WorldTime = data.WorldTime.GetSourceTime();
+	{
+		FPoseAIPipelineScope pushScope(*pipelineStats, EPoseAIPipelineTimer::Push);
+		// a remapping was applied or removed with this frame, so its bones are pushed ahead of it
+		if (rig.TakeStaticDataChanged())
+			liveLinkClient->PushSubjectStaticData_AnyThread(subjectKey, GetSubjectRole(), quantized ? rig.MakeQuantizedStaticData() : rig.MakeStaticData());
+		PushFrameData(subjectKey, data);
+
+		// the rig converted the same decoded pose for each derived subject, whose bones are pushed again whenever the set changed
+		const bool derivedChanged = rig.TakeDerivedSubjectsChanged();
+		for (int32 i = 0; i < rig.NumDerivedSubjects(); ++i) {
+			const FLiveLinkSubjectKey derivedKey(subjectKey.Source, rig.GetDerivedSubjectName(i));
+			if (derivedChanged)
+				liveLinkClient->PushSubjectStaticData_AnyThread(derivedKey, GetSubjectRole(), rig.MakeDerivedStaticData(i, quantized));
+			PushFrameData(derivedKey, rig.GetDerivedFrame(i));
+		}
+	}
+	latencyTrace.Pushed = FPlatformTime::Seconds();
+	latencyTrace.ModelLatencyMs = rig.liveValues.modelLatency;
+	if (latencyTrace.Received > 0.0 && FPoseAILatencyTracker::IsEnabled())
+		FPoseAILatencyTracker::Get().RecordFrame(subjectKey.SubjectName.Name, latencyTrace);
+	latencyTrace = FPoseAIFrameTrace();
+}
+
+
+void FPoseAISubjectPublisher::PushFrameData(const FLiveLinkSubjectKey& key, const FLiveLinkAnimationFrameData& data)
+{
+	// frames are built in reused scratch frames, so they are copied rather than moved
+	if (quantized) {
+		FLiveLinkFrameDataStruct frameData(FLiveLinkPoseAIQuantizedFrameData::StaticStruct());
+		frameData.Cast<FLiveLinkPoseAIQuantizedFrameData>()->Pack(data);
+		liveLinkClient->PushSubjectFrameData_AnyThread(key, MoveTemp(frameData));
+	}
+	else {
+		FLiveLinkFrameDataStruct frameData(FLiveLinkAnimationFrameData::StaticStruct());
+		FLiveLinkAnimationFrameData& animationData = *frameData.Cast<FLiveLinkAnimationFrameData>();
+		animationData.WorldTime = data.WorldTime;
+		animationData.Transforms = data.Transforms;
+		liveLinkClient->PushSubjectFrameData_AnyThread(key, MoveTemp(frameData));
+	}
+}
+
+
+void FPoseAISubjectPublisher::Update(PoseAIRig& rig, FCriticalSection& synchObject)
+{
+	// the generation counts changes for every subject, so a change for another subject only rebuilds this rig's tables
+	if (derivedSubjectsGeneration != PoseAIRig::GetDerivedSubjectsGeneration())
+		UpdateDerivedSubjects(rig, synchObject);
+}
+
+
+void FPoseAISubjectPublisher::UpdateDerivedSubjects(PoseAIRig& rig, FCriticalSection& synchObject)
+{
+	check(IsInGameThread());
+	derivedSubjectsGeneration = PoseAIRig::GetDerivedSubjectsGeneration();
+	const TArray<FLiveLinkSubjectName> names = rig.GetDerivedSubjectNames();
+	for (const FLiveLinkSubjectName& derivedName : names) {
+		if (derivedSubjects.Contains(derivedName))
+			continue;
+		FLiveLinkSubjectPreset subject = MakeSubjectPreset(derivedName);
+		FScopeLock ScopeLock(&synchObject);
+		if (!liveLinkClient->CreateSubject(subject))
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create derived subject %s"), *derivedName.Name.ToString());
+		else
+			UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: created subject %s derived from %s"), *derivedName.Name.ToString(), *subjectKey.SubjectName.Name.ToString());
+	}
+	// subjects exist before the worker takes up the tables and pushes their static data
+	rig.ApplyDerivedSubjects();
+	for (const FLiveLinkSubjectName& derivedName : derivedSubjects) {
+		if (!names.Contains(derivedName))
+			liveLinkClient->RemoveSubject_AnyThread(FLiveLinkSubjectKey(subjectKey.Source, derivedName));
+	}
+	derivedSubjects = names;
+}
+
+
+void FPoseAISubjectPublisher::RemoveDerivedSubjects()
+{
+	for (const FLiveLinkSubjectName& derivedName : derivedSubjects)
+		liveLinkClient->RemoveSubject_AnyThread(FLiveLinkSubjectKey(subjectKey.Source, derivedName));
+	derivedSubjects.Reset();
+	derivedSubjectsGeneration = INDEX_NONE;
+}
+
+#undef LOCTEXT_NAMESPACE
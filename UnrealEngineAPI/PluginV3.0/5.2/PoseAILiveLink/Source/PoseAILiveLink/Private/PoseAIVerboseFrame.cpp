@@ -0,0 +1,118 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIVerboseFrame.h"
+#include "PoseAIJsonTokenizer.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+bool FPoseAIVerboseFrame::Parse(const uint8* data, int32 len) {
+	Timestamp = 0.0;
+	bHasModelLatency = false;
+	ModelLatency = 0;
+	Rig.Reset();
+	Body = FPoseAIVerbosePart();
+	LeftHand = FPoseAIVerbosePart();
+	RightHand = FPoseAIVerbosePart();
+	bHasFace = false;
+	Face.Reset();
+
+	FPoseAIJsonTokenizer tokens(data, len);
+	int32 packetFormat = 0;
+
+	auto readRotations = [&tokens](FPoseAIVerbosePart& part) {
+		part.bHasRotations = true;
+		return tokens.ReadObject([&tokens, &part](FUtf8StringView key) {
+			double xyzw[4];
+			int32 count;
+			if (!tokens.ReadNumberArray(xyzw, 4, count))
+				return false;
+			if (count >= 4)
+				part.Rotations.Add({ key, FQuat(xyzw[0], xyzw[1], xyzw[2], xyzw[3]) });
+			return true;
+		});
+	};
+
+	auto readPart = [&tokens, &readRotations](FPoseAIVerbosePart& part) {
+		part.bPresent = true;
+		return tokens.ReadObject([&tokens, &readRotations, &part](FUtf8StringView key) {
+			if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Rotations"))
+				return readRotations(part);
+			if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Scalars"))
+				return tokens.ReadRawValue(part.Scalars);
+			if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Events"))
+				return tokens.ReadRawValue(part.Events);
+			if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Vectors"))
+				return tokens.ReadRawValue(part.Vectors);
+			if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Open")) {
+				double open;
+				part.bHasOpen = tokens.ReadNumber(open);
+				part.Open = (float)open;
+				return part.bHasOpen;
+			}
+			return tokens.SkipValue();
+		});
+	};
+
+	const bool parsed = tokens.ReadObject([&](FUtf8StringView key) {
+		double number;
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "PF")) {
+			if (!tokens.ReadNumber(number))
+				return false;
+			packetFormat = (int32)number;
+			return true;
+		}
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Timestamp"))
+			return tokens.ReadNumber(Timestamp);
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "ModelLatency")) {
+			bHasModelLatency = tokens.ReadNumber(number);
+			ModelLatency = (int32)number;
+			return bHasModelLatency;
+		}
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Rig"))
+			return tokens.ReadString(Rig);
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Body"))
+			return readPart(Body);
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "LeftHand"))
+			return readPart(LeftHand);
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "RightHand"))
+			return readPart(RightHand);
+		if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Face")) {
+			double values[64];
+			int32 count;
+			if (!tokens.ReadNumberArray(values, UE_ARRAY_COUNT(values), count))
+				return false;
+			bHasFace = true;
+			for (int32 i = 0; i < FMath::Min(count, (int32)UE_ARRAY_COUNT(values)); ++i)
+				Face.Add((float)values[i]);
+			return true;
+		}
+		return tokens.SkipValue();
+	});
+
+	return parsed && tokens.AtEnd() && packetFormat != 1;
+}
+
+
+bool FPoseAIVerboseFrame::PeekEventSignature(const uint8* data, int32 len, uint32& outSignature) {
+	double packetFormat;
+	if (FPoseAIJsonTokenizer::FindNumber(data, len, "PF", packetFormat) && packetFormat == 1.0)
+		return false;
+	auto rawValue = [data, len](const uint8* value) {
+		FUtf8StringView view;
+		if (value)
+			FPoseAIJsonTokenizer(value, (int32)(data + len - value)).ReadRawValue(view);
+		return view;
+	};
+	const FUtf8StringView events = rawValue(FPoseAIJsonTokenizer::FindValue(data, len, "Events"));
+	const FUtf8StringView scalars = rawValue(FPoseAIJsonTokenizer::FindValue(data, len, "Scalars"));
+	outSignature = FCrc::MemCrc32(scalars.GetData(), scalars.Len(), FCrc::MemCrc32(events.GetData(), events.Len()));
+	return true;
+}
+
+
+bool FPoseAIVerboseFrame::IsRig(FName rigType) const {
+	return FPoseAIJsonTokenizer::NameIs(Rig, rigType);
+}
+
+#undef LOCTEXT_NAMESPACE
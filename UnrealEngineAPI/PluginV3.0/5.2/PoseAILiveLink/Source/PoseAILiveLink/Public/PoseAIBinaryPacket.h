@@ -0,0 +1,108 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/* sections of a binary (PF=2) frame.  The order matches the offset table in the header */
+enum class EPoseAIBinarySection : uint8
+{
+	BodyRotations,
+	LeftHandRotations,
+	RightHandRotations,
+	Scalars,
+	Vectors,
+	Events,
+	HandVectors,
+	Face,
+	MAX
+};
+
+
+/**
+ * Read-only view over a binary (PF=2) frame, see StreamFormat.md for the layout.
+ * The view does not copy or own the bytes, so it is only valid while the receive buffer it points into is alive.
+ *
+ * Header (32 bytes, little endian):
+ *   0  uint8[2]  magic 'P' 'B'
+ *   2  uint8     format version
+ *   3  uint8     flags (EPoseAIBinaryFlags)
+ *   4  uint8     rig (EPoseAiRigPresets)
+ *   5  uint8     reserved
+ *   6  uint16    model latency in ms
+ *   8  double    device timestamp in seconds
+ *   16 uint16[8] byte offset of each EPoseAIBinarySection from the start of the packet, 0 if the section is absent
+ *
+ * Fixed point values use the same 12 bit quantization as the compact format, packed two values per three bytes.
+ */
+class POSEAILIVELINK_API FPoseAIBinaryPacket
+{
+public:
+	static const uint8 MagicA = 'P';
+	static const uint8 MagicB = 'B';
+	static const uint8 FormatVersion = 1;
+	static const int32 HeaderSize = 32;
+
+	enum EPoseAIBinaryFlags : uint8
+	{
+		FlagMirrored = 1 << 0,
+		FlagDesktop = 1 << 1,
+	};
+
+	/* cheap test on the first bytes of a datagram.  JSON packets always begin with '{' */
+	static bool IsBinaryPacket(const uint8* data, int32 len) {
+		return len >= HeaderSize && data[0] == MagicA && data[1] == MagicB;
+	}
+
+	/* validates the header and section bounds.  Returns false (and leaves the view empty) for malformed packets */
+	bool Parse(const uint8* data, int32 len);
+
+	bool IsValid() const { return bytes != nullptr; }
+	uint8 GetVersion() const { return bytes[2]; }
+	uint8 GetFlags() const { return bytes[3]; }
+	uint8 GetRig() const { return bytes[4]; }
+	int32 GetModelLatency() const { return ReadUint16(6); }
+	double GetTimestamp() const;
+
+	bool HasSection(EPoseAIBinarySection section) const { return sectionOffsets[(int32)section] > 0; }
+	bool HasFrameData() const {
+		return HasSection(EPoseAIBinarySection::BodyRotations) || HasSection(EPoseAIBinarySection::LeftHandRotations) || HasSection(EPoseAIBinarySection::RightHandRotations);
+	}
+
+	/* number of entries recorded in the section's count byte (quaternions, values or events).  0 if absent */
+	int32 GetSectionCount(EPoseAIBinarySection section) const;
+
+	/* decodes the quaternions of a rotation section, normalized and appended to quatArray. Returns number appended */
+	int32 ReadQuats(EPoseAIBinarySection section, TArray<FQuat>& quatArray) const;
+
+	/* decodes the fixed point values of a value section (Vectors, Face), appending to flatArray.  Returns number appended */
+	int32 ReadFixed12(EPoseAIBinarySection section, TArray<float>& flatArray) const;
+
+	/* hash of the event counts and the visibility, stable feet, hand zone and crouch values.  Equal hashes mean no events to trigger */
+	uint32 EventSignature() const;
+
+	/* raw access for the fixed-layout sections (Scalars, Events, HandVectors).  Returns nullptr if absent */
+	const uint8* GetSectionData(EPoseAIBinarySection section) const {
+		return HasSection(section) ? bytes + sectionOffsets[(int32)section] : nullptr;
+	}
+	int32 GetSectionSize(EPoseAIBinarySection section) const { return HasSection(section) ? sectionSizes[(int32)section] : 0; }
+
+	uint16 ReadUint16(int32 offset) const { return (uint16)bytes[offset] | ((uint16)bytes[offset + 1] << 8); }
+	uint32 ReadUint32(int32 offset) const;
+
+	/* unpacks the idx'th 12 bit value from a packed run starting at data */
+	static uint32 UnpackUint12(const uint8* data, int32 idx);
+
+	/* maps a 12 bit value to the same float produced by FixedB64pairToFloat for the equivalent base64 pair */
+	static float Fixed12ToFloat(uint32 value);
+
+	/* bytes needed for count packed 12 bit values */
+	static int32 PackedSize(int32 count) { return (count * 3 + 1) / 2; }
+
+private:
+	const uint8* bytes = nullptr;
+	int32 length = 0;
+	uint16 sectionOffsets[(int32)EPoseAIBinarySection::MAX] = {};
+	uint16 sectionSizes[(int32)EPoseAIBinarySection::MAX] = {};
+};
@@ -0,0 +1,66 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Json.h"
+
+
+/* fields of a LeftHand or RightHand object in a compact (PF=1) packet */
+struct POSEAILIVELINK_API FPoseAICompactHand
+{
+	bool bPresent = false;
+	FUtf8StringView RotA;
+	FUtf8StringView Point;
+	bool bHasOpen = false;
+	float Open = 0.5f;
+};
+
+
+/**
+ * A compact (PF=1) packet tokenized in a single forward pass over its UTF-8 bytes, in place of the FJsonObject DOM.
+ * String fields are views into the parsed bytes, so parsing does not allocate and the frame is only valid while those bytes are alive.
+ * Only the compact schema is recognized; the hello message, verbose packets and anything with escaped strings are left to the DOM.
+ */
+class POSEAILIVELINK_API FPoseAICompactFrame
+{
+public:
+	/* returns true for a well formed packet with "PF":1.  Unrecognized keys are skipped */
+	bool Parse(const uint8* data, int32 len);
+
+	/* fills the frame from an already deserialized compact packet, converting its strings into storage which must outlive the frame */
+	bool ParseJsonObject(const TSharedPtr<FJsonObject>& jsonObject, TArray<UTF8CHAR>& storage);
+
+	bool IsFrameData() const { return bHasBody || LeftHand.bPresent || RightHand.bPresent; }
+
+	/* hash of the event counts, visibility and the integer scalars (stable feet, hand zones, crouch).  Equal hashes mean no events to trigger */
+	uint32 EventSignature() const { return MakeEventSignature(EveA, VisA, ScaA); }
+
+	/* EventSignature of a compact packet without parsing it, searching for the three fields it hashes.  Returns false if the packet is not PF=1 */
+	static bool PeekEventSignature(const uint8* data, int32 len, uint32& outSignature);
+
+	/* case insensitive comparison of the Rig field against a rig name, matching FName equality */
+	bool IsRig(FName rigType) const;
+
+	double Timestamp = 0.0;
+	bool bHasModelLatency = false;
+	int32 ModelLatency = 0;
+	FUtf8StringView Rig;
+
+	bool bHasBody = false;
+	FUtf8StringView RotA;
+	FUtf8StringView VisA;
+	FUtf8StringView ScaA;
+	FUtf8StringView VecA;
+	FUtf8StringView EveA;
+
+	FPoseAICompactHand LeftHand;
+	FPoseAICompactHand RightHand;
+
+	bool bHasFace = false;
+	FUtf8StringView Face;
+
+private:
+	static uint32 MakeEventSignature(FUtf8StringView eveA, FUtf8StringView visA, FUtf8StringView scaA);
+};
@@ -0,0 +1,109 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+
+/* the intervals tracked per source.  Camera is the model latency reported by the phone, the rest are measured on this machine */
+enum class EPoseAILatencyStage : uint8
+{
+	// socket receive to parse done, including the wait for the worker
+	Parse,
+	// parse done to rig done
+	Rig,
+	// rig done to the LiveLink push returning
+	Push,
+	// LiveLink push to the first animation evaluation using the frame
+	Anim,
+	// socket receive to the first animation evaluation
+	Total,
+	Camera,
+	Num
+};
+
+
+/* FPlatformTime::Seconds() stamps of one frame on its way through the plugin.  Zero if a stage was not reached */
+struct FPoseAIFrameTrace
+{
+	double Received = 0.0;
+	double Parsed = 0.0;
+	double RigDone = 0.0;
+	double Pushed = 0.0;
+	// the frame's LiveLink world time, by which the animation evaluation is matched to it
+	double WorldTime = 0.0;
+	int32 ModelLatencyMs = 0;
+};
+
+
+/* log spaced histogram of durations, four buckets per octave from one microsecond */
+class POSEAILIVELINK_API FPoseAILatencyHistogram
+{
+public:
+	static constexpr int32 NUM_BUCKETS = 4 * 26;
+
+	void Add(double seconds);
+	void Reset() { *this = FPoseAILatencyHistogram(); }
+
+	uint64 Count() const { return count; }
+	/* in milliseconds, interpolated within the bucket holding the percentile.  0 if empty */
+	double Percentile(double p) const;
+	double MeanMs() const { return count > 0 ? 1000.0 * sum / count : 0.0; }
+	double MaxMs() const { return 1000.0 * maxSeconds; }
+
+private:
+	uint64 buckets[NUM_BUCKETS] = {};
+	uint64 count = 0;
+	double sum = 0.0;
+	double maxSeconds = 0.0;
+};
+
+
+/**
+ * Per source latency histograms, from socket receive through parsing, the rig and the LiveLink push to the first animation evaluation
+ * that consumed the frame.  Sources record a trace per pushed frame and animation code reports the world times of the frames it evaluates.
+ * Reported with the PoseAI.Latency console command and written as CSV and JSON by PoseAI.LatencyDump, for regression runs on headless machines.
+ * Off unless PoseAI.LatencyTracking is set, as recording takes a lock per pushed frame and per animation evaluation.
+ */
+class POSEAILIVELINK_API FPoseAILatencyTracker
+{
+public:
+	static FPoseAILatencyTracker& Get();
+
+	/* any thread, lock free: callers check this before building or reporting traces */
+	static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+	static void SetEnabled(bool enabled) { bEnabled.store(enabled, std::memory_order_relaxed); }
+
+	/* any thread: records a pushed frame and keeps it pending until an animation evaluation matches its world time */
+	void RecordFrame(FName source, const FPoseAIFrameTrace& trace);
+
+	/* any thread: an animation evaluation used the frame pushed with this world time.  Only the first evaluation of a frame counts */
+	void MarkEvaluated(double worldTime);
+
+	void Reset();
+
+	/* p50, p95, p99, mean and max in milliseconds for each source and stage */
+	FString ToCsv() const;
+	FString ToJson() const;
+	void LogSummary() const;
+
+	static const TCHAR* StageName(EPoseAILatencyStage stage);
+
+private:
+	static constexpr int32 PENDING_FRAMES = 16;
+
+	struct FSourceLatency
+	{
+		FPoseAILatencyHistogram Stages[(int32)EPoseAILatencyStage::Num];
+		// recently pushed frames not yet seen by an animation evaluation, as a ring
+		FPoseAIFrameTrace Pending[PENDING_FRAMES];
+		int32 NextPending = 0;
+	};
+
+	mutable FCriticalSection lock;
+	TMap<FName, FSourceLatency> sources;
+
+	static std::atomic<bool> bEnabled;
+};
@@ -15,6 +15,10 @@
 #include "LiveLinkTypes.h"
 #include "LiveLinkLog.h"
 #include "Json.h"
+#include "PoseAIBinaryPacket.h"
+#include "PoseAICompactFrame.h"
+#include "PoseAIVerboseFrame.h"
+#include "PoseAIPipelineStats.h"
 
 
 /**
@@ -29,6 +33,17 @@ public:
 	bool AddSubject(FCriticalSection& InSynchObject);
 	bool RequestSubSourceShutdown();
 	void UpdateFace(TSharedPtr<FJsonObject> jsonPose);
+	void UpdateFace(const FPoseAIBinaryPacket& packet);
+	void UpdateFace(const FPoseAICompactFrame& frame);
+	void UpdateFace(const FPoseAIVerboseFrame& frame);
+
+	/* decodes a frame's blend shapes in PoseAIFaceBlendShape order, without a LiveLink client.  False if the frame has no face */
+	static bool DecodeFace(TSharedPtr<FJsonObject> jsonPose, TArray<float>& outValues);
+	static bool DecodeFace(const FPoseAIBinaryPacket& packet, TArray<float>& outValues);
+	static bool DecodeFace(const FPoseAICompactFrame& frame, TArray<float>& outValues);
+	static bool DecodeFace(const FPoseAIVerboseFrame& frame, TArray<float>& outValues);
+	/* the curve names of the blend shapes, in PoseAIFaceBlendShape order */
+	static const TArray<FName>& BlendShapeNames();
 
 private:
 
@@ -36,6 +51,11 @@ private:
 	FName subjectName = "FacePoseAI"; // will be overwritten on initialization
 	ILiveLinkClient* liveLinkClient = nullptr;
 	FLiveLinkSkeletonStaticData StaticData;
+	// face time is counted against the pose subject
+	FPoseAIPipelineStats* pipelineStats;
+
+	template <typename FrameType>
+	void PushFace(const FrameType& frame);
 };
 
 
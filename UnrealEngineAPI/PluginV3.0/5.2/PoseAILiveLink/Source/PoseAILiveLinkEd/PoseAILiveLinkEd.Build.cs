@@ -44,6 +44,10 @@ public class PoseAILiveLinkEd : ModuleRules
 				"AnimGraph",
 				"PoseAILiveLink",
 				"BlueprintGraph",  // to be checked if this is an issue for packaging
+				"UnrealEd",
+				"AssetRegistry",
+				"LiveLinkInterface",
+				"Json",
 
 				// ... add private dependencies that you statically link with here ...	
 			}
@@ -0,0 +1,24 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PoseAIBakeCommandlet.generated.h"
+
+
+/**
+ * Bakes PoseAI captures into animation sequences without playing them back:
+ * UnrealEditor-Cmd Project.uproject -run=PoseAIBake -Skeleton=/Game/Path/Skeleton -Files=a.paicap+b.paicap [-Dir=Saved/PoseAI/Captures]
+ *     [-Out=/Game/PoseAI/Bakes] [-FPS=30] [-ChunkBlocks=4]
+ */
+UCLASS()
+class UPoseAIBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPoseAIBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
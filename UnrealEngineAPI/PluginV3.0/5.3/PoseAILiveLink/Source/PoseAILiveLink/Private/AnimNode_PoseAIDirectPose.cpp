@@ -0,0 +1,156 @@
+// Copyright 2022 Pose AI Ltd. All Rights Reserved.
+
+#include "AnimNode_PoseAIDirectPose.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimTrace.h"
+#include "PoseAIRig.h"
+#include "PoseAILatencyTracker.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+DECLARE_CYCLE_STAT(TEXT("PoseAIDirectPose Eval"), STAT_PoseAIDirectPose_Eval, STATGROUP_Anim);
+
+
+/////////////////////////////////////////////////////
+// FAnimNode_PoseAIDirectPose
+
+FAnimNode_PoseAIDirectPose::FAnimNode_PoseAIDirectPose()
+{
+}
+
+void FAnimNode_PoseAIDirectPose::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	InputPose.Initialize(Context);
+}
+
+void FAnimNode_PoseAIDirectPose::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(CacheBones_AnyThread)
+	InputPose.CacheBones(Context);
+	bBoneMapDirty = true;
+}
+
+void FAnimNode_PoseAIDirectPose::PreUpdate(const UAnimInstance* InAnimInstance)
+{
+	if (!(SubjectName == resolvedSubjectName) || !rig.IsValid()) {
+		rig = PoseAIRig::GetRigFromSubjectName(SubjectName);
+		resolvedSubjectName = SubjectName;
+		remapGeneration = INDEX_NONE;
+	}
+	// a retarget asset set on the subject renames the joints, so the names follow the rig's remap generation
+	if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> pinnedRig = rig.Pin()) {
+		if (pinnedRig->GetRemapGeneration() != remapGeneration) {
+			jointNames = pinnedRig->GetOutputJointNames();
+			remapGeneration = pinnedRig->GetRemapGeneration();
+			bBoneMapDirty = true;
+		}
+	}
+}
+
+void FAnimNode_PoseAIDirectPose::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Update_AnyThread)
+	InputPose.Update(Context);
+	GetEvaluateGraphExposedInputs().Execute(Context);
+}
+
+void FAnimNode_PoseAIDirectPose::Evaluate_AnyThread(FPoseContext& Output)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Evaluate_AnyThread)
+	SCOPE_CYCLE_COUNTER(STAT_PoseAIDirectPose_Eval);
+	InputPose.Evaluate(Output);
+
+	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> pinnedRig = rig.Pin();
+	if (!pinnedRig.IsValid())
+		return;
+	const FBoneContainer& requiredBones = Output.Pose.GetBoneContainer();
+	if (bBoneMapDirty)
+		RebuildBoneMap(requiredBones);
+
+	// latched as late as possible, so the pose is from the newest frame the worker finished before this evaluation
+	int32 numJoints = 0;
+	double worldTime = 0.0;
+	const bool useComponentSpace = bUseComponentSpaceRotations;
+	pinnedRig->GetDirectPose().ReadInPlace([&](const FPoseAIDirectPoseFrame& frame) {
+		// a pose retargeted differently from the names the bone map was built with is skipped, for the frame or two until both agree
+		numJoints = frame.RemapGeneration == remapGeneration ? FMath::Min(frame.NumJoints, jointToBone.Num()) : 0;
+		latchedRotations.Reset();
+		latchedRotations.Append(useComponentSpace ? frame.ComponentRotations : frame.LocalRotations, numJoints);
+		latchedRootTranslation = frame.RootTranslation;
+		latchedTimestamp = frame.Timestamp;
+		worldTime = frame.WorldTime;
+	});
+	if (numJoints > 0 && FPoseAILatencyTracker::IsEnabled())
+		FPoseAILatencyTracker::Get().MarkEvaluated(worldTime);
+	if (numJoints < 1)
+		return;
+
+	// as UPoseAILiveLinkRetargetRotations: horizontal root motion on the root and vertical on the hips, other bones keep their translations
+	const FVector rootTranslation = latchedRootTranslation * ScaleTranslation;
+	auto applyRootMotion = [&](int32 joint, const FCompactPoseBoneIndex& bone) {
+		if (joint == 0)
+			Output.Pose[bone].SetTranslation(Output.Pose.GetRefPose(bone).GetTranslation() + FVector(rootTranslation.X, rootTranslation.Y, 0.0f));
+		else if (joint == 1)
+			Output.Pose[bone].SetTranslation(Output.Pose.GetRefPose(bone).GetTranslation() + FVector(0.0f, 0.0f, rootTranslation.Z));
+	};
+
+	if (!useComponentSpace) {
+		for (int32 joint = 0; joint < numJoints; ++joint) {
+			const FCompactPoseBoneIndex bone = jointToBone[joint];
+			if (!bone.IsValid())
+				continue;
+			Output.Pose[bone].SetRotation(latchedRotations[joint]);
+			applyRootMotion(joint, bone);
+		}
+		return;
+	}
+
+	// one pass in compact pose order, where parents precede children, converting each driven bone against its parent on this skeleton
+	boneComponentRotations.Reset();
+	boneComponentRotations.AddUninitialized(Output.Pose.GetNumBones());
+	for (const FCompactPoseBoneIndex bone : Output.Pose.ForEachBoneIndex()) {
+		const FCompactPoseBoneIndex parent = requiredBones.GetParentBoneIndex(bone);
+		const FQuat parentRotation = parent.IsValid() ? boneComponentRotations[parent.GetInt()] : FQuat::Identity;
+		const int32 joint = boneToJoint[bone.GetInt()];
+		FTransform& transform = Output.Pose[bone];
+		if (joint == INDEX_NONE || joint >= numJoints) {
+			boneComponentRotations[bone.GetInt()] = parentRotation * transform.GetRotation();
+			continue;
+		}
+		const FQuat& rotation = latchedRotations[joint];
+		boneComponentRotations[bone.GetInt()] = rotation;
+		FQuat localRotation = parentRotation.Inverse() * rotation;
+		localRotation.Normalize();
+		transform.SetRotation(localRotation);
+		applyRootMotion(joint, bone);
+	}
+}
+
+void FAnimNode_PoseAIDirectPose::RebuildBoneMap(const FBoneContainer& requiredBones)
+{
+	const int32 numBones = requiredBones.GetCompactPoseNumBones();
+	jointToBone.Reset(jointNames.Num());
+	boneToJoint.Init(INDEX_NONE, numBones);
+	for (int32 joint = 0; joint < jointNames.Num(); ++joint) {
+		const int32 meshIndex = requiredBones.GetPoseBoneIndexForBoneName(jointNames[joint]);
+		const FCompactPoseBoneIndex bone = meshIndex != INDEX_NONE ? requiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(meshIndex)) : FCompactPoseBoneIndex(INDEX_NONE);
+		jointToBone.Add(bone);
+		if (bone.IsValid())
+			boneToJoint[bone.GetInt()] = joint;
+	}
+	latchedRotations.Reserve(jointNames.Num());
+	boneComponentRotations.Reserve(numBones);
+	bBoneMapDirty = false;
+}
+
+void FAnimNode_PoseAIDirectPose::GatherDebugData(FNodeDebugData& DebugData)
+{
+	FString DebugLine = DebugData.GetNodeName(this);
+	DebugLine += FString::Printf(TEXT("(Subject: %s, Timestamp: %.3f)"), *SubjectName.ToString(), latchedTimestamp);
+	DebugData.AddDebugItem(DebugLine);
+	InputPose.GatherDebugData(DebugData);
+}
+
+#undef LOCTEXT_NAMESPACE
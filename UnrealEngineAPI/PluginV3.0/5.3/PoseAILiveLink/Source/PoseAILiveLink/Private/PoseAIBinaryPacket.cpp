@@ -0,0 +1,133 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIBinaryPacket.h"
+#include "PoseAIFixed12Decoder.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+// minimum payload of each section, beyond which the count byte determines the size
+static int32 RequiredSectionSize(EPoseAIBinarySection section, const uint8* data) {
+	const int32 count = data[0];
+	switch (section) {
+	case EPoseAIBinarySection::BodyRotations:
+	case EPoseAIBinarySection::LeftHandRotations:
+	case EPoseAIBinarySection::RightHandRotations:
+		return 1 + FPoseAIBinaryPacket::PackedSize(count * 4);
+	case EPoseAIBinarySection::Vectors:
+	case EPoseAIBinarySection::Face:
+		return 1 + FPoseAIBinaryPacket::PackedSize(count);
+	case EPoseAIBinarySection::Scalars:
+		return 6 + FPoseAIBinaryPacket::PackedSize(4);
+	case EPoseAIBinarySection::Events:
+		return 1 + count * 6;
+	case EPoseAIBinarySection::HandVectors:
+		return 1 + ((count & 1) + ((count >> 1) & 1)) * FPoseAIBinaryPacket::PackedSize(6);
+	default:
+		return 1;
+	}
+}
+
+
+bool FPoseAIBinaryPacket::Parse(const uint8* data, int32 len) {
+	bytes = nullptr;
+	length = 0;
+	if (!IsBinaryPacket(data, len) || data[2] != FormatVersion)
+		return false;
+
+	const int32 numSections = (int32)EPoseAIBinarySection::MAX;
+	for (int32 i = 0; i < numSections; ++i) {
+		const int32 offset = (int32)data[16 + 2 * i] | ((int32)data[17 + 2 * i] << 8);
+		if (offset != 0 && (offset < HeaderSize || offset >= len))
+			return false;
+		sectionOffsets[i] = (uint16)offset;
+	}
+
+	// a section runs until the next section begins or the packet ends
+	for (int32 i = 0; i < numSections; ++i) {
+		sectionSizes[i] = 0;
+		if (sectionOffsets[i] == 0)
+			continue;
+		int32 end = len;
+		for (int32 j = 0; j < numSections; ++j) {
+			if (sectionOffsets[j] > sectionOffsets[i] && sectionOffsets[j] < end)
+				end = sectionOffsets[j];
+		}
+		sectionSizes[i] = (uint16)(end - sectionOffsets[i]);
+		if (sectionSizes[i] < RequiredSectionSize((EPoseAIBinarySection)i, data + sectionOffsets[i]))
+			return false;
+	}
+
+	bytes = data;
+	length = len;
+	return true;
+}
+
+double FPoseAIBinaryPacket::GetTimestamp() const {
+	// packets are little endian, as are all platforms the plugin ships on
+	static_assert(PLATFORM_LITTLE_ENDIAN, "PoseAI binary packets assume a little endian host");
+	double timestamp;
+	FMemory::Memcpy(&timestamp, bytes + 8, sizeof(double));
+	return timestamp;
+}
+
+uint32 FPoseAIBinaryPacket::ReadUint32(int32 offset) const {
+	return (uint32)bytes[offset] | ((uint32)bytes[offset + 1] << 8) | ((uint32)bytes[offset + 2] << 16) | ((uint32)bytes[offset + 3] << 24);
+}
+
+int32 FPoseAIBinaryPacket::GetSectionCount(EPoseAIBinarySection section) const {
+	return HasSection(section) ? bytes[sectionOffsets[(int32)section]] : 0;
+}
+
+uint32 FPoseAIBinaryPacket::UnpackUint12(const uint8* data, int32 idx) {
+	const uint8* triple = data + (idx >> 1) * 3;
+	return (idx & 1) ?
+		((uint32)(triple[1] >> 4) | ((uint32)triple[2] << 4)) :
+		((uint32)triple[0] | (((uint32)triple[1] & 0x0F) << 8));
+}
+
+float FPoseAIBinaryPacket::Fixed12ToFloat(uint32 value) {
+	return ::Fixed12ToFloat(value);
+}
+
+int32 FPoseAIBinaryPacket::ReadQuats(EPoseAIBinarySection section, TArray<FQuat>& quatArray) const {
+	if (!HasSection(section))
+		return 0;
+	const uint8* data = GetSectionData(section);
+	const int32 count = data[0];
+	const uint8* packed = data + 1;
+	quatArray.Reserve(quatArray.Num() + count);
+	for (int32 i = 0; i < count; ++i) {
+		FQuat quat(
+			Fixed12ToFloat(UnpackUint12(packed, 4 * i)),
+			Fixed12ToFloat(UnpackUint12(packed, 4 * i + 1)),
+			Fixed12ToFloat(UnpackUint12(packed, 4 * i + 2)),
+			Fixed12ToFloat(UnpackUint12(packed, 4 * i + 3))
+		);
+		quat.Normalize();
+		quatArray.Add(quat);
+	}
+	return count;
+}
+
+int32 FPoseAIBinaryPacket::ReadFixed12(EPoseAIBinarySection section, TArray<float>& flatArray) const {
+	if (!HasSection(section))
+		return 0;
+	const uint8* data = GetSectionData(section);
+	const int32 count = data[0];
+	flatArray.Reserve(flatArray.Num() + count);
+	for (int32 i = 0; i < count; ++i)
+		flatArray.Add(Fixed12ToFloat(UnpackUint12(data + 1, i)));
+	return count;
+}
+
+uint32 FPoseAIBinaryPacket::EventSignature() const {
+	uint32 crc = 0;
+	if (const uint8* scalarData = GetSectionData(EPoseAIBinarySection::Scalars))
+		crc = FCrc::MemCrc32(scalarData, FMath::Min(5, GetSectionSize(EPoseAIBinarySection::Scalars)), crc);
+	if (const uint8* eventData = GetSectionData(EPoseAIBinarySection::Events))
+		crc = FCrc::MemCrc32(eventData, GetSectionSize(EPoseAIBinarySection::Events), crc);
+	return crc;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -56,6 +56,7 @@ PoseAILiveLinkNetworkSource::PoseAILiveLinkNetworkSource(const FPoseAIHandshake&
 	status(LOCTEXT("statusConnecting", "connecting"))
 {
 	subjectKey = FLiveLinkSubjectKey(sourceGuid, SubjectNameFromPort(port));
+	pipelineStats = &FPoseAIPipelineStats::ForSource(subjectKey.SubjectName.Name);
 
 	UE_LOG(LogTemp, Display, TEXT("PoseAI: connecting to %d"), port);
 	
@@ -86,6 +87,7 @@ void PoseAILiveLinkNetworkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid
 	record.source = InSourceGuid;
 	record.subjectKey = subjectKey;
 	usedPorts.Add(port, record);
+	publisher = MakeUnique<FPoseAISubjectPublisher>(subjectKey, InClient, *pipelineStats);
 	liveLinkClient = InClient;
 
 	AddSubject();
@@ -113,40 +115,21 @@ void PoseAILiveLinkNetworkSource::AddSubject(){
 		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create rig %s"), *handshake.GetRigString());
 		return;
 	}
-	check(IsInGameThread());
-	liveLinkClient->RemoveSubject_AnyThread(subjectKey);
-	FLiveLinkSubjectPreset subject;
-	subject.bEnabled = true;
-	subject.Key =  subjectKey;
-	subject.Role = TSubclassOf<ULiveLinkRole>(ULiveLinkAnimationRole::StaticClass());
-	subject.Settings = nullptr;
-	subject.VirtualSubject = nullptr;
-	
-	FScopeLock ScopeLock(&InSynchObject);
-	if (!liveLinkClient->CreateSubject(subject)) {
-		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create subject %s"), *(subjectKey.SubjectName.Name.ToString()));
-	}
-	else {
-		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: created subject %s"), *(subjectKey.SubjectName.Name.ToString()));
-		FLiveLinkStaticDataStruct rigDefinition = rig->MakeStaticData();
-		liveLinkClient->PushSubjectStaticData_AnyThread(subject.Key, ULiveLinkAnimationRole::StaticClass(), MoveTemp(rigDefinition));
-	}
+	publisher->CreateSubject(*rig, InSynchObject);
 }
 
 
 /*
-*  The main processing function. For this source the update is called by the udpclient when it receives a frame.
+*  The main processing function. For this source the update is called by the server's mailbox worker, with the latest received frame.
 */
 void PoseAILiveLinkNetworkSource::UpdatePose(TSharedPtr<FJsonObject> jsonPose)
 {
 	if (!liveLinkClient ||!rig || !rig.IsValid()) {
 		return;
 	}
-	FLiveLinkFrameDataStruct frameData(FLiveLinkAnimationFrameData::StaticStruct());
-	FLiveLinkAnimationFrameData& data = *frameData.Cast<FLiveLinkAnimationFrameData>();
-	data.Transforms.Reserve(100);
+	FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
 	if (rig->ProcessFrame(jsonPose, data)) {
-		liveLinkClient->PushSubjectFrameData_AnyThread(subjectKey, MoveTemp(frameData));
+		publisher->PushFrame(*rig, data, latencyTrace);
 		faceSubSource->UpdateFace(jsonPose);
 	}
 	else {
@@ -156,6 +139,91 @@ void PoseAILiveLinkNetworkSource::UpdatePose(TSharedPtr<FJsonObject> jsonPose)
 }
 
 
+void PoseAILiveLinkNetworkSource::UpdatePose(const FPoseAIBinaryPacket& packet)
+{
+	if (!liveLinkClient || !rig || !rig.IsValid()) {
+		return;
+	}
+	FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+	if (rig->ProcessFrame(packet, data)) {
+		publisher->PushFrame(*rig, data, latencyTrace);
+		faceSubSource->UpdateFace(packet);
+	}
+	else {
+		static const FName NAME_BinaryError = "PoseAILiveLink_ProcessBinaryFrameError";
+		FLiveLinkLog::WarningOnce(NAME_BinaryError, subjectKey, TEXT("PoseAI: Error processing binary frame (for instance, rig type mismatch)"));
+	}
+}
+
+
+void PoseAILiveLinkNetworkSource::UpdatePose(const FPoseAICompactFrame& frame)
+{
+	if (!liveLinkClient || !rig || !rig.IsValid()) {
+		return;
+	}
+	FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+	if (rig->ProcessFrame(frame, data)) {
+		publisher->PushFrame(*rig, data, latencyTrace);
+		faceSubSource->UpdateFace(frame);
+	}
+	else {
+		static const FName NAME_JsonError = "PoseAILiveLink_ProcessFrameError";
+		FLiveLinkLog::WarningOnce(NAME_JsonError, subjectKey, TEXT("PoseAI: Error processing frame (for instance, rig type mismatch)"));
+	}
+}
+
+
+void PoseAILiveLinkNetworkSource::UpdatePose(const FPoseAIVerboseFrame& frame)
+{
+	if (!liveLinkClient || !rig || !rig.IsValid()) {
+		return;
+	}
+	FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+	if (rig->ProcessFrame(frame, data)) {
+		publisher->PushFrame(*rig, data, latencyTrace);
+		faceSubSource->UpdateFace(frame);
+	}
+	else {
+		static const FName NAME_JsonError = "PoseAILiveLink_ProcessFrameError";
+		FLiveLinkLog::WarningOnce(NAME_JsonError, subjectKey, TEXT("PoseAI: Error processing frame (for instance, rig type mismatch)"));
+	}
+}
+
+
+void PoseAILiveLinkNetworkSource::Update()
+{
+	if (liveLinkClient && rig.IsValid())
+		publisher->Update(*rig, InSynchObject);
+}
+
+
+void PoseAILiveLinkNetworkSource::ScanPose(const FPoseAIBinaryPacket& packet)
+{
+	if (liveLinkClient && rig && rig.IsValid())
+		rig->ScanFrame(packet);
+}
+
+
+void PoseAILiveLinkNetworkSource::ScanPose(const FPoseAICompactFrame& frame)
+{
+	if (liveLinkClient && rig && rig.IsValid())
+		rig->ScanFrame(frame);
+}
+
+
+void PoseAILiveLinkNetworkSource::ScanPose(const FPoseAIVerboseFrame& frame)
+{
+	if (liveLinkClient && rig && rig.IsValid())
+		rig->ScanFrame(frame);
+}
+
+
+void PoseAILiveLinkNetworkSource::ScanPose(TSharedPtr<FJsonObject> jsonPose)
+{
+	if (liveLinkClient && rig && rig.IsValid())
+		rig->ScanFrame(jsonPose);
+}
+
 
 void PoseAILiveLinkNetworkSource::SetHandshake(const FPoseAIHandshake& newHandshake) {
 	bool dirty = handshake != newHandshake;
@@ -216,6 +284,7 @@ bool PoseAILiveLinkNetworkSource::RequestSourceShutdown()
 	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: PoseAILiveLinkNetworkSource on port %d closed"), port);
 	if (liveLinkClient != nullptr) {
 		faceSubSource->RequestSubSourceShutdown();
+		publisher->RemoveDerivedSubjects();
 		liveLinkClient->RemoveSubject_AnyThread(subjectKey);
 		liveLinkClient->RemoveSource(sourceGuid);
 		liveLinkClient = nullptr;
@@ -0,0 +1,109 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIStreamListener.h"
+#include "Misc/ScopeRWLock.h"
+
+#include <atomic>
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+namespace {
+	struct FListenerEntry
+	{
+		IPoseAIStreamListener* Listener;
+		EPoseAIStreamFields Fields;
+	};
+
+	struct FSubjectListeners
+	{
+		TArray<FListenerEntry, TInlineAllocator<4>> Entries;
+		// union of the entries' fields
+		EPoseAIStreamFields Fields = EPoseAIStreamFields::None;
+
+		void UpdateFields() {
+			Fields = EPoseAIStreamFields::None;
+			for (const FListenerEntry& entry : Entries)
+				Fields |= entry.Fields;
+		}
+	};
+
+	FRWLock listenersLock;
+	TMap<FLiveLinkSubjectName, FSubjectListeners> listenersBySubject;
+	std::atomic<int32> listenerCount{ 0 };
+
+	void CountListeners() {
+		int32 count = 0;
+		for (const TPair<FLiveLinkSubjectName, FSubjectListeners>& subject : listenersBySubject)
+			count += subject.Value.Entries.Num();
+		listenerCount.store(count, std::memory_order_release);
+	}
+}
+
+
+void FPoseAIStreamListeners::Add(const FLiveLinkSubjectName& subject, IPoseAIStreamListener* listener, EPoseAIStreamFields fields) {
+	if (listener == nullptr)
+		return;
+	FWriteScopeLock lock(listenersLock);
+	FSubjectListeners& listeners = listenersBySubject.FindOrAdd(subject);
+	FListenerEntry* existing = listeners.Entries.FindByPredicate([listener](const FListenerEntry& entry) { return entry.Listener == listener; });
+	if (existing != nullptr)
+		existing->Fields = fields;
+	else
+		listeners.Entries.Add({ listener, fields });
+	listeners.UpdateFields();
+	CountListeners();
+}
+
+void FPoseAIStreamListeners::Remove(IPoseAIStreamListener* listener) {
+	FWriteScopeLock lock(listenersLock);
+	for (auto it = listenersBySubject.CreateIterator(); it; ++it) {
+		it->Value.Entries.RemoveAll([listener](const FListenerEntry& entry) { return entry.Listener == listener; });
+		if (it->Value.Entries.Num() == 0)
+			it.RemoveCurrent();
+		else
+			it->Value.UpdateFields();
+	}
+	CountListeners();
+}
+
+void FPoseAIStreamListeners::Notify(const FLiveLinkSubjectName& subject, const FPoseAIEventRecord& record, const FPoseAIVisibilityFlags& visibilityFlags,
+	const FPoseAILiveValues& liveValues) {
+	if (listenerCount.load(std::memory_order_acquire) == 0)
+		return;
+
+	FReadScopeLock lock(listenersLock);
+	const FSubjectListeners* listeners = listenersBySubject.Find(subject);
+	if (listeners == nullptr)
+		return;
+
+	const bool sendEvents = EnumHasAnyFlags(listeners->Fields, EPoseAIStreamFields::Events) && record.Events.Num() > 0;
+	const bool sendVisibility = EnumHasAnyFlags(listeners->Fields, EPoseAIStreamFields::Visibility) && record.bHasVisibility;
+	const bool sendLiveValues = EnumHasAnyFlags(listeners->Fields, EPoseAIStreamFields::LiveValues) && record.bHasLiveValues;
+	const bool sendHandTargets = EnumHasAnyFlags(listeners->Fields, EPoseAIStreamFields::HandTargets);
+
+	FPoseAIHandTargets handTargets;
+	if (sendHandTargets) {
+		handTargets.handIkL = liveValues.handIkL;
+		handTargets.handIkR = liveValues.handIkR;
+		handTargets.fingerIkL = liveValues.fingerIkL;
+		handTargets.fingerIkR = liveValues.fingerIkR;
+		handTargets.opennessLeftHand = liveValues.opennessLeftHand;
+		handTargets.opennessRightHand = liveValues.opennessRightHand;
+	}
+
+	for (const FListenerEntry& entry : listeners->Entries) {
+		if (sendEvents && EnumHasAnyFlags(entry.Fields, EPoseAIStreamFields::Events)) {
+			for (const FPoseAIEvent& event : record.Events)
+				entry.Listener->OnPoseAIEvent(subject, event);
+		}
+		if (sendVisibility && EnumHasAnyFlags(entry.Fields, EPoseAIStreamFields::Visibility))
+			entry.Listener->OnPoseAIVisibility(subject, visibilityFlags);
+		if (sendLiveValues && EnumHasAnyFlags(entry.Fields, EPoseAIStreamFields::LiveValues))
+			entry.Listener->OnPoseAILiveValues(subject, liveValues);
+		if (sendHandTargets && EnumHasAnyFlags(entry.Fields, EPoseAIStreamFields::HandTargets))
+			entry.Listener->OnPoseAIHandTargets(subject, handTargets);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
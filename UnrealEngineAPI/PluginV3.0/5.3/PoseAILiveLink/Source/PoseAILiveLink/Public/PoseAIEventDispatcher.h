@@ -7,8 +7,11 @@
 #include "Async/Async.h"
 #include "LiveLinkTypes.h"
 #include "PoseAIStructs.h"
+#include "PoseAIEventRecord.h"
 #include "PoseAIEventDispatcher.generated.h"
 
+class UPoseAIRetargetAsset;
+
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FPoseAIDisconnect, const FLiveLinkSubjectName&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FPoseAIHandshakeUpdate, const FPoseAIHandshake&);
@@ -173,6 +176,22 @@ class POSEAILIVELINK_API UPoseAIMovementComponent : public UActorComponent
      UFUNCTION(BlueprintCallable, Category = "PoseAI Configuration")
      void UseCurrentPoseToOrientCamera();
 
+     /** Copies the live values of the most recent frame, without waiting for the next onLiveValues event.  Returns false if the subject has no rig */
+     UFUNCTION(BlueprintCallable, Category = "PoseAI Events")
+     bool GetLatestLiveValues(FPoseAILiveValues& values);
+
+     /** Retargets the subject's rig onto another skeleton as it is processed, or restores the rig's own skeleton if null */
+     UFUNCTION(BlueprintCallable, Category = "PoseAI Configuration")
+     void SetRetargetAsset(UPoseAIRetargetAsset* RetargetAsset);
+
+     /** Publishes the subject's frames again as another LiveLink subject, retargeted with the asset (for instance onto another rig's skeleton),
+      *  without decoding them twice or asking the camera for another rig.  The subject's own rig if the asset is null */
+     UFUNCTION(BlueprintCallable, Category = "PoseAI Configuration")
+     void AddDerivedSubject(FLiveLinkSubjectName DerivedSubjectName, UPoseAIRetargetAsset* RetargetAsset);
+
+     UFUNCTION(BlueprintCallable, Category = "PoseAI Configuration")
+     void RemoveDerivedSubject(FLiveLinkSubjectName DerivedSubjectName);
+
      /** Remove all live root motion (sets scalemotion to zero)*/
      UFUNCTION(BlueprintCallable, Category = "PoseAI Configuration")
          void ZeroMotion();
@@ -355,10 +374,11 @@ public:
     void BroadcastCloseSource(const FLiveLinkSubjectName& subjectName);
     void BroadcastConfigUpdate(const FLiveLinkSubjectName& subjectName, FPoseAIModelConfig config);
     void BroadcastDisconnect(const FLiveLinkSubjectName& subjectName);
-    void BroadcastFrameReceived(const FLiveLinkSubjectName& subjectName);
     void BroadcastSubjectConnected(const FLiveLinkSubjectName& subjectName);
 
-    // Pose Camera driven events
+    /* Pose Camera driven events.  These are queued with the subject's pending record and dispatched by the next DrainPendingEvents,
+       so a packet costs one lock however many events it carries and game thread work stays bounded at high packet rates */
+    void QueueEvents(const FLiveLinkSubjectName& subjectName, const FPoseAIEventRecord& record);
     void BroadcastArmpumps(const FLiveLinkSubjectName& subjectName, float stepHeight);
     void BroadcastArmflexes(const FLiveLinkSubjectName& subjectName, float stepHeight, bool isExpanding);
     void BroadcastArmjacks(const FLiveLinkSubjectName& subjectName, bool isRising);
@@ -370,7 +390,6 @@ public:
     void BroadcastHandToZoneL(const FLiveLinkSubjectName& subjectName, int32 zone);
     void BroadcastHandToZoneR(const FLiveLinkSubjectName& subjectName, int32 zone);
     void BroadcastJumps(const FLiveLinkSubjectName& subjectName);
-    void BroadcastLiveValues(const FLiveLinkSubjectName& subjectName, FPoseAILiveValues values);
     void BroadcastSidestepL(const FLiveLinkSubjectName& subjectName, bool isLeftStep);
     void BroadcastSidestepR(const FLiveLinkSubjectName& subjectName, bool isLeftStep);   
     void BroadcastStationary(const FLiveLinkSubjectName& subjectName);
@@ -383,7 +402,23 @@ public:
 
     void BroadcastResetZeroLivePosition();
 
+    /* game thread: dispatches every subject's pending record.  Bound to the start of each engine frame by the module, so handlers
+       run once per tick, before any world's actors tick */
+    static void DrainPendingEvents();
+
+    FPoseAIEventQueueStats GetEventQueueStats() const;
+
 private:
+    void QueueEvent(const FLiveLinkSubjectName& subjectName, EPoseAIEventType type, float value = 0.0f, int32 intValue = 0, bool flag = false);
+    void DispatchRecord(const FLiveLinkSubjectName& subjectName, const FPoseAIEventRecord& record);
+    void DispatchEvent(UPoseAIMovementComponent* component, const FPoseAIEvent& event);
+
+    // records waiting for the game thread, and the set being dispatched, swapped under the lock so entries are reused without allocating
+    mutable FCriticalSection pendingLock;
+    TMap<FLiveLinkSubjectName, FPoseAIEventRecord> pendingEvents;
+    TMap<FLiveLinkSubjectName, FPoseAIEventRecord> drainingEvents;
+    FPoseAIEventQueueStats eventQueueStats;
+
     static UPoseAIEventDispatcher* theInstance;
     const double timeoutInSeconds = 60.0;
     TQueue<UPoseAIMovementComponent*> componentQueue;
@@ -0,0 +1,86 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PoseAIStructs.h"
+
+
+/* the discrete, counted events a packet can trigger on a UPoseAIMovementComponent */
+enum class EPoseAIEventType : uint8
+{
+	Footstep,
+	Feetsplit,
+	Armpump,
+	Armflex,
+	Armjack,
+	ArmGestureL,
+	ArmGestureR,
+	SidestepL,
+	SidestepR,
+	Jump,
+	Crouch,
+	HandToZoneL,
+	HandToZoneR,
+	Stationary,
+};
+
+
+/* one discrete event.  Value carries heights and widths, IntValue zones and gestures, and bFlag the side or direction where an event has one */
+struct FPoseAIEvent
+{
+	EPoseAIEventType Type;
+	float Value = 0.0f;
+	int32 IntValue = 0;
+	bool bFlag = false;
+};
+
+
+/**
+ * Everything one subject's packets have for the game thread since it last drained: the discrete events in order, and the latest
+ * visibility flags and frame time, which only ever need their newest state.  Live values are only flagged, as the game thread reads
+ * them from the rig's snapshot when it drains.
+ * When several packets arrive within one game thread tick, as during a hitch, they coalesce into the same record: state fields keep
+ * the newest value and discrete events are appended, dropping the oldest once MAX_EVENTS are pending so the record stays bounded.
+ */
+struct POSEAILIVELINK_API FPoseAIEventRecord
+{
+	static constexpr int32 MAX_EVENTS = 32;
+
+	TArray<FPoseAIEvent, TInlineAllocator<MAX_EVENTS>> Events;
+
+	bool bHasLiveValues = false;
+
+	bool bHasVisibility = false;
+	FPoseAIVisibilityFlags VisibilityFlags;
+
+	// set by the rig when it processes a frame, rather than queued as a record of its own
+	bool bFrameReceived = false;
+
+	void AddEvent(EPoseAIEventType type, float value = 0.0f, int32 intValue = 0, bool flag = false) {
+		Events.Add({ type, value, intValue, flag });
+	}
+
+	bool IsEmpty() const { return Events.Num() == 0 && !bHasLiveValues && !bHasVisibility && !bFrameReceived; }
+
+	void Reset() {
+		Events.Reset();
+		bHasLiveValues = false;
+		bHasVisibility = false;
+		bFrameReceived = false;
+	}
+
+	/* merges a newer record into this one, returning the number of events dropped to stay within MAX_EVENTS */
+	int32 Coalesce(const FPoseAIEventRecord& newer);
+};
+
+
+struct FPoseAIEventQueueStats
+{
+	// records queued by rigs and sources, those merged into a record still waiting for the game thread, and game thread drains
+	uint64 Queued = 0;
+	uint64 Coalesced = 0;
+	uint64 Drains = 0;
+	// discrete events dropped as a subject had MAX_EVENTS pending
+	uint64 EventsDropped = 0;
+};
@@ -15,14 +15,36 @@
 #include "PoseAIStructs.h"
 #include "PoseAIUdpSocketReceiver.h"
 #include "PoseAIEndpoint.h"
+#include "PoseAIFrameMailbox.h"
+#include "PoseAIPipelineStats.h"
+#include "PoseAICaptureFile.h"
 #include "SocketSubsystem.h"
 
 
-class PoseAILiveLinkReceiverRunnable;
 class PoseAILiveLinkNetworkSource;
 class PoseAILiveLinkServerListener;
 class FPoseAISocketSender;
 
+/* messages of the same kind to the same recipient replace each other while queued, apart from Other */
+enum class EPoseAISendKind : uint8
+{
+	Other,
+	Handshake,
+	Config,
+	Disconnect,
+};
+
+struct FPoseAISenderStats
+{
+	uint64 Queued = 0;
+	uint64 Sent = 0;
+	// messages replaced by a newer one of the same kind before they were sent
+	uint64 Coalesced = 0;
+	uint64 Failed = 0;
+	uint64 BytesSent = 0;
+};
+
+
 // The networking class needs to be rewritten
 
 class POSEAILIVELINK_API PoseAILiveLinkServer
@@ -44,13 +66,18 @@ public:
 	TSharedPtr<FSocket> GetSocket() const { return serverSocket; }
 
 	void ProcessNetworkPacket(const FString& recvMessage, const FPoseAIEndpoint& endpoint);
+	// entry point for the receiver's byte delegate.  Dispatches binary, compact and json packets without an intermediate FString where possible
+	void ProcessNetworkBytes(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpoint);
+	void ProcessBinaryPacket(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpoint);
+
+	FPoseAIReceiveStats GetReceiveStats() const;
+	FPoseAIMailboxStats GetMailboxStats() const;
+	FPoseAISenderStats GetSenderStats() const;
 
 
-	bool SendString(FString& message) const;
+	bool SendString(FString& message, EPoseAISendKind kind = EPoseAISendKind::Other) const;
 	void SendHandshake() const;
 	void SetHandshake(const FPoseAIHandshake& handshake);
-	// receiver will be set on a runnable thread and set once started
-	void SetReceiver(TSharedPtr<FPoseAIUdpSocketReceiver> receiver) { udpSocketReceiver = receiver; }
 
 
 private:
@@ -69,27 +96,43 @@ private:
 	
 	// time of last connection.  After timeout seconds a newer connection can takeover the port.
 	FDateTime lastConnection;
+	// when the packet being handled on the socket thread was received, for latency tracing
+	double packetReceiveTime = 0.0;
+	// packet counts of the port's subject, shared with its source and rig
+	FPoseAIPipelineStats* pipelineStats;
+	// writes the port's packets to a file while PoseAI.CaptureStart is running
+	TSharedPtr<FPoseAICaptureTap, ESPMode::ThreadSafe> captureTap;
 	const double TIMEOUT_SECONDS = 10.0;
 
 	TSharedPtr<FSocket> serverSocket;
 	
-	//used to launch receiver without slowing main thread
-	TSharedPtr<PoseAILiveLinkReceiverRunnable, ESPMode::ThreadSafe> poseAILiveLinkRunnable;
-	
-	//Listens for packets
+	//Listens for packets, serviced by a thread of the shared FPoseAINetworkReactor
 	TSharedPtr<FPoseAIUdpSocketReceiver> udpSocketReceiver;
 	
+	// latest frame handoff between the receive thread and the worker which decodes and pushes to LiveLink
+	TSharedPtr<FPoseAIFrameMailbox, ESPMode::ThreadSafe> mailbox = MakeShared<FPoseAIFrameMailbox, ESPMode::ThreadSafe>();
+
 	//sends instructions to paired app
-	TSharedPtr<FPoseAISocketSender> udpSocketSender;
+	TSharedPtr<FPoseAISocketSender, ESPMode::ThreadSafe> udpSocketSender;
 	FPoseAIEndpoint endpoint;
 	
 	// disconnect message formatted for Pose AI mobile app
 	FString disconnect = FString(TEXT("{\"REQUESTS\":[\"DISCONNECT\"]}"));
 	
+	void ProcessJsonPacket(const FString& recvMessage, const FPoseAIEndpoint& endpointRecv);
 	void InitiateConnection(TSharedPtr<FJsonObject> jsonObject, const FPoseAIEndpoint& endpointRecv);
+
+	// publishes compact and verbose frames from the connected endpoint without parsing them.  Returns false if the packet needs the json path
+	bool ProcessFramePacket(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpointRecv);
+
+	// hands a frame from the connected endpoint to the worker
+	void PublishFrame(TArrayView<const uint8> recvBytes, uint32 eventSignature);
+	static void DrainMailbox(FPoseAIFrameMailbox& mailbox, TWeakPtr<PoseAILiveLinkNetworkSource> weakSource);
+	static void ProcessQueuedFrame(PoseAILiveLinkNetworkSource& source, TArrayView<const uint8> frameBytes, bool scanOnly);
 	
 
 	bool HasValidConnection() const;
+	bool IsCurrentEndpoint(const FPoseAIEndpoint& endpointRecv) const;
 
 	FName ExtractConnectionName(TSharedPtr<FJsonObject> jsonObject, const FPoseAIEndpoint& endpoint) const;
 
@@ -105,100 +148,53 @@ private:
 
 
 
-class POSEAILIVELINK_API PoseAILiveLinkReceiverRunnable : public FRunnable
-{
-public:
-	PoseAILiveLinkReceiverRunnable(int32 port, TSharedPtr<PoseAILiveLinkServerListener> listener, PoseAILiveLinkServer* poseAILiveLinkServer) :
-		port(port), poseAILiveLinkServer(poseAILiveLinkServer), listener(listener) {
-		myName = "PoseAILiveLinkServer_" + FGuid::NewGuid().ToString();
-		thread = FRunnableThread::Create(this, *myName, 0, EThreadPriority::TPri_Normal);
-	}
-	virtual uint32 Run() override;
-	
-protected:
-	FString myName;
-	int32 port;
-	FRunnableThread* thread = nullptr;
-private:
-	PoseAILiveLinkServer* poseAILiveLinkServer;
-	TSharedPtr<PoseAILiveLinkServerListener> listener;
-	TSharedPtr<FPoseAIUdpSocketReceiver> udpSocketReceiver;
-};
-
-
-
-
-// built in udpSocketSender kept crashing on cleanup so recreated one with sleep instead of tick/update 
-class POSEAILIVELINK_API FPoseAISocketSender : public FRunnable
+/*
+* Queues messages for the paired app and sends them from a task graph task, scheduled when the queue goes from empty to non empty,
+* so callers (including the receive thread when resending handshakes) never wait on the socket and no thread is kept per port.
+* Message buffers are pooled.  Stop refuses new messages, anything already queued is still sent.
+*/
+class POSEAILIVELINK_API FPoseAISocketSender : public TSharedFromThis<FPoseAISocketSender, ESPMode::ThreadSafe>
 {
 public:
-	FPoseAISocketSender(TSharedPtr<FSocket> Socket, const TCHAR* threadDescription) :
-		Socket(Socket) {
-		thread = FRunnableThread::Create(this, threadDescription, 0, EThreadPriority::TPri_Normal);
-	}
+	FPoseAISocketSender(TSharedPtr<FSocket> Socket) : Socket(Socket) {}
 
-
-	virtual uint32 Run() override {
-		while (running && thread == nullptr) {
-			FPlatformProcess::Sleep(0.2);
-		}
-
-		while (running ) {
-			Sleep(true);
-			while (running && sleeping) {
-				FPlatformProcess::Sleep(0.005);	
-			}
-			
-		}
-		
-		thread = nullptr;
-		return 0;
+	/* returns true if the message was queued */
+	bool Send(TArrayView<const uint8> Data, const FPoseAIEndpoint& Recipient, EPoseAISendKind Kind = EPoseAISendKind::Other);
+	bool Send(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& Data, const FPoseAIEndpoint& Recipient) {
+		return Send(TArrayView<const uint8>(*Data), Recipient);
 	}
 
-	virtual void Stop() override {
-		running = false;
-		if (thread != nullptr) {
-			Sleep(false);
-		}
-	}
+	void Stop() { running = false; }
 
-	bool Send(const TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>& Data, const FPoseAIEndpoint& Recipient)
-	{
-		if (running) {
-			
-			int32 sent = 0;
-			if (!Socket) {
-				UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: socket missing from sender"));
-				return false;
-			}
-								
-			if (!Socket->SendTo(Data->GetData(), Data->Num(), sent, *Recipient.ToInternetAddr()))
-				UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to send to %s"), *(Recipient.ToString()));
-
-			if (sent != Data->Num())
-				return false;
-			
-			Sleep(false);
-			return true;
-		}
-		return false;
-	}
-
-	void Sleep(bool sleep) {
-		sleeping = sleep;
-		if (thread != nullptr)
-			thread->Suspend(sleep);
-	}
+	FPoseAISenderStats GetStats() const;
 
 protected:
 	/** The network socket. */
 	TSharedPtr<FSocket> Socket;
-	
-	/** The thread object. */
-	FRunnableThread* thread = nullptr;
 
-	bool running = true;
-	bool sleeping = false;
+private:
+	struct FPendingSend
+	{
+		TArray<uint8> Bytes;
+		FPoseAIEndpoint Recipient;
+		EPoseAISendKind Kind;
+	};
+
+	void Flush();
+
+	FCriticalSection lock;
+	TArray<FPendingSend> pending;
+	// only touched by the single flush task
+	TArray<FPendingSend> sending;
+	TArray<TArray<uint8>> freeBuffers;
+	bool flushScheduled = false;
+	std::atomic<bool> running{ true };
+
+	std::atomic<uint64> queued{ 0 };
+	std::atomic<uint64> sent{ 0 };
+	std::atomic<uint64> coalesced{ 0 };
+	std::atomic<uint64> failed{ 0 };
+	std::atomic<uint64> bytesSent{ 0 };
 };
 
 
@@ -211,6 +207,12 @@ public:
 	void ReceiveUDPDelegate(const FString& recvMessage, const FPoseAIEndpoint& endpoint) {
 		parent->ProcessNetworkPacket(recvMessage, endpoint);
 	}
+	void ReceiveBinaryDelegate(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpoint) {
+		parent->ProcessBinaryPacket(recvBytes, endpoint);
+	}
+	void ReceiveBytesDelegate(TArrayView<const uint8> recvBytes, const FPoseAIEndpoint& endpoint) {
+		parent->ProcessNetworkBytes(recvBytes, endpoint);
+	}
 	PoseAILiveLinkServerListener(PoseAILiveLinkServer* parent) : parent(parent) {}
 private:
 	PoseAILiveLinkServer* parent;
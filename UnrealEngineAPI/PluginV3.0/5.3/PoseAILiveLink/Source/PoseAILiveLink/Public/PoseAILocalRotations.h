@@ -0,0 +1,23 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Batched conversion of the camera's component space joint rotations to the local transforms LiveLink expects.
+ * Joints are gathered four at a time into structure of arrays lanes and each local rotation, parent.Inverse() * rotation,
+ * is computed with the conjugate multiply, renormalized and moved to the w >= 0 hemisphere in SIMD (AVX, SSE2 or NEON depending
+ * on the platform, with a scalar fallback).  As every input is already in component space, no joint depends on another's result,
+ * so a batch may span any joints whose parents' component rotations are known.
+ */
+
+/* appends a transform for each joint in [begin, end) to outTransforms, with the local rotation of rotations[joint - begin] relative
+   to componentRotations[parentIndices[joint]] (identity for parents < 0) and the joint's bind translation.  componentRotations must
+   already hold the joints' rotations, as parents may be in the same range.  Degenerate rotations become identity, as with FQuat::Normalize */
+POSEAILIVELINK_API void PoseAIAppendLocalTransforms(const FQuat* componentRotations, const FQuat* rotations, const int32* parentIndices, const FVector* translations,
+	int32 begin, int32 end, TArray<FTransform>& outTransforms);
+
+/* the instruction set used by the kernel, for logs and the PoseAI.LocalRotationBenchmark console command */
+POSEAILIVELINK_API const TCHAR* PoseAILocalRotationsPath();
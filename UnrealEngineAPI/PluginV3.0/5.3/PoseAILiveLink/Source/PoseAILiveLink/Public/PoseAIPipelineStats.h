@@ -0,0 +1,124 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include <atomic>
+
+
+DECLARE_STATS_GROUP(TEXT("PoseAI"), STATGROUP_PoseAI, STATCAT_Advanced);
+
+/* Insights channel for the receive pipeline, enabled with -trace=poseai */
+UE_TRACE_CHANNEL_EXTERN(PoseAIChannel, POSEAILIVELINK_API);
+
+/* a CPU scope named PoseAI::<Name> on the PoseAI trace channel */
+#define POSEAI_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("PoseAI::" #Name, PoseAIChannel)
+
+
+/* the timed stages of a source's receive pipeline */
+enum class EPoseAIPipelineTimer : uint8
+{
+	// decoding a frame from its bytes on the worker
+	Parse,
+	// rig processing, including the events and live values
+	Rig,
+	// decoding and pushing the face subject
+	Face,
+	// the LiveLink push of the pose
+	Push,
+	Num
+};
+
+enum class EPoseAIPipelineCounter : uint8
+{
+	Packets,
+	Bytes,
+	// frames older than the rig's latest timestamp, dropped by the rig
+	Stale,
+	// frames streamed in a different rig format than the handshake asked for
+	RigMismatch,
+	// json packets which failed to deserialize and binary packets which failed to parse
+	Malformed,
+	Num
+};
+
+
+/**
+ * Counters and stage timings of one source's receive pipeline, updated lock free from the receive thread and the worker.
+ * Once per engine frame the game thread turns them into per second rates and average stage times over the last second, which are
+ * published under stat PoseAI with one line per source and stage, and logged by the PoseAI.Stats console command.
+ */
+class POSEAILIVELINK_API FPoseAIPipelineStats
+{
+public:
+	/* the stats of a subject, created on first use and kept for the module's lifetime, so callers may hold on to the reference */
+	static FPoseAIPipelineStats& ForSource(FName source);
+	/* stats outside the registry, which are neither published nor logged, for rigs built by diagnostics */
+	static TUniquePtr<FPoseAIPipelineStats> MakeDetached(FName source);
+
+	void Count(EPoseAIPipelineCounter counter, uint64 amount = 1) {
+		counters[(int32)counter].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	void AddTime(EPoseAIPipelineTimer timer, uint64 cycles) {
+		timerCycles[(int32)timer].fetch_add(cycles, std::memory_order_relaxed);
+		timerCalls[(int32)timer].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64 GetCount(EPoseAIPipelineCounter counter) const { return counters[(int32)counter].load(std::memory_order_relaxed); }
+
+	/* game thread, once per engine frame */
+	static void PublishAll();
+	static void LogAll();
+
+	static const TCHAR* TimerName(EPoseAIPipelineTimer timer);
+	static const TCHAR* CounterName(EPoseAIPipelineCounter counter);
+
+private:
+	explicit FPoseAIPipelineStats(FName source) : source(source) {}
+
+	void Publish(double now);
+	void Log() const;
+
+	FName source;
+
+	std::atomic<uint64> counters[(int32)EPoseAIPipelineCounter::Num] = {};
+	std::atomic<uint64> timerCycles[(int32)EPoseAIPipelineTimer::Num] = {};
+	std::atomic<uint64> timerCalls[(int32)EPoseAIPipelineTimer::Num] = {};
+
+	// game thread only: the totals at the start of the current one second window and the rates of the last complete one
+	double windowStart = 0.0;
+	uint64 windowCounters[(int32)EPoseAIPipelineCounter::Num] = {};
+	uint64 windowCycles[(int32)EPoseAIPipelineTimer::Num] = {};
+	uint64 windowCalls[(int32)EPoseAIPipelineTimer::Num] = {};
+	double packetsPerSecond = 0.0;
+	double bytesPerSecond = 0.0;
+	double averageMicros[(int32)EPoseAIPipelineTimer::Num] = {};
+
+#if STATS
+	bool bStatsCreated = false;
+	TStatId rateStats[2];
+	TStatId timerStats[(int32)EPoseAIPipelineTimer::Num];
+	TStatId counterStats[(int32)EPoseAIPipelineCounter::Num];
+#endif
+};
+
+
+/* times the enclosing scope into one of a source's pipeline stages */
+class FPoseAIPipelineScope
+{
+public:
+	FPoseAIPipelineScope(FPoseAIPipelineStats& stats, EPoseAIPipelineTimer timer) :
+		stats(stats), timer(timer), start(FPlatformTime::Cycles64()) {}
+
+	~FPoseAIPipelineScope() { stats.AddTime(timer, FPlatformTime::Cycles64() - start); }
+
+private:
+	FPoseAIPipelineStats& stats;
+	EPoseAIPipelineTimer timer;
+	uint64 start;
+};
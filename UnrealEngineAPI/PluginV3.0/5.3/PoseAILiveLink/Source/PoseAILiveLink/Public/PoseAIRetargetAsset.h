@@ -0,0 +1,73 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "PoseAIStructs.h"
+#include "PoseAIRig.h"
+#include "PoseAIRetargetAsset.generated.h"
+
+class USkeleton;
+
+
+/** One rig joint's remapping onto a bone of the target skeleton. */
+USTRUCT(BlueprintType)
+struct POSEAILIVELINK_API FPoseAIRetargetJoint
+{
+	GENERATED_BODY()
+
+	/** Joint of the PoseAI rig, as streamed. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseAI Retarget")
+	FName SourceJoint;
+
+	/** Bone of the target skeleton it drives.  The source joint's name if left empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseAI Retarget")
+	FName TargetJoint;
+
+	/** Target reference component rotation relative to the source's, applied on the right of the rig's component rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseAI Retarget")
+	FQuat RotAdj = FQuat::Identity;
+
+	/** Translation of the target bone relative to its parent in the target's reference pose. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseAI Retarget")
+	FVector BindTranslation = FVector::ZeroVector;
+};
+
+
+/**
+ * Retargets a PoseAI rig onto an arbitrary skeleton on the receiving side, as the Unity plugin's PoseAIRigRetarget does.  The rig applies
+ * the remapping on its worker, so LiveLink subjects and the direct pose node get rotations, bone names and bind translations of the
+ * target skeleton and need no retarget asset of their own.  Assign to a subject with UPoseAIMovementComponent::SetRetargetAsset, or publish
+ * it alongside the subject with UPoseAIMovementComponent::AddDerivedSubject.
+ */
+UCLASS(BlueprintType)
+class POSEAILIVELINK_API UPoseAIRetargetAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Rig the camera streams, which names the source joints.  The asset is not applied to subjects streaming another rig. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PoseAI Retarget")
+	EPoseAiRigPresets SourceRig = EPoseAiRigPresets::UE4;
+
+	/** Skeleton whose reference pose the rig was authored against, e.g. the UE4 Mannequin for the UE4 rig.  Only used to generate the joints. */
+	UPROPERTY(EditAnywhere, Category = "PoseAI Retarget")
+	TSoftObjectPtr<USkeleton> SourceSkeleton;
+
+	/** Skeleton to retarget onto.  Only used to generate the joints. */
+	UPROPERTY(EditAnywhere, Category = "PoseAI Retarget")
+	TSoftObjectPtr<USkeleton> TargetSkeleton;
+
+	/** Joints of the rig and the target bones they drive.  Rig joints left out keep their own names and rotations. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseAI Retarget")
+	TArray<FPoseAIRetargetJoint> Joints;
+
+	/** Fills each joint's rotation adjustment and bind translation from the reference poses of the two skeletons, listing every rig joint
+	 *  by its own name first if Joints is empty.  Joints whose bones are missing keep their nearest found ancestor's adjustment. */
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "PoseAI Retarget")
+	void GenerateFromSkeletons();
+
+	/* the remappings for PoseAIRig::SetRemapping with SourceRig, keyed by source joint */
+	TMap<FName, Remapping> MakeRemappings() const;
+};
@@ -7,6 +7,8 @@
 #include "JsonObjectConverter.h"
 #include "PoseAIStructs.generated.h"
 
+struct FPoseAICompactHand;
+struct FPoseAIVerbosePart;
 
 
 /* decoding utilities for compact representation */
@@ -19,7 +21,7 @@ void FlatArrayToQuats(const TArray<float>& flatArray, TArray<FQuat>& quatArray);
 UENUM(BlueprintType)
 enum class EPoseAiPacketFormat : uint8
 {
-    Verbose, Compact
+    Verbose, Compact, Binary
 };
 
 UENUM(BlueprintType)
@@ -110,7 +112,7 @@ struct POSEAILIVELINK_API FPoseAIHandshake
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PoseAI Handshake")
         bool locomotionEvents = false;
 
-    /* controls compactness of packet. */
+    /* controls compactness of packet. Binary requires a camera build which supports the PF=2 format (see StreamFormat.md). */
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PoseAI Handshake")
         EPoseAiPacketFormat packetFormat = EPoseAiPacketFormat::Compact;
 
@@ -125,6 +127,8 @@ struct POSEAILIVELINK_API FPoseAIHandshake
     int32 GetBodyModelVersion() const;
     int32 GetHandModelVersion() const;
     FString ToString() const;
+    /* reads back the json written by ToString, keeping the current value of any missing field */
+    bool FromString(const FString& json);
     FString YesNoString(bool val) const {
         return val ? FString("YES") : FString("NO");
     }
@@ -177,6 +181,8 @@ public:
         uint32 Count = 0;
 
     virtual void ProcessCompact(const FString& compactString) {};
+    virtual void ProcessCompact(FUtf8StringView compactString) {};
+    virtual void ProcessBinary(uint32 count, uint32 value) {};
     bool CheckTriggerAndUpdate();
 private:
     uint32 InternalCount = 0;
@@ -195,6 +201,8 @@ public:
         float Magnitude = 0.0f;
 
     void ProcessCompact(const FString& compactString) override;
+    void ProcessCompact(FUtf8StringView compactString) override;
+    void ProcessBinary(uint32 count, uint32 value) override;
 
 };
 
@@ -209,6 +217,8 @@ public:
         uint32 Current = 0;
 
     void ProcessCompact(const FString& compactString) override;
+    void ProcessCompact(FUtf8StringView compactString) override;
+    void ProcessBinary(uint32 count, uint32 value) override;
 
 };
 
@@ -259,7 +269,11 @@ public:
 
 
     void ProcessJsonObject(const TSharedPtr < FJsonObject > eveBody);
+    /* the Events object of a verbose packet as raw JSON */
+    void ProcessVerboseJson(FUtf8StringView eveJson);
     void ProcessCompactBody(const FString& compactString);
+    void ProcessCompactBody(FUtf8StringView compactString);
+    void ProcessBinaryBody(const uint8* eventData);
 
 };
 
@@ -319,6 +333,8 @@ public:
 
     
     void ProcessJsonObject(const TSharedPtr < FJsonObject > scaBody);
+    /* the Scalars object of a verbose packet as raw JSON */
+    void ProcessVerboseJson(FUtf8StringView scaJson);
 
 };
 
@@ -345,6 +361,10 @@ public:
         TArray<float> FootIkL;
     UPROPERTY()
         TArray<float> FootIkR;
+
+    void ProcessJsonObject(const TSharedPtr < FJsonObject > vecBody);
+    /* the Vectors object of a verbose packet as raw JSON */
+    void ProcessVerboseJson(FUtf8StringView vecJson);
 };
 
 
@@ -360,6 +380,7 @@ public:
     UPROPERTY()
     FPoseAIVerboseBodyVectors Vectors;
     void ProcessJsonObject(const TSharedPtr < FJsonObject > jsonObj);
+    void ProcessVerboseBody(const FPoseAIVerbosePart& body);
 
 };
 
@@ -392,6 +413,8 @@ public:
     bool HasChanged() { return hasChanged; }
     void ProcessVerbose(FPoseAIScalarStruct& scalars);
     void ProcessCompact(const FString& visString);
+    void ProcessCompact(FUtf8StringView visString);
+    void ProcessBinary(uint8 visBits);
 
 private:
     bool hasChanged = false;
@@ -508,18 +531,23 @@ public:
     /** if at least one foot has been stationary for a few frames */
     UPROPERTY(BlueprintReadOnly, Category = "PoseAI")
     int32 stableFeet = 0;
-    
-    FVector rootOffset = FVector(0.0f, 0.0f, 0.0f);
-    FRotator cameraRotation = FRotator(0.0f, 0.0f, 0.0f);
-    FVector scaleMotion = FVector(1.0f, 0.0f, 1.0f);
 
     void ProcessVerboseBody(const FPoseAIVerbose& scalars);
     void ProcessVerboseVectorsHandLeft(const TSharedPtr < FJsonObject > vecHand);
     void ProcessVerboseVectorsHandRight(const TSharedPtr < FJsonObject > vecHand);
+    void ProcessVerboseVectorsHandLeft(FUtf8StringView vecJson);
+    void ProcessVerboseVectorsHandRight(FUtf8StringView vecJson);
     void ProcessCompactScalarsBody(const FString& compactString);
+    void ProcessCompactScalarsBody(FUtf8StringView compactString);
     void ProcessCompactVectorsBody(const FString& compactString);
+    void ProcessCompactVectorsBody(FUtf8StringView compactString);
     void ProcessCompactVectorsHandLeft(const TSharedPtr < FJsonObject >);
     void ProcessCompactVectorsHandRight(const TSharedPtr < FJsonObject >);
+    void ProcessCompactVectorsHandLeft(const FPoseAICompactHand& hand);
+    void ProcessCompactVectorsHandRight(const FPoseAICompactHand& hand);
+    void ProcessVectorsBody(TArrayView<const float> values);
+    void ProcessBinaryScalarsBody(const uint8* scalarData);
+    void ProcessBinaryVectorsHands(const uint8* handData);
 
 private:
     static const FString fieldPointScreen;
@@ -0,0 +1,62 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+
+/* a named joint rotation from the Rotations object of a verbose packet, in component space */
+struct FPoseAIVerboseRotation
+{
+	FUtf8StringView Name;
+	FQuat Rotation;
+};
+
+
+/* fields of a Body, LeftHand or RightHand object in a verbose packet.  Scalars, Events and Vectors are left as raw JSON for the structs they fill */
+struct POSEAILIVELINK_API FPoseAIVerbosePart
+{
+	bool bPresent = false;
+	bool bHasRotations = false;
+	TArray<FPoseAIVerboseRotation, TInlineAllocator<32>> Rotations;
+	FUtf8StringView Scalars;
+	FUtf8StringView Events;
+	FUtf8StringView Vectors;
+	bool bHasOpen = false;
+	float Open = 0.5f;
+};
+
+
+/**
+ * A verbose packet, the debugging format with named joints and fields, tokenized in a single pass over its UTF-8 bytes like FPoseAICompactFrame.
+ * Joint names and raw sections are views into the parsed bytes, so the frame is only valid while those bytes are alive.
+ * Compact packets, the hello message and anything with escaped strings are rejected and left to the FJsonObject path.
+ */
+class POSEAILIVELINK_API FPoseAIVerboseFrame
+{
+public:
+	/* returns true for a well formed packet without "PF":1.  Unrecognized keys are skipped */
+	bool Parse(const uint8* data, int32 len);
+
+	/* hash of the raw Events and Scalars of the packet, found without parsing it, as FPoseAICompactFrame::PeekEventSignature.  The scalars
+	   hold continuous values too, so the hash changes more often than the events, which only means more overwritten frames are scanned */
+	static bool PeekEventSignature(const uint8* data, int32 len, uint32& outSignature);
+
+	bool IsFrameData() const { return Body.bPresent || LeftHand.bPresent || RightHand.bPresent; }
+
+	/* case insensitive comparison of the Rig field against a rig name, matching FName equality */
+	bool IsRig(FName rigType) const;
+
+	double Timestamp = 0.0;
+	bool bHasModelLatency = false;
+	int32 ModelLatency = 0;
+	FUtf8StringView Rig;
+
+	FPoseAIVerbosePart Body;
+	FPoseAIVerbosePart LeftHand;
+	FPoseAIVerbosePart RightHand;
+
+	bool bHasFace = false;
+	TArray<float, TInlineAllocator<64>> Face;
+};
@@ -0,0 +1,365 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAICaptureBaker.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimData/IAnimationDataController.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "ObjectTools.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "PoseAICaptureFile.h"
+#include "PoseAIRig.h"
+#include "PoseAIBinaryPacket.h"
+#include "PoseAICompactFrame.h"
+#include "PoseAIVerboseFrame.h"
+#include "PoseAILiveLinkFaceSubSource.h"
+
+#include <atomic>
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+namespace {
+	// one sampled joint, in single precision as an hour of keys for every joint already runs to a couple of hundred megabytes
+	struct FBakeKey
+	{
+		FQuat4f Rotation = FQuat4f::Identity;
+		FVector3f Translation = FVector3f::ZeroVector;
+	};
+
+	struct FBakeFile
+	{
+		FString Path;
+		FPoseAIHandshake Handshake;
+		FLiveLinkSubjectName SubjectName;
+		TArray<FName> BoneNames;
+		// joints the rig outputs for the handshake: the body, then both hands if they were streamed
+		int32 NumTracks = 0;
+		// device time of the first frame, which is key 0
+		double StartTime = 0.0;
+		int32 NumKeys = 0;
+		// key major, so each chunk writes one contiguous range
+		TArray<FBakeKey> Keys;
+		TArray<float> Curves;
+		std::atomic<bool> bHasFace{ false };
+	};
+
+	struct FBakeChunk
+	{
+		FBakeFile* File = nullptr;
+		TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> Rig;
+		int64 FirstBlock = 0;
+		int32 FirstKey = 0;
+		int32 EndKey = 0;
+	};
+
+	/* the device time of the first frame at or after the reader's position */
+	bool NextFrameTime(FPoseAICaptureReader& reader, double& outTime) {
+		FPoseAICaptureRecord record;
+		while (reader.Next(record)) {
+			if (record.IsFrame()) {
+				outTime = record.Header.DeviceTimestamp;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* decodes a captured packet through the rig in the native source's order of formats.  False if the rig produced no pose */
+	bool DecodeFrame(PoseAIRig& rig, TArrayView<const uint8> bytes, FLiveLinkAnimationFrameData& data, TArray<float>& face, bool& bOutHasFace) {
+		data.Transforms.Reset();
+		bOutHasFace = false;
+		if (FPoseAIBinaryPacket::IsBinaryPacket(bytes.GetData(), bytes.Num())) {
+			FPoseAIBinaryPacket packet;
+			if (!packet.Parse(bytes.GetData(), bytes.Num()) || !packet.HasFrameData() || !rig.ProcessFrame(packet, data))
+				return false;
+			bOutHasFace = PoseAILiveLinkFaceSubSource::DecodeFace(packet, face);
+			return true;
+		}
+		FPoseAICompactFrame frame;
+		if (frame.Parse(bytes.GetData(), bytes.Num())) {
+			if (!rig.ProcessFrame(frame, data))
+				return false;
+			bOutHasFace = PoseAILiveLinkFaceSubSource::DecodeFace(frame, face);
+			return true;
+		}
+		FPoseAIVerboseFrame verboseFrame;
+		if (verboseFrame.Parse(bytes.GetData(), bytes.Num()) && verboseFrame.IsFrameData()) {
+			if (!rig.ProcessFrame(verboseFrame, data))
+				return false;
+			bOutHasFace = PoseAILiveLinkFaceSubSource::DecodeFace(verboseFrame, face);
+			return true;
+		}
+		TSharedPtr<FJsonObject> jsonObject;
+		TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(FString(bytes.Num(), reinterpret_cast<const UTF8CHAR*>(bytes.GetData())));
+		if (!FJsonSerializer::Deserialize(reader, jsonObject) || !rig.ProcessFrame(jsonObject, data))
+			return false;
+		bOutHasFace = PoseAILiveLinkFaceSubSource::DecodeFace(jsonObject, face);
+		return true;
+	}
+
+	/* worker: decodes a chunk's frames and writes its keys, each interpolated between the frames either side of it */
+	void BakeChunk(const FBakeChunk& chunk, int32 frameRate) {
+		FBakeFile& file = *chunk.File;
+		TUniquePtr<FPoseAICaptureReader> reader = FPoseAICaptureReader::Open(file.Path);
+		if (!reader.IsValid())
+			return;
+		// frames of the block before the chunk only warm the rig up, as their times are before the chunk's first key
+		reader->SeekToBlock(FMath::Max<int64>(chunk.FirstBlock - 1, 0));
+
+		const int32 numCurves = PoseAILiveLinkFaceSubSource::BlendShapeNames().Num();
+		FLiveLinkAnimationFrameData data;
+		TArray<float> face;
+		TArray<FTransform> previous;
+		TArray<FTransform> current;
+		TArray<float> previousFace;
+		TArray<float> currentFace;
+		previousFace.SetNumZeroed(numCurves);
+		currentFace.SetNumZeroed(numCurves);
+		double previousTime = 0.0;
+		bool bHasPrevious = false;
+		bool bChunkHasFace = false;
+
+		auto writeKey = [&file, numCurves](int32 key, const TArray<FTransform>& from, const TArray<float>& fromFace,
+			const TArray<FTransform>& to, const TArray<float>& toFace, double alpha) {
+			FBakeKey* keys = &file.Keys[key * file.NumTracks];
+			for (int32 track = 0; track < file.NumTracks; ++track) {
+				keys[track].Rotation = FQuat4f(FQuat::Slerp(from[track].GetRotation(), to[track].GetRotation(), alpha));
+				keys[track].Translation = FVector3f(FMath::Lerp(from[track].GetTranslation(), to[track].GetTranslation(), alpha));
+			}
+			float* curves = &file.Curves[key * numCurves];
+			for (int32 curve = 0; curve < numCurves; ++curve)
+				curves[curve] = FMath::Lerp(fromFace[curve], toFace[curve], (float)alpha);
+		};
+
+		int32 key = chunk.FirstKey;
+		FPoseAICaptureRecord record;
+		while (key < chunk.EndKey && reader->Next(record)) {
+			if (!record.IsFrame())
+				continue;
+			const double time = record.Header.DeviceTimestamp - file.StartTime;
+			// repeated timestamps would divide by zero, and the rig drops older ones anyway
+			if (bHasPrevious && time <= previousTime)
+				continue;
+			bool bFrameHasFace;
+			if (!DecodeFrame(*chunk.Rig, record.Payload, data, face, bFrameHasFace) || data.Transforms.Num() < file.NumTracks)
+				continue;
+
+			current.Reset();
+			current.Append(data.Transforms.GetData(), file.NumTracks);
+			if (bFrameHasFace) {
+				currentFace = face;
+				bChunkHasFace = true;
+			}
+			else {
+				// frames without a face hold the last one
+				currentFace = previousFace;
+			}
+
+			for (; key < chunk.EndKey && key <= time * frameRate; ++key) {
+				if (bHasPrevious)
+					writeKey(key, previous, previousFace, current, currentFace, ((double)key / frameRate - previousTime) / (time - previousTime));
+				else
+					writeKey(key, current, currentFace, current, currentFace, 0.0);
+			}
+			Swap(previous, current);
+			Swap(previousFace, currentFace);
+			previousTime = time;
+			bHasPrevious = true;
+		}
+		// keys after the last frame of the capture hold its pose
+		if (bHasPrevious) {
+			for (; key < chunk.EndKey; ++key)
+				writeKey(key, previous, previousFace, previous, previousFace, 0.0);
+		}
+		if (bChunkHasFace)
+			file.bHasFace = true;
+	}
+
+	/* game thread: maps a file, sizes its keys and splits it into chunks with a rig each.  False if it holds no frames */
+	bool PrepareFile(FBakeFile& file, int32 frameRate, int64 chunkBlocks, TArray<FBakeChunk>& outChunks) {
+		TUniquePtr<FPoseAICaptureReader> reader = FPoseAICaptureReader::Open(file.Path);
+		if (!reader.IsValid())
+			return false;
+		const FString handshakeJson = reader->FindHandshake();
+		if (handshakeJson.IsEmpty() || !file.Handshake.FromString(handshakeJson))
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %s has no handshake, baking with the default rig"), *file.Path);
+
+		// each chunk's keys start at the first frame of its first block
+		TArray<double> chunkStarts;
+		TArray<int64> chunkFirstBlocks;
+		for (int64 block = 0; block < reader->GetNumBlocks(); block += chunkBlocks) {
+			reader->SeekToBlock(block);
+			double time;
+			if (NextFrameTime(*reader, time) && (chunkStarts.Num() == 0 || time > chunkStarts.Last())) {
+				chunkStarts.Add(time);
+				chunkFirstBlocks.Add(block);
+			}
+		}
+		if (chunkStarts.Num() == 0) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %s holds no frames to bake"), *file.Path);
+			return false;
+		}
+		double endTime = chunkStarts[0];
+		for (int64 block = reader->GetNumBlocks() - 1; block >= 0 && endTime == chunkStarts[0]; --block) {
+			reader->SeekToBlock(block);
+			FPoseAICaptureRecord record;
+			while (reader->Next(record)) {
+				if (record.IsFrame())
+					endTime = FMath::Max(endTime, record.Header.DeviceTimestamp);
+			}
+		}
+
+		file.StartTime = chunkStarts[0];
+		file.NumKeys = FMath::FloorToInt((endTime - file.StartTime) * frameRate) + 1;
+		// detached, so the workers' rigs stay out of the registry and each chunk keeps stats of its own
+		file.SubjectName = FLiveLinkSubjectName(FName(*(TEXT("PoseAIBake-") + FPaths::GetBaseFilename(file.Path))));
+		TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::MakeDetachedRig(file.SubjectName, file.Handshake);
+		FLiveLinkStaticDataStruct staticData = rig->MakeStaticData();
+		file.BoneNames = staticData.Cast<FLiveLinkSkeletonStaticData>()->GetBoneNames();
+		file.NumTracks = FMath::Min(file.BoneNames.Num(), rig->NumBodyJoints() + (file.Handshake.IncludesHands() ? 2 * rig->NumHandJoints() : 0));
+		file.Keys.SetNum(file.NumKeys * file.NumTracks);
+		file.Curves.SetNumZeroed(file.NumKeys * PoseAILiveLinkFaceSubSource::BlendShapeNames().Num());
+
+		for (int32 i = 0; i < chunkStarts.Num(); ++i) {
+			FBakeChunk& chunk = outChunks.AddDefaulted_GetRef();
+			chunk.File = &file;
+			chunk.Rig = i == 0 ? rig : PoseAIRig::MakeDetachedRig(file.SubjectName, file.Handshake);
+			chunk.FirstBlock = chunkFirstBlocks[i];
+			chunk.FirstKey = i == 0 ? 0 : FMath::Min(FMath::CeilToInt((chunkStarts[i] - file.StartTime) * frameRate), file.NumKeys);
+			chunk.EndKey = i + 1 < chunkStarts.Num() ? FMath::Min(FMath::CeilToInt((chunkStarts[i + 1] - file.StartTime) * frameRate), file.NumKeys) : file.NumKeys;
+		}
+		return true;
+	}
+
+	/* game thread: writes the baked keys to a new sequence and saves its package */
+	bool SaveSequence(const FBakeFile& file, const FPoseAIBakeSettings& settings, int32 frameRate) {
+		const FString assetName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(file.Path));
+		const FString packageName = settings.OutputPath / assetName;
+		UPackage* package = CreatePackage(*packageName);
+		UAnimSequence* sequence = NewObject<UAnimSequence>(package, *assetName, RF_Public | RF_Standalone);
+		sequence->SetSkeleton(settings.Skeleton);
+		const FReferenceSkeleton& referenceSkeleton = settings.Skeleton->GetReferenceSkeleton();
+
+		IAnimationDataController& controller = sequence->GetController();
+		controller.OpenBracket(LOCTEXT("BakePoseAICapture", "Bake PoseAI capture"), false);
+#if UE_VERSION_OLDER_THAN(5, 2, 0)
+		controller.SetFrameRate(FFrameRate(frameRate, 1), false);
+		controller.SetPlayLength(FMath::Max(file.NumKeys - 1, 1) / (float)frameRate, false);
+#else
+		controller.InitializeModel();
+		controller.SetFrameRate(FFrameRate(frameRate, 1), false);
+		controller.SetNumberOfFrames(FFrameNumber(FMath::Max(file.NumKeys - 1, 1)), false);
+#endif
+
+		TArray<FVector3f> positions;
+		TArray<FQuat4f> rotations;
+		TArray<FVector3f> scales;
+		scales.Init(FVector3f::OneVector, file.NumKeys);
+		int32 skipped = 0;
+		for (int32 track = 0; track < file.NumTracks; ++track) {
+			const FName bone = file.BoneNames[track];
+			if (referenceSkeleton.FindBoneIndex(bone) == INDEX_NONE) {
+				++skipped;
+				continue;
+			}
+			positions.Reset(file.NumKeys);
+			rotations.Reset(file.NumKeys);
+			for (int32 key = 0; key < file.NumKeys; ++key) {
+				const FBakeKey& bakeKey = file.Keys[key * file.NumTracks + track];
+				positions.Add(bakeKey.Translation);
+				rotations.Add(bakeKey.Rotation);
+			}
+			controller.AddBoneCurve(bone, false);
+			controller.SetBoneTrackKeys(bone, positions, rotations, scales, false);
+		}
+		if (skipped > 0)
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %d of the %s rig's joints are not in %s and were not baked"),
+				skipped, *file.Handshake.GetRigString(), *settings.Skeleton->GetName());
+
+		if (file.bHasFace) {
+			const TArray<FName>& curveNames = PoseAILiveLinkFaceSubSource::BlendShapeNames();
+			TArray<FRichCurveKey> curveKeys;
+			for (int32 curve = 0; curve < curveNames.Num(); ++curve) {
+#if UE_VERSION_OLDER_THAN(5, 3, 0)
+				FSmartName smartName;
+				settings.Skeleton->AddSmartNameAndModify(USkeleton::AnimCurveMappingName, curveNames[curve], smartName);
+				const FAnimationCurveIdentifier curveId(smartName, ERawCurveTrackTypes::RCT_Float);
+#else
+				const FAnimationCurveIdentifier curveId(curveNames[curve], ERawCurveTrackTypes::RCT_Float);
+#endif
+				curveKeys.Reset(file.NumKeys);
+				for (int32 key = 0; key < file.NumKeys; ++key)
+					curveKeys.Add(FRichCurveKey((float)key / frameRate, file.Curves[key * curveNames.Num() + curve]));
+				controller.AddCurve(curveId, AACF_Editable, false);
+				controller.SetCurveKeys(curveId, curveKeys, false);
+			}
+		}
+		controller.NotifyPopulated();
+		controller.CloseBracket(false);
+
+		// the rig puts the player's motion on the root joint
+		sequence->bEnableRootMotion = true;
+		sequence->MarkPackageDirty();
+		FAssetRegistryModule::AssetCreated(sequence);
+
+		const FString fileName = FPackageName::LongPackageNameToFilename(packageName, FPackageName::GetAssetPackageExtension());
+		FSavePackageArgs saveArgs;
+		saveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		if (!UPackage::SavePackage(package, sequence, *fileName, saveArgs)) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to save %s"), *fileName);
+			return false;
+		}
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: baked %s into %s, %d keys at %d fps"), *file.Path, *packageName, file.NumKeys, frameRate);
+		return true;
+	}
+}
+
+
+int32 FPoseAICaptureBaker::Bake(const FPoseAIBakeSettings& settings) {
+	check(IsInGameThread());
+	if (settings.Skeleton == nullptr) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: baking needs the skeleton of the captured rig"));
+		return 0;
+	}
+	const int32 frameRate = FMath::Max(settings.FrameRate, 1);
+	const int64 chunkBlocks = FMath::Max(settings.ChunkBlocks, 1);
+	// created before the workers start, which may not create them concurrently
+	PoseAILiveLinkFaceSubSource::BlendShapeNames();
+
+	const double start = FPlatformTime::Seconds();
+	TArray<TUniquePtr<FBakeFile>> files;
+	TArray<FBakeChunk> chunks;
+	double capturedSeconds = 0.0;
+	for (const FString& path : settings.Files) {
+		TUniquePtr<FBakeFile> file = MakeUnique<FBakeFile>();
+		file->Path = path;
+		if (PrepareFile(*file, frameRate, chunkBlocks, chunks)) {
+			capturedSeconds += (double)(file->NumKeys - 1) / frameRate;
+			files.Add(MoveTemp(file));
+		}
+	}
+
+	ParallelFor(chunks.Num(), [&chunks, frameRate](int32 index) {
+		BakeChunk(chunks[index], frameRate);
+	});
+	const double decoded = FPlatformTime::Seconds();
+	chunks.Reset();
+
+	int32 saved = 0;
+	for (const TUniquePtr<FBakeFile>& file : files) {
+		if (SaveSequence(*file, settings, frameRate))
+			++saved;
+	}
+	const double elapsed = FPlatformTime::Seconds() - start;
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: baked %d of %d captures, %.1f seconds of motion in %.2f seconds (%.2f decoding), %.0fx real time"),
+		saved, settings.Files.Num(), capturedSeconds, elapsed, decoded - start, elapsed > 0.0 ? capturedSeconds / elapsed : 0.0);
+	return saved;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,178 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAICaptureReplay.h"
+#include "Async/Async.h"
+#include "Features/IModularFeatures.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+namespace {
+	// replays started from the console, kept until they are stopped or the next one starts after they finish
+	TArray<TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe>> consoleReplays;
+}
+
+
+TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe> FPoseAICaptureReplay::Start(const FString& path, double speed, bool bLoop, FName subjectName) {
+	TUniquePtr<FPoseAICaptureReader> reader = FPoseAICaptureReader::Open(path);
+	if (!reader.IsValid())
+		return nullptr;
+
+	FPoseAIHandshake handshake;
+	const FString handshakeJson = reader->FindHandshake();
+	if (handshakeJson.IsEmpty() || !handshake.FromString(handshakeJson))
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: %s has no handshake, replaying with the default rig"), *path);
+
+	if (subjectName.IsNone())
+		subjectName = FName(FPaths::GetBaseFilename(path));
+	TWeakPtr<PoseAILiveLinkNativeSource> source = PoseAILiveLinkNativeSource::AddSource(subjectName, handshake);
+	TSharedPtr<PoseAILiveLinkNativeSource> pinned = source.Pin();
+	if (!pinned.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to add a source to replay %s"), *path);
+		return nullptr;
+	}
+	// replayed packets are already on disk
+	pinned->DisableCapture();
+	pinned->AddSubject();
+
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: replaying %s (%.1f seconds captured %s) into %s at %s"),
+		*path, reader->GetDuration(), *reader->GetStartTime().ToString(), *subjectName.ToString(),
+		speed > 0.0 ? *FString::Printf(TEXT("%gx speed"), speed) : TEXT("full speed"));
+	return MakeShareable(new FPoseAICaptureReplay(MoveTemp(reader), source, subjectName, speed, bLoop));
+}
+
+void FPoseAICaptureReplay::StopAll() {
+	for (const TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe>& replay : consoleReplays)
+		replay->Stop();
+	consoleReplays.Reset();
+}
+
+FPoseAICaptureReplay::FPoseAICaptureReplay(TUniquePtr<FPoseAICaptureReader>&& reader, TWeakPtr<PoseAILiveLinkNativeSource> source, FName subjectName, double speed, bool bLoop) :
+	reader(MoveTemp(reader)), source(source), subjectName(subjectName), speed(FMath::Max(speed, 0.0)), bLoop(bLoop)
+{
+	wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	const FString threadName = TEXT("PoseAILiveLink_Replay_") + subjectName.ToString();
+	thread = FRunnableThread::Create(this, *threadName, 128 * 1024, TPri_AboveNormal);
+}
+
+FPoseAICaptureReplay::~FPoseAICaptureReplay() {
+	Stop();
+	if (thread != nullptr) {
+		thread->Kill(true);
+		delete thread;
+		thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+	wakeEvent = nullptr;
+}
+
+uint32 FPoseAICaptureReplay::Run() {
+	const double start = FPlatformTime::Seconds();
+	while (ReplayPass() && bLoop) {}
+	const double elapsed = FPlatformTime::Seconds() - start;
+	const uint64 frames = GetFramesReplayed();
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: replayed %llu frames into %s in %.2f seconds, %.1f frames/sec"),
+		frames, *subjectName.ToString(), elapsed, elapsed > 0.0 ? frames / elapsed : 0.0);
+	running = false;
+	return 0;
+}
+
+void FPoseAICaptureReplay::Stop() {
+	running = false;
+	wakeEvent->Trigger();
+	RemoveSource();
+}
+
+void FPoseAICaptureReplay::RemoveSource() {
+	if (sourceRemoved.exchange(true))
+		return;
+	TWeakPtr<PoseAILiveLinkNativeSource> weakSource = source;
+	auto removeSource = [weakSource]() {
+		FGuid sourceGuid;
+		{
+			// LiveLink owns the only lasting pointer to the source, so it is released before the source is removed
+			TSharedPtr<PoseAILiveLinkNativeSource> pinned = weakSource.Pin();
+			if (!pinned.IsValid())
+				return;
+			sourceGuid = pinned->GetSourceGuid();
+		}
+		if (sourceGuid.IsValid() && IModularFeatures::Get().IsModularFeatureAvailable(ILiveLinkClient::ModularFeatureName))
+			IModularFeatures::Get().GetModularFeature<ILiveLinkClient>(ILiveLinkClient::ModularFeatureName).RemoveSource(sourceGuid);
+	};
+	if (IsInGameThread())
+		removeSource();
+	else
+		AsyncTask(ENamedThreads::GameThread, MoveTemp(removeSource));
+}
+
+bool FPoseAICaptureReplay::ReplayPass() {
+	reader->Rewind();
+	{
+		TSharedPtr<PoseAILiveLinkNativeSource> pinned = source.Pin();
+		if (!pinned.IsValid())
+			return false;
+		if (pinned->rig.IsValid())
+			pinned->rig->ResetTimestamp();
+	}
+
+	const double passStart = FPlatformTime::Seconds();
+	double firstArrival = -1.0;
+	FPoseAICaptureRecord record;
+	while (running && reader->Next(record)) {
+		if (!record.IsFrame())
+			continue;
+
+		if (speed > 0.0) {
+			if (firstArrival < 0.0)
+				firstArrival = record.Header.Arrival;
+			const double due = passStart + (record.Header.Arrival - firstArrival) / speed;
+			for (double wait = due - FPlatformTime::Seconds(); running && wait > 0.0; wait = due - FPlatformTime::Seconds()) {
+				// sleeps through most of the wait and yields through the last millisecond, which a sleep would overshoot
+				if (wait > 0.002)
+					wakeEvent->Wait(FTimespan::FromSeconds(wait - 0.001));
+				else
+					FPlatformProcess::YieldThread();
+			}
+		}
+
+		TSharedPtr<PoseAILiveLinkNativeSource> pinned = source.Pin();
+		if (!pinned.IsValid())
+			return false;
+		pinned->ReceivePacket(record.Payload);
+		framesReplayed.fetch_add(1, std::memory_order_relaxed);
+	}
+	return running;
+}
+
+
+static void ReplayCapture(const TArray<FString>& Args) {
+	if (Args.Num() == 0) {
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: usage PoseAI.ReplayCapture <file> [speed, 0 for full speed] [loop] [subject]"));
+		return;
+	}
+	FString path = Args[0];
+	if (FPaths::IsRelative(path) && !FPaths::FileExists(path))
+		path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("PoseAI"), TEXT("Captures"), path);
+	const double speed = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 1.0;
+	const bool bLoop = Args.Num() > 2 && Args[2].ToBool();
+	const FName subjectName = Args.Num() > 3 ? FName(*Args[3]) : NAME_None;
+
+	consoleReplays.RemoveAll([](const TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe>& replay) { return !replay->IsRunning(); });
+	TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe> replay = FPoseAICaptureReplay::Start(path, speed, bLoop, subjectName);
+	if (replay.IsValid())
+		consoleReplays.Add(replay);
+}
+
+static FAutoConsoleCommand ReplayCaptureCommand(
+	TEXT("PoseAI.ReplayCapture"),
+	TEXT("Replays a .paicap capture into a new source.  Arguments: file (relative paths also looked up in Saved/PoseAI/Captures), speed (default 1, 0 for as fast as possible), loop (default 0), subject name (default the file name)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ReplayCapture));
+
+static FAutoConsoleCommand ReplayStopCommand(
+	TEXT("PoseAI.ReplayStop"),
+	TEXT("Stops the replays started by PoseAI.ReplayCapture"),
+	FConsoleCommandDelegate::CreateStatic(&FPoseAICaptureReplay::StopAll));
+
+#undef LOCTEXT_NAMESPACE
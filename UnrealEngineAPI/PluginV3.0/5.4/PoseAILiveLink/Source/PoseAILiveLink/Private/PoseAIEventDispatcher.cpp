@@ -2,6 +2,7 @@
 
 #include "PoseAIEventDispatcher.h"
 #include "PoseAILiveLinkNetworkSource.h"
+#include "PoseAIRetargetAsset.h"
 
 #define LOCTEXT_NAMESPACE "PoseAI"
 
@@ -147,55 +148,74 @@ void UPoseAIMovementComponent::SetHandshake(const FPoseAIHandshake& handshake) {
     UPoseAIEventDispatcher::GetDispatcher()->SetHandshake(handshake);
 }
 
+// the settings below are published to the rig as a whole config block, as its worker reads them while processing frames
 void UPoseAIMovementComponent::ScaleMotion(float RigHeight, FVector Scale) {
-    TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::GetRigFromSubjectName(subjectName);
-    if (rig == nullptr)
-        return;
-    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = rig.Pin()) {
-        lockedRig->rigHeight = RigHeight;
-        lockedRig->liveValues.scaleMotion = Scale;
+    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = PoseAIRig::GetRigFromSubjectName(subjectName).Pin()) {
+        FPoseAIMotionConfig config = lockedRig->GetMotionConfig();
+        config.rigHeight = RigHeight;
+        config.scaleMotion = Scale;
+        lockedRig->SetMotionConfig(config);
     }
 }
 
 void UPoseAIMovementComponent::SetLiveCameraRotation(float pitch, float yaw, float roll){
-    TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::GetRigFromSubjectName(subjectName);
-    if (rig == nullptr)
-        return;
-    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = rig.Pin()) {
+    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = PoseAIRig::GetRigFromSubjectName(subjectName).Pin()) {
+        FPoseAIMotionConfig config = lockedRig->GetMotionConfig();
         // order changed due to rotated root bone in UE
-        lockedRig->liveValues.cameraRotation = FRotator(roll, yaw, pitch);
+        config.cameraRotation = FRotator(roll, yaw, pitch);
+        lockedRig->SetMotionConfig(config);
     }
 }
 
 
 void UPoseAIMovementComponent::UseCurrentPoseToOrientCamera() {
-    TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::GetRigFromSubjectName(subjectName);
-    if (rig==nullptr)
-        return;
-    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = rig.Pin()) {
-        float pitch = -lockedRig->liveValues.upperBodyLean.Y;
-        float yaw = -lockedRig->liveValues.chestYaw;
-        lockedRig->liveValues.cameraRotation = FRotator(0.0f, yaw, pitch);
+    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = PoseAIRig::GetRigFromSubjectName(subjectName).Pin()) {
+        const FPoseAILiveValues values = lockedRig->GetLatestLiveValues();
+        FPoseAIMotionConfig config = lockedRig->GetMotionConfig();
+        float pitch = -values.upperBodyLean.Y;
+        float yaw = -values.chestYaw;
+        config.cameraRotation = FRotator(0.0f, yaw, pitch);
+        lockedRig->SetMotionConfig(config);
     }
 }
 void UPoseAIMovementComponent::UseCurrentPoseAsBaseTranslation() {
-    TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::GetRigFromSubjectName(subjectName);
-    if (rig == nullptr)
-        return;
-    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = rig.Pin()) {
-        lockedRig->liveValues.rootOffset = lockedRig->liveValues.rootTranslation;
+    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = PoseAIRig::GetRigFromSubjectName(subjectName).Pin()) {
+        FPoseAIMotionConfig config = lockedRig->GetMotionConfig();
+        config.rootOffset = lockedRig->GetLatestLiveValues().rootTranslation;
+        lockedRig->SetMotionConfig(config);
     }
 }
 
 void UPoseAIMovementComponent::ZeroMotion() {
-    TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::GetRigFromSubjectName(subjectName);
-    if (rig == nullptr)
-        return;
-    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = rig.Pin()) {
-        lockedRig->liveValues.scaleMotion = FVector3d::Zero();
+    if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = PoseAIRig::GetRigFromSubjectName(subjectName).Pin()) {
+        FPoseAIMotionConfig config = lockedRig->GetMotionConfig();
+        config.scaleMotion = FVector3d::Zero();
+        lockedRig->SetMotionConfig(config);
     }
 }
 
+void UPoseAIMovementComponent::SetRetargetAsset(UPoseAIRetargetAsset* RetargetAsset) {
+    if (RetargetAsset)
+        PoseAIRig::SetRemapping(subjectName, RetargetAsset->MakeRemappings(), RetargetAsset->SourceRig);
+    else
+        PoseAIRig::SetRemapping(subjectName, TMap<FName, Remapping>());
+}
+
+void UPoseAIMovementComponent::AddDerivedSubject(FLiveLinkSubjectName DerivedSubjectName, UPoseAIRetargetAsset* RetargetAsset) {
+    if (RetargetAsset)
+        PoseAIRig::SetDerivedSubject(subjectName, DerivedSubjectName, RetargetAsset->MakeRemappings(), RetargetAsset->SourceRig);
+    else
+        PoseAIRig::SetDerivedSubject(subjectName, DerivedSubjectName, TMap<FName, Remapping>());
+}
+
+void UPoseAIMovementComponent::RemoveDerivedSubject(FLiveLinkSubjectName DerivedSubjectName) {
+    PoseAIRig::RemoveDerivedSubject(subjectName, DerivedSubjectName);
+}
+
+bool UPoseAIMovementComponent::GetLatestLiveValues(FPoseAILiveValues& values) {
+    return PoseAIRig::GetLatestLiveValues(subjectName, values);
+}
+
 bool UPoseAIEventDispatcher::AddSourceNextOpenPort(const FPoseAIHandshake& handshake, bool isIPv6, int32& portNum, FString& myIP, FLiveLinkSubjectName& subject) {
     portNum = PoseAILiveLinkNetworkSource::portDefault;
     while (!PoseAILiveLinkNetworkSource::IsValidPort(portNum)) {
@@ -294,167 +314,223 @@ void UPoseAIEventDispatcher::SetHandshake(const FPoseAIHandshake& handshake) {
     handshakeUpdate.Broadcast(handshake);
 }
 
-void UPoseAIEventDispatcher::BroadcastFrameReceived(const FLiveLinkSubjectName& subjectName) {
-    FDateTime& nameRef = knownConnectionsWithTime.FindOrAdd(subjectName);
-    nameRef = FDateTime::Now();
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) component->lastFrameReceived = FDateTime::Now();
-     });
+int32 FPoseAIEventRecord::Coalesce(const FPoseAIEventRecord& newer) {
+    int32 dropped = 0;
+    for (const FPoseAIEvent& event : newer.Events) {
+        if (Events.Num() >= MAX_EVENTS) {
+            Events.RemoveAt(0);
+            ++dropped;
+        }
+        Events.Add(event);
+    }
+    bHasLiveValues |= newer.bHasLiveValues;
+    if (newer.bHasVisibility) {
+        VisibilityFlags = newer.VisibilityFlags;
+        bHasVisibility = true;
+    }
+    bFrameReceived |= newer.bFrameReceived;
+    return dropped;
 }
 
-void UPoseAIEventDispatcher::BroadcastVisibilityChange(const FLiveLinkSubjectName& subjectName, FPoseAIVisibilityFlags visibilityFlags){
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, visibilityFlags]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->onVisibilityChange.Broadcast(visibilityFlags);
-            component->visibilityFlags = visibilityFlags;
-        }
-     });
+
+void UPoseAIEventDispatcher::QueueEvents(const FLiveLinkSubjectName& subjectName, const FPoseAIEventRecord& record) {
+    if (record.IsEmpty())
+        return;
+    FScopeLock lock(&pendingLock);
+    FPoseAIEventRecord& pending = pendingEvents.FindOrAdd(subjectName);
+    ++eventQueueStats.Queued;
+    if (!pending.IsEmpty())
+        ++eventQueueStats.Coalesced;
+    const int32 dropped = pending.Coalesce(record);
+    if (dropped > 0) {
+        if (eventQueueStats.EventsDropped == 0)
+            UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: game thread fell behind, dropping the oldest pending events for %s"), *subjectName.ToString());
+        eventQueueStats.EventsDropped += dropped;
+    }
 }
 
-void UPoseAIEventDispatcher::BroadcastLiveValues(const FLiveLinkSubjectName& subjectName, FPoseAILiveValues values){
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, values]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->onLiveValues.Broadcast(values);
+void UPoseAIEventDispatcher::QueueEvent(const FLiveLinkSubjectName& subjectName, EPoseAIEventType type, float value, int32 intValue, bool flag) {
+    FPoseAIEventRecord record;
+    record.AddEvent(type, value, intValue, flag);
+    QueueEvents(subjectName, record);
+}
+
+void UPoseAIEventDispatcher::DrainPendingEvents() {
+    check(IsInGameThread());
+    UPoseAIEventDispatcher* dispatcher = theInstance;
+    if (dispatcher == nullptr)
+        return;
+    {
+        FScopeLock lock(&dispatcher->pendingLock);
+        Swap(dispatcher->pendingEvents, dispatcher->drainingEvents);
+        ++dispatcher->eventQueueStats.Drains;
+    }
+    for (TPair<FLiveLinkSubjectName, FPoseAIEventRecord>& pending : dispatcher->drainingEvents) {
+        if (pending.Value.IsEmpty())
+            continue;
+        dispatcher->DispatchRecord(pending.Key, pending.Value);
+        pending.Value.Reset();
+    }
+}
+
+FPoseAIEventQueueStats UPoseAIEventDispatcher::GetEventQueueStats() const {
+    FScopeLock lock(&pendingLock);
+    return eventQueueStats;
+}
+
+void UPoseAIEventDispatcher::DispatchRecord(const FLiveLinkSubjectName& subjectName, const FPoseAIEventRecord& record) {
+    if (record.bFrameReceived)
+        knownConnectionsWithTime.FindOrAdd(subjectName) = FDateTime::Now();
+
+    UPoseAIMovementComponent* component;
+    if (!HasComponent(subjectName, component))
+        return;
+    if (record.bFrameReceived)
+        component->lastFrameReceived = FDateTime::Now();
+    if (record.bHasVisibility) {
+        component->onVisibilityChange.Broadcast(record.VisibilityFlags);
+        component->visibilityFlags = record.VisibilityFlags;
+    }
+    for (const FPoseAIEvent& event : record.Events) {
+        // a handler may deregister or destroy the component
+        if (!IsValid(component))
+            return;
+        DispatchEvent(component, event);
+    }
+    if (record.bHasLiveValues && IsValid(component)) {
+        FPoseAILiveValues values;
+        if (PoseAIRig::GetLatestLiveValues(subjectName, values)) {
             component->SetLiveValues(values);
+            component->onLiveValues.Broadcast(component->mostRecentValues);
         }
-    });
+    }
 }
 
-void UPoseAIEventDispatcher::BroadcastFootsteps(const FLiveLinkSubjectName& subjectName, float stepHeight, bool isLeftStep) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, stepHeight, isLeftStep]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->footsteps->RegisterStep(stepHeight);
-            component->onFootstep.Broadcast(stepHeight, isLeftStep);
+void UPoseAIEventDispatcher::DispatchEvent(UPoseAIMovementComponent* component, const FPoseAIEvent& event) {
+    switch (event.Type) {
+    case EPoseAIEventType::Footstep:
+        component->footsteps->RegisterStep(event.Value);
+        component->onFootstep.Broadcast(event.Value, event.bFlag);
+        break;
+    case EPoseAIEventType::Feetsplit:
+        component->feetsplits->RegisterStep(event.Value);
+        component->onFeetsplit.Broadcast(event.Value, event.bFlag);
+        break;
+    case EPoseAIEventType::Armpump:
+        component->armpumps->RegisterStep(event.Value);
+        component->onArmpump.Broadcast(event.Value);
+        break;
+    case EPoseAIEventType::Armflex:
+        component->armflexes->RegisterStep(event.Value);
+        component->onArmflex.Broadcast(event.Value, event.bFlag);
+        break;
+    case EPoseAIEventType::Armjack:
+        component->armjacks->RegisterStep(0.5f);
+        component->onArmjack.Broadcast(event.bFlag);
+        break;
+    case EPoseAIEventType::ArmGestureL:
+        component->onArmGestureLeft.Broadcast(event.IntValue);
+        if (event.IntValue == 10) {
+            component->armflapL->RegisterStep(1.0f);
+            component->onArmflapL.Broadcast();
         }
-    });
+        break;
+    case EPoseAIEventType::ArmGestureR:
+        component->onArmGestureRight.Broadcast(event.IntValue);
+        if (event.IntValue == 10) {
+            component->armflapR->RegisterStep(1.0f);
+            component->onArmflapR.Broadcast();
+        }
+        break;
+    case EPoseAIEventType::SidestepL:
+        ((event.bFlag) ? component->leftsteps : component->rightsteps)->RegisterStep(1.0f);
+        component->onSidestepLeftFoot.Broadcast(event.bFlag);
+        break;
+    case EPoseAIEventType::SidestepR:
+        ((event.bFlag) ? component->leftsteps : component->rightsteps)->RegisterStep(1.0f);
+        component->onSidestepRightFoot.Broadcast(event.bFlag);
+        break;
+    case EPoseAIEventType::Jump:
+        component->onJump.Broadcast();
+        component->jumps->RegisterStep(1.0f);
+        break;
+    case EPoseAIEventType::Crouch:
+        component->onCrouch.Broadcast(event.bFlag);
+        break;
+    case EPoseAIEventType::HandToZoneL:
+        component->onHandToZoneL.Broadcast(event.IntValue);
+        break;
+    case EPoseAIEventType::HandToZoneR:
+        component->onHandToZoneR.Broadcast(event.IntValue);
+        break;
+    case EPoseAIEventType::Stationary:
+        component->onStationary.Broadcast();
+        break;
+    }
 }
+
+
+void UPoseAIEventDispatcher::BroadcastVisibilityChange(const FLiveLinkSubjectName& subjectName, FPoseAIVisibilityFlags visibilityFlags){
+    FPoseAIEventRecord record;
+    record.bHasVisibility = true;
+    record.VisibilityFlags = visibilityFlags;
+    QueueEvents(subjectName, record);
+}
+
+void UPoseAIEventDispatcher::BroadcastFootsteps(const FLiveLinkSubjectName& subjectName, float stepHeight, bool isLeftStep) {
+    QueueEvent(subjectName, EPoseAIEventType::Footstep, stepHeight, 0, isLeftStep);
+}
+
 void UPoseAIEventDispatcher::BroadcastFeetsplits(const FLiveLinkSubjectName& subjectName, float width, bool isExpanding) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, width, isExpanding]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->feetsplits->RegisterStep(width);
-            component->onFeetsplit.Broadcast(width, isExpanding);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Feetsplit, width, 0, isExpanding);
 }
+
 void UPoseAIEventDispatcher::BroadcastArmpumps(const FLiveLinkSubjectName& subjectName, float stepHeight) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, stepHeight]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->armpumps->RegisterStep(stepHeight);
-            component->onArmpump.Broadcast(stepHeight);
-        }
-    });
+    QueueEvent(subjectName, EPoseAIEventType::Armpump, stepHeight);
 }
 
 void UPoseAIEventDispatcher::BroadcastArmflexes(const FLiveLinkSubjectName& subjectName, float width, bool isExpanding) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, width, isExpanding]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->armflexes->RegisterStep(width);
-            component->onArmflex.Broadcast(width, isExpanding);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Armflex, width, 0, isExpanding);
 }
 
 void UPoseAIEventDispatcher::BroadcastArmjacks(const FLiveLinkSubjectName& subjectName, bool isRising) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, isRising]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->armjacks->RegisterStep(0.5f);
-            component->onArmjack.Broadcast(isRising);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Armjack, 0.0f, 0, isRising);
 }
 
-
 void UPoseAIEventDispatcher::BroadcastSidestepL(const FLiveLinkSubjectName& subjectName, bool isLeftStep) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, isLeftStep]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            ((isLeftStep) ? component->leftsteps : component->rightsteps)->RegisterStep(1.0f);
-            component->onSidestepLeftFoot.Broadcast(isLeftStep);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::SidestepL, 0.0f, 0, isLeftStep);
 }
 
 void UPoseAIEventDispatcher::BroadcastSidestepR(const FLiveLinkSubjectName& subjectName, bool isLeftStep) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, isLeftStep]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            ((isLeftStep) ? component->leftsteps : component->rightsteps)->RegisterStep(1.0f);
-            component->onSidestepRightFoot.Broadcast(isLeftStep);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::SidestepR, 0.0f, 0, isLeftStep);
 }
 
 void UPoseAIEventDispatcher::BroadcastJumps(const FLiveLinkSubjectName& subjectName) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->onJump.Broadcast();
-            component->jumps->RegisterStep(1.0f);
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Jump);
 }
 
 void UPoseAIEventDispatcher::BroadcastCrouches(const FLiveLinkSubjectName& subjectName, bool isCrouching) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, isCrouching]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) component->onCrouch.Broadcast(isCrouching);
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Crouch, 0.0f, 0, isCrouching);
 }
 
 void UPoseAIEventDispatcher::BroadcastArmGestureL(const FLiveLinkSubjectName& subjectName, int32 gesture) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, gesture]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->onArmGestureLeft.Broadcast(gesture);
-            if (gesture == 10) {
-                component->armflapL->RegisterStep(1.0f);
-                component->onArmflapL.Broadcast();
-            }
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::ArmGestureL, 0.0f, gesture);
 }
 
 void UPoseAIEventDispatcher::BroadcastArmGestureR(const FLiveLinkSubjectName& subjectName, int32 gesture) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, gesture]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) {
-            component->onArmGestureRight.Broadcast(gesture);
-            if (gesture == 10) {
-                component->armflapR->RegisterStep(1.0f);
-                component->onArmflapR.Broadcast();
-            }
-        }
-        });
+    QueueEvent(subjectName, EPoseAIEventType::ArmGestureR, 0.0f, gesture);
 }
 
 void UPoseAIEventDispatcher::BroadcastHandToZoneL(const FLiveLinkSubjectName& subjectName, int32 zone) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, zone]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) component->onHandToZoneL.Broadcast(zone);
-        });
+    QueueEvent(subjectName, EPoseAIEventType::HandToZoneL, 0.0f, zone);
 }
 
-
 void UPoseAIEventDispatcher::BroadcastHandToZoneR(const FLiveLinkSubjectName& subjectName, int32 zone) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName, zone]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) component->onHandToZoneR.Broadcast(zone);
-        });
+    QueueEvent(subjectName, EPoseAIEventType::HandToZoneR, 0.0f, zone);
 }
 
 void UPoseAIEventDispatcher::BroadcastStationary(const FLiveLinkSubjectName& subjectName) {
-    AsyncTask(ENamedThreads::GameThread, [this, subjectName]() {
-        UPoseAIMovementComponent* component;
-        if (HasComponent(subjectName, component)) component->onStationary.Broadcast();
-        });
+    QueueEvent(subjectName, EPoseAIEventType::Stationary);
 }
 
 
@@ -33,8 +33,10 @@ TWeakPtr<PoseAILiveLinkNativeSource> PoseAILiveLinkNativeSource::AddSource(FName
  * governs how the source will appear in the LiveLink UI and how to connect in the LiveLinkPose node in the animation blueprint
  */
 PoseAILiveLinkNativeSource::PoseAILiveLinkNativeSource(FName subjectName, const FPoseAIHandshake& handshake) :
-	subjectName(subjectName), handshake(handshake), status(LOCTEXT("statusConnecting", "connecting"))
+	subjectName(subjectName), handshake(handshake), status(LOCTEXT("statusConnecting", "connecting")),
+	pipelineStats(&FPoseAIPipelineStats::ForSource(subjectName)), captureTap(MakeUnique<FPoseAICaptureTap>(subjectName))
 {
+	captureTap->SetHandshake(handshake.ToString());
 	UPoseAIEventDispatcher* dispatcher;
 	dispatcher = UPoseAIEventDispatcher::GetDispatcher();
 }
@@ -48,6 +50,7 @@ void PoseAILiveLinkNativeSource::ReceiveClient(ILiveLinkClient* InClient, FGuid
 	status = FText::FormatOrdered(LOCTEXT("statusLocalConnected", "Connected to {0}"), FText::FromName(subjectName));
 	sourceGuid = InSourceGuid;
 	subjectKey = FLiveLinkSubjectKey(sourceGuid, subjectName);
+	publisher = MakeUnique<FPoseAISubjectPublisher>(subjectKey, InClient, *pipelineStats);
 	liveLinkClient = InClient;
 
 	faceSubSource = TUniquePtr<PoseAILiveLinkFaceSubSource>(new PoseAILiveLinkFaceSubSource(subjectKey, liveLinkClient));
@@ -69,26 +72,8 @@ bool PoseAILiveLinkNativeSource::AddSubject(){
 	rig = PoseAIRig::PoseAIRigFactory(subjectName, handshake);
 	
 	if (rig.IsValid() && liveLinkClient && IsInGameThread()) {
-		liveLinkClient->RemoveSubject_AnyThread(subjectKey);
-		FLiveLinkSubjectPreset subject;
-		subject.bEnabled = true;
-		subject.Key = subjectKey;
-		subject.Role = TSubclassOf<ULiveLinkRole>(ULiveLinkAnimationRole::StaticClass());
-		subject.Settings = nullptr;
-		subject.VirtualSubject = nullptr;
 		UPoseAIEventDispatcher::GetDispatcher()->BroadcastSubjectConnected(subjectKey.SubjectName);
-		FScopeLock ScopeLock(&InSynchObject);
-
-		if (!liveLinkClient->CreateSubject(subject)) {
-			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: unable to create subject %s"), *(subjectKey.SubjectName.Name.ToString()));
-			return false;
-		}
-		else {
-			UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: created subject %s"), *(subjectKey.SubjectName.Name.ToString()));
-			FLiveLinkStaticDataStruct rigDefinition = rig->MakeStaticData();
-			liveLinkClient->PushSubjectStaticData_AnyThread(subject.Key, ULiveLinkAnimationRole::StaticClass(), MoveTemp(rigDefinition));
-			return true;
-		}
+		return publisher->CreateSubject(*rig, InSynchObject);
 	}
 	else {
 		return false;
@@ -115,6 +100,7 @@ bool PoseAILiveLinkNativeSource::RequestSourceShutdown()
 	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: PoseAILiveLinkLocalSource request source shutdown"));
 	if (liveLinkClient) {
 		faceSubSource->RequestSubSourceShutdown();
+		publisher->RemoveDerivedSubjects();
 		liveLinkClient->RemoveSubject_AnyThread(subjectKey);
 		liveLinkClient->RemoveSource(sourceGuid);
 		liveLinkClient = nullptr;
@@ -125,8 +111,33 @@ bool PoseAILiveLinkNativeSource::RequestSourceShutdown()
 }
 
 void PoseAILiveLinkNativeSource::ReceivePacket(const FString& recvMessage) {
+	BeginTrace();
+	pipelineStats->Count(EPoseAIPipelineCounter::Packets);
+	pipelineStats->Count(EPoseAIPipelineCounter::Bytes, recvMessage.Len());
+	if (captureTap.IsValid() && captureTap->IsActive()) {
+		FTCHARToUTF8 utf8(*recvMessage, recvMessage.Len());
+		captureTap->Capture(TArrayView<const uint8>(reinterpret_cast<const uint8*>(utf8.Get()), utf8.Length()), latencyTrace.Received);
+	}
+	ReceiveText(recvMessage);
+}
+
+void PoseAILiveLinkNativeSource::ReceiveText(const FString& recvMessage) {
 	static const FGuid GUID_Error = FGuid();
 
+	FTCHARToUTF8 utf8(*recvMessage, recvMessage.Len());
+	FPoseAICompactFrame frame;
+	if (frame.Parse(reinterpret_cast<const uint8*>(utf8.Get()), utf8.Length())) {
+		MarkParsed();
+		UpdatePose(frame);
+		return;
+	}
+	FPoseAIVerboseFrame verboseFrame;
+	if (verboseFrame.Parse(reinterpret_cast<const uint8*>(utf8.Get()), utf8.Length()) && verboseFrame.IsFrameData()) {
+		MarkParsed();
+		UpdatePose(verboseFrame);
+		return;
+	}
+
 	TSharedPtr<FJsonObject> jsonObject = MakeShareable(new FJsonObject);
 	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(recvMessage);
 
@@ -134,29 +145,103 @@ void PoseAILiveLinkNativeSource::ReceivePacket(const FString& recvMessage) {
 		static const FName NAME_JsonError = "PoseAILiveLink_JsonError";
 		FLiveLinkSubjectKey failKey = FLiveLinkSubjectKey(GUID_Error, FName("PoseAINativeSource"));
 		FLiveLinkLog::WarningOnce(NAME_JsonError, failKey, TEXT("PoseAI: failed to deserialize json object from local posecam, %s"), *Reader->GetErrorMessage());
+		pipelineStats->Count(EPoseAIPipelineCounter::Malformed);
 		return;
 	}
+	MarkParsed();
 	UpdatePose(jsonObject);
 }
 
+void PoseAILiveLinkNativeSource::ReceivePacket(TArrayView<const uint8> recvBytes) {
+	BeginTrace();
+	pipelineStats->Count(EPoseAIPipelineCounter::Packets);
+	pipelineStats->Count(EPoseAIPipelineCounter::Bytes, recvBytes.Num());
+	if (captureTap.IsValid())
+		captureTap->Capture(recvBytes, latencyTrace.Received);
+	if (FPoseAIBinaryPacket::IsBinaryPacket(recvBytes.GetData(), recvBytes.Num())) {
+		FPoseAIBinaryPacket packet;
+		if (!packet.Parse(recvBytes.GetData(), recvBytes.Num())) {
+			pipelineStats->Count(EPoseAIPipelineCounter::Malformed);
+		}
+		else if (packet.HasFrameData()) {
+			MarkParsed();
+			UpdatePose(packet);
+		}
+		return;
+	}
+
+	FPoseAICompactFrame frame;
+	if (frame.Parse(recvBytes.GetData(), recvBytes.Num())) {
+		MarkParsed();
+		UpdatePose(frame);
+		return;
+	}
+	FPoseAIVerboseFrame verboseFrame;
+	if (verboseFrame.Parse(recvBytes.GetData(), recvBytes.Num()) && verboseFrame.IsFrameData()) {
+		MarkParsed();
+		UpdatePose(verboseFrame);
+		return;
+	}
+	ReceiveText(FString(recvBytes.Num(), reinterpret_cast<const UTF8CHAR*>(recvBytes.GetData())));
+}
+
+
+void PoseAILiveLinkNativeSource::Update()
+{
+	if (liveLinkClient && rig.IsValid())
+		publisher->Update(*rig, InSynchObject);
+}
 
 void PoseAILiveLinkNativeSource::UpdatePose(TSharedPtr<FJsonObject> jsonPose)
 {
 
 	if (liveLinkClient && rig && rig.IsValid()) {
 
-		FLiveLinkFrameDataStruct frameData(FLiveLinkAnimationFrameData::StaticStruct());
-		FLiveLinkAnimationFrameData& data = *frameData.Cast<FLiveLinkAnimationFrameData>();
-		data.Transforms.Reserve(100);
+		FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
 
 		if (rig->ProcessFrame(jsonPose, data)) {
-			liveLinkClient->PushSubjectFrameData_AnyThread(subjectKey, MoveTemp(frameData));
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastFrameReceived(subjectKey.SubjectName);
+			publisher->PushFrame(*rig, data, latencyTrace);
 			faceSubSource->UpdateFace(jsonPose);
 		}
 	}
 }
 
+void PoseAILiveLinkNativeSource::UpdatePose(const FPoseAICompactFrame& frame)
+{
+	if (liveLinkClient && rig && rig.IsValid()) {
+		FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+
+		if (rig->ProcessFrame(frame, data)) {
+			publisher->PushFrame(*rig, data, latencyTrace);
+			faceSubSource->UpdateFace(frame);
+		}
+	}
+}
+
+void PoseAILiveLinkNativeSource::UpdatePose(const FPoseAIVerboseFrame& frame)
+{
+	if (liveLinkClient && rig && rig.IsValid()) {
+		FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+
+		if (rig->ProcessFrame(frame, data)) {
+			publisher->PushFrame(*rig, data, latencyTrace);
+			faceSubSource->UpdateFace(frame);
+		}
+	}
+}
+
+void PoseAILiveLinkNativeSource::UpdatePose(const FPoseAIBinaryPacket& packet)
+{
+	if (liveLinkClient && rig && rig.IsValid()) {
+		FLiveLinkAnimationFrameData& data = publisher->BeginFrame();
+
+		if (rig->ProcessFrame(packet, data)) {
+			publisher->PushFrame(*rig, data, latencyTrace);
+			faceSubSource->UpdateFace(packet);
+		}
+	}
+}
+
 FText  PoseAILiveLinkNativeSource::GetSourceType() const {
 	return LOCTEXT("SourceType", "PoseAI mobile");
 }
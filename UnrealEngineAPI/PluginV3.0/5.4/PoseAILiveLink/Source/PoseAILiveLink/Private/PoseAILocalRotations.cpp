@@ -0,0 +1,259 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAILocalRotations.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+#if defined(PLATFORM_ALWAYS_HAS_AVX) && PLATFORM_ALWAYS_HAS_AVX
+	#define POSEAI_LOCALROT_AVX 1
+#else
+	#define POSEAI_LOCALROT_AVX 0
+#endif
+
+#if !POSEAI_LOCALROT_AVX && PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS
+	#define POSEAI_LOCALROT_SSE2 1
+#else
+	#define POSEAI_LOCALROT_SSE2 0
+#endif
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON && PLATFORM_64BITS
+	#define POSEAI_LOCALROT_NEON 1
+	#include <arm_neon.h>
+#else
+	#define POSEAI_LOCALROT_NEON 0
+#endif
+
+#if POSEAI_LOCALROT_AVX || POSEAI_LOCALROT_SSE2
+	#include <immintrin.h>
+#endif
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+static constexpr int32 LocalRotationBatch = 4;
+// FQuat::Normalize's tolerance, below which a rotation becomes identity
+static constexpr double LocalRotationTolerance = 1.e-8;
+
+/* one batch of joints in structure of arrays layout: parent and child component rotations in, local rotations and squared lengths out */
+struct alignas(32) FLocalRotationLanes
+{
+	double PX[LocalRotationBatch], PY[LocalRotationBatch], PZ[LocalRotationBatch], PW[LocalRotationBatch];
+	double CX[LocalRotationBatch], CY[LocalRotationBatch], CZ[LocalRotationBatch], CW[LocalRotationBatch];
+	double X[LocalRotationBatch], Y[LocalRotationBatch], Z[LocalRotationBatch], W[LocalRotationBatch];
+	double SizeSquared[LocalRotationBatch];
+};
+
+/* the handful of operations the kernel needs, for each register width */
+struct FLocalRotationScalarOps
+{
+	typedef double V;
+	static constexpr int32 Width = 1;
+	static FORCEINLINE V Load(const double* p) { return *p; }
+	static FORCEINLINE void Store(double* p, V v) { *p = v; }
+	static FORCEINLINE V Add(V a, V b) { return a + b; }
+	static FORCEINLINE V Sub(V a, V b) { return a - b; }
+	static FORCEINLINE V Mul(V a, V b) { return a * b; }
+	static FORCEINLINE V InvSqrt(V a) { return 1.0 / FMath::Sqrt(a); }
+	/* +1 or -1 with the sign of a */
+	static FORCEINLINE V SignOf(V a) { return (a < 0.0) ? -1.0 : 1.0; }
+};
+
+#if POSEAI_LOCALROT_AVX
+struct FLocalRotationAVXOps
+{
+	typedef __m256d V;
+	static constexpr int32 Width = 4;
+	static FORCEINLINE V Load(const double* p) { return _mm256_load_pd(p); }
+	static FORCEINLINE void Store(double* p, V v) { _mm256_store_pd(p, v); }
+	static FORCEINLINE V Add(V a, V b) { return _mm256_add_pd(a, b); }
+	static FORCEINLINE V Sub(V a, V b) { return _mm256_sub_pd(a, b); }
+	static FORCEINLINE V Mul(V a, V b) { return _mm256_mul_pd(a, b); }
+	static FORCEINLINE V InvSqrt(V a) { return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+	static FORCEINLINE V SignOf(V a) { return _mm256_or_pd(_mm256_and_pd(a, _mm256_set1_pd(-0.0)), _mm256_set1_pd(1.0)); }
+};
+typedef FLocalRotationAVXOps FLocalRotationOps;
+#elif POSEAI_LOCALROT_SSE2
+struct FLocalRotationSSE2Ops
+{
+	typedef __m128d V;
+	static constexpr int32 Width = 2;
+	static FORCEINLINE V Load(const double* p) { return _mm_load_pd(p); }
+	static FORCEINLINE void Store(double* p, V v) { _mm_store_pd(p, v); }
+	static FORCEINLINE V Add(V a, V b) { return _mm_add_pd(a, b); }
+	static FORCEINLINE V Sub(V a, V b) { return _mm_sub_pd(a, b); }
+	static FORCEINLINE V Mul(V a, V b) { return _mm_mul_pd(a, b); }
+	static FORCEINLINE V InvSqrt(V a) { return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a)); }
+	static FORCEINLINE V SignOf(V a) { return _mm_or_pd(_mm_and_pd(a, _mm_set1_pd(-0.0)), _mm_set1_pd(1.0)); }
+};
+typedef FLocalRotationSSE2Ops FLocalRotationOps;
+#elif POSEAI_LOCALROT_NEON
+struct FLocalRotationNEONOps
+{
+	typedef float64x2_t V;
+	static constexpr int32 Width = 2;
+	static FORCEINLINE V Load(const double* p) { return vld1q_f64(p); }
+	static FORCEINLINE void Store(double* p, V v) { vst1q_f64(p, v); }
+	static FORCEINLINE V Add(V a, V b) { return vaddq_f64(a, b); }
+	static FORCEINLINE V Sub(V a, V b) { return vsubq_f64(a, b); }
+	static FORCEINLINE V Mul(V a, V b) { return vmulq_f64(a, b); }
+	static FORCEINLINE V InvSqrt(V a) { return vdivq_f64(vdupq_n_f64(1.0), vsqrtq_f64(a)); }
+	static FORCEINLINE V SignOf(V a) {
+		const uint64x2_t sign = vandq_u64(vreinterpretq_u64_f64(a), vdupq_n_u64(0x8000000000000000ull));
+		return vreinterpretq_f64_u64(vorrq_u64(sign, vreinterpretq_u64_f64(vdupq_n_f64(1.0))));
+	}
+};
+typedef FLocalRotationNEONOps FLocalRotationOps;
+#else
+typedef FLocalRotationScalarOps FLocalRotationOps;
+#endif
+
+
+/* conjugate(parent) * child for every lane, scaled to unit length with w >= 0 */
+template <typename Ops>
+static FORCEINLINE void SolveLocalRotationLanes(FLocalRotationLanes& lanes) {
+	typedef typename Ops::V V;
+	for (int32 l = 0; l < LocalRotationBatch; l += Ops::Width) {
+		const V px = Ops::Load(lanes.PX + l), py = Ops::Load(lanes.PY + l), pz = Ops::Load(lanes.PZ + l), pw = Ops::Load(lanes.PW + l);
+		const V cx = Ops::Load(lanes.CX + l), cy = Ops::Load(lanes.CY + l), cz = Ops::Load(lanes.CZ + l), cw = Ops::Load(lanes.CW + l);
+
+		const V x = Ops::Add(Ops::Sub(Ops::Sub(Ops::Mul(pw, cx), Ops::Mul(px, cw)), Ops::Mul(py, cz)), Ops::Mul(pz, cy));
+		const V y = Ops::Sub(Ops::Sub(Ops::Add(Ops::Mul(pw, cy), Ops::Mul(px, cz)), Ops::Mul(py, cw)), Ops::Mul(pz, cx));
+		const V z = Ops::Sub(Ops::Add(Ops::Sub(Ops::Mul(pw, cz), Ops::Mul(px, cy)), Ops::Mul(py, cx)), Ops::Mul(pz, cw));
+		const V w = Ops::Add(Ops::Add(Ops::Add(Ops::Mul(pw, cw), Ops::Mul(px, cx)), Ops::Mul(py, cy)), Ops::Mul(pz, cz));
+
+		const V sizeSquared = Ops::Add(Ops::Add(Ops::Mul(x, x), Ops::Mul(y, y)), Ops::Add(Ops::Mul(z, z), Ops::Mul(w, w)));
+		const V scale = Ops::Mul(Ops::InvSqrt(sizeSquared), Ops::SignOf(w));
+		Ops::Store(lanes.X + l, Ops::Mul(x, scale));
+		Ops::Store(lanes.Y + l, Ops::Mul(y, scale));
+		Ops::Store(lanes.Z + l, Ops::Mul(z, scale));
+		Ops::Store(lanes.W + l, Ops::Mul(w, scale));
+		Ops::Store(lanes.SizeSquared + l, sizeSquared);
+	}
+}
+
+template <typename Ops>
+static void AppendLocalTransforms(const FQuat* componentRotations, const FQuat* rotations, const int32* parentIndices, const FVector* translations,
+	int32 begin, int32 end, TArray<FTransform>& outTransforms) {
+	if (end <= begin)
+		return;
+	FTransform* out = outTransforms.GetData() + outTransforms.AddUninitialized(end - begin);
+
+	FLocalRotationLanes lanes;
+	for (int32 first = begin; first < end; first += LocalRotationBatch) {
+		const int32 count = FMath::Min(LocalRotationBatch, end - first);
+		for (int32 l = 0; l < LocalRotationBatch; ++l) {
+			// unused lanes of the last batch repeat its last joint, so they stay finite
+			const int32 joint = first + FMath::Min(l, count - 1);
+			const int32 parentIdx = parentIndices[joint];
+			const FQuat& parent = (parentIdx < 0) ? FQuat::Identity : componentRotations[parentIdx];
+			const FQuat& child = rotations[joint - begin];
+			lanes.PX[l] = parent.X; lanes.PY[l] = parent.Y; lanes.PZ[l] = parent.Z; lanes.PW[l] = parent.W;
+			lanes.CX[l] = child.X; lanes.CY[l] = child.Y; lanes.CZ[l] = child.Z; lanes.CW[l] = child.W;
+		}
+		SolveLocalRotationLanes<Ops>(lanes);
+		for (int32 l = 0; l < count; ++l) {
+			const FQuat rotation = (lanes.SizeSquared[l] >= LocalRotationTolerance) ? FQuat(lanes.X[l], lanes.Y[l], lanes.Z[l], lanes.W[l]) : FQuat::Identity;
+			new (out++) FTransform(rotation, translations[first + l], FVector::OneVector);
+		}
+	}
+}
+
+void PoseAIAppendLocalTransforms(const FQuat* componentRotations, const FQuat* rotations, const int32* parentIndices, const FVector* translations,
+	int32 begin, int32 end, TArray<FTransform>& outTransforms) {
+	AppendLocalTransforms<FLocalRotationOps>(componentRotations, rotations, parentIndices, translations, begin, end, outTransforms);
+}
+
+const TCHAR* PoseAILocalRotationsPath() {
+#if POSEAI_LOCALROT_AVX
+	return TEXT("AVX");
+#elif POSEAI_LOCALROT_SSE2
+	return TEXT("SSE2");
+#elif POSEAI_LOCALROT_NEON
+	return TEXT("NEON");
+#else
+	return TEXT("scalar");
+#endif
+}
+
+
+/*
+ * Console check and microbenchmark for the kernel:  PoseAI.LocalRotationBenchmark [iterations]
+ * Compares random hierarchies against the original per joint FQuat path (parent.Inverse() * rotation, then Normalize), allowing for the
+ * hemisphere flip, then times both on a MetaHuman sized skeleton with hands.
+ */
+static void RunLocalRotationBenchmark(const TArray<FString>& Args) {
+	const int32 iterations = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+	const int32 numJoints = 68;
+
+	FRandomStream random(1234);
+	TArray<FQuat> rotations;
+	TArray<int32> parents;
+	TArray<FVector> translations;
+	for (int32 i = 0; i < numJoints; ++i) {
+		FQuat rotation(random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f));
+		rotation.Normalize();
+		rotations.Add(rotation);
+		parents.Add(i == 0 ? -1 : random.RandRange(0, i - 1));
+		translations.Add(random.GetUnitVector() * 10.0);
+	}
+
+	auto appendReference = [&](TArray<FTransform>& out) {
+		for (int32 i = 0; i < numJoints; ++i) {
+			const FQuat parentQuat = (parents[i] < 0) ? FQuat::Identity : rotations[parents[i]];
+			FQuat finalRotation = parentQuat.Inverse() * rotations[i];
+			finalRotation.Normalize();
+			out.Add(FTransform(finalRotation, translations[i], FVector::OneVector));
+		}
+	};
+
+	TArray<FTransform> expected;
+	TArray<FTransform> actual;
+	int32 mismatches = 0;
+	double maxError = 0.0;
+	for (int32 trial = 0; trial < 100; ++trial) {
+		expected.Reset();
+		actual.Reset();
+		appendReference(expected);
+		// split the range as the rigs do, body then hands
+		const int32 split = random.RandRange(1, numJoints - 1);
+		PoseAIAppendLocalTransforms(rotations.GetData(), rotations.GetData(), parents.GetData(), translations.GetData(), 0, split, actual);
+		PoseAIAppendLocalTransforms(rotations.GetData(), rotations.GetData() + split, parents.GetData(), translations.GetData(), split, numJoints, actual);
+		for (int32 i = 0; i < numJoints; ++i) {
+			const FQuat a = expected[i].GetRotation();
+			const FQuat b = actual[i].GetRotation();
+			const double error = FMath::Min((a - b).SizeSquared(), (a + b).SizeSquared());
+			maxError = FMath::Max(maxError, error);
+			mismatches += (error > 1.0e-12 || b.W < 0.0 || !expected[i].GetTranslation().Equals(actual[i].GetTranslation(), 0.0)) ? 1 : 0;
+		}
+		rotations[random.RandRange(0, numJoints - 1)] = FQuat(random.GetUnitVector(), random.FRandRange(-PI, PI));
+	}
+	UE_LOG(LogTemp, Display, TEXT("PoseAI: local rotation kernel (%s) verification, %d mismatches, max squared error %g"), PoseAILocalRotationsPath(), mismatches, maxError);
+
+	double checksum = 0.0;
+	double startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; ++i) {
+		expected.Reset();
+		appendReference(expected);
+		checksum += expected[i % numJoints].GetRotation().X;
+	}
+	const double referenceSeconds = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; ++i) {
+		actual.Reset();
+		PoseAIAppendLocalTransforms(rotations.GetData(), rotations.GetData(), parents.GetData(), translations.GetData(), 0, numJoints, actual);
+		checksum += actual[i % numJoints].GetRotation().X;
+	}
+	const double kernelSeconds = FPlatformTime::Seconds() - startTime;
+
+	UE_LOG(LogTemp, Display, TEXT("PoseAI: local rotation benchmark, %d iterations of %d joints.  Original %.1f ns/frame, %s %.1f ns/frame (checksum %f)"),
+		iterations, numJoints, referenceSeconds * 1.0e9 / iterations, PoseAILocalRotationsPath(), kernelSeconds * 1.0e9 / iterations, checksum);
+}
+
+static FAutoConsoleCommand LocalRotationBenchmarkCommand(
+	TEXT("PoseAI.LocalRotationBenchmark"),
+	TEXT("Verifies the batched local rotation kernel against the per joint FQuat path and times both.  Optional argument: iterations"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunLocalRotationBenchmark));
+
+#undef LOCTEXT_NAMESPACE
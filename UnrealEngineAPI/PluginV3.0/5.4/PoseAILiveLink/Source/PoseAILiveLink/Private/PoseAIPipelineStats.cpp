@@ -0,0 +1,131 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIPipelineStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+UE_TRACE_CHANNEL_DEFINE(PoseAIChannel);
+
+namespace {
+	FCriticalSection statsLock;
+	TMap<FName, TUniquePtr<FPoseAIPipelineStats>> statsBySource;
+}
+
+
+FPoseAIPipelineStats& FPoseAIPipelineStats::ForSource(FName source) {
+	FScopeLock scopeLock(&statsLock);
+	TUniquePtr<FPoseAIPipelineStats>& stats = statsBySource.FindOrAdd(source);
+	if (!stats.IsValid())
+		stats = TUniquePtr<FPoseAIPipelineStats>(new FPoseAIPipelineStats(source));
+	return *stats;
+}
+
+TUniquePtr<FPoseAIPipelineStats> FPoseAIPipelineStats::MakeDetached(FName source) {
+	return TUniquePtr<FPoseAIPipelineStats>(new FPoseAIPipelineStats(source));
+}
+
+const TCHAR* FPoseAIPipelineStats::TimerName(EPoseAIPipelineTimer timer) {
+	switch (timer) {
+	case EPoseAIPipelineTimer::Parse: return TEXT("Parse");
+	case EPoseAIPipelineTimer::Rig: return TEXT("Rig");
+	case EPoseAIPipelineTimer::Face: return TEXT("Face");
+	case EPoseAIPipelineTimer::Push: return TEXT("Push");
+	default: return TEXT("Unknown");
+	}
+}
+
+const TCHAR* FPoseAIPipelineStats::CounterName(EPoseAIPipelineCounter counter) {
+	switch (counter) {
+	case EPoseAIPipelineCounter::Packets: return TEXT("Packets");
+	case EPoseAIPipelineCounter::Bytes: return TEXT("Bytes");
+	case EPoseAIPipelineCounter::Stale: return TEXT("Stale");
+	case EPoseAIPipelineCounter::RigMismatch: return TEXT("Rig mismatch");
+	case EPoseAIPipelineCounter::Malformed: return TEXT("Malformed");
+	default: return TEXT("Unknown");
+	}
+}
+
+void FPoseAIPipelineStats::PublishAll() {
+	const double now = FPlatformTime::Seconds();
+	FScopeLock scopeLock(&statsLock);
+	for (TPair<FName, TUniquePtr<FPoseAIPipelineStats>>& stats : statsBySource)
+		stats.Value->Publish(now);
+}
+
+void FPoseAIPipelineStats::LogAll() {
+	FScopeLock scopeLock(&statsLock);
+	if (statsBySource.Num() == 0) {
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: no sources have received packets"));
+		return;
+	}
+	for (const TPair<FName, TUniquePtr<FPoseAIPipelineStats>>& stats : statsBySource)
+		stats.Value->Log();
+}
+
+void FPoseAIPipelineStats::Publish(double now) {
+	if (windowStart == 0.0)
+		windowStart = now;
+
+	const double elapsed = now - windowStart;
+	if (elapsed >= 1.0) {
+		const uint64 packets = GetCount(EPoseAIPipelineCounter::Packets);
+		const uint64 bytes = GetCount(EPoseAIPipelineCounter::Bytes);
+		packetsPerSecond = (packets - windowCounters[(int32)EPoseAIPipelineCounter::Packets]) / elapsed;
+		bytesPerSecond = (bytes - windowCounters[(int32)EPoseAIPipelineCounter::Bytes]) / elapsed;
+		for (int32 i = 0; i < (int32)EPoseAIPipelineCounter::Num; ++i)
+			windowCounters[i] = counters[i].load(std::memory_order_relaxed);
+
+		for (int32 i = 0; i < (int32)EPoseAIPipelineTimer::Num; ++i) {
+			const uint64 cycles = timerCycles[i].load(std::memory_order_relaxed);
+			const uint64 calls = timerCalls[i].load(std::memory_order_relaxed);
+			const uint64 windowCallCount = calls - windowCalls[i];
+			averageMicros[i] = windowCallCount > 0 ? 1.0e6 * FPlatformTime::ToSeconds64(cycles - windowCycles[i]) / windowCallCount : 0.0;
+			windowCycles[i] = cycles;
+			windowCalls[i] = calls;
+		}
+		windowStart = now;
+	}
+
+#if STATS
+	// non accumulator stats clear every frame, so the last window's values are set again each frame
+	if (!bStatsCreated) {
+		const FString prefix = source.ToString();
+		rateStats[0] = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_PoseAI>(prefix + TEXT(" packets/sec"));
+		rateStats[1] = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_PoseAI>(prefix + TEXT(" bytes/sec"));
+		for (int32 i = 0; i < (int32)EPoseAIPipelineTimer::Num; ++i)
+			timerStats[i] = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_PoseAI>(
+				FString::Printf(TEXT("%s %s us/frame"), *prefix, TimerName((EPoseAIPipelineTimer)i)));
+		for (int32 i = 0; i < (int32)EPoseAIPipelineCounter::Num; ++i)
+			counterStats[i] = FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_PoseAI>(
+				FString::Printf(TEXT("%s %s total"), *prefix, CounterName((EPoseAIPipelineCounter)i)));
+		bStatsCreated = true;
+	}
+	SET_FLOAT_STAT_FName(rateStats[0].GetName(), packetsPerSecond);
+	SET_FLOAT_STAT_FName(rateStats[1].GetName(), bytesPerSecond);
+	for (int32 i = 0; i < (int32)EPoseAIPipelineTimer::Num; ++i)
+		SET_FLOAT_STAT_FName(timerStats[i].GetName(), averageMicros[i]);
+	for (int32 i = 0; i < (int32)EPoseAIPipelineCounter::Num; ++i)
+		SET_DWORD_STAT_FName(counterStats[i].GetName(), counters[i].load(std::memory_order_relaxed));
+#endif
+}
+
+void FPoseAIPipelineStats::Log() const {
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: %s %.1f packets/sec, %.0f bytes/sec, parse %.1f us, rig %.1f us, face %.1f us, push %.1f us"),
+		*source.ToString(), packetsPerSecond, bytesPerSecond,
+		averageMicros[(int32)EPoseAIPipelineTimer::Parse], averageMicros[(int32)EPoseAIPipelineTimer::Rig],
+		averageMicros[(int32)EPoseAIPipelineTimer::Face], averageMicros[(int32)EPoseAIPipelineTimer::Push]);
+	UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: %s %llu packets (%llu bytes), %llu stale, %llu rig mismatches, %llu malformed"),
+		*source.ToString(), GetCount(EPoseAIPipelineCounter::Packets), GetCount(EPoseAIPipelineCounter::Bytes),
+		GetCount(EPoseAIPipelineCounter::Stale), GetCount(EPoseAIPipelineCounter::RigMismatch), GetCount(EPoseAIPipelineCounter::Malformed));
+}
+
+
+static FAutoConsoleCommand StatsCommand(
+	TEXT("PoseAI.Stats"),
+	TEXT("Logs packet and byte rates, average stage times over the last second and the stale, rig mismatch and malformed packet counts of each source"),
+	FConsoleCommandDelegate::CreateStatic(&FPoseAIPipelineStats::LogAll));
+
+#undef LOCTEXT_NAMESPACE
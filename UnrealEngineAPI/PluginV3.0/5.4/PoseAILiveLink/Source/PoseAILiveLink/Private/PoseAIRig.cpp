@@ -2,6 +2,11 @@
 
 #include "PoseAIRig.h"
 #include "PoseAIEventDispatcher.h"
+#include "PoseAIStreamListener.h"
+#include "PoseAIFixed12Decoder.h"
+#include "PoseAILocalRotations.h"
+#include "PoseAIQuantizedRole.h"
+#include "HAL/IConsoleManager.h"
 
 #define LOCTEXT_NAMESPACE "PoseAI"
 
@@ -15,6 +20,26 @@ const FString PoseAIRig::fieldScalars = FString(TEXT("Scalars"));
 const FString PoseAIRig::fieldEvents = FString(TEXT("Events"));
 const FString PoseAIRig::fieldVectors = FString(TEXT("Vectors"));
 TMap<FLiveLinkSubjectName, TWeakPtr<PoseAIRig, ESPMode::ThreadSafe>> PoseAIRig::RigMap = {};
+TMap<FLiveLinkSubjectName, PoseAIRig::FSubjectRemapping> PoseAIRig::RemappingMap = {};
+TMap<FLiveLinkSubjectName, TMap<FLiveLinkSubjectName, PoseAIRig::FSubjectRemapping>> PoseAIRig::DerivedSubjectMap = {};
+int32 PoseAIRig::DerivedSubjectsGeneration = 0;
+
+namespace {
+	// identifies remap tables, so direct pose nodes can tell which joint names a published pose goes with
+	int32 remapGenerations = 0;
+
+	/* converts local transforms in the rig's convention to the table's target, keeping the root's translation for root motion */
+	void ApplyRemapTable(const FPoseAIRemapTable& remap, TArray<FTransform>& transforms) {
+		const int32 numJoints = FMath::Min(transforms.Num(), remap.Joints.Num());
+		for (int32 i = 0; i < numJoints; ++i) {
+			FQuat rotation = remap.ParentRotAdjInverse[i] * transforms[i].GetRotation() * remap.Joints[i].RotAdj;
+			rotation.Normalize();
+			transforms[i].SetRotation(rotation);
+			if (i > 0)
+				transforms[i].SetTranslation(remap.Joints[i].BindTranslation);
+		}
+	}
+}
 
 bool isDifferentAndSet(int32 newValue, int32& storedValue) {
 	bool isDifferent = newValue != storedValue;
@@ -26,14 +51,14 @@ bool isDifferentAndSet(int32 newValue, int32& storedValue) {
 PoseAIRig::PoseAIRig(FLiveLinkSubjectName name, const FPoseAIHandshake& handshake) :
 	name(name),
 	rigType(FName(handshake.GetRigString())),
+	rigPreset(handshake.rig),
 	includeHands(handshake.IncludesHands()),
 	isMirrored(handshake.isMirrored),
 	isLowerBodyRotated(handshake.isLowerBodyRotated),
 	isDesktop(handshake.mode == EPoseAiAppModes::Desktop) {
-	Configure();
 }
 
-TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::PoseAIRigFactory(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake) {
+TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::MakeRig(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake) {
 	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rigPtr;
 	switch (handshake.rig) {
 		case EPoseAiRigPresets::MetaHuman:
@@ -55,38 +80,253 @@ TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::PoseAIRigFactory(const FLi
 	}
 	
 	rigPtr->Configure();
+	rigPtr->ReserveScratch();
+	return rigPtr;
+}
+
+TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::PoseAIRigFactory(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake) {
+	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rigPtr = MakeRig(name, handshake);
+	rigPtr->pipelineStats = &FPoseAIPipelineStats::ForSource(name.Name);
+	// no worker processes the rig yet, so the remapping is applied directly
+	const FSubjectRemapping* remapping = RemappingMap.Find(name);
+	if (remapping && rigPtr->AcceptsRemapping(*remapping, name)) {
+		rigPtr->activeRemap = rigPtr->MakeRemapTable(remapping->Joints);
+		rigPtr->gameRemap = rigPtr->activeRemap;
+	}
 	RigMap.Add(name, rigPtr);
 	return rigPtr;
 }
 
+TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::MakeDetachedRig(const FLiveLinkSubjectName& name, const FPoseAIHandshake& handshake) {
+	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rigPtr = MakeRig(name, handshake);
+	rigPtr->isDetached = true;
+	rigPtr->detachedStats = FPoseAIPipelineStats::MakeDetached(name.Name);
+	rigPtr->pipelineStats = rigPtr->detachedStats.Get();
+	return rigPtr;
+}
+
 TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> PoseAIRig::GetRigFromSubjectName(const FLiveLinkSubjectName& name) {
 	return RigMap.Contains(name)? RigMap[name] : nullptr;
 }
 
+bool PoseAIRig::MatchesSourceRig(const FSubjectRemapping& remapping) const {
+	return remapping.Joints.Num() == 0 || !remapping.SourceRig.IsSet() || remapping.SourceRig.GetValue() == rigPreset;
+}
+
+bool PoseAIRig::AcceptsRemapping(const FSubjectRemapping& remapping, const FLiveLinkSubjectName& subject) const {
+	if (MatchesSourceRig(remapping))
+		return true;
+	// joints are matched by name, so an asset for another rig would leave most joints unmapped and rotate the rest wrongly
+	const UEnum* rigEnum = StaticEnum<EPoseAiRigPresets>();
+	UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: not retargeting %s, its asset is for the %s rig but the subject streams the %s rig"),
+		*subject.Name.ToString(), *rigEnum->GetNameStringByValue((int64)remapping.SourceRig.GetValue()), *rigEnum->GetNameStringByValue((int64)rigPreset));
+	return false;
+}
+
+void PoseAIRig::SetRemapping(const FLiveLinkSubjectName& name, const TMap<FName, Remapping>& remappings, TOptional<EPoseAiRigPresets> sourceRig) {
+	check(IsInGameThread());
+	FSubjectRemapping remapping{ remappings, sourceRig };
+	TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = GetRigFromSubjectName(name).Pin();
+	if (lockedRig && !lockedRig->AcceptsRemapping(remapping, name))
+		return;
+	if (remappings.Num() > 0)
+		RemappingMap.Add(name, MoveTemp(remapping));
+	else
+		RemappingMap.Remove(name);
+
+	if (lockedRig) {
+		lockedRig->gameRemap = lockedRig->MakeRemapTable(remappings);
+		{
+			FScopeLock lock(&lockedRig->pendingRemapLock);
+			lockedRig->pendingRemap = lockedRig->gameRemap;
+		}
+		lockedRig->remapPending.store(true, std::memory_order_release);
+	}
+}
+
+void PoseAIRig::SetDerivedSubject(const FLiveLinkSubjectName& name, const FLiveLinkSubjectName& derivedName, const TMap<FName, Remapping>& remappings,
+	TOptional<EPoseAiRigPresets> sourceRig) {
+	check(IsInGameThread());
+	FSubjectRemapping remapping{ remappings, sourceRig };
+	if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = GetRigFromSubjectName(name).Pin()) {
+		if (!lockedRig->AcceptsRemapping(remapping, derivedName))
+			return;
+	}
+	DerivedSubjectMap.FindOrAdd(name).Add(derivedName, MoveTemp(remapping));
+	++DerivedSubjectsGeneration;
+}
+
+void PoseAIRig::RemoveDerivedSubject(const FLiveLinkSubjectName& name, const FLiveLinkSubjectName& derivedName) {
+	check(IsInGameThread());
+	if (TMap<FLiveLinkSubjectName, FSubjectRemapping>* derived = DerivedSubjectMap.Find(name)) {
+		derived->Remove(derivedName);
+		if (derived->Num() == 0)
+			DerivedSubjectMap.Remove(name);
+		++DerivedSubjectsGeneration;
+	}
+}
+
+TArray<FLiveLinkSubjectName> PoseAIRig::GetDerivedSubjectNames() const {
+	TArray<FLiveLinkSubjectName> names;
+	// derived subjects set for another rig before this one was created are not published, ApplyDerivedSubjects warns of them
+	if (const TMap<FLiveLinkSubjectName, FSubjectRemapping>* derived = DerivedSubjectMap.Find(name)) {
+		for (const TPair<FLiveLinkSubjectName, FSubjectRemapping>& elem : *derived) {
+			if (MatchesSourceRig(elem.Value))
+				names.Add(elem.Key);
+		}
+	}
+	return names;
+}
+
+void PoseAIRig::ApplyDerivedSubjects() {
+	check(IsInGameThread());
+	TSharedPtr<TArray<FPoseAIDerivedSubject>, ESPMode::ThreadSafe> derivedSubjects;
+	if (const TMap<FLiveLinkSubjectName, FSubjectRemapping>* derived = DerivedSubjectMap.Find(name)) {
+		derivedSubjects = MakeShared<TArray<FPoseAIDerivedSubject>, ESPMode::ThreadSafe>();
+		derivedSubjects->Reserve(derived->Num());
+		for (const TPair<FLiveLinkSubjectName, FSubjectRemapping>& elem : *derived) {
+			if (AcceptsRemapping(elem.Value, elem.Key))
+				derivedSubjects->Add({ elem.Key, MakeRemapTable(elem.Value.Joints) });
+		}
+	}
+	{
+		FScopeLock lock(&pendingRemapLock);
+		pendingDerived = derivedSubjects;
+	}
+	derivedPending.store(true, std::memory_order_release);
+}
+
+TSharedPtr<const FPoseAIRemapTable, ESPMode::ThreadSafe> PoseAIRig::MakeRemapTable(const TMap<FName, Remapping>& remappings) const {
+	if (remappings.Num() == 0)
+		return nullptr;
+	TSharedPtr<FPoseAIRemapTable, ESPMode::ThreadSafe> table = MakeShared<FPoseAIRemapTable, ESPMode::ThreadSafe>();
+	table->Generation = ++remapGenerations;
+	const int32 numJoints = jointNames.Num();
+	table->Joints.Reserve(numJoints);
+	table->ParentRotAdjInverse.Reserve(numJoints);
+	table->TargetNames.Reserve(numJoints);
+	for (int32 i = 0; i < numJoints; ++i) {
+		const Remapping* remapping = remappings.Find(jointNames[i]);
+		table->Joints.Add(remapping ? *remapping : Remapping(jointNames[i], FQuat::Identity, boneTranslations[i]));
+		table->TargetNames.Add(table->Joints[i].TargetJointName);
+		// parents precede their children, so the parent's entry is already in the table
+		table->ParentRotAdjInverse.Add(parentIndices[i] < 0 ? FQuat::Identity : table->Joints[parentIndices[i]].RotAdj.Inverse());
+	}
+	return table;
+}
+
+bool PoseAIRig::GetLatestLiveValues(const FLiveLinkSubjectName& name, FPoseAILiveValues& outValues) {
+	if (TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> lockedRig = GetRigFromSubjectName(name).Pin()) {
+		lockedRig->liveValuesSnapshot.Read(outValues);
+		return true;
+	}
+	return false;
+}
+
 
 FLiveLinkStaticDataStruct PoseAIRig::MakeStaticData(){
+	return MakeStaticData(activeRemap.Get());
+}
+
+FLiveLinkStaticDataStruct PoseAIRig::MakeQuantizedStaticData() const {
+	return MakeQuantizedStaticData(activeRemap.Get());
+}
+
+FLiveLinkStaticDataStruct PoseAIRig::MakeDerivedStaticData(int32 index, bool quantized) const {
+	const FPoseAIRemapTable* remap = (*activeDerived)[index].Remap.Get();
+	return quantized ? MakeQuantizedStaticData(remap) : MakeStaticData(remap);
+}
+
+FLiveLinkStaticDataStruct PoseAIRig::MakeStaticData(const FPoseAIRemapTable* remap) const {
 	FLiveLinkStaticDataStruct staticData;
 	staticData.InitializeWith(FLiveLinkSkeletonStaticData::StaticStruct(), nullptr);
 	FLiveLinkSkeletonStaticData* skelData = staticData.Cast<FLiveLinkSkeletonStaticData>();
 	check(skelData);
-	skelData->SetBoneNames(jointNames);
+	skelData->SetBoneNames(remap != nullptr ? remap->TargetNames : jointNames);
 	skelData->SetBoneParents(parentIndices);
 	return staticData;
 }
 
-void PoseAIRig::AddBone(FName boneName, FName parentName, FVector translation) {
-	jointNames.Emplace(boneName);
-	if (parentName == boneName) {
-		parentIndices.Emplace(-1);
-	} else {
-		parentIndices.Emplace(jointNames.IndexOfByKey(parentName));
+FLiveLinkStaticDataStruct PoseAIRig::MakeQuantizedStaticData(const FPoseAIRemapTable* remap) const {
+	FLiveLinkStaticDataStruct staticData;
+	staticData.InitializeWith(FLiveLinkPoseAIQuantizedStaticData::StaticStruct(), nullptr);
+	FLiveLinkPoseAIQuantizedStaticData* quantizedData = staticData.Cast<FLiveLinkPoseAIQuantizedStaticData>();
+	check(quantizedData);
+	quantizedData->SetBoneParents(parentIndices);
+	if (remap != nullptr) {
+		quantizedData->SetBoneNames(remap->TargetNames);
+		// the root keeps the rig's, as its translation is replaced by root motion in every frame
+		quantizedData->BindTranslations.Reserve(remap->Joints.Num());
+		for (int32 i = 0; i < remap->Joints.Num(); ++i)
+			quantizedData->BindTranslations.Add(i == 0 ? boneTranslations[0] : remap->Joints[i].BindTranslation);
 	}
-	boneVectors.Add(boneName,translation);
-	lastBoneAdded = boneName;
+	else {
+		quantizedData->SetBoneNames(jointNames);
+		quantizedData->BindTranslations = boneTranslations;
+	}
+	return staticData;
 }
 
-void PoseAIRig::AddBoneToLast(FName boneName, FVector translation) {
-	AddBone(boneName, lastBoneAdded, translation);
+
+// FNV-1a over the lowercased characters.  Names are ASCII, so a TCHAR and a UTF-8 key of the same name hash alike
+template <typename CharType>
+static uint32 HashJointName(const CharType* chars, int32 len) {
+	uint32 hash = 2166136261u;
+	for (int32 i = 0; i < len; ++i)
+		hash = (hash ^ (uint32)FCharAnsi::ToLower((ANSICHAR)chars[i])) * 16777619u;
+	return hash;
+}
+
+void FPoseAIJointNameIndex::Build(const TArray<FName>& jointNames) {
+	keys.Reset();
+	slots.Reset();
+	const int32 numSlots = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(4, jointNames.Num() * 2));
+	slots.SetNum(numSlots);
+	slotMask = (uint32)numSlots - 1;
+
+	for (int32 joint = 0; joint < jointNames.Num(); ++joint) {
+		const FString name = jointNames[joint].ToString();
+		FSlot entry;
+		entry.KeyOffset = keys.Num();
+		entry.KeyLen = name.Len();
+		entry.Joint = joint;
+		for (TCHAR c : name)
+			keys.Add((UTF8CHAR)FCharAnsi::ToLower((ANSICHAR)c));
+
+		// keep the first joint of a name, as IndexOfByKey did
+		if (FindChars(*name, name.Len()) != INDEX_NONE)
+			continue;
+		uint32 slot = HashJointName(*name, name.Len()) & slotMask;
+		while (slots[slot].Joint != INDEX_NONE)
+			slot = (slot + 1) & slotMask;
+		slots[slot] = entry;
+	}
+}
+
+template <typename CharType>
+int32 FPoseAIJointNameIndex::FindChars(const CharType* chars, int32 len) const {
+	if (slots.Num() == 0)
+		return INDEX_NONE;
+	for (uint32 slot = HashJointName(chars, len) & slotMask; slots[slot].Joint != INDEX_NONE; slot = (slot + 1) & slotMask) {
+		const FSlot& entry = slots[slot];
+		if (entry.KeyLen != len)
+			continue;
+		const UTF8CHAR* key = keys.GetData() + entry.KeyOffset;
+		int32 i = 0;
+		while (i < len && (uint32)chars[i] < 128 && (UTF8CHAR)FCharAnsi::ToLower((ANSICHAR)chars[i]) == key[i])
+			++i;
+		if (i == len)
+			return entry.Joint;
+	}
+	return INDEX_NONE;
+}
+
+int32 FPoseAIJointNameIndex::Find(FUtf8StringView name) const {
+	return FindChars(name.GetData(), name.Len());
+}
+
+int32 FPoseAIJointNameIndex::Find(FStringView name) const {
+	return FindChars(name.GetData(), name.Len());
 }
 
 bool PoseAIRig::IsFrameData(const TSharedPtr<FJsonObject> jsonObject)
@@ -96,17 +336,27 @@ bool PoseAIRig::IsFrameData(const TSharedPtr<FJsonObject> jsonObject)
 
 bool PoseAIRig::ProcessFrame(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data)
 {
+	uint32 packetFormat = 0;
+	jsonObject->TryGetNumberField("PF", packetFormat);
+
+	// compact packets which reach the DOM (normally they are tokenized directly) share the compact frame path
+	if (packetFormat == 1) {
+		FPoseAICompactFrame frame;
+		TArray<UTF8CHAR> storage;
+		return frame.ParseJsonObject(jsonObject, storage) && ProcessFrame(frame, data);
+	}
+	POSEAI_TRACE_SCOPE(ProcessFrame);
+	FPoseAIPipelineScope rigScope(*pipelineStats, EPoseAIPipelineTimer::Rig);
 
-	double timestamp;
+	double timestamp = 0.0;
 	jsonObject->TryGetNumberField("Timestamp", timestamp);
-	// drop packets which are older than latest.  in case clock changes capping staleness test at 600 seconds. 
-	if (liveValues.timestamp - 600.0 < timestamp && timestamp < liveValues.timestamp) {
+	if (!AcceptTimestamp(timestamp)) {
 		return false;
 	}
-	liveValues.timestamp = timestamp;
 
 	FString rigStringOut;
 	if (jsonObject->TryGetStringField(fieldRigType, rigStringOut) && FName(rigStringOut) != rigType) {
+		pipelineStats->Count(EPoseAIPipelineCounter::RigMismatch);
 		static bool not_warned = true;
 		if (not_warned) {
 			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: Rig is streaming in %s format, expected %s format."), *rigStringOut, *rigType.ToString());
@@ -115,161 +365,309 @@ bool PoseAIRig::ProcessFrame(const TSharedPtr<FJsonObject> jsonObject, FLiveLink
 		return false;
 	}
 
+	ProcessVerboseSupplementaryData(jsonObject, data);
+
+	TriggerEvents(true);
+
+	data.WorldTime = FPlatformTime::Seconds();
+	return FinishFrame(ProcessVerboseRotations(jsonObject, data), data);
+}
+
+bool PoseAIRig::ProcessFrame(const FPoseAIVerboseFrame& frame, FLiveLinkAnimationFrameData& data)
+{
+	POSEAI_TRACE_SCOPE(ProcessFrame);
+	FPoseAIPipelineScope rigScope(*pipelineStats, EPoseAIPipelineTimer::Rig);
+	if (!AcceptTimestamp(frame.Timestamp)) {
+		return false;
+	}
+
+	if (!frame.Rig.IsEmpty() && !frame.IsRig(rigType)) {
+		pipelineStats->Count(EPoseAIPipelineCounter::RigMismatch);
+		static bool not_warned = true;
+		if (not_warned) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: Rig is streaming in a different format, expected %s format."), *rigType.ToString());
+			not_warned = false;
+		}
+		return false;
+	}
+
+	ProcessVerboseSupplementaryData(frame);
+	TriggerEvents(true);
+
+	data.WorldTime = FPlatformTime::Seconds();
+	return FinishFrame(ProcessVerboseRotations(frame, data), data);
+}
+
+bool PoseAIRig::ProcessFrame(const FPoseAICompactFrame& frame, FLiveLinkAnimationFrameData& data)
+{
+	POSEAI_TRACE_SCOPE(ProcessFrame);
+	FPoseAIPipelineScope rigScope(*pipelineStats, EPoseAIPipelineTimer::Rig);
+	double timestamp = frame.Timestamp;
+	if (!AcceptTimestamp(timestamp)) {
+		return false;
+	}
+
+	if (!frame.Rig.IsEmpty() && !frame.IsRig(rigType)) {
+		pipelineStats->Count(EPoseAIPipelineCounter::RigMismatch);
+		static bool not_warned = true;
+		if (not_warned) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: Rig is streaming in a different format, expected %s format."), *rigType.ToString());
+			not_warned = false;
+		}
+		return false;
+	}
+
+	ProcessCompactSupplementaryData(frame);
+	TriggerEvents(true);
+
+	data.WorldTime = FPlatformTime::Seconds();
+	return FinishFrame(ProcessCompactRotations(frame, data), data);
+}
+
+bool PoseAIRig::ProcessFrame(const FPoseAIBinaryPacket& packet, FLiveLinkAnimationFrameData& data)
+{
+	POSEAI_TRACE_SCOPE(ProcessFrame);
+	FPoseAIPipelineScope rigScope(*pipelineStats, EPoseAIPipelineTimer::Rig);
+	double timestamp = packet.GetTimestamp();
+	if (!AcceptTimestamp(timestamp)) {
+		return false;
+	}
+
+	if (packet.GetRig() != static_cast<uint8>(rigPreset)) {
+		pipelineStats->Count(EPoseAIPipelineCounter::RigMismatch);
+		static bool not_warned = true;
+		if (not_warned) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: Rig is streaming in format %d, expected %s format."), packet.GetRig(), *rigType.ToString());
+			not_warned = false;
+		}
+		return false;
+	}
+
+	ProcessBinarySupplementaryData(packet);
+	TriggerEvents(true);
+
+	data.WorldTime = FPlatformTime::Seconds();
+	return FinishFrame(ProcessBinaryRotations(packet, data), data);
+}
+
+bool PoseAIRig::ScanFrame(const FPoseAICompactFrame& frame)
+{
+	if (!AcceptEventTimestamp(frame.Timestamp) || (!frame.Rig.IsEmpty() && !frame.IsRig(rigType))) {
+		return false;
+	}
+	ProcessCompactSupplementaryData(frame);
+	TriggerEvents(false);
+	return true;
+}
+
+bool PoseAIRig::ScanFrame(const FPoseAIVerboseFrame& frame)
+{
+	if (!AcceptEventTimestamp(frame.Timestamp) || (!frame.Rig.IsEmpty() && !frame.IsRig(rigType))) {
+		return false;
+	}
+	ProcessVerboseSupplementaryData(frame);
+	TriggerEvents(false);
+	return true;
+}
+
+bool PoseAIRig::ScanFrame(const TSharedPtr<FJsonObject> jsonObject)
+{
 	uint32 packetFormat = 0;
 	jsonObject->TryGetNumberField("PF", packetFormat);
+	if (packetFormat == 1) {
+		FPoseAICompactFrame frame;
+		TArray<UTF8CHAR> storage;
+		return frame.ParseJsonObject(jsonObject, storage) && ScanFrame(frame);
+	}
 
-	if (packetFormat == 1)
-		ProcessCompactSupplementaryData(jsonObject, data);
-	else
-		ProcessVerboseSupplementaryData(jsonObject, data);
+	double timestamp = 0.0;
+	jsonObject->TryGetNumberField("Timestamp", timestamp);
+	FString rigStringOut;
+	if (!AcceptEventTimestamp(timestamp) || (jsonObject->TryGetStringField(fieldRigType, rigStringOut) && FName(rigStringOut) != rigType)) {
+		return false;
+	}
+	// the DOM overload does not write to the frame it takes
+	FLiveLinkAnimationFrameData unused;
+	ProcessVerboseSupplementaryData(jsonObject, unused);
+	TriggerEvents(false);
+	return true;
+}
+
+bool PoseAIRig::ScanFrame(const FPoseAIBinaryPacket& packet)
+{
+	if (!AcceptEventTimestamp(packet.GetTimestamp()) || packet.GetRig() != static_cast<uint8>(rigPreset)) {
+		return false;
+	}
+	ProcessBinarySupplementaryData(packet);
+	TriggerEvents(false);
+	return true;
+}
 
-	TriggerEvents();
+bool PoseAIRig::AcceptTimestamp(double timestamp) {
+	// drop packets which are older than latest.  in case clock changes capping staleness test at 600 seconds. 
+	if (liveValues.timestamp - 600.0 < timestamp && timestamp < liveValues.timestamp) {
+		pipelineStats->Count(EPoseAIPipelineCounter::Stale);
+		return false;
+	}
+	liveValues.timestamp = timestamp;
+	eventTimestamp = timestamp;
+	return true;
+}
 
-	data.WorldTime = FPlatformTime::Seconds();
-	bool has_processed = (packetFormat == 1) ? ProcessCompactRotations(jsonObject, data) : ProcessVerboseRotations(jsonObject, data);
-	return has_processed;
+bool PoseAIRig::AcceptEventTimestamp(double timestamp) {
+	if (eventTimestamp - 600.0 < timestamp && timestamp < eventTimestamp) {
+		pipelineStats->Count(EPoseAIPipelineCounter::Stale);
+		return false;
+	}
+	eventTimestamp = timestamp;
+	return true;
 }
 
-void PoseAIRig::TriggerEvents() {
-	/* trigger various events and update the Pose AI Movement Component */
+void PoseAIRig::TriggerEvents(bool frameReceived) {
+	POSEAI_TRACE_SCOPE(TriggerEvents);
+	/* gather the packet's events into one record for the Pose AI Movement Component, dispatched on the game thread's next tick */
+	FPoseAIEventRecord& record = eventRecord;
+	record.Reset();
 	if (visibilityFlags.HasChanged()) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastVisibilityChange(name, visibilityFlags);
+		record.bHasVisibility = true;
+		record.VisibilityFlags = visibilityFlags;
 	}
 	if (verbose.Events.Jump.CheckTriggerAndUpdate()) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastJumps(name);
+		record.AddEvent(EPoseAIEventType::Jump);
 	}
 	if (verbose.Events.Footstep.CheckTriggerAndUpdate()) {
 		float height = FMath::Abs(verbose.Events.Footstep.Magnitude);
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastFootsteps(name, height, verbose.Events.Footstep.Magnitude > 0.0f);
+		record.AddEvent(EPoseAIEventType::Footstep, height, 0, verbose.Events.Footstep.Magnitude > 0.0f);
 	}
 	if (verbose.Events.FeetSplit.CheckTriggerAndUpdate()) {
 		float width = FMath::Abs(verbose.Events.FeetSplit.Magnitude);
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastFeetsplits(name, width, verbose.Events.FeetSplit.Magnitude < 0.0f);
+		record.AddEvent(EPoseAIEventType::Feetsplit, width, 0, verbose.Events.FeetSplit.Magnitude < 0.0f);
 	}
 	if (verbose.Events.ArmPump.CheckTriggerAndUpdate()) {
 		float height = FMath::Abs(verbose.Events.ArmPump.Magnitude);
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmpumps(name, height);
+		record.AddEvent(EPoseAIEventType::Armpump, height);
 	}
 	if (verbose.Events.ArmFlex.CheckTriggerAndUpdate()) {
 		float width = FMath::Abs(verbose.Events.ArmFlex.Magnitude);
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmflexes(name, width, verbose.Events.ArmFlex.Magnitude < 0.0f);
+		record.AddEvent(EPoseAIEventType::Armflex, width, 0, verbose.Events.ArmFlex.Magnitude < 0.0f);
 	}
 	if (verbose.Events.SidestepL.CheckTriggerAndUpdate()) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastSidestepL(name, verbose.Events.SidestepL.Magnitude < 0.0f);
+		record.AddEvent(EPoseAIEventType::SidestepL, 0.0f, 0, verbose.Events.SidestepL.Magnitude < 0.0f);
 	}
 	if (verbose.Events.SidestepR.CheckTriggerAndUpdate()) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastSidestepR(name, verbose.Events.SidestepR.Magnitude < 0.0f);
+		record.AddEvent(EPoseAIEventType::SidestepR, 0.0f, 0, verbose.Events.SidestepR.Magnitude < 0.0f);
 	}
 	if (verbose.Events.ArmGestureL.CheckTriggerAndUpdate()) {
 		if (verbose.Events.ArmGestureL.Current == 50)
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmjacks(name, true);
+			record.AddEvent(EPoseAIEventType::Armjack, 0.0f, 0, true);
 		else if (verbose.Events.ArmGestureL.Current == 51)
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmjacks(name, false);
+			record.AddEvent(EPoseAIEventType::Armjack, 0.0f, 0, false);
 		else
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmGestureL(name, verbose.Events.ArmGestureL.Current);
+			record.AddEvent(EPoseAIEventType::ArmGestureL, 0.0f, verbose.Events.ArmGestureL.Current);
 	}
 	if (verbose.Events.ArmGestureR.CheckTriggerAndUpdate()) {
 		if (verbose.Events.ArmGestureR.Current < 50)
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastArmGestureR(name, verbose.Events.ArmGestureR.Current);
+			record.AddEvent(EPoseAIEventType::ArmGestureR, 0.0f, verbose.Events.ArmGestureR.Current);
 	}
 	if (isDifferentAndSet(liveValues.handZoneLeft, handZoneL)) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastHandToZoneL(name, handZoneL);
+		record.AddEvent(EPoseAIEventType::HandToZoneL, 0.0f, handZoneL);
 	}
 	if (isDifferentAndSet(liveValues.handZoneRight, handZoneR)) {
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastHandToZoneR(name, handZoneR);
+		record.AddEvent(EPoseAIEventType::HandToZoneR, 0.0f, handZoneR);
 	}
 	if (isDifferentAndSet(liveValues.stableFeet, stableFeet)) {
 		if (stableFeet > 1)
-			UPoseAIEventDispatcher::GetDispatcher()->BroadcastStationary(name);
+			record.AddEvent(EPoseAIEventType::Stationary);
 	}
 	if (liveValues.isCrouching != isCrouching) {
 		isCrouching = !isCrouching;
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastCrouches(name, isCrouching);
+		record.AddEvent(EPoseAIEventType::Crouch, 0.0f, 0, isCrouching);
 	}
-	if (visibilityFlags.isTorso)
-		UPoseAIEventDispatcher::GetDispatcher()->BroadcastLiveValues(name, liveValues);
+	// pollers read the snapshot directly, and the game thread reads it once per tick for onLiveValues rather than copying every packet
+	liveValuesSnapshot.Write(liveValues);
+	record.bHasLiveValues = visibilityFlags.isTorso;
+	record.bFrameReceived = frameReceived;
+	if (isDetached)
+		return;
+	UPoseAIEventDispatcher::GetDispatcher()->QueueEvents(name, record);
+	FPoseAIStreamListeners::Notify(name, record, visibilityFlags, liveValues);
 }
 
 
-void PoseAIRig::ProcessCompactSupplementaryData(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data)
+void PoseAIRig::ProcessCompactSupplementaryData(const FPoseAICompactFrame& frame)
 {
-	TSharedPtr < FJsonObject > objBody;
-	TSharedPtr < FJsonObject > objHandLeft;
-	TSharedPtr < FJsonObject > objHandRight;
-
-	jsonObject->TryGetNumberField("ModelLatency", liveValues.modelLatency);
-	
-	objBody = (jsonObject->HasTypedField<EJson::Object>(fieldBody)) ? jsonObject->GetObjectField(fieldBody) : nullptr;
-	if (objBody != nullptr && objBody.IsValid()) {
-		FString VisA = (objBody->HasTypedField<EJson::String>("VisA")) ? objBody->GetStringField("VisA") : "";
-		FString ScaA = (objBody->HasTypedField<EJson::String>("ScaA")) ? objBody->GetStringField("ScaA") : "";
-		FString VecA = (objBody->HasTypedField<EJson::String>("VecA")) ? objBody->GetStringField("VecA") : "";
-		FString EveA = (objBody->HasTypedField<EJson::String>("EveA")) ? objBody->GetStringField("EveA") : "";
-		visibilityFlags.ProcessCompact(VisA);
-		liveValues.ProcessCompactScalarsBody(ScaA);
-		liveValues.ProcessCompactVectorsBody(VecA);
-		verbose.Events.ProcessCompactBody(EveA);
+	if (frame.bHasModelLatency)
+		liveValues.modelLatency = frame.ModelLatency;
+
+	if (frame.bHasBody) {
+		visibilityFlags.ProcessCompact(frame.VisA);
+		liveValues.ProcessCompactScalarsBody(frame.ScaA);
+		liveValues.ProcessCompactVectorsBody(frame.VecA);
+		verbose.Events.ProcessCompactBody(frame.EveA);
 		liveValues.jumpHeight = verbose.Events.Jump.Magnitude;
-
 	}
-	objHandLeft = (jsonObject->HasTypedField<EJson::Object>(fieldHandLeft)) ? jsonObject->GetObjectField(fieldHandLeft) : nullptr;
-	if (objHandLeft != nullptr && objHandLeft.IsValid()) {
-		liveValues.ProcessCompactVectorsHandLeft(objHandLeft);
+	if (frame.LeftHand.bPresent) {
+		liveValues.ProcessCompactVectorsHandLeft(frame.LeftHand);
 	}
+	if (frame.RightHand.bPresent) {
+		liveValues.ProcessCompactVectorsHandRight(frame.RightHand);
+	}
+}
 
-	objHandRight = (jsonObject->HasTypedField<EJson::Object>(fieldHandRight)) ? jsonObject->GetObjectField(fieldHandRight) : nullptr;
-	if (objHandRight != nullptr && objHandRight.IsValid()) {
-		liveValues.ProcessCompactVectorsHandRight(objHandRight);
+void PoseAIRig::ProcessBinarySupplementaryData(const FPoseAIBinaryPacket& packet)
+{
+	liveValues.modelLatency = packet.GetModelLatency();
+
+	if (const uint8* scalarData = packet.GetSectionData(EPoseAIBinarySection::Scalars)) {
+		visibilityFlags.ProcessBinary(scalarData[0]);
+		liveValues.ProcessBinaryScalarsBody(scalarData);
+	}
+	if (packet.HasSection(EPoseAIBinarySection::Vectors)) {
+		TArray<float, TInlineAllocator<32>> values;
+		packet.ReadFixed12(EPoseAIBinarySection::Vectors, values);
+		liveValues.ProcessVectorsBody(values);
+	}
+	if (const uint8* eventData = packet.GetSectionData(EPoseAIBinarySection::Events)) {
+		verbose.Events.ProcessBinaryBody(eventData);
+		liveValues.jumpHeight = verbose.Events.Jump.Magnitude;
+	}
+	if (const uint8* handData = packet.GetSectionData(EPoseAIBinarySection::HandVectors)) {
+		liveValues.ProcessBinaryVectorsHands(handData);
 	}
 }
 
 void PoseAIRig::AssignCharacterMotion(FLiveLinkAnimationFrameData& data) {
 	if (!isDesktop) {
-		FVector playerMotion = liveValues.cameraRotation.RotateVector(liveValues.rootTranslation - liveValues.rootOffset) * rigHeight * liveValues.scaleMotion;
+		const FPoseAIMotionConfig config = motionConfig.Read();
+		FVector playerMotion = config.cameraRotation.RotateVector(liveValues.rootTranslation - config.rootOffset) * config.rigHeight * config.scaleMotion;
 		data.Transforms[0].SetTranslation(playerMotion);
 	}
 }
 
-bool PoseAIRig::ProcessCompactRotations(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data)
+bool PoseAIRig::ProcessCompactRotations(const FPoseAICompactFrame& frame, FLiveLinkAnimationFrameData& data)
 {
-	TSharedPtr < FJsonObject > objBody;
-	TSharedPtr < FJsonObject > objHandLeft;
-	TSharedPtr < FJsonObject > objHandRight;
-	FString rotaBody;
-	FString rotaHandLeft;
-	FString rotaHandRight;
-
-	objBody = (jsonObject->HasTypedField<EJson::Object>(fieldBody)) ? jsonObject->GetObjectField(fieldBody) : nullptr;
-	if (objBody != nullptr && objBody.IsValid())
-		rotaBody = (objBody->HasTypedField<EJson::String>("RotA")) ? objBody->GetStringField("RotA") : "";
-
-	objHandLeft = (jsonObject->HasTypedField<EJson::Object>(fieldHandLeft)) ? jsonObject->GetObjectField(fieldHandLeft) : nullptr;
-	if (objHandLeft != nullptr && objHandLeft.IsValid())
-		rotaHandLeft = (objHandLeft->HasTypedField<EJson::String>("RotA")) ? objHandLeft->GetStringField("RotA") : "";
-
-	objHandRight = (jsonObject->HasTypedField<EJson::Object>(fieldHandRight)) ? jsonObject->GetObjectField(fieldHandRight) : nullptr;
-	if (objHandRight != nullptr && objHandRight.IsValid())
-		rotaHandRight = (objHandRight->HasTypedField<EJson::String>("RotA")) ? objHandRight->GetStringField("RotA") : "";
-
+	const FUtf8StringView rotaBody = frame.RotA;
+	const FUtf8StringView rotaHandLeft = frame.LeftHand.RotA;
+	const FUtf8StringView rotaHandRight = frame.RightHand.RotA;
 
 	bool hasProcessedRotations;
 
-	if ((rotaBody.Len() < 8 && cachedPose.Num() < 1) ) {
+	if ((rotaBody.Len() < 8 && CachedPose().Num() < 1) ) {
 		hasProcessedRotations = false;
 	}
 	else if (rotaBody.Len() < 8 ) {
-		data.Transforms.Append(cachedPose);
+		data.Transforms.Append(CachedPose());
 		hasProcessedRotations = true;
 	}
 	else {
-		TArray<FQuat> componentRotations;
+		TArray<FQuat>& componentRotations = scratchComponentRotations;
+		TArray<FQuat>& quatArray = scratchQuats;
+		componentRotations.Reset();
 		AppendCachedRotations(0, 1, componentRotations, data);
 
 		if (rotaBody.Len() > 7) {
-			TArray<float> flatArray;
-			TArray<FQuat> quatArray;
-			FStringFixed12ToFloat(rotaBody, flatArray);
-			FlatArrayToQuats(flatArray, quatArray);
+			quatArray.Reset();
+			Fixed12DecodeQuats(rotaBody.GetData(), rotaBody.Len(), quatArray);
 			if (isLowerBodyRotated) {
 				RotateLowerBody180(quatArray);
 			}
@@ -281,19 +679,15 @@ bool PoseAIRig::ProcessCompactRotations(const TSharedPtr<FJsonObject> jsonObject
 
 		if (includeHands) {
 			if (rotaHandLeft.Len() > 7) {
-				TArray<float> flatArray;
-				TArray<FQuat> quatArray;
-				FStringFixed12ToFloat(rotaHandLeft, flatArray);
-				FlatArrayToQuats(flatArray, quatArray);
+				quatArray.Reset();
+				Fixed12DecodeQuats(rotaHandLeft.GetData(), rotaHandLeft.Len(), quatArray);
 				AppendQuatArray(quatArray, numBodyJoints, componentRotations, data);
 			}
 			else
 				AppendCachedRotations(numBodyJoints, numBodyJoints + numHandJoints, componentRotations, data);
 			if (rotaHandRight.Len() > 7) {
-				TArray<float> flatArray;
-				TArray<FQuat> quatArray;
-				FStringFixed12ToFloat(rotaHandRight, flatArray);
-				FlatArrayToQuats(flatArray, quatArray);
+				quatArray.Reset();
+				Fixed12DecodeQuats(rotaHandRight.GetData(), rotaHandRight.Len(), quatArray);
 				AppendQuatArray(quatArray, numBodyJoints + numHandJoints, componentRotations, data);
 			}
 			else
@@ -301,11 +695,65 @@ bool PoseAIRig::ProcessCompactRotations(const TSharedPtr<FJsonObject> jsonObject
 		}
 		AssignCharacterMotion(data);
 		CachePose(data.Transforms);
+		CheckScratchGrowth();
 		hasProcessedRotations = true;
 	}
 	return hasProcessedRotations;
 }
 
+bool PoseAIRig::ProcessBinaryRotations(const FPoseAIBinaryPacket& packet, FLiveLinkAnimationFrameData& data)
+{
+	const int32 numBodyQuats = packet.GetSectionCount(EPoseAIBinarySection::BodyRotations);
+	if (numBodyQuats < 1) {
+		if (CachedPose().Num() < 1)
+			return false;
+		data.Transforms.Append(CachedPose());
+		return true;
+	}
+	// unlike the JSON formats the counts are explicit, so reject rather than misalign the skeleton
+	if (numBodyQuats != numBodyJoints - 1) {
+		static bool not_warned = true;
+		if (not_warned) {
+			UE_LOG(LogTemp, Warning, TEXT("PoseAI LiveLink: binary packet has %d body rotations, expected %d."), numBodyQuats, numBodyJoints - 1);
+			not_warned = false;
+		}
+		return false;
+	}
+
+	TArray<FQuat>& componentRotations = scratchComponentRotations;
+	TArray<FQuat>& quatArray = scratchQuats;
+	componentRotations.Reset();
+	quatArray.Reset();
+	AppendCachedRotations(0, 1, componentRotations, data);
+	packet.ReadQuats(EPoseAIBinarySection::BodyRotations, quatArray);
+	if (isLowerBodyRotated) {
+		RotateLowerBody180(quatArray);
+	}
+	AppendQuatArray(quatArray, 1, componentRotations, data); //start at 1 as pose camera does not include the root joint
+
+	if (includeHands) {
+		quatArray.Reset();
+		if (packet.GetSectionCount(EPoseAIBinarySection::LeftHandRotations) == numHandJoints) {
+			packet.ReadQuats(EPoseAIBinarySection::LeftHandRotations, quatArray);
+			AppendQuatArray(quatArray, numBodyJoints, componentRotations, data);
+		}
+		else
+			AppendCachedRotations(numBodyJoints, numBodyJoints + numHandJoints, componentRotations, data);
+
+		quatArray.Reset();
+		if (packet.GetSectionCount(EPoseAIBinarySection::RightHandRotations) == numHandJoints) {
+			packet.ReadQuats(EPoseAIBinarySection::RightHandRotations, quatArray);
+			AppendQuatArray(quatArray, numBodyJoints + numHandJoints, componentRotations, data);
+		}
+		else
+			AppendCachedRotations(numBodyJoints + numHandJoints, numBodyJoints + 2 * numHandJoints, componentRotations, data);
+	}
+	AssignCharacterMotion(data);
+	CachePose(data.Transforms);
+	CheckScratchGrowth();
+	return true;
+}
+
 bool PoseAIRig::ProcessVerboseRotations(const TSharedPtr<FJsonObject> jsonObject, FLiveLinkAnimationFrameData& data)
 {
 	TSharedPtr < FJsonObject > objBody;
@@ -328,32 +776,68 @@ bool PoseAIRig::ProcessVerboseRotations(const TSharedPtr<FJsonObject> jsonObject
 		rotHandRight = (objHandRight->HasTypedField<EJson::Object>(fieldRotations)) ? objHandRight->GetObjectField(fieldRotations) : nullptr;
 
 
+	// body rotations take precedence over hand rotations of the same name, as the lookup order did
+	ResetVerboseRotations();
+	for (const TSharedPtr<FJsonObject>& rotObj : { rotBody, rotHandLeft, rotHandRight }) {
+		if (rotObj == nullptr)
+			continue;
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& field : rotObj->Values) {
+			const int32 joint = jointNameIndex.Find(FStringView(field.Key));
+			const TArray<TSharedPtr<FJsonValue>>* outArray;
+			if (joint == INDEX_NONE || scratchVerboseFound[joint] || !field.Value->TryGetArray(outArray) || outArray->Num() < 4)
+				continue;
+			scratchVerboseRotations[joint] = FQuat((*outArray)[0]->AsNumber(), (*outArray)[1]->AsNumber(), (*outArray)[2]->AsNumber(), (*outArray)[3]->AsNumber());
+			scratchVerboseFound[joint] = true;
+		}
+	}
+	return ApplyVerboseRotations(rotBody != nullptr, data);
+}
+
+bool PoseAIRig::ProcessVerboseRotations(const FPoseAIVerboseFrame& frame, FLiveLinkAnimationFrameData& data)
+{
+	ResetVerboseRotations();
+	for (const FPoseAIVerbosePart* part : { &frame.Body, &frame.LeftHand, &frame.RightHand }) {
+		for (const FPoseAIVerboseRotation& entry : part->Rotations) {
+			const int32 joint = jointNameIndex.Find(entry.Name);
+			if (joint == INDEX_NONE || scratchVerboseFound[joint])
+				continue;
+			scratchVerboseRotations[joint] = entry.Rotation;
+			scratchVerboseFound[joint] = true;
+		}
+	}
+	return ApplyVerboseRotations(frame.Body.bHasRotations, data);
+}
+
+void PoseAIRig::ResetVerboseRotations() {
+	scratchVerboseRotations.SetNumUninitialized(jointNames.Num());
+	scratchVerboseFound.SetNumUninitialized(jointNames.Num());
+	FMemory::Memzero(scratchVerboseFound.GetData(), scratchVerboseFound.Num() * sizeof(bool));
+}
+
+bool PoseAIRig::ApplyVerboseRotations(bool hasBodyRotations, FLiveLinkAnimationFrameData& data)
+{
 	bool hasProcessedRotations;
-	if (rotBody == nullptr && cachedPose.Num() < 1) {
+	if (!hasBodyRotations && CachedPose().Num() < 1) {
 		hasProcessedRotations = false;
 	}
-	else if (rotBody == nullptr || !visibilityFlags.isTorso) {
-		data.Transforms.Append(cachedPose);
+	else if (!hasBodyRotations || !visibilityFlags.isTorso) {
+		data.Transforms.Append(CachedPose());
 		hasProcessedRotations = true;
 	}
 	else {
-		TArray<FQuat> componentRotations;
+		TArray<FQuat>& componentRotations = scratchComponentRotations;
+		componentRotations.Reset();
 
 		for (int32 i = 0; i < jointNames.Num(); i++) {
-			const FName& jointName = jointNames[i];
 			int32 parentIdx = parentIndices[i];
 			FQuat parentQuat = (parentIdx < 0 ? FQuat::Identity : componentRotations[parentIdx]);
-			const FVector& translation = boneVectors.FindRef(jointName);
+			const FVector& translation = boneTranslations[i];
 			FQuat rotation;
-			const TArray < TSharedPtr < FJsonValue > >* outArray;
-			FString jointString = jointName.ToString();
-			if ((rotBody != nullptr && rotBody->TryGetArrayField(jointString, outArray)) ||
-				(rotHandLeft != nullptr && rotHandLeft->TryGetArrayField(jointString, outArray)) ||
-				(rotHandRight != nullptr && rotHandRight->TryGetArrayField(jointString, outArray))) {
-				rotation = FQuat((*outArray)[0]->AsNumber(), (*outArray)[1]->AsNumber(), (*outArray)[2]->AsNumber(), (*outArray)[3]->AsNumber());
+			if (scratchVerboseFound[i]) {
+				rotation = scratchVerboseRotations[i];
 			}
-			else if (cachedPose.Num() > i) {
-				rotation = parentQuat * cachedPose[i].GetRotation();
+			else if (CachedPose().Num() > i) {
+				rotation = parentQuat * CachedPose()[i].GetRotation();
 			}
 			else {
 				rotation = FQuat::Identity;
@@ -367,6 +851,7 @@ bool PoseAIRig::ProcessVerboseRotations(const TSharedPtr<FJsonObject> jsonObject
 		}
 		AssignCharacterMotion(data);
 		CachePose(data.Transforms);
+		CheckScratchGrowth();
 
 		hasProcessedRotations = true;
 	}
@@ -414,6 +899,32 @@ void PoseAIRig::ProcessVerboseSupplementaryData(const TSharedPtr<FJsonObject> js
 	visibilityFlags.ProcessVerbose(verbose.Scalars);
 }
 
+void PoseAIRig::ProcessVerboseSupplementaryData(const FPoseAIVerboseFrame& frame)
+{
+	if (frame.bHasModelLatency)
+		liveValues.modelLatency = frame.ModelLatency;
+
+	if (frame.Body.bPresent)
+		verbose.ProcessVerboseBody(frame.Body);
+	liveValues.ProcessVerboseBody(verbose);
+
+	if (frame.LeftHand.bPresent) {
+		if (!frame.LeftHand.Vectors.IsEmpty())
+			liveValues.ProcessVerboseVectorsHandLeft(frame.LeftHand.Vectors);
+		if (frame.LeftHand.bHasOpen)
+			liveValues.opennessLeftHand = frame.LeftHand.Open;
+	}
+	if (frame.RightHand.bPresent) {
+		if (!frame.RightHand.Vectors.IsEmpty())
+			liveValues.ProcessVerboseVectorsHandRight(frame.RightHand.Vectors);
+		if (frame.RightHand.bHasOpen)
+			liveValues.opennessRightHand = frame.RightHand.Open;
+	}
+
+	liveValues.jumpHeight = verbose.Events.Jump.Magnitude;
+	visibilityFlags.ProcessVerbose(verbose.Scalars);
+}
+
 void PoseAIRig::RotateLowerBody180(TArray<FQuat>& quatArray) {
 	FQuat q180 = FQuat(0.0, 0.0, 1.0, 0.0);
 	for (int32 i = 0; i < lowerBodyNumOfJoints + 1; ++i) {
@@ -424,27 +935,20 @@ void PoseAIRig::RotateLowerBody180(TArray<FQuat>& quatArray) {
 
 
 void PoseAIRig::AppendQuatArray(const TArray<FQuat>& quatArray, int32 begin, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data) {
-	for (int32 i = begin; i < begin + quatArray.Num(); i++) {
-		const FName& jointName = jointNames[i];
-		int32 parentIdx = parentIndices[i];
-		const FQuat& rotation = quatArray[i - begin];
-		FQuat parentQuat = (parentIdx < 0 ? FQuat::Identity : componentRotations[parentIdx]);
-		const FVector& translation = boneVectors.FindRef(jointName);
-		componentRotations.Add(rotation);
-		FQuat finalRotation = parentQuat.Inverse() * rotation;
-		finalRotation.Normalize();
-		FTransform transform = FTransform(finalRotation, translation, FVector::OneVector);
-		data.Transforms.Add(transform);
-	}
+	const int32 end = FMath::Min(begin + quatArray.Num(), jointNames.Num());
+	if (end <= begin)
+		return;
+	componentRotations.Append(quatArray.GetData(), end - begin);
+	PoseAIAppendLocalTransforms(componentRotations.GetData(), quatArray.GetData(), parentIndices.GetData(), boneTranslations.GetData(), begin, end, data.Transforms);
 }
 
 void PoseAIRig::AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data) {
 	for (int32 i = begin; i < end; i++) {
-		const FName& jointName = jointNames[i];
 		int32 parentIdx = parentIndices[i];
 		FQuat parentQuat = (parentIdx < 0 ? FQuat::Identity : componentRotations[parentIdx]);
+		const TArray<FTransform>& cachedPose = CachedPose();
 		const FQuat& rotation =  (cachedPose.Num() > i) ? parentQuat * cachedPose[i].GetRotation() : FQuat::Identity;
-		const FVector& translation = boneVectors.FindRef(jointName);
+		const FVector& translation = boneTranslations[i];
 		componentRotations.Add(rotation);
 		FQuat finalRotation = parentQuat.Inverse() * rotation;
 		finalRotation.Normalize();
@@ -454,424 +958,256 @@ void PoseAIRig::AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& com
 }
 
 void PoseAIRig::CachePose(const TArray<FTransform>& transforms) {
-	cachedPose = TArray<FTransform>(transforms);
+	const int32 back = 1 - cachedPoseFront;
+	cachedPoses[back].Reset();
+	cachedPoses[back].Append(transforms);
+	cachedPoseFront = back;
 }
 
-void PoseAIRig::Configure() {}
+bool PoseAIRig::FinishFrame(bool processed, FLiveLinkAnimationFrameData& data) {
+	if (remapPending.load(std::memory_order_acquire)) {
+		FScopeLock lock(&pendingRemapLock);
+		activeRemap = pendingRemap;
+		remapPending.store(false, std::memory_order_relaxed);
+		staticDataChanged.store(true, std::memory_order_relaxed);
+	}
+	if (derivedPending.load(std::memory_order_acquire)) {
+		FScopeLock lock(&pendingRemapLock);
+		activeDerived = pendingDerived;
+		derivedPending.store(false, std::memory_order_relaxed);
+		derivedChanged.store(true, std::memory_order_relaxed);
+		derivedFrames.SetNum(NumDerivedSubjects());
+	}
+	if (!processed)
+		return false;
 
-void PoseAIRigUE4::Configure()
-{
-	jointNames.Empty();
-	boneVectors.Empty();
-	parentIndices.Empty();
-
-	AddBone(TEXT("root"), TEXT("root"), FVector(0.0, 0, 0.0));
-	AddBoneToLast(TEXT("pelvis"), FVector(0.0, 0, 0.0));
-
-	AddBone(TEXT("thigh_r"), TEXT("pelvis"), FVector(-1.448829, 0.531424, 9.00581));
-	AddBoneToLast(TEXT("calf_r"), FVector(42.572037, 0, 0));
-	AddBoneToLast(TEXT("foot_r"), FVector(40.19669, 0, 0));
-	AddBoneToLast(TEXT("ball_r"), FVector(10.453837, -16.577854, 0.080156));
-
-	AddBone(TEXT("thigh_l"), TEXT("pelvis"), FVector(-1.448829, 0.531424, -9.00581));
-	AddBoneToLast(TEXT("calf_l"), FVector(-42.572037, 0, 0));
-	AddBoneToLast(TEXT("foot_l"), FVector(-40.19669, 0, 0));
-	AddBoneToLast(TEXT("ball_l"), FVector(-10.453837, 16.577854, 0.080156));
-
-	AddBone(TEXT("spine_01"), TEXT("pelvis"), FVector(10.808878, 0.851415, 0));
-	AddBoneToLast(TEXT("spine_02"), FVector(18.875349, -3.801159, 0));
-	AddBoneToLast(TEXT("spine_03"), FVector(13.407329, -0.420477, 0));
-	AddBoneToLast(TEXT("neck_01"), FVector(16.558783, 0.355318, 0));
-	AddBoneToLast(TEXT("head"), FVector(9.283613, -0.364157, 0));
-
-	AddBone(TEXT("clavicle_l"), TEXT("spine_03"), FVector(11.883688, 2.732088, -3.781983));
-	AddBoneToLast(TEXT("upperarm_l"), FVector(15.784872, 0, 0));
-	AddBoneToLast(TEXT("lowerarm_l"), FVector(30.33993, 0, 0));
-
-	AddBone(TEXT("clavicle_r"), TEXT("spine_03"), FVector(11.883688, 2.732102, 3.782003));
-	AddBoneToLast(TEXT("upperarm_r"), FVector(-15.784872, 0, 0));
-	AddBoneToLast(TEXT("lowerarm_r"), FVector(-30.33993, 0, 0));
-	numBodyJoints = jointNames.Num();
-	if (includeHands) {
-		AddBone(TEXT("hand_l"), TEXT("lowerarm_l"), FVector(26.975143, 0, 0));
-		AddBone(TEXT("lowerarm_twist_01_l"), TEXT("lowerarm_l"), FVector(14.0, 0, 0));
-		AddBone(TEXT("index_01_l"), TEXT("hand_l"), FVector(12.068114, -1.763462, -2.109398));
-		AddBoneToLast(TEXT("index_02_l"), FVector(4.287498, 0, 0));
-		AddBoneToLast(TEXT("index_03_l"), FVector(3.39379, 0, 0));
-		AddBone(TEXT("middle_01_l"), TEXT("hand_l"), FVector(12.244281, -1.293644, 0.571162));
-		AddBoneToLast(TEXT("middle_02_l"), FVector(4.640374, 0, 0));
-		AddBoneToLast(TEXT("middle_03_l"), FVector(3.648844, 0, 0));
-		AddBone(TEXT("ring_01_l"), TEXT("hand_l"), FVector(11.497885, -1.753527, 2.846912));
-		AddBoneToLast(TEXT("ring_02_l"), FVector(4.430177, 0, 0));
-		AddBoneToLast(TEXT("ring_03_l"), FVector(3.476652, 0, 0));
-		AddBone(TEXT("pinky_01_l"), TEXT("hand_l"), FVector(10.140665, -2.263151, 4.643148));
-		AddBoneToLast(TEXT("pinky_02_l"), FVector(3.570981, 0, 0));
-		AddBoneToLast(TEXT("pinky_03_l"), FVector(2.985631, 0, 0));
-		AddBone(TEXT("thumb_01_l"), TEXT("hand_l"), FVector(4.762036, -2.374981, -2.53782));
-		AddBoneToLast(TEXT("thumb_02_l"), FVector(3.869672, 0, 0));
-		AddBoneToLast(TEXT("thumb_03_l"), FVector(4.062171, 0, 0));
-		
-		AddBone(TEXT("hand_r"), TEXT("lowerarm_r"), FVector(-26.975143, 0, 0));
-		AddBone(TEXT("lowerarm_twist_01_r"), TEXT("lowerarm_r"), FVector(-14.0, 0, 0));
-		AddBone(TEXT("index_01_r"), TEXT("hand_r"), FVector(-12.068114, 1.763462, 2.109398));
-		AddBoneToLast(TEXT("index_02_r"), FVector(-4.287498, 0, 0));
-		AddBoneToLast(TEXT("index_03_r"), FVector(-3.39379, 0, 0));
-		AddBone(TEXT("middle_01_r"), TEXT("hand_r"), FVector(-12.244281, 1.293644, -0.571162));
-		AddBoneToLast(TEXT("middle_02_r"), FVector(-4.640374, 0, 0));
-		AddBoneToLast(TEXT("middle_03_r"), FVector(-3.648844, 0, 0));
-		AddBone(TEXT("ring_01_r"), TEXT("hand_r"), FVector(-11.497885, 1.753527, -2.846912));
-		AddBoneToLast(TEXT("ring_02_r"), FVector(-4.430177, 0, 0));
-		AddBoneToLast(TEXT("ring_03_r"), FVector(-3.476652, 0, 0));
-		AddBone(TEXT("pinky_01_r"), TEXT("hand_r"), FVector(-10.140665, 2.263151, -4.643148));
-		AddBoneToLast(TEXT("pinky_02_r"), FVector(-3.570981, 0, 0));
-		AddBoneToLast(TEXT("pinky_03_r"), FVector(-2.985631, 0, 0));
-		AddBone(TEXT("thumb_01_r"), TEXT("hand_r"), FVector(-4.762036, 2.374981, 2.53782));
-		AddBoneToLast(TEXT("thumb_02_r"), FVector(-3.869672, 0, 0));
-		AddBoneToLast(TEXT("thumb_03_r"), FVector(-4.062171, 0, 0));
-	}
-	numHandJoints = (jointNames.Num() - numBodyJoints) / 2;
+	// the cached pose and the component rotations stay in the rig's own convention, as joints missing from later frames are rebuilt from them
+	TArray<FTransform>& transforms = data.Transforms;
+	// derived subjects convert the decoded pose before the subject's own remapping, so no frame is decoded twice
+	for (int32 i = 0; i < derivedFrames.Num(); ++i) {
+		FLiveLinkAnimationFrameData& derivedFrame = derivedFrames[i];
+		derivedFrame.WorldTime = data.WorldTime;
+		derivedFrame.Transforms.Reset();
+		derivedFrame.Transforms.Append(transforms);
+		if (const FPoseAIRemapTable* derivedRemap = (*activeDerived)[i].Remap.Get())
+			ApplyRemapTable(*derivedRemap, derivedFrame.Transforms);
+	}
+	const FPoseAIRemapTable* remap = activeRemap.Get();
+	if (remap != nullptr)
+		ApplyRemapTable(*remap, transforms);
+
+	const int32 numJoints = FMath::Min3(transforms.Num(), scratchComponentRotations.Num(), FPoseAIDirectPoseFrame::MaxJoints);
+	directPose.WriteInPlace([&](FPoseAIDirectPoseFrame& frame) {
+		frame.NumJoints = numJoints;
+		frame.RemapGeneration = remap != nullptr ? remap->Generation : 0;
+		frame.Timestamp = liveValues.timestamp;
+		frame.WorldTime = data.WorldTime.GetSourceTime();
+		frame.RootTranslation = numJoints > 0 ? transforms[0].GetTranslation() : FVector::ZeroVector;
+		for (int32 i = 0; i < numJoints; ++i)
+			frame.LocalRotations[i] = transforms[i].GetRotation();
+		if (remap != nullptr) {
+			for (int32 i = 0; i < numJoints; ++i)
+				frame.ComponentRotations[i] = scratchComponentRotations[i] * remap->Joints[i].RotAdj;
+		}
+		else
+			FMemory::Memcpy(frame.ComponentRotations, scratchComponentRotations.GetData(), numJoints * sizeof(FQuat));
+	});
+	return true;
+}
 
-	rig = MakeStaticData();
+void PoseAIRig::ReserveScratch() {
+	const int32 numJoints = numBodyJoints + 2 * numHandJoints;
+	scratchComponentRotations.Reserve(numJoints);
+	scratchQuats.Reserve(FMath::Max(numBodyJoints, numHandJoints));
+	cachedPoses[0].Reserve(numJoints);
+	cachedPoses[1].Reserve(numJoints);
+	scratchVerboseRotations.SetNumUninitialized(jointNames.Num());
+	scratchVerboseFound.SetNumZeroed(jointNames.Num());
+	scratchCapacity = ScratchCapacity();
 }
 
+int64 PoseAIRig::ScratchCapacity() const {
+	return (int64)scratchComponentRotations.Max() + scratchQuats.Max() + cachedPoses[0].Max() + cachedPoses[1].Max() +
+		scratchVerboseRotations.Max() + scratchVerboseFound.Max();
+}
 
-void PoseAIRigMixamo::Configure()
-{
-	jointNames.Empty();
-	boneVectors.Empty();
-	parentIndices.Empty();
-	AddBone(TEXT("root"), TEXT("root"), FVector(0.0, 0, 0.0));
-	AddBoneToLast(TEXT("hips"), FVector(0.0, 0, 0.0));
-
-	AddBone(TEXT("RightUpLeg"), TEXT("hips"), FVector(-9.4, 5.0, 0));
-	AddBoneToLast(TEXT("RightLeg"), FVector(0, -44.5, 0));
-	AddBoneToLast(TEXT("RightFoot"), FVector(0.7, -35.0, -2.4));
-	AddBoneToLast(TEXT("RightToeBase"), FVector(-0.7, -17.8, -5.8));
-
-	AddBone(TEXT("LeftUpLeg"), TEXT("hips"), FVector(9.4, 5.0, 0));
-	AddBoneToLast(TEXT("LeftLeg"), FVector(-0, -44.5, 0));
-	AddBoneToLast(TEXT("LeftFoot"), FVector(-0.7, -35.0, -2.4));
-	AddBoneToLast(TEXT("LeftToeBase"), FVector(0.7, -17.8, -5.8));
-
-	AddBone(TEXT("Spine"), TEXT("hips"), FVector(0, -9.0, -0.3));
-	AddBoneToLast(TEXT("Spine1"), FVector(0, -10.5, 0));
-	AddBoneToLast(TEXT("Spine2"), FVector(0, -12.0, 0));
-	AddBoneToLast(TEXT("Neck"), FVector(0, -13.5, 0));
-	AddBoneToLast(TEXT("Head"), FVector(0, -8.2, 2.1));
-
-	AddBone(TEXT("LeftShoulder"), TEXT("Spine2"), FVector(5.7, -11.8, 0));
-	AddBoneToLast(TEXT("LeftArm"), FVector(0, -12.0, 0));
-	AddBoneToLast(TEXT("LeftForeArm"), FVector(0, -25.7, 0));
-
-	AddBone(TEXT("RightShoulder"), TEXT("Spine2"), FVector(-5.7, -11.8, 0));
-	AddBoneToLast(TEXT("RightArm"), FVector(0, -12.0, 0));
-	AddBoneToLast(TEXT("RightForeArm"), FVector(0, -25.7, 0));
-
-	numBodyJoints = jointNames.Num();
-	if (includeHands) {
-		AddBone(TEXT("LeftHand"), TEXT("LeftForeArm"), FVector(0, -23.0, 0));
-		AddBone(TEXT("LeftForeArmTwist"), TEXT("LeftForeArm"), FVector(0, -14.0, 0));
-		
-		AddBone(TEXT("LeftHandIndex1"), TEXT("LeftHand"), FVector(-3.3, -8.3, 0.1));
-		AddBoneToLast(TEXT("LeftHandIndex2"), FVector(0, -3.1, 0));
-		AddBoneToLast(TEXT("LeftHandIndex3"), FVector(0, -2.9, 0));
-		AddBone(TEXT("LeftHandMiddle1"), TEXT("LeftHand"), FVector(-0.9, -8.5, -0.1));
-		AddBoneToLast(TEXT("LeftHandMiddle2"), FVector(0, -3.3, 0));
-		AddBoneToLast(TEXT("LeftHandMiddle3"), FVector(0, -3.1, 0));
-		AddBone(TEXT("LeftHandRing1"), TEXT("LeftHand"), FVector(1.1, -8.7, 0.2));
-		AddBoneToLast(TEXT("LeftHandRing2"), FVector(0, -2.7, 0));
-		AddBoneToLast(TEXT("LeftHandRing3"), FVector(0, -2.7, 0));
-		AddBone(TEXT("LeftHandPinky1"), TEXT("LeftHand"), FVector(3.1, -8.0, 0.2));
-		AddBoneToLast(TEXT("LeftHandPinky2"), FVector(0, -2.5, 0));
-		AddBoneToLast(TEXT("LeftHandPinky3"), FVector(0, -2.0, 0));
-		AddBone(TEXT("LeftHandThumb1"), TEXT("LeftHand"), FVector(-2.9, -2.6, 1.2));
-		AddBoneToLast(TEXT("LeftHandThumb2"), FVector(-0.7, -3.2, 0));
-		AddBoneToLast(TEXT("LeftHandThumb3"), FVector(0.2, -3.0, 0));
-
-		AddBone(TEXT("RightHand"), TEXT("RightForeArm"), FVector(0, -23.0, 0));
-		AddBone(TEXT("RightForeArmTwist"), TEXT("RightForeArm"), FVector(0, -14.0, 0));
-		AddBone(TEXT("RightHandIndex1"), TEXT("RightHand"), FVector(3.3, -8.3, 0.1));
-		AddBoneToLast(TEXT("RightHandIndex2"), FVector(0, -3.1, 0));
-		AddBoneToLast(TEXT("RightHandIndex3"), FVector(0, -2.9, 0));
-		AddBone(TEXT("RightHandMiddle1"), TEXT("RightHand"), FVector(0.9, -8.5, -0.1));
-		AddBoneToLast(TEXT("RightHandMiddle2"), FVector(0, -3.3, 0));
-		AddBoneToLast(TEXT("RightHandMiddle3"), FVector(0, -3.1, 0));
-		AddBone(TEXT("RightHandRing1"), TEXT("RightHand"), FVector(-1.1, -8.7, 0.2));
-		AddBoneToLast(TEXT("RightHandRing2"), FVector(0, -2.7, 0));
-		AddBoneToLast(TEXT("RightHandRing3"), FVector(0, -2.7, 0));
-		AddBone(TEXT("RightHandPinky1"), TEXT("RightHand"), FVector(-3.1, -8.0, 0.2));
-		AddBoneToLast(TEXT("RightHandPinky2"), FVector(0, -2.5, 0));
-		AddBoneToLast(TEXT("RightHandPinky3"), FVector(0, -2.0, 0));
-		AddBone(TEXT("RightHandThumb1"), TEXT("RightHand"), FVector(2.9, -2.6, 1.2));
-		AddBoneToLast(TEXT("RightHandThumb2"), FVector(0.7, -3.2, 0));
-		AddBoneToLast(TEXT("RightHandThumb3"), FVector(-0.2, -3.0, 0));
-	}
-	numHandJoints = (jointNames.Num() - numBodyJoints) / 2;
-	rig = MakeStaticData();
+void PoseAIRig::CheckScratchGrowth() {
+	const int64 capacity = ScratchCapacity();
+	if (capacity != scratchCapacity) {
+		scratchCapacity = capacity;
+		++scratchGrowths;
+	}
 }
 
-void PoseAIRigMixamoAlt::Configure()
+void PoseAIRig::Configure() {}
+
+template <typename TRigTraits>
+void TPoseAIRig<TRigTraits>::Configure()
 {
-	jointNames.Empty();
-	boneVectors.Empty();
-	parentIndices.Empty();
-	AddBone(TEXT("root"), TEXT("root"), FVector(0.0, 0, 0.0));
-	AddBoneToLast(TEXT("hips"), FVector(0.0, 0, 0.0));
-
-	AddBone(TEXT("RightUpLeg"), TEXT("hips"), FVector(-9.4, 5.0, 0));
-	AddBoneToLast(TEXT("RightLeg"), FVector(0, 44.5, 0));
-	AddBoneToLast(TEXT("RightFoot"), FVector(0.7, 35.0, -2.4));
-	AddBoneToLast(TEXT("RightToeBase"), FVector(0, 11.0, 13.0));
-
-	AddBone(TEXT("LeftUpLeg"), TEXT("hips"), FVector(9.4, 5.0, 0));
-	AddBoneToLast(TEXT("LeftLeg"), FVector(-0, 44.5, 0));
-	AddBoneToLast(TEXT("LeftFoot"), FVector(-0.7, 35.0, -2.4));
-	AddBoneToLast(TEXT("LeftToeBase"), FVector(0, 11.0, 13.0));
-
-	AddBone(TEXT("Spine"), TEXT("hips"), FVector(0, -9.0, -0.3));
-	AddBoneToLast(TEXT("Spine1"), FVector(0, -10.5, 0));
-	AddBoneToLast(TEXT("Spine2"), FVector(0, -12.0, 0));
-	AddBoneToLast(TEXT("Neck"), FVector(0, -13.5, 0));
-	AddBoneToLast(TEXT("Head"), FVector(0, -8.2, 2.1));
-
-	AddBone(TEXT("LeftShoulder"), TEXT("Spine2"), FVector(5.7, -11.8, 0));
-	AddBoneToLast(TEXT("LeftArm"), FVector(12.0,0, 0));
-	AddBoneToLast(TEXT("LeftForeArm"), FVector(25.7,0, 0));
-
-	AddBone(TEXT("RightShoulder"), TEXT("Spine2"), FVector(-5.7, -11.8, 0));
-	AddBoneToLast(TEXT("RightArm"), FVector(-12.0,0, 0	));
-	AddBoneToLast(TEXT("RightForeArm"), FVector(-25.7,0, 0));
-
-	numBodyJoints = jointNames.Num();
-	if (includeHands) {
-		AddBone(TEXT("LeftHand"), TEXT("LeftForeArm"), FVector(23.0, 0, 0));
-		AddBone(TEXT("LeftForeArmTwist"), TEXT("LeftForeArm"), FVector(14.0,0, 0));
-
-		AddBone(TEXT("LeftHandIndex1"), TEXT("LeftHand"), FVector(-3.3, -8.3, 0.1));
-		AddBoneToLast(TEXT("LeftHandIndex2"), FVector(0, -3.1, 0));
-		AddBoneToLast(TEXT("LeftHandIndex3"), FVector(0, -2.9, 0));
-		AddBone(TEXT("LeftHandMiddle1"), TEXT("LeftHand"), FVector(-0.9, -8.5, -0.1));
-		AddBoneToLast(TEXT("LeftHandMiddle2"), FVector(0, -3.3, 0));
-		AddBoneToLast(TEXT("LeftHandMiddle3"), FVector(0, -3.1, 0));
-		AddBone(TEXT("LeftHandRing1"), TEXT("LeftHand"), FVector(1.1, -8.7, 0.2));
-		AddBoneToLast(TEXT("LeftHandRing2"), FVector(0, -2.7, 0));
-		AddBoneToLast(TEXT("LeftHandRing3"), FVector(0, -2.7, 0));
-		AddBone(TEXT("LeftHandPinky1"), TEXT("LeftHand"), FVector(3.1, -8.0, 0.2));
-		AddBoneToLast(TEXT("LeftHandPinky2"), FVector(0, -2.5, 0));
-		AddBoneToLast(TEXT("LeftHandPinky3"), FVector(0, -2.0, 0));
-		AddBone(TEXT("LeftHandThumb1"), TEXT("LeftHand"), FVector(-2.9, -2.6, 1.2));
-		AddBoneToLast(TEXT("LeftHandThumb2"), FVector(-0.7, -3.2, 0));
-		AddBoneToLast(TEXT("LeftHandThumb3"), FVector(0.2, -3.0, 0));
-
-		AddBone(TEXT("RightHand"), TEXT("RightForeArm"), FVector(-23.0,0,  0));
-		AddBone(TEXT("RightForeArmTwist"), TEXT("RightForeArm"), FVector(-14.0,0, 0));
-		AddBone(TEXT("RightHandIndex1"), TEXT("RightHand"), FVector(3.3, -8.3, 0.1));
-		AddBoneToLast(TEXT("RightHandIndex2"), FVector(0, -3.1, 0));
-		AddBoneToLast(TEXT("RightHandIndex3"), FVector(0, -2.9, 0));
-		AddBone(TEXT("RightHandMiddle1"), TEXT("RightHand"), FVector(0.9, -8.5, -0.1));
-		AddBoneToLast(TEXT("RightHandMiddle2"), FVector(0, -3.3, 0));
-		AddBoneToLast(TEXT("RightHandMiddle3"), FVector(0, -3.1, 0));
-		AddBone(TEXT("RightHandRing1"), TEXT("RightHand"), FVector(-1.1, -8.7, 0.2));
-		AddBoneToLast(TEXT("RightHandRing2"), FVector(0, -2.7, 0));
-		AddBoneToLast(TEXT("RightHandRing3"), FVector(0, -2.7, 0));
-		AddBone(TEXT("RightHandPinky1"), TEXT("RightHand"), FVector(-3.1, -8.0, 0.2));
-		AddBoneToLast(TEXT("RightHandPinky2"), FVector(0, -2.5, 0));
-		AddBoneToLast(TEXT("RightHandPinky3"), FVector(0, -2.0, 0));
-		AddBone(TEXT("RightHandThumb1"), TEXT("RightHand"), FVector(2.9, -2.6, 1.2));
-		AddBoneToLast(TEXT("RightHandThumb2"), FVector(0.7, -3.2, 0));
-		AddBoneToLast(TEXT("RightHandThumb3"), FVector(-0.2, -3.0, 0));
-	}
-	numHandJoints = (jointNames.Num() - numBodyJoints) / 2;
+	static_assert(UE_ARRAY_COUNT(TRigTraits::Joints) == NumJoints, "rig table must hold the body joints and both hands");
+	static_assert(NumJoints <= FPoseAIDirectPoseFrame::MaxJoints, "direct pose frame must fit every rig");
+	rShinJoint = TRigTraits::RShinJoint;
+	lShinJoint = TRigTraits::LShinJoint;
+	lowerBodyNumOfJoints = TRigTraits::LowerBodyNumOfJoints;
+	numBodyJoints = TRigTraits::NumBodyJoints;
+	numHandJoints = includeHands ? TRigTraits::NumHandJoints : 0;
+
+	const int32 numJoints = numBodyJoints + 2 * numHandJoints;
+	jointNames.Reset(numJoints);
+	parentIndices.Reset(numJoints);
+	boneTranslations.Reset(numJoints);
+	for (int32 i = 0; i < numJoints; ++i) {
+		const FPoseAIJointDef& joint = TRigTraits::Joints[i];
+		jointNames.Emplace(joint.Name);
+		parentIndices.Emplace(joint.Parent);
+		boneTranslations.Emplace(joint.X, joint.Y, joint.Z);
+	}
+	jointNameIndex.Build(jointNames);
 	rig = MakeStaticData();
 }
 
+template <typename TRigTraits>
+void TPoseAIRig<TRigTraits>::AppendCachedRotations(int32 begin, int32 end, TArray<FQuat>& componentRotations, FLiveLinkAnimationFrameData& data) {
+	end = FMath::Min(end, jointNames.Num());
+	const TArray<FTransform>& cachedPose = CachedPose();
+	for (int32 i = begin; i < end; i++) {
+		const FPoseAIJointDef& joint = TRigTraits::Joints[i];
+		const FQuat parentQuat = (joint.Parent < 0 ? FQuat::Identity : componentRotations[joint.Parent]);
+		const FQuat rotation = (cachedPose.Num() > i) ? parentQuat * cachedPose[i].GetRotation() : FQuat::Identity;
+		componentRotations.Add(rotation);
+		FQuat finalRotation = parentQuat.Inverse() * rotation;
+		finalRotation.Normalize();
+		data.Transforms.Emplace(finalRotation, FVector(joint.X, joint.Y, joint.Z), FVector::OneVector);
+	}
+}
 
+template class TPoseAIRig<FPoseAIRigTraitsUE4>;
+template class TPoseAIRig<FPoseAIRigTraitsMixamo>;
+template class TPoseAIRig<FPoseAIRigTraitsMixamoAlt>;
+template class TPoseAIRig<FPoseAIRigTraitsMetaHuman>;
+template class TPoseAIRig<FPoseAIRigTraitsDazUE>;
+
+
+/*
+* Console check that steady state rig processing reuses its buffers: every rig preset processes a synthetic compact frame repeatedly, with
+* every body and hand field filled and event counts that change each frame, and reports any growth of the rig's scratch and cached pose
+* buffers or of the output transforms after the first frame.  It measures buffer capacity, so allocations made and freed within a frame
+* do not show; run it under a memory profiler for those.
+*/
+static void RunRigBufferGrowthCheck(const TArray<FString>& args) {
+	const int32 frames = (args.Num() > 0) ? FMath::Max(2, FCString::Atoi(*args[0])) : 1000;
+	static const ANSICHAR alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	// a value in [-1, 1] as the two character fixed point of the compact format
+	auto appendFixed = [](TArray<UTF8CHAR>& out, float value) {
+		const int32 fixed = FMath::Clamp(FMath::RoundToInt((value + 1.0f) * 2047.0f), 0, 4095);
+		out.Add((UTF8CHAR)alphabet[fixed >> 6]);
+		out.Add((UTF8CHAR)alphabet[fixed & 63]);
+	};
+	auto appendUint = [](TArray<UTF8CHAR>& out, uint32 value, int32 digits) {
+		for (int32 digit = digits - 1; digit >= 0; --digit)
+			out.Add((UTF8CHAR)alphabet[(value >> (6 * digit)) & 63]);
+	};
+	auto appendQuats = [&appendFixed](TArray<UTF8CHAR>& out, int32 count, int32 seed) {
+		for (int32 i = 0; i < count; ++i) {
+			const float angle = 0.3f * FMath::Sin((float)(seed + i));
+			appendFixed(out, FMath::Sin(angle * 0.5f));
+			appendFixed(out, 0.0f);
+			appendFixed(out, 0.0f);
+			appendFixed(out, FMath::Cos(angle * 0.5f));
+		}
+	};
+
+	const EPoseAiRigPresets presets[] = { EPoseAiRigPresets::MetaHuman, EPoseAiRigPresets::UE4, EPoseAiRigPresets::Mixamo, EPoseAiRigPresets::DazUE, EPoseAiRigPresets::MixamoAlt };
+	for (EPoseAiRigPresets preset : presets) {
+		FPoseAIHandshake handshake;
+		handshake.rig = preset;
+		const FLiveLinkSubjectName subjectName(FName(TEXT("PoseAI.RigBufferGrowthCheck")));
+		TSharedPtr<PoseAIRig, ESPMode::ThreadSafe> rig = PoseAIRig::MakeDetachedRig(subjectName, handshake);
+
+		// every string is laid out before views are taken, as appending may move the storage
+		TArray<UTF8CHAR> storage;
+		appendQuats(storage, rig->NumBodyJoints() - 1, 0);
+		const int32 bodyLen = storage.Num();
+		appendQuats(storage, rig->NumHandJoints(), 50);
+		appendQuats(storage, rig->NumHandJoints(), 90);
+		const int32 handLen = (storage.Num() - bodyLen) / 2;
+		const int32 scalarsStart = storage.Num();
+		// body height, chest yaw and stance yaw, then stable feet, hand zones and crouching
+		for (int32 i = 0; i < 3; ++i)
+			appendFixed(storage, 0.1f * i);
+		for (int32 i = 0; i < 4; ++i)
+			appendUint(storage, i & 1, 2);
+		const int32 vectorsStart = storage.Num();
+		// lean, hip and chest screen, hand IK and root, foot IK
+		for (int32 i = 0; i < 21; ++i)
+			appendFixed(storage, 0.05f * (i % 7));
+		const int32 pointsStart = storage.Num();
+		for (int32 i = 0; i < 8; ++i)
+			appendFixed(storage, 0.1f * (i % 4));
+		const int32 eventsStart = storage.Num();
+		// nine events of a three character count and a two character value, rewritten in place every frame
+		const int32 numEvents = 9;
+		for (int32 i = 0; i < numEvents; ++i) {
+			appendUint(storage, 0, 3);
+			appendFixed(storage, 0.0f);
+		}
+		static const ANSICHAR visible[] = "111111";
+
+		FPoseAICompactFrame frame;
+		frame.bHasModelLatency = true;
+		frame.ModelLatency = 20;
+		frame.bHasBody = true;
+		frame.RotA = FUtf8StringView(storage.GetData(), bodyLen);
+		frame.ScaA = FUtf8StringView(storage.GetData() + scalarsStart, vectorsStart - scalarsStart);
+		frame.VecA = FUtf8StringView(storage.GetData() + vectorsStart, pointsStart - vectorsStart);
+		frame.EveA = FUtf8StringView(storage.GetData() + eventsStart, storage.Num() - eventsStart);
+		frame.VisA = FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(visible), UE_ARRAY_COUNT(visible) - 1);
+		FPoseAICompactHand* hands[2] = { &frame.LeftHand, &frame.RightHand };
+		for (int32 h = 0; h < 2; ++h) {
+			hands[h]->bPresent = true;
+			hands[h]->RotA = FUtf8StringView(storage.GetData() + bodyLen + h * handLen, handLen);
+			hands[h]->Point = FUtf8StringView(storage.GetData() + pointsStart, 8);
+			hands[h]->bHasOpen = true;
+			hands[h]->Open = 0.5f;
+		}
 
-void PoseAIRigMetaHuman::Configure()
-{
-	jointNames.Empty();
-	boneVectors.Empty();
-	parentIndices.Empty();
-
-	AddBone(TEXT("root"), TEXT("root"), FVector(0.0, 0, 0.0));
-	AddBoneToLast(TEXT("pelvis"), FVector(0.0, 0, 0.0));
-
-	AddBone(TEXT("thigh_r"), TEXT("pelvis"), FVector(-2.3, 0.4, 9.27));
-	AddBoneToLast(TEXT("calf_r"), FVector(41.2, 0, 0));
-	AddBoneToLast(TEXT("foot_r"), FVector(40.0, 0, 0));
-	AddBoneToLast(TEXT("ball_r"), FVector(7.1, -14.4, -0.4));
-
-	AddBone(TEXT("thigh_l"), TEXT("pelvis"), FVector(-2.3, 0.4, -9.27));
-	AddBoneToLast(TEXT("calf_l"), FVector(-41.2, 0, 0));
-	AddBoneToLast(TEXT("foot_l"), FVector(-40.0, 0, 0));
-	AddBoneToLast(TEXT("ball_l"), FVector(-7.1, 14.4, 0.4));
-
-	AddBone(TEXT("spine_01"), TEXT("pelvis"), FVector(3.4, 0.0, 0));
-	AddBoneToLast(TEXT("spine_02"), FVector(6.3, 0.0, 0));
-	AddBoneToLast(TEXT("spine_03"), FVector(6.9, 0.0, 0));
-	AddBoneToLast(TEXT("spine_04"), FVector(8.1, 0.0, 0));
-	AddBoneToLast(TEXT("spine_05"), FVector(18.3, 0.0, 0));
-	AddBoneToLast(TEXT("neck_01"), FVector(11.6, 1.0, 0));
-	AddBoneToLast(TEXT("neck_02"), FVector(5.0, 0, 0));
-	AddBoneToLast(TEXT("head"), FVector(5.0, 0, 0));
-
-	AddBone(TEXT("clavicle_l"), TEXT("spine_05"), FVector(5.5, -0.7, -1.2));
-	AddBoneToLast(TEXT("upperarm_l"), FVector(17.0, 0, 0));
-	AddBoneToLast(TEXT("lowerarm_l"), FVector(27.0, 0, 0));
-
-	AddBone(TEXT("clavicle_r"), TEXT("spine_05"), FVector(5.5, -0.7, 1.2));
-	AddBoneToLast(TEXT("upperarm_r"), FVector(-17.0, 0, 0));
-	AddBoneToLast(TEXT("lowerarm_r"), FVector(-27.0, 0, 0));
-
-	numBodyJoints = jointNames.Num();
-	if (includeHands) {
-		AddBone(TEXT("hand_l"), TEXT("lowerarm_l"), FVector(25.2, 0, 0));		
-		AddBone(TEXT("lowerarm_twist_01_l"), TEXT("lowerarm_l"), FVector(14.0, 0, 0));
-		AddBone(TEXT("lowerarm_twist_02_l"), TEXT("lowerarm_l"), FVector(7.0, 0, 0));
-		
-		AddBone(TEXT("index_metacarpal_l"), TEXT("hand_l"), FVector(3.5, 0.4, -2.1));
-		AddBoneToLast(TEXT("index_01_l"), FVector(5.9, 0.1, 0.3));
-		AddBoneToLast(TEXT("index_02_l"), FVector(3.6, 0, 0));
-		AddBoneToLast(TEXT("index_03_l"), FVector(2.4, 0, 0));
-		AddBone(TEXT("middle_metacarpal_l"), TEXT("hand_l"), FVector(3.3, 0.3, -0.1));
-		AddBoneToLast(TEXT("middle_01_l"), FVector(6.1, 0, 0.2));
-		AddBoneToLast(TEXT("middle_02_l"), FVector(4.3, 0, 0));
-		AddBoneToLast(TEXT("middle_03_l"), FVector(2.6, 0, 0));
-		AddBone(TEXT("ring_metacarpal_l"), TEXT("hand_l"), FVector(3.2, -0.2, 1.2));
-		AddBoneToLast(TEXT("ring_01_l"), FVector(6.0, 0.2, 0.4));
-		AddBoneToLast(TEXT("ring_02_l"), FVector(3.6, 0, 0));
-		AddBoneToLast(TEXT("ring_03_l"), FVector(2.5, 0, 0));
-		AddBone(TEXT("pinky_metacarpal_l"), TEXT("hand_l"), FVector(3.1, -0.7, 2.4));
-		AddBoneToLast(TEXT("pinky_01_l"), FVector(5.1, 0.1, 0.1));
-		AddBoneToLast(TEXT("pinky_02_l"), FVector(3.3, 0, 0));
-		AddBoneToLast(TEXT("pinky_03_l"), FVector(1.8, 0, 0));
-		AddBone(TEXT("thumb_01_l"), TEXT("hand_l"), FVector(2.0, -1.0, -2.6));
-		AddBoneToLast(TEXT("thumb_02_l"), FVector(4.4, 0, 0));
-		AddBoneToLast(TEXT("thumb_03_l"), FVector(2.7, 0, 0));
-
-		AddBone(TEXT("hand_r"), TEXT("lowerarm_r"), FVector(-25.2, 0, 0));
-		AddBone(TEXT("lowerarm_twist_01_r"), TEXT("lowerarm_r"), FVector(-14.0, 0, 0));
-		AddBone(TEXT("lowerarm_twist_02_r"), TEXT("lowerarm_r"), FVector(-7.0, 0, 0));
-		AddBone(TEXT("index_metacarpal_r"), TEXT("hand_r"), FVector(-3.5, -0.4, 2.1));
-		AddBoneToLast(TEXT("index_01_r"), FVector(-5.9, 0.1, 0.3));
-		AddBoneToLast(TEXT("index_02_r"), FVector(-3.6, 0, 0));
-		AddBoneToLast(TEXT("index_03_r"), FVector(-2.4, 0, 0));
-		AddBone(TEXT("middle_metacarpal_r"), TEXT("hand_r"), FVector(-3.3, -0.3, 0.1));
-		AddBoneToLast(TEXT("middle_01_r"), FVector(-6.1, 0, 0.2));
-		AddBoneToLast(TEXT("middle_02_r"), FVector(-4.3, 0, 0));
-		AddBoneToLast(TEXT("middle_03_r"), FVector(-2.6, 0, 0));
-		AddBone(TEXT("ring_metacarpal_r"), TEXT("hand_r"), FVector(-3.2, 0.2, -1.2));
-		AddBoneToLast(TEXT("ring_01_r"), FVector(-6.0, 0.2, 0.4));
-		AddBoneToLast(TEXT("ring_02_r"), FVector(-3.6, 0, 0));
-		AddBoneToLast(TEXT("ring_03_r"), FVector(-2.5, 0, 0));
-		AddBone(TEXT("pinky_metacarpal_r"), TEXT("hand_r"), FVector(-3.1, 0.7, -2.4));
-		AddBoneToLast(TEXT("pinky_01_r"), FVector(-5.1, 0.1, 0.1));
-		AddBoneToLast(TEXT("pinky_02_r"), FVector(-3.3, 0, 0));
-		AddBoneToLast(TEXT("pinky_03_r"), FVector(-1.8, 0, 0));
-		AddBone(TEXT("thumb_01_r"), TEXT("hand_r"), FVector(-2.0, 1.0, 2.6));
-		AddBoneToLast(TEXT("thumb_02_r"), FVector(-4.4, 0, 0));
-		AddBoneToLast(TEXT("thumb_03_r"), FVector(-2.7, 0, 0));
-	}
-	numHandJoints = (jointNames.Num() - numBodyJoints) / 2;
-	rig = MakeStaticData();
+		FLiveLinkAnimationFrameData data;
+		TArray<UTF8CHAR> eventScratch;
+		int32 growthsAfterWarmup = 0;
+		int32 outputCapacity = 0;
+		int32 outputGrowths = 0;
+		for (int32 f = 0; f < frames; ++f) {
+			// each event fires once a frame, so the counts the rig compares change
+			eventScratch.Reset();
+			for (int32 i = 0; i < numEvents; ++i) {
+				appendUint(eventScratch, (uint32)f, 3);
+				appendFixed(eventScratch, 0.5f);
+			}
+			FMemory::Memcpy(storage.GetData() + eventsStart, eventScratch.GetData(), eventScratch.Num() * sizeof(UTF8CHAR));
+			frame.Timestamp = (double)f;
+			data.Transforms.Reset();
+			rig->ProcessFrame(frame, data);
+			if (f == 0) {
+				growthsAfterWarmup = rig->GetScratchGrowths();
+				outputCapacity = data.Transforms.Max();
+			}
+			else if (data.Transforms.Max() != outputCapacity) {
+				outputCapacity = data.Transforms.Max();
+				++outputGrowths;
+			}
+		}
+		const int32 scratchGrowths = rig->GetScratchGrowths() - growthsAfterWarmup;
+		UE_LOG(LogTemp, Display, TEXT("PoseAI LiveLink: %s rig, %d joints, %d frames: %d scratch buffer growths, %d output buffer growths after the first frame"),
+			*rig->RigType().ToString(), data.Transforms.Num(), frames, scratchGrowths, outputGrowths);
+		if (scratchGrowths > 0 || outputGrowths > 0)
+			UE_LOG(LogTemp, Error, TEXT("PoseAI LiveLink: %s rig grows its buffers in steady state"), *rig->RigType().ToString());
+	}
 }
 
-void PoseAIRigDazUE::Configure()
-{
-	//daz has extra joints in the legs
-	 rShinJoint = 5;
-	 lShinJoint = 10;
-	 lowerBodyNumOfJoints = 11;
-
-	jointNames.Empty();
-	boneVectors.Empty();
-	parentIndices.Empty();
-
-	AddBone(TEXT("root"), TEXT("root"), FVector(0.0, 0, 0.0));
-	AddBoneToLast(TEXT("hip"), FVector(0.0, -105.0, 0.0));
-	AddBoneToLast(TEXT("pelvis"), FVector(0.0, -1.8, 0.0));
-
-	AddBone(TEXT("rThighBend"), TEXT("pelvis"), FVector(-7.9, 10.6, -1.5));
-	AddBoneToLast(TEXT("rThighTwist"), FVector(0.0, 21, 0));
-	AddBoneToLast(TEXT("rShin"), FVector(0.0, 25.3, -1.2));
-	AddBoneToLast(TEXT("rFoot"), FVector(0.0, 42.8, 1));
-	AddBoneToLast(TEXT("rToe"), FVector(0.0, 0, 14.0));
-
-	AddBone(TEXT("lThighBend"), TEXT("pelvis"), FVector(7.9, 10.6, -1.5));
-	AddBoneToLast(TEXT("lThighTwist"), FVector(0.0, 21, 0));
-	AddBoneToLast(TEXT("lShin"), FVector(0.0, 25.3, -1.2));
-	AddBoneToLast(TEXT("lFoot"), FVector(0.0, 42.8, 1));
-	AddBoneToLast(TEXT("lToe"), FVector(0.0, 0.0, 14.0));
-
-	AddBone(TEXT("abdomenLower"), TEXT("hip"), FVector(0.0, -1.7, -1.5));
-	AddBoneToLast(TEXT("abdomenUpper"), FVector(0.0, -8.2, 1.2));
-	AddBoneToLast(TEXT("chestLower"), FVector(0.0, -7.9, -0.4));
-	AddBoneToLast(TEXT("chestUpper"), FVector(0.0, -13.1, -3.6));
-	AddBoneToLast(TEXT("neckLower"), FVector(0.0, -18.3, -1.5));
-	AddBoneToLast(TEXT("neckUpper"), FVector(0.0, -3.5, 1.5));
-	AddBoneToLast(TEXT("head"), FVector(0.0, -4.9, -0.5));
-
-	AddBone(TEXT("lCollar"), TEXT("chestUpper"), FVector(3.5, -10.9, -1.6));
-	AddBoneToLast(TEXT("lShldrBend"), FVector(11.9, 1.7, 0));
-	AddBoneToLast(TEXT("lShldrTwist"), FVector(11.6, 0, 0));
-	AddBoneToLast(TEXT("lForearmBend"), FVector(14.4, -0.2, -0.5));
-
-	AddBone(TEXT("rCollar"), TEXT("chestUpper"), FVector(-3.5, -10.9, -1.6));
-	AddBoneToLast(TEXT("rShldrBend"), FVector(-11.9, 1.7, 0));
-	AddBoneToLast(TEXT("rShldrTwist"), FVector(-11.6, 0, 0));
-	AddBoneToLast(TEXT("rForearmBend"), FVector(-14.4, -0.2, -0.5));
-
-	numBodyJoints = jointNames.Num();
-	if (includeHands) {
-		AddBone(TEXT("lForearmTwist"), TEXT("lForearmBend"), FVector(12.1, 0, 0));
-		AddBone(TEXT("lHand"), TEXT("lForearmTwist"), FVector(14.2, 0, -0.3));
-
-		AddBone(TEXT("lCarpal1"), TEXT("lHand"), FVector(0.4, -0.4, 1.1));
-		AddBoneToLast(TEXT("lIndex1"), FVector(7.6, -0.2, 0.1));
-		AddBoneToLast(TEXT("lIndex2"), FVector(3.9, 0, 0));
-		AddBoneToLast(TEXT("lIndex3"), FVector(2.1, 0, 0));
-		AddBone(TEXT("lCarpal2"), TEXT("lHand"), FVector(0.7, -0.4, 0.2));
-		AddBoneToLast(TEXT("lMid1"), FVector(7.5, -0.3, 0));
-		AddBoneToLast(TEXT("lMid2"), FVector(4.3, 0, 0));
-		AddBoneToLast(TEXT("lMid3"), FVector(2.5, 0, 0));
-		AddBone(TEXT("lCarpal3"), TEXT("lHand"), FVector(0.8, -0.4, -0.8));
-		AddBoneToLast(TEXT("lRing1"), FVector(6.9, -0.2, 0.0));
-		AddBoneToLast(TEXT("lRing2"), FVector(4.0, 0, 0));
-		AddBoneToLast(TEXT("lRing3"), FVector(2.2, 0, 0));
-		AddBone(TEXT("lCarpal4"), TEXT("lHand"), FVector(0.7, -0.4, 1.7));
-		AddBoneToLast(TEXT("lPinky1"), FVector(6.5, 0.2, 0));
-		AddBoneToLast(TEXT("lPinky2"), FVector(2.8, 0, 0));
-		AddBoneToLast(TEXT("lPinky3"), FVector(1.7, 0, 0));
-		AddBone(TEXT("lThumb1"), TEXT("lHand"), FVector(1.4, 0.7, 1.6));
-		AddBoneToLast(TEXT("lThumb2"), FVector(4.1, 0, 0));
-		AddBoneToLast(TEXT("lThumb3"), FVector(3.0, 0, 0));
-
-		AddBone(TEXT("rForearmTwist"), TEXT("rForearmBend"), FVector(-12.1, 0, 0));
-		AddBone(TEXT("rHand"), TEXT("rForearmTwist"), FVector(-14.2, 0, -0.3));
-
-		AddBone(TEXT("rCarpal1"), TEXT("rHand"), FVector(-0.4, -0.4, 1.1));
-		AddBoneToLast(TEXT("rIndex1"), FVector(-7.6, -0.2, 0.1));
-		AddBoneToLast(TEXT("rIndex2"), FVector(-3.9, 0, 0));
-		AddBoneToLast(TEXT("rIndex3"), FVector(-2.1, 0, 0));
-		AddBone(TEXT("rCarpal2"), TEXT("rHand"), FVector(0.7, -0.4, 0.2));
-		AddBoneToLast(TEXT("rMid1"), FVector(-7.5, -0.3, 0));
-		AddBoneToLast(TEXT("rMid2"), FVector(-4.3, 0, 0));
-		AddBoneToLast(TEXT("rMid3"), FVector(-2.5, 0, 0));
-		AddBone(TEXT("rCarpal3"), TEXT("rHand"), FVector(-0.8, -0.4, 0.8));
-		AddBoneToLast(TEXT("rRing1"), FVector(-6.9, -0.2, 0));
-		AddBoneToLast(TEXT("rRing2"), FVector(-4.0, 0, 0));
-		AddBoneToLast(TEXT("rRing3"), FVector(-2.2, 0, 0));
-		AddBone(TEXT("rCarpal4"), TEXT("rHand"), FVector(-0.7, -0.4, 1.7));
-		AddBoneToLast(TEXT("rPinky1"), FVector(-6.5, 0.2, 0));
-		AddBoneToLast(TEXT("rPinky2"), FVector(-2.8, 0, 0));
-		AddBoneToLast(TEXT("rPinky3"), FVector(-1.7, 0, 0));
-		AddBone(TEXT("rThumb1"), TEXT("rHand"), FVector(-1.4, 0.7, 1.6));
-		AddBoneToLast(TEXT("rThumb2"), FVector(-4.1, 0, 0));
-		AddBoneToLast(TEXT("rThumb3"), FVector(-3.0, 0, 0));
-	}
-	numHandJoints = (jointNames.Num() - numBodyJoints) / 2;
-	rig = MakeStaticData();
-}
+static FAutoConsoleCommand RigBufferGrowthCheckCommand(
+	TEXT("PoseAI.RigBufferGrowthCheck"),
+	TEXT("Verifies that every rig preset processes full compact frames without growing its scratch, cached pose or output buffers after the first frame.  Optional argument: frames"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunRigBufferGrowthCheck));
 
 #undef LOCTEXT_NAMESPACE
 
@@ -1,6 +1,11 @@
 // Copyright Pose AI Ltd 2022.  All Rights Reserved.
 
 #include "PoseAIStructs.h"
+#include "PoseAIBinaryPacket.h"
+#include "PoseAIFixed12Decoder.h"
+#include "PoseAICompactFrame.h"
+#include "PoseAIVerboseFrame.h"
+#include "PoseAIJsonTokenizer.h"
 
 #define LOCTEXT_NAMESPACE "PoseAI"
 
@@ -23,9 +28,9 @@ float FixedB64pairToFloat(char a, char b) {
 }
 
 void FStringFixed12ToFloat(const FString& data, TArray<float>& flatArray) {
-    flatArray.Reserve(flatArray.Num() + data.Len() / 2);
-    for (int i = 0; i + 1 < data.Len(); i += 2)
-        flatArray.Add(FixedB64pairToFloat(data[i], data[i + 1]));
+    const int32 start = flatArray.Num();
+    flatArray.AddUninitialized(data.Len() / 2);
+    Fixed12DecodeFloats(*data, data.Len(), flatArray.GetData() + start);
 }
 
 void FlatArrayToQuats(const TArray<float>& flatArray, TArray<FQuat>& quatArray) {
@@ -153,6 +158,50 @@ FString FPoseAIHandshake::ToString() const {
 }
 
 
+bool FPoseAIHandshake::FromString(const FString& json) {
+    TSharedPtr<FJsonObject> root;
+    TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+    const TSharedPtr<FJsonObject>* fields;
+    if (!FJsonSerializer::Deserialize(reader, root) || !root.IsValid() || !root->TryGetObjectField(TEXT("HANDSHAKE"), fields))
+        return false;
+
+    // the enums are matched through the same strings ToString writes
+    FString value;
+    if ((*fields)->TryGetStringField(TEXT("rig"), value)) {
+        for (uint8 i = 0; i <= (uint8)EPoseAiRigPresets::MixamoAlt; ++i) {
+            rig = (EPoseAiRigPresets)i;
+            if (GetRigString() == value)
+                break;
+        }
+    }
+    if ((*fields)->TryGetStringField(TEXT("mode"), value)) {
+        for (uint8 i = 0; i <= (uint8)EPoseAiAppModes::PortraitBodyOnly; ++i) {
+            mode = (EPoseAiAppModes)i;
+            if (GetModeString() == value)
+                break;
+        }
+    }
+    if ((*fields)->TryGetStringField(TEXT("face"), value))
+        isFaceAnimating = value == YesNoString(true);
+    if ((*fields)->TryGetStringField(TEXT("mirror"), value))
+        isMirrored = value == YesNoString(true);
+    if ((*fields)->TryGetStringField(TEXT("locomotion"), value))
+        locomotionEvents = value == YesNoString(true);
+    (*fields)->TryGetStringField(TEXT("whoami"), whoami);
+    (*fields)->TryGetStringField(TEXT("signature"), signature);
+    (*fields)->TryGetNumberField(TEXT("syncFPS"), syncFPS);
+    (*fields)->TryGetNumberField(TEXT("cameraFPS"), cameraFPS);
+    int32 number;
+    if ((*fields)->TryGetNumberField(TEXT("modelVersion"), number))
+        bodyModelVersion = (EPoseAiBodyModel)FMath::Clamp(number - 2, 0, (int32)EPoseAiBodyModel::Version3);
+    if ((*fields)->TryGetNumberField(TEXT("handModelVersion"), number))
+        handModelVersion = (EPoseAiHandModel)FMath::Clamp(number - 1, 0, (int32)EPoseAiHandModel::Version2_EXPERIMENTAL);
+    if ((*fields)->TryGetNumberField(TEXT("packetFormat"), number))
+        packetFormat = (EPoseAiPacketFormat)FMath::Clamp(number, 0, (int32)EPoseAiPacketFormat::Binary);
+    return true;
+}
+
+
 bool FPoseAIHandshake::operator==(const FPoseAIHandshake& Other) const
 {
     return rig == Other.rig && mode == Other.mode && syncFPS == Other.syncFPS && cameraFPS == Other.cameraFPS && isMirrored == Other.isMirrored && packetFormat == Other.packetFormat;
@@ -193,6 +242,38 @@ void FPoseAIGesturePair::ProcessCompact(const FString& compactString) {
     Current = UintB64ToUint(compactString[3], compactString[4]);
 }
 
+void FPoseAIEventPair::ProcessCompact(FUtf8StringView compactString) {
+    Count = UintB64ToUint((char)compactString[0], (char)compactString[1], (char)compactString[2]);
+    Magnitude = FixedB64pairToFloat((char)compactString[3], (char)compactString[4]);
+}
+
+void FPoseAIGesturePair::ProcessCompact(FUtf8StringView compactString) {
+    Count = UintB64ToUint((char)compactString[0], (char)compactString[1], (char)compactString[2]);
+    Current = UintB64ToUint((char)compactString[3], (char)compactString[4]);
+}
+
+void FPoseAIEventPair::ProcessBinary(uint32 count, uint32 value) {
+    Count = count;
+    Magnitude = FPoseAIBinaryPacket::Fixed12ToFloat(value);
+}
+
+void FPoseAIGesturePair::ProcessBinary(uint32 count, uint32 value) {
+    Count = count;
+    Current = value;
+}
+
+void FPoseAIEventStruct::ProcessBinaryBody(const uint8* eventData) {
+    // layout: number of events, then for each a little endian uint32 count and uint16 magnitude or gesture code, in the compact order
+    FPoseAIEventPairBase* binaryOrder[] = { &Footstep, &SidestepL, &SidestepR, &Jump, &FeetSplit, &ArmPump, &ArmFlex, &ArmGestureL, &ArmGestureR };
+    const int32 numEvents = FMath::Min<int32>(eventData[0], UE_ARRAY_COUNT(binaryOrder));
+    const uint8* entry = eventData + 1;
+    for (int32 i = 0; i < numEvents; ++i, entry += 6) {
+        uint32 count = (uint32)entry[0] | ((uint32)entry[1] << 8) | ((uint32)entry[2] << 16) | ((uint32)entry[3] << 24);
+        uint32 value = (uint32)entry[4] | ((uint32)entry[5] << 8);
+        binaryOrder[i]->ProcessBinary(count, value);
+    }
+}
+
 void FPoseAIEventStruct::ProcessCompactBody(const FString& compactString) {
     TArray<FPoseAIEventPairBase*> compactOrder = { &Footstep, &SidestepL, &SidestepR, &Jump, &FeetSplit, &ArmPump, &ArmFlex, &ArmGestureL, &ArmGestureR};
     if (compactString.Len() % 5 != 0) {
@@ -206,6 +287,17 @@ void FPoseAIEventStruct::ProcessCompactBody(const FString& compactString) {
     }
 }
 
+void FPoseAIEventStruct::ProcessCompactBody(FUtf8StringView compactString) {
+    FPoseAIEventPairBase* compactOrder[] = { &Footstep, &SidestepL, &SidestepR, &Jump, &FeetSplit, &ArmPump, &ArmFlex, &ArmGestureL, &ArmGestureR };
+    if (compactString.Len() % 5 != 0) {
+        UE_LOG(LogTemp, Warning, TEXT("PoseAILiveLink: Invalid event string of length %d."), compactString.Len());
+        return;
+    }
+    const int32 numEvents = FMath::Min<int32>(compactString.Len() / 5, UE_ARRAY_COUNT(compactOrder));
+    for (int32 i = 0; i < numEvents; ++i)
+        compactOrder[i]->ProcessCompact(compactString.Mid(i * 5, 5));
+}
+
 void  FPoseAIVisibilityFlags::ProcessCompact(const FString& visString) {
     hasChanged = false;
     SetAndCheckForChange(visString[0] != '0', isTorso, hasChanged);
@@ -217,108 +309,162 @@ void  FPoseAIVisibilityFlags::ProcessCompact(const FString& visString) {
         SetAndCheckForChange(visString[5] != '0', isFace, hasChanged);
 }
 
-void FPoseAILiveValues::ProcessCompactScalarsBody(const FString& compactString) {
+void FPoseAIVisibilityFlags::ProcessCompact(FUtf8StringView visString) {
+    hasChanged = false;
+    if (visString.Len() < 5)
+        return;
+    SetAndCheckForChange(visString[0] != '0', isTorso, hasChanged);
+    SetAndCheckForChange(visString[1] != '0', isLeftLeg, hasChanged);
+    SetAndCheckForChange(visString[2] != '0', isRightLeg, hasChanged);
+    SetAndCheckForChange(visString[3] != '0', isLeftArm, hasChanged);
+    SetAndCheckForChange(visString[4] != '0', isRightArm, hasChanged);
+    if (visString.Len() > 5)
+        SetAndCheckForChange(visString[5] != '0', isFace, hasChanged);
+}
+
+void FPoseAIVisibilityFlags::ProcessBinary(uint8 visBits) {
+    hasChanged = false;
+    SetAndCheckForChange((visBits & (1 << 0)) != 0, isTorso, hasChanged);
+    SetAndCheckForChange((visBits & (1 << 1)) != 0, isLeftLeg, hasChanged);
+    SetAndCheckForChange((visBits & (1 << 2)) != 0, isRightLeg, hasChanged);
+    SetAndCheckForChange((visBits & (1 << 3)) != 0, isLeftArm, hasChanged);
+    SetAndCheckForChange((visBits & (1 << 4)) != 0, isRightArm, hasChanged);
+    SetAndCheckForChange((visBits & (1 << 5)) != 0, isFace, hasChanged);
+}
+
+// shared by the FString (json DOM) and UTF-8 (compact tokenizer) paths
+template <typename StringType>
+static void ProcessCompactScalars(FPoseAILiveValues& values, const StringType& compactString) {
     int32 idx = 0;
     if(compactString.Len() < 14) return;
-    bodyHeight = FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) + 1.0f;
-    chestYaw = FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 180.0f;
-    stanceYaw = FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 180.0f;
-    stableFeet = UintB64ToUint(compactString[idx + 6], compactString[idx + 7]);
-    handZoneLeft = UintB64ToUint(compactString[idx + 8], compactString[idx + 9]);
-    handZoneRight = UintB64ToUint(compactString[idx + 10], compactString[idx + 11]);
-    isCrouching = UintB64ToUint(compactString[idx + 12], compactString[idx + 13]) > 0;
+    values.bodyHeight = FixedB64pairToFloat((char)compactString[idx], (char)compactString[idx + 1]) + 1.0f;
+    values.chestYaw = FixedB64pairToFloat((char)compactString[idx + 2], (char)compactString[idx + 3]) * 180.0f;
+    values.stanceYaw = FixedB64pairToFloat((char)compactString[idx + 4], (char)compactString[idx + 5]) * 180.0f;
+    values.stableFeet = UintB64ToUint((char)compactString[idx + 6], (char)compactString[idx + 7]);
+    values.handZoneLeft = UintB64ToUint((char)compactString[idx + 8], (char)compactString[idx + 9]);
+    values.handZoneRight = UintB64ToUint((char)compactString[idx + 10], (char)compactString[idx + 11]);
+    values.isCrouching = UintB64ToUint((char)compactString[idx + 12], (char)compactString[idx + 13]) > 0;
 }
 
-void FPoseAILiveValues::ProcessCompactVectorsBody(const FString& compactString) {
-    //tbd - this could be simplified if we don't need to keep supported older versions of the api
+template <typename StringType>
+static void ProcessCompactPoints(const StringType& Point, FVector2D& pointHand, FVector2D& pointThumb) {
     int32 idx = 0;
-    if (compactString.Len() < 12) return;
-    upperBodyLean.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 180.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 180.0f
-    );
-    idx += 4;
-    hipScreen.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx+1]),
-        FixedB64pairToFloat(compactString[idx+2], compactString[idx+3])
+    if (Point.Len() < idx + 4) return;
+    pointHand.Set(
+        FixedB64pairToFloat((char)Point[idx], (char)Point[idx + 1]),
+        FixedB64pairToFloat((char)Point[idx + 2], (char)Point[idx + 3])
     );
     idx += 4;
-    chestScreen.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]),
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3])
+    if (Point.Len() < idx + 4) return;
+    pointThumb.Set(
+        FixedB64pairToFloat((char)Point[idx], (char)Point[idx + 1]),
+        FixedB64pairToFloat((char)Point[idx + 2], (char)Point[idx + 3])
     );
-    idx += 4;
-    if (compactString.Len() < idx + 12) return;
+}
+
+void FPoseAILiveValues::ProcessCompactScalarsBody(const FString& compactString) {
+    ProcessCompactScalars(*this, compactString);
+}
+
+void FPoseAILiveValues::ProcessCompactScalarsBody(FUtf8StringView compactString) {
+    ProcessCompactScalars(*this, compactString);
+}
+
+void FPoseAILiveValues::ProcessCompactVectorsBody(const FString& compactString) {
+    TArray<float, TInlineAllocator<32>> values;
+    values.AddUninitialized(compactString.Len() / 2);
+    Fixed12DecodeFloats(*compactString, compactString.Len(), values.GetData());
+    ProcessVectorsBody(values);
+}
+
+void FPoseAILiveValues::ProcessCompactVectorsBody(FUtf8StringView compactString) {
+    TArray<float, TInlineAllocator<32>> values;
+    values.AddUninitialized(compactString.Len() / 2);
+    Fixed12DecodeFloats(compactString.GetData(), compactString.Len(), values.GetData());
+    ProcessVectorsBody(values);
+}
+
+void FPoseAILiveValues::ProcessVectorsBody(TArrayView<const float> values) {
+    //tbd - this could be simplified if we don't need to keep supported older versions of the api
+    int32 idx = 0;
+    if (values.Num() < 6) return;
+    upperBodyLean.Set(values[idx] * 180.0f, values[idx + 1] * 180.0f);
+    idx += 2;
+    hipScreen.Set(values[idx], values[idx + 1]);
+    idx += 2;
+    chestScreen.Set(values[idx], values[idx + 1]);
+    idx += 2;
+    if (values.Num() < idx + 6) return;
     //ik vector rescaled by 0.25f to fit in fixed point range for compact format, so need to be rescaled by 4.0f
-    handIkL.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 4.0f
-    );
-    idx += 6;
-    handIkR.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 4.0f
-    );
-    idx += 6;
-    if (compactString.Len() < idx + 18) return;
-    rootTranslation.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 4.0f
-    );
-    idx += 6;
-    footIkL.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 4.0f
-    );
-    idx += 6;
-    footIkR.Set(
-        FixedB64pairToFloat(compactString[idx], compactString[idx + 1]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 2], compactString[idx + 3]) * 4.0f,
-        FixedB64pairToFloat(compactString[idx + 4], compactString[idx + 5]) * 4.0f
-    );
-    idx += 6;
+    handIkL.Set(values[idx] * 4.0f, values[idx + 1] * 4.0f, values[idx + 2] * 4.0f);
+    idx += 3;
+    handIkR.Set(values[idx] * 4.0f, values[idx + 1] * 4.0f, values[idx + 2] * 4.0f);
+    idx += 3;
+    if (values.Num() < idx + 9) return;
+    rootTranslation.Set(values[idx] * 4.0f, values[idx + 1] * 4.0f, values[idx + 2] * 4.0f);
+    idx += 3;
+    footIkL.Set(values[idx] * 4.0f, values[idx + 1] * 4.0f, values[idx + 2] * 4.0f);
+    idx += 3;
+    footIkR.Set(values[idx] * 4.0f, values[idx + 1] * 4.0f, values[idx + 2] * 4.0f);
+    idx += 3;
+}
+
+void FPoseAILiveValues::ProcessBinaryScalarsBody(const uint8* scalarData) {
+    // layout: visibility bits, stable feet, hand zone left, hand zone right, crouching, padding, then packed fixed point values
+    stableFeet = scalarData[1];
+    handZoneLeft = scalarData[2];
+    handZoneRight = scalarData[3];
+    isCrouching = scalarData[4] > 0;
+    const uint8* packed = scalarData + 6;
+    bodyHeight = FPoseAIBinaryPacket::Fixed12ToFloat(FPoseAIBinaryPacket::UnpackUint12(packed, 0)) + 1.0f;
+    chestYaw = FPoseAIBinaryPacket::Fixed12ToFloat(FPoseAIBinaryPacket::UnpackUint12(packed, 1)) * 180.0f;
+    stanceYaw = FPoseAIBinaryPacket::Fixed12ToFloat(FPoseAIBinaryPacket::UnpackUint12(packed, 2)) * 180.0f;
+}
+
+void FPoseAILiveValues::ProcessBinaryVectorsHands(const uint8* handData) {
+    // layout: hand mask, then for each hand present six packed values: point x, y, thumb x, y, openness, padding
+    const uint8 mask = handData[0];
+    const uint8* packed = handData + 1;
+    auto value = [&packed](int32 idx) { return FPoseAIBinaryPacket::Fixed12ToFloat(FPoseAIBinaryPacket::UnpackUint12(packed, idx)); };
+    if (mask & 1) {
+        pointHandLeft.Set(value(0), value(1));
+        pointThumbLeft.Set(value(2), value(3));
+        opennessLeftHand = value(4);
+        packed += FPoseAIBinaryPacket::PackedSize(6);
+    }
+    if (mask & 2) {
+        pointHandRight.Set(value(0), value(1));
+        pointThumbRight.Set(value(2), value(3));
+        opennessRightHand = value(4);
+    }
 }
 
 void FPoseAILiveValues::ProcessCompactVectorsHandLeft(const TSharedPtr < FJsonObject > handObj) {
     FString Point = (handObj->HasTypedField<EJson::String>("Point")) ? handObj->GetStringField("Point") : "";
-    int32 idx = 0;
-    if (Point.Len() < idx + 4) return;
-    pointHandLeft.Set(
-        FixedB64pairToFloat(Point[idx], Point[idx + 1]),
-        FixedB64pairToFloat(Point[idx + 2], Point[idx + 3])
-    );
-    idx += 4;
-    if (Point.Len() < idx + 4) return;
-    pointThumbLeft.Set(
-        FixedB64pairToFloat(Point[idx], Point[idx + 1]),
-        FixedB64pairToFloat(Point[idx + 2], Point[idx + 3])
-    );
-    if (handObj->HasTypedField<EJson::Number>("Open")) 
+    ProcessCompactPoints(Point, pointHandLeft, pointThumbLeft);
+    if (Point.Len() >= 8 && handObj->HasTypedField<EJson::Number>("Open")) 
         opennessLeftHand = handObj->GetNumberField("Open");
 }
 
 void FPoseAILiveValues::ProcessCompactVectorsHandRight(const TSharedPtr < FJsonObject > handObj) {
     FString Point = (handObj->HasTypedField<EJson::String>("Point")) ? handObj->GetStringField("Point") : "";
-    int32 idx = 0;
-    if (Point.Len() < idx + 4) return;
-    pointHandRight.Set(
-        FixedB64pairToFloat(Point[idx], Point[idx + 1]),
-        FixedB64pairToFloat(Point[idx + 2], Point[idx + 3])
-    );
-    idx += 4;
-    if (Point.Len() < idx + 4) return;
-    pointThumbRight.Set(
-        FixedB64pairToFloat(Point[idx], Point[idx + 1]),
-        FixedB64pairToFloat(Point[idx + 2], Point[idx + 3])
-    );
-    if (handObj->HasTypedField<EJson::Number>("Open"))
+    ProcessCompactPoints(Point, pointHandRight, pointThumbRight);
+    if (Point.Len() >= 8 && handObj->HasTypedField<EJson::Number>("Open"))
         opennessRightHand = handObj->GetNumberField("Open");
 }
 
+void FPoseAILiveValues::ProcessCompactVectorsHandLeft(const FPoseAICompactHand& hand) {
+    ProcessCompactPoints(hand.Point, pointHandLeft, pointThumbLeft);
+    if (hand.Point.Len() >= 8 && hand.bHasOpen)
+        opennessLeftHand = hand.Open;
+}
+
+void FPoseAILiveValues::ProcessCompactVectorsHandRight(const FPoseAICompactHand& hand) {
+    ProcessCompactPoints(hand.Point, pointHandRight, pointThumbRight);
+    if (hand.Point.Len() >= 8 && hand.bHasOpen)
+        opennessRightHand = hand.Open;
+}
+
 
 void FPoseAIVisibilityFlags::ProcessVerbose(FPoseAIScalarStruct& scalars) {
     hasChanged = false;
@@ -333,16 +479,168 @@ void FPoseAIVisibilityFlags::ProcessVerbose(FPoseAIScalarStruct& scalars) {
 const FString FPoseAILiveValues::fieldPointScreen = FString(TEXT("PointScreen"));
 const FString FPoseAILiveValues::fieldThumbScreen = FString(TEXT("ThumbScreen"));
 
+/*
+* Direct field binders for the verbose sections, in place of FJsonObjectConverter which walks the reflection data and converts
+* every property name on every packet.  Each list names the fields once and the macros below expand it into an FJsonObject
+* lookup with a prebuilt key, or a tokenizer dispatch on the UTF-8 key.  Keys match case insensitively, as with the converter.
+*/
+#define POSEAI_VERBOSE_SCALAR_FIELDS(X) X(VisTorso) X(VisArmL) X(VisArmR) X(VisLegL) X(VisLegR) X(VisFace) \
+    X(HandZoneL) X(HandZoneR) X(ChestYaw) X(StanceYaw) X(BodyHeight) X(IsCrouching) X(StableFoot)
+#define POSEAI_VERBOSE_EVENT_FIELDS(X) X(Footstep) X(SidestepL) X(SidestepR) X(Jump) X(FeetSplit) X(ArmPump) X(ArmFlex) X(ArmGestureL) X(ArmGestureR)
+#define POSEAI_VERBOSE_VECTOR_FIELDS(X) X(HipLean) X(HipScreen) X(ChestScreen) X(HandIkL) X(HandIkR) X(Hip) X(FootIkL) X(FootIkR)
+
+// integers are truncated through int64, as the converter does
+static void AssignVerboseNumber(float& field, double value) { field = (float)value; }
+static void AssignVerboseNumber(int32& field, double value) { field = (int32)(int64)value; }
+static void AssignVerboseNumber(uint32& field, double value) { field = (uint32)(int64)value; }
+
+static void AssignVerboseArray(TArray<float>& field, const TArray<TSharedPtr<FJsonValue>>& values) {
+    field.Reset();
+    for (const TSharedPtr<FJsonValue>& value : values)
+        field.Add((float)value->AsNumber());
+}
+
+static bool ReadVerboseArray(FPoseAIJsonTokenizer& tokens, TArray<float>& field) {
+    double values[16];
+    int32 count;
+    if (!tokens.ReadNumberArray(values, UE_ARRAY_COUNT(values), count))
+        return false;
+    field.Reset();
+    for (int32 i = 0; i < FMath::Min(count, (int32)UE_ARRAY_COUNT(values)); ++i)
+        field.Add((float)values[i]);
+    return true;
+}
+
+/* a number field, or anything else skipped so one odd value does not stop the section */
+template <typename T>
+static bool ReadVerboseNumber(FPoseAIJsonTokenizer& tokens, T& field) {
+    double value;
+    if (!tokens.ReadNumber(value))
+        return tokens.SkipValue();
+    AssignVerboseNumber(field, value);
+    return true;
+}
+
+static FPoseAIJsonTokenizer VerboseTokens(FUtf8StringView json) {
+    return FPoseAIJsonTokenizer(reinterpret_cast<const uint8*>(json.GetData()), json.Len());
+}
+
+#define POSEAI_BIND_JSON_NUMBER(Object, Key, Field) \
+    { static const FString key(TEXT(#Key)); double number; \
+      if (const TSharedPtr<FJsonValue>* value = Object->Values.Find(key)) { if ((*value)->TryGetNumber(number)) AssignVerboseNumber(Field, number); } }
+#define POSEAI_BIND_TOKEN_NUMBER(Field) \
+    if (FPoseAIJsonTokenizer::KeyIsNoCase(key, #Field)) return ReadVerboseNumber(tokens, Field);
+
+
+static void ProcessVerbosePair(const TSharedPtr<FJsonObject>& pairObj, FPoseAIEventPair& pair) {
+    POSEAI_BIND_JSON_NUMBER(pairObj, Count, pair.Count)
+    POSEAI_BIND_JSON_NUMBER(pairObj, Magnitude, pair.Magnitude)
+}
+
+static void ProcessVerbosePair(const TSharedPtr<FJsonObject>& pairObj, FPoseAIGesturePair& pair) {
+    POSEAI_BIND_JSON_NUMBER(pairObj, Count, pair.Count)
+    POSEAI_BIND_JSON_NUMBER(pairObj, Current, pair.Current)
+}
+
+static bool ReadVerbosePair(FPoseAIJsonTokenizer& tokens, FPoseAIEventPair& pair) {
+    return tokens.ReadObject([&tokens, &pair](FUtf8StringView key) {
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Count"))
+            return ReadVerboseNumber(tokens, pair.Count);
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Magnitude"))
+            return ReadVerboseNumber(tokens, pair.Magnitude);
+        return tokens.SkipValue();
+    });
+}
+
+static bool ReadVerbosePair(FPoseAIJsonTokenizer& tokens, FPoseAIGesturePair& pair) {
+    return tokens.ReadObject([&tokens, &pair](FUtf8StringView key) {
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Count"))
+            return ReadVerboseNumber(tokens, pair.Count);
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "Current"))
+            return ReadVerboseNumber(tokens, pair.Current);
+        return tokens.SkipValue();
+    });
+}
+
+
 void FPoseAIScalarStruct::ProcessJsonObject(const TSharedPtr < FJsonObject > scaBody) {
-    FJsonObjectConverter::JsonObjectToUStruct(scaBody.ToSharedRef(), this);
+    if (!scaBody.IsValid())
+        return;
+#define POSEAI_BIND_SCALAR(Field) POSEAI_BIND_JSON_NUMBER(scaBody, Field, Field)
+    POSEAI_VERBOSE_SCALAR_FIELDS(POSEAI_BIND_SCALAR)
+#undef POSEAI_BIND_SCALAR
+}
+
+void FPoseAIScalarStruct::ProcessVerboseJson(FUtf8StringView scaJson) {
+    FPoseAIJsonTokenizer tokens = VerboseTokens(scaJson);
+    tokens.ReadObject([this, &tokens](FUtf8StringView key) {
+        POSEAI_VERBOSE_SCALAR_FIELDS(POSEAI_BIND_TOKEN_NUMBER)
+        return tokens.SkipValue();
+    });
 }
 
 void FPoseAIEventStruct::ProcessJsonObject(const TSharedPtr < FJsonObject > eveBody) {
-    FJsonObjectConverter::JsonObjectToUStruct(eveBody.ToSharedRef(), this);
+    if (!eveBody.IsValid())
+        return;
+    const TSharedPtr<FJsonObject>* pairObj;
+#define POSEAI_BIND_EVENT(Field) \
+    { static const FString key(TEXT(#Field)); if (eveBody->TryGetObjectField(key, pairObj)) ProcessVerbosePair(*pairObj, Field); }
+    POSEAI_VERBOSE_EVENT_FIELDS(POSEAI_BIND_EVENT)
+#undef POSEAI_BIND_EVENT
+}
+
+void FPoseAIEventStruct::ProcessVerboseJson(FUtf8StringView eveJson) {
+    FPoseAIJsonTokenizer tokens = VerboseTokens(eveJson);
+    tokens.ReadObject([this, &tokens](FUtf8StringView key) {
+#define POSEAI_BIND_EVENT(Field) \
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, #Field)) return ReadVerbosePair(tokens, Field);
+        POSEAI_VERBOSE_EVENT_FIELDS(POSEAI_BIND_EVENT)
+#undef POSEAI_BIND_EVENT
+        return tokens.SkipValue();
+    });
+}
+
+void FPoseAIVerboseBodyVectors::ProcessJsonObject(const TSharedPtr < FJsonObject > vecBody) {
+    if (!vecBody.IsValid())
+        return;
+    const TArray<TSharedPtr<FJsonValue>>* values;
+#define POSEAI_BIND_VECTOR(Field) \
+    { static const FString key(TEXT(#Field)); if (vecBody->TryGetArrayField(key, values)) AssignVerboseArray(Field, *values); }
+    POSEAI_VERBOSE_VECTOR_FIELDS(POSEAI_BIND_VECTOR)
+#undef POSEAI_BIND_VECTOR
+}
+
+void FPoseAIVerboseBodyVectors::ProcessVerboseJson(FUtf8StringView vecJson) {
+    FPoseAIJsonTokenizer tokens = VerboseTokens(vecJson);
+    tokens.ReadObject([this, &tokens](FUtf8StringView key) {
+#define POSEAI_BIND_VECTOR(Field) \
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, #Field)) return ReadVerboseArray(tokens, Field);
+        POSEAI_VERBOSE_VECTOR_FIELDS(POSEAI_BIND_VECTOR)
+#undef POSEAI_BIND_VECTOR
+        return tokens.SkipValue();
+    });
 }
 
 void FPoseAIVerbose::ProcessJsonObject(const TSharedPtr < FJsonObject > jsonObj) {
-    FJsonObjectConverter::JsonObjectToUStruct(jsonObj.ToSharedRef(), this);
+    static const FString fieldEvents(TEXT("Events"));
+    static const FString fieldScalars(TEXT("Scalars"));
+    static const FString fieldVectors(TEXT("Vectors"));
+    const TSharedPtr<FJsonObject>* section;
+    if (jsonObj->TryGetObjectField(fieldEvents, section))
+        Events.ProcessJsonObject(*section);
+    if (jsonObj->TryGetObjectField(fieldScalars, section))
+        Scalars.ProcessJsonObject(*section);
+    if (jsonObj->TryGetObjectField(fieldVectors, section))
+        Vectors.ProcessJsonObject(*section);
+}
+
+void FPoseAIVerbose::ProcessVerboseBody(const FPoseAIVerbosePart& body) {
+    if (!body.Events.IsEmpty())
+        Events.ProcessVerboseJson(body.Events);
+    if (!body.Scalars.IsEmpty())
+        Scalars.ProcessVerboseJson(body.Scalars);
+    if (!body.Vectors.IsEmpty())
+        Vectors.ProcessVerboseJson(body.Vectors);
 }
 
 
@@ -383,5 +681,45 @@ void FPoseAILiveValues::ProcessVerboseVectorsHandRight(const TSharedPtr < FJsonO
     ProcessFieldAsVector3D(vecHand, "FingerIk", fingerIkR);
 }
 
+/* like ProcessFieldAsVector2D and ProcessFieldAsVector3D, arrays too short leave the vector unchanged */
+static bool ReadVerboseVector(FPoseAIJsonTokenizer& tokens, double* values, int32 numValues, bool& complete) {
+    int32 count;
+    const bool read = tokens.ReadNumberArray(values, numValues, count);
+    complete = read && count >= numValues;
+    return read;
+}
+
+static void ProcessVerboseHandVectors(FUtf8StringView vecJson, FVector2D& point, FVector2D& thumb, FVector& fingerIk) {
+    FPoseAIJsonTokenizer tokens = VerboseTokens(vecJson);
+    tokens.ReadObject([&](FUtf8StringView key) {
+        double values[3];
+        bool complete;
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "PointScreen") || FPoseAIJsonTokenizer::KeyIsNoCase(key, "ThumbScreen")) {
+            FVector2D& target = FPoseAIJsonTokenizer::KeyIsNoCase(key, "PointScreen") ? point : thumb;
+            if (!ReadVerboseVector(tokens, values, 2, complete))
+                return false;
+            if (complete)
+                target = FVector2D(values[0], values[1]);
+            return true;
+        }
+        if (FPoseAIJsonTokenizer::KeyIsNoCase(key, "FingerIk")) {
+            if (!ReadVerboseVector(tokens, values, 3, complete))
+                return false;
+            if (complete)
+                fingerIk = FVector(values[0], values[1], values[2]);
+            return true;
+        }
+        return tokens.SkipValue();
+    });
+}
+
+void FPoseAILiveValues::ProcessVerboseVectorsHandLeft(FUtf8StringView vecJson) {
+    ProcessVerboseHandVectors(vecJson, pointHandLeft, pointThumbLeft, fingerIkL);
+}
+
+void FPoseAILiveValues::ProcessVerboseVectorsHandRight(FUtf8StringView vecJson) {
+    ProcessVerboseHandVectors(vecJson, pointHandRight, pointThumbRight, fingerIkR);
+}
+
 
 #undef LOCTEXT_NAMESPACE
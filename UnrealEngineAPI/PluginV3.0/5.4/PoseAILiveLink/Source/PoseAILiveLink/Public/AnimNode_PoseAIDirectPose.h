@@ -0,0 +1,76 @@
+// Copyright 2022 Pose AI Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "Animation/AnimNodeBase.h"
+#include "LiveLinkTypes.h"
+
+#include "AnimNode_PoseAIDirectPose.generated.h"
+
+class PoseAIRig;
+
+
+/**
+ *	Poses the skeleton straight from a PoseAI subject's rig, bypassing LiveLink.  The latest decoded frame is latched when the node
+ *	is evaluated on the animation worker, rather than when LiveLink buffered it earlier in the frame, and rig joints are matched to
+ *	bones by name like the PoseAI retarget asset does, after any UPoseAIRetargetAsset set on the subject.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct POSEAILIVELINK_API FAnimNode_PoseAIDirectPose : public FAnimNode_Base
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Pose for bones not driven by the subject.  The reference pose if left unconnected. **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Links)
+		FPoseLink InputPose;
+
+	/** PoseAI subject to read, as named in LiveLink. **/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = SourceData, meta = (PinShownByDefault))
+		FLiveLinkSubjectName SubjectName;
+
+	/** Use the component space rotations sent by the camera, converted to local space along this skeleton's own hierarchy, instead of
+	 *  the rig's local rotations.  Keeps the orientation of every driven bone when the skeleton has extra bones between driven ones. **/
+	UPROPERTY(EditAnywhere, Category = Settings)
+		bool bUseComponentSpaceRotations = false;
+
+	/** Scales root motion for differences in skeleton sizes. **/
+	UPROPERTY(EditAnywhere, Category = Settings)
+		float ScaleTranslation = 1.0f;
+
+public:
+	FAnimNode_PoseAIDirectPose();
+
+	// FAnimNode_Base interface
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+	virtual bool HasPreUpdate() const override { return true; }
+	virtual void PreUpdate(const UAnimInstance* InAnimInstance) override;
+	// End of FAnimNode_Base interface
+
+private:
+	/* matches the rig's output joint names to the required bones, after either changed */
+	void RebuildBoneMap(const FBoneContainer& requiredBones);
+
+	// resolved on the game thread, as the rig lookup is not thread safe.  A subject name set through a pin is resolved a frame late
+	TWeakPtr<PoseAIRig, ESPMode::ThreadSafe> rig;
+	FLiveLinkSubjectName resolvedSubjectName;
+	// the rig's joint names after any retargeting, copied on the game thread with the remap generation they belong to
+	TArray<FName> jointNames;
+	int32 remapGeneration = 0;
+
+	// compact pose bone of each rig joint, and rig joint of each compact pose bone, INDEX_NONE if unmatched
+	TArray<FCompactPoseBoneIndex> jointToBone;
+	TArray<int32> boneToJoint;
+	bool bBoneMapDirty = true;
+
+	// reused every evaluation so latching the pose does not allocate
+	TArray<FQuat> latchedRotations;
+	TArray<FQuat> boneComponentRotations;
+	FVector latchedRootTranslation = FVector::ZeroVector;
+	double latchedTimestamp = 0.0;
+};
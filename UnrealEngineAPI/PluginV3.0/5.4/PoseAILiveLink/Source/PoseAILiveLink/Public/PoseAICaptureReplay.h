@@ -0,0 +1,63 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "PoseAICaptureFile.h"
+#include "PoseAILiveLinkNativeSource.h"
+
+#include <atomic>
+
+
+/**
+ * Replays a capture file into a native source of its own, configured with the captured handshake, so a recorded session drives
+ * LiveLink, the rig, events and the pipeline stats exactly as it did live.  Frames are fed from a thread of the replay's own at the
+ * original timing, at a multiple of it, or as fast as possible for parser and rig benchmarks on real traffic.  Control messages
+ * such as the camera's hello are skipped, as the native source has no connection to manage.
+ */
+class POSEAILIVELINK_API FPoseAICaptureReplay : public FRunnable
+{
+public:
+	/**
+	 * game thread: maps the capture, adds its source and starts replaying.  Returns null if the file can not be read.
+	 * speed 1 replays at the original timing, 2 at twice the speed and 0 as fast as possible.
+	 * The subject defaults to the capture's file name.
+	 */
+	static TSharedPtr<FPoseAICaptureReplay, ESPMode::ThreadSafe> Start(const FString& path, double speed = 1.0, bool bLoop = false, FName subjectName = NAME_None);
+
+	/* game thread: stops the replays started by the PoseAI.ReplayCapture console command and removes their sources */
+	static void StopAll();
+
+	virtual ~FPoseAICaptureReplay();
+
+	virtual uint32 Run() override;
+	/* stops feeding frames and removes the replay's source from LiveLink, on the game thread */
+	virtual void Stop() override;
+
+	bool IsRunning() const { return running.load(std::memory_order_relaxed); }
+	uint64 GetFramesReplayed() const { return framesReplayed.load(std::memory_order_relaxed); }
+	FName GetSubjectName() const { return subjectName; }
+
+private:
+	FPoseAICaptureReplay(TUniquePtr<FPoseAICaptureReader>&& reader, TWeakPtr<PoseAILiveLinkNativeSource> source, FName subjectName, double speed, bool bLoop);
+
+	/* feeds one pass over the capture, false if the replay was stopped or its source removed */
+	bool ReplayPass();
+	/* once, from Stop, which the destructor also calls */
+	void RemoveSource();
+
+	TUniquePtr<FPoseAICaptureReader> reader;
+	TWeakPtr<PoseAILiveLinkNativeSource> source;
+	FName subjectName;
+	double speed;
+	bool bLoop;
+
+	FRunnableThread* thread = nullptr;
+	// wakes the paced wait between frames early when the replay is stopped
+	FEvent* wakeEvent = nullptr;
+	std::atomic<bool> running{ true };
+	std::atomic<bool> sourceRemoved{ false };
+	std::atomic<uint64> framesReplayed{ 0 };
+};
@@ -0,0 +1,226 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+
+/*
+* Forward-only cursor over the bytes of a packet, shared by the compact and verbose frame parsers.  Every read returns false on
+* input it does not expect, which sends the packet back to the FJsonObject path rather than guessing.
+*/
+class FPoseAIJsonTokenizer
+{
+public:
+	FPoseAIJsonTokenizer(const uint8* data, int32 len) : cursor(data), end(data + len) {}
+
+	template <int32 N>
+	static bool KeyIs(FUtf8StringView key, const ANSICHAR(&name)[N]) {
+		return key.Len() == N - 1 && FMemory::Memcmp(key.GetData(), name, N - 1) == 0;
+	}
+
+	/* case insensitive, as FJsonObject field lookups are */
+	template <int32 N>
+	static bool KeyIsNoCase(FUtf8StringView key, const ANSICHAR(&name)[N]) {
+		if (key.Len() != N - 1)
+			return false;
+		for (int32 i = 0; i < N - 1; ++i) {
+			if (FCharAnsi::ToLower((ANSICHAR)key[i]) != FCharAnsi::ToLower(name[i]))
+				return false;
+		}
+		return true;
+	}
+
+	/* case insensitive comparison of a name field against a rig name, matching FName equality */
+	static bool NameIs(FUtf8StringView value, FName name) {
+		TCHAR nameChars[NAME_SIZE];
+		const int32 len = (int32)name.ToString(nameChars, NAME_SIZE);
+		if (len != value.Len())
+			return false;
+		for (int32 i = 0; i < len; ++i) {
+			if (FChar::ToLower(nameChars[i]) != FChar::ToLower((TCHAR)(uint8)value[i]))
+				return false;
+		}
+		return true;
+	}
+
+	bool AtEnd() {
+		SkipWhitespace();
+		return cursor == end;
+	}
+
+	bool Consume(uint8 c) {
+		SkipWhitespace();
+		if (cursor < end && *cursor == c) {
+			++cursor;
+			return true;
+		}
+		return false;
+	}
+
+	/* strings in the compact schema are base64 or names, so escapes are not expected and are rejected */
+	bool ReadString(FUtf8StringView& view) {
+		if (!Consume('"'))
+			return false;
+		const uint8* start = cursor;
+		while (cursor < end && *cursor != '"') {
+			if (*cursor == '\\')
+				return false;
+			++cursor;
+		}
+		if (cursor == end)
+			return false;
+		view = FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(start), (int32)(cursor - start));
+		++cursor;
+		return true;
+	}
+
+	bool ReadNumber(double& value) {
+		SkipWhitespace();
+		ANSICHAR buffer[64];
+		int32 len = 0;
+		while (cursor < end && IsNumberChar(*cursor)) {
+			if (len == UE_ARRAY_COUNT(buffer) - 1)
+				return false;
+			buffer[len++] = (ANSICHAR)*cursor++;
+		}
+		if (len == 0)
+			return false;
+		buffer[len] = '\0';
+		value = FCStringAnsi::Atod(buffer);
+		return true;
+	}
+
+	/* reads [n, n, ...] into out, keeping the first maxValues.  count is the number of values read, which may exceed maxValues */
+	bool ReadNumberArray(double* out, int32 maxValues, int32& count) {
+		count = 0;
+		if (!Consume('['))
+			return false;
+		if (Consume(']'))
+			return true;
+		do {
+			double value;
+			if (!ReadNumber(value))
+				return false;
+			if (count < maxValues)
+				out[count] = value;
+			++count;
+		} while (Consume(','));
+		return Consume(']');
+	}
+
+	/* the raw text of the next value, for sections decoded later by the struct they fill */
+	bool ReadRawValue(FUtf8StringView& view) {
+		SkipWhitespace();
+		const uint8* start = cursor;
+		if (!SkipValue())
+			return false;
+		view = FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(start), (int32)(cursor - start));
+		return true;
+	}
+
+	/* skips a value of any type, including nested objects and arrays and escaped strings */
+	bool SkipValue() {
+		SkipWhitespace();
+		if (cursor == end)
+			return false;
+		if (*cursor == '"')
+			return SkipString();
+		if (*cursor == '{' || *cursor == '[') {
+			int32 depth = 0;
+			while (cursor < end) {
+				const uint8 c = *cursor;
+				if (c == '"') {
+					if (!SkipString())
+						return false;
+					continue;
+				}
+				++cursor;
+				if (c == '{' || c == '[')
+					++depth;
+				else if ((c == '}' || c == ']') && --depth == 0)
+					return true;
+			}
+			return false;
+		}
+		// numbers and the literals true, false and null
+		const uint8* start = cursor;
+		while (cursor < end && (IsNumberChar(*cursor) || FCharAnsi::IsAlpha((ANSICHAR)*cursor)))
+			++cursor;
+		return cursor > start;
+	}
+
+	/* reads an object, calling onField(key) with the cursor at each value.  onField must consume the value */
+	template <typename FieldFunc>
+	bool ReadObject(FieldFunc&& onField) {
+		if (!Consume('{'))
+			return false;
+		if (Consume('}'))
+			return true;
+		do {
+			FUtf8StringView key;
+			if (!ReadString(key) || !Consume(':') || !onField(key))
+				return false;
+		} while (Consume(','));
+		return Consume('}');
+	}
+
+	/*
+	* The start of the value of the first "key" in a packet, found by searching rather than tokenizing, or nullptr.  For quick checks on the
+	* socket thread of packets the worker parses in full.  The match may be at any depth, which the schemas allow as their keys are unique and
+	* their string values are base64 or names
+	*/
+	template <int32 N>
+	static const uint8* FindValue(const uint8* data, int32 len, const ANSICHAR(&key)[N]) {
+		const uint8* end = data + len;
+		for (const uint8* at = data; at + N < end; ++at) {
+			if (at[0] != '"' || at[N] != '"' || FMemory::Memcmp(at + 1, key, N - 1) != 0)
+				continue;
+			FPoseAIJsonTokenizer tokens(at + N + 1, (int32)(end - at - N - 1));
+			if (tokens.Consume(':')) {
+				tokens.SkipWhitespace();
+				return tokens.cursor;
+			}
+		}
+		return nullptr;
+	}
+
+	template <int32 N>
+	static bool FindString(const uint8* data, int32 len, const ANSICHAR(&key)[N], FUtf8StringView& view) {
+		const uint8* value = FindValue(data, len, key);
+		return value && FPoseAIJsonTokenizer(value, (int32)(data + len - value)).ReadString(view);
+	}
+
+	template <int32 N>
+	static bool FindNumber(const uint8* data, int32 len, const ANSICHAR(&key)[N], double& number) {
+		const uint8* value = FindValue(data, len, key);
+		return value && FPoseAIJsonTokenizer(value, (int32)(data + len - value)).ReadNumber(number);
+	}
+
+private:
+	const uint8* cursor;
+	const uint8* end;
+
+	static bool IsNumberChar(uint8 c) {
+		return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+	}
+
+	void SkipWhitespace() {
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+			++cursor;
+	}
+
+	bool SkipString() {
+		++cursor;
+		while (cursor < end) {
+			if (*cursor == '\\') {
+				cursor += 2;
+				continue;
+			}
+			if (*cursor++ == '"')
+				return true;
+		}
+		return false;
+	}
+};
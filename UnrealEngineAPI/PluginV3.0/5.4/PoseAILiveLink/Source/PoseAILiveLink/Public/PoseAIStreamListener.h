@@ -0,0 +1,73 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkTypes.h"
+#include "PoseAIStructs.h"
+#include "PoseAIEventRecord.h"
+
+
+/* the parts of each frame a native listener is called with */
+enum class EPoseAIStreamFields : uint32
+{
+	None = 0,
+	/* discrete events such as footsteps, jumps and gestures, in the order the frame triggered them */
+	Events = 1 << 0,
+	/* visibility flags, whenever they change */
+	Visibility = 1 << 1,
+	/* the full live values, for every frame with a visible torso */
+	LiveValues = 1 << 2,
+	/* hand and finger IK targets and hand openness, for every frame */
+	HandTargets = 1 << 3,
+	All = Events | Visibility | LiveValues | HandTargets,
+};
+ENUM_CLASS_FLAGS(EPoseAIStreamFields);
+
+
+/* the subset of live values the hand IK nodes use */
+struct FPoseAIHandTargets
+{
+	FVector handIkL = FVector::ZeroVector;
+	FVector handIkR = FVector::ZeroVector;
+	FVector fingerIkL = FVector::ZeroVector;
+	FVector fingerIkR = FVector::ZeroVector;
+	float opennessLeftHand = 0.5f;
+	float opennessRightHand = 0.5f;
+};
+
+
+/**
+ * Native alternative to the movement component's dynamic delegates, for C++ systems that want a subject's stream without reflection
+ * or copies.  Callbacks run on the worker processing the subject's frames, as soon as each frame is decoded, and only for the fields
+ * the listener subscribed to.  They must be quick and thread safe, and must not add or remove listeners.
+ */
+class POSEAILIVELINK_API IPoseAIStreamListener
+{
+public:
+	virtual ~IPoseAIStreamListener() = default;
+
+	virtual void OnPoseAIEvent(const FLiveLinkSubjectName& subject, const FPoseAIEvent& event) {}
+	virtual void OnPoseAIVisibility(const FLiveLinkSubjectName& subject, const FPoseAIVisibilityFlags& flags) {}
+	virtual void OnPoseAILiveValues(const FLiveLinkSubjectName& subject, const FPoseAILiveValues& values) {}
+	virtual void OnPoseAIHandTargets(const FLiveLinkSubjectName& subject, const FPoseAIHandTargets& targets) {}
+};
+
+
+/**
+ * Registry of native listeners per subject.  Rigs check an atomic listener count first, so subjects nobody listens to skip the
+ * registry entirely, and only the fields some listener of the subject subscribed to are gathered and dispatched.
+ */
+class POSEAILIVELINK_API FPoseAIStreamListeners
+{
+public:
+	/* registers, or updates the fields of, a listener for a subject.  The listener must stay alive until removed */
+	static void Add(const FLiveLinkSubjectName& subject, IPoseAIStreamListener* listener, EPoseAIStreamFields fields);
+
+	/* unregisters a listener from every subject.  Waits for callbacks in progress, so the listener may be destroyed once this returns */
+	static void Remove(IPoseAIStreamListener* listener);
+
+	/* called by rigs after each frame's events are gathered */
+	static void Notify(const FLiveLinkSubjectName& subject, const FPoseAIEventRecord& record, const FPoseAIVisibilityFlags& visibilityFlags,
+		const FPoseAILiveValues& liveValues);
+};
@@ -13,8 +13,11 @@
 #include "Interfaces/IPv4/IPv4Endpoint.h"
 
 #include "PoseAIEndpoint.h"
+#include "PoseAIBinaryPacket.h"
 #include "IPAddress.h"
 
+#include <atomic>
+
 
 
 
@@ -32,6 +35,33 @@ typedef TSharedPtr<FArrayReader, ESPMode::ThreadSafe> FArrayReaderPtr;
  */
 DECLARE_DELEGATE_TwoParams(FPoseAIOnSocketDataReceived, const FString&, const FPoseAIEndpoint&);  //Change delegate name and use our endpoint
 
+/**
+ * Delegate type for received binary (PF=2) frames.
+ *
+ * The first parameter views the receiver's read buffer and is only valid for the duration of the call.
+ * The second parameter is sender's IP endpoint.
+ */
+DECLARE_DELEGATE_TwoParams(FPoseAIOnSocketBinaryReceived, TArrayView<const uint8>, const FPoseAIEndpoint&);
+
+/**
+ * Delegate type for received datagrams as raw bytes, UTF-8 for JSON packets.
+ *
+ * The first parameter views the receiver's recycled read buffer and is only valid for the duration of the call.
+ * The second parameter is sender's IP endpoint.
+ */
+DECLARE_DELEGATE_TwoParams(FPoseAIOnSocketBytesReceived, TArrayView<const uint8>, const FPoseAIEndpoint&);
+
+
+/**
+ * Receive counters.
+ */
+struct FPoseAIReceiveStats
+{
+	uint64 DatagramsReceived = 0;
+	uint64 BatchesRead = 0;
+	int32 LargestBatch = 0;
+};
+
 
 /**
  * Asynchronously receives data from an UDP socket.
@@ -58,7 +88,6 @@ public:
 	{
 		check(Socket != nullptr);
 		check(Socket->GetSocketType() == SOCKTYPE_Datagram);
-		Reader->SetNumUninitialized(MaxReadBufferSize);
 		SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
 	}
 
@@ -100,6 +129,68 @@ public:
 		return DataReceivedDelegate;
 	}
 
+	/**
+	 * Returns a delegate that is executed when a binary frame has been received, bypassing the string conversion.
+	 * If unbound, binary frames are dropped.  Same binding rules as OnDataReceived.
+	 *
+	 * @return The delegate.
+	 */
+	FPoseAIOnSocketBinaryReceived& OnBinaryReceived()
+	{
+		check(Thread == nullptr);
+		return BinaryReceivedDelegate;
+	}
+
+	/**
+	 * Returns a delegate that is executed with the bytes of every datagram, without converting to FString.
+	 * When bound it takes precedence over OnDataReceived and OnBinaryReceived, which remain for string based listeners.
+	 * Same binding rules as OnDataReceived.
+	 *
+	 * @return The delegate.
+	 */
+	FPoseAIOnSocketBytesReceived& OnBytesReceived()
+	{
+		check(Thread == nullptr);
+		return BytesReceivedDelegate;
+	}
+
+	/**
+	 * Reads and delivers one batch of pending datagrams without waiting, for a reactor which services this socket from its own thread
+	 * instead of Start().  Limiting each call to a batch keeps a busy socket from starving the others on the thread.
+	 * SharedBuffer holds the datagrams of a batch while the delegates run, so one buffer can serve every socket on a thread.
+	 *
+	 * @return true if any datagram was read.
+	 */
+	bool Poll(TArray<uint8>& SharedBuffer)
+	{
+		if (Stopping || !Socket || !Socket.IsValid())
+		{
+			return false;
+		}
+		return ReadBatches(SharedBuffer, 1);
+	}
+
+	/** Blocks until the socket is readable or the wait time passes. */
+	bool WaitForRead(const FTimespan& SocketWaitTime)
+	{
+		return !Stopping && Socket && Socket.IsValid() && Socket->Wait(ESocketWaitConditions::WaitForRead, SocketWaitTime);
+	}
+
+	bool IsStopping() const
+	{
+		return Stopping;
+	}
+
+	/** Snapshot of the receive counters, safe to call from any thread. */
+	FPoseAIReceiveStats GetStats() const
+	{
+		FPoseAIReceiveStats Stats;
+		Stats.DatagramsReceived = DatagramsReceived;
+		Stats.BatchesRead = BatchesRead;
+		Stats.LargestBatch = LargestBatch;
+		return Stats;
+	}
+
 public:
 
 	//~ FRunnable interface
@@ -150,32 +241,96 @@ protected:
 		if (Stopping)
 			return;
 
-		TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr(Socket->GetProtocol());
+		ReadBatches(BatchBuffer);
+	}
+
+	/** Reads and delivers up to MaxBatches batches of pending datagrams through Buffer.  Returns true if anything was read. */
+	bool ReadBatches(TArray<uint8>& Buffer, int32 MaxBatches = MAX_int32)
+	{
+		// pending datagrams are read as a batch, so a burst costs one wakeup rather than one per datagram
+		if (Buffer.Num() < 2 * (int32)MaxReadBufferSize)
+		{
+			Buffer.SetNumUninitialized(2 * MaxReadBufferSize);
+		}
+
+		bool bReadAny = false;
 		uint32 Size;
-		while (Socket && Socket.IsValid() && Socket->HasPendingData(Size))
-		{			
-			// we also send the messages via delegate as FStrings instead of FArrayReaderPtrs
+		for (int32 NumBatches = 0; NumBatches < MaxBatches && Socket && Socket.IsValid() && !Stopping && Socket->HasPendingData(Size); ++NumBatches)
+		{
+			int32 BatchBytes = 0;
+			Batch.Reset();
+			while (Batch.Num() < MaxBatchDatagrams && Buffer.Num() - BatchBytes >= (int32)FMath::Min(Size, MaxReadBufferSize))
+			{
+				if (SenderPool.Num() <= Batch.Num())
+				{
+					SenderPool.Add(SocketSubsystem->CreateInternetAddr(Socket->GetProtocol()));
+				}
+				FInternetAddr& Sender = *SenderPool[Batch.Num()];
+
+				int32 BytesRead = 0;
+				if (!Socket->RecvFrom(Buffer.GetData() + BatchBytes, FMath::Min(Size, MaxReadBufferSize), BytesRead, Sender))
+				{
+					break;
+				}
+				Batch.Add({ BatchBytes, BytesRead });
+				BatchBytes += BytesRead;
+
+				if (!Socket->HasPendingData(Size))
+				{
+					break;
+				}
+			}
 
-			int32 BytesRead = 0;
-			if (Socket->RecvFrom(Reader->GetData(), FMath::Min(Size, MaxReadBufferSize), BytesRead, *Sender))
+			if (Batch.Num() == 0)
+			{
+				break;
+			}
+			bReadAny = true;
+			DeliverBatch(Buffer);
+		}
+		return bReadAny;
+	}
+
+	/** Hands a batch to the delegates in arrival order. */
+	void DeliverBatch(const TArray<uint8>& Buffer)
+	{
+		DatagramsReceived += Batch.Num();
+		BatchesRead++;
+		if (Batch.Num() > LargestBatch)
+		{
+			LargestBatch = Batch.Num();
+		}
+
+		for (int32 i = 0; i < Batch.Num() && !Stopping; ++i)
+		{
+			const FBatchEntry& Entry = Batch[i];
+			TArrayView<const uint8> bytes(Buffer.GetData() + Entry.Offset, Entry.Length);
+			FPoseAIEndpoint Endpoint(SenderPool[i]);
+			if (BytesReceivedDelegate.IsBound())
+			{
+				BytesReceivedDelegate.Execute(bytes, Endpoint);
+			}
+			// binary frames are handed over straight from the read buffer
+			else if (FPoseAIBinaryPacket::IsBinaryPacket(bytes.GetData(), bytes.Num()))
+			{
+				BinaryReceivedDelegate.ExecuteIfBound(bytes, Endpoint);
+			}
+			else
 			{
-				
 				// UE4.2x versions
 				//UTF8CHAR* bytedata_utf8 = (UTF8CHAR*)Reader->GetData();
 				//TCHAR* bytedata = UTF8_TO_TCHAR(bytedata_utf8);
 				// end UE4.2x
 
 				// UE5.0
-				 UTF8CHAR* bytedata = (UTF8CHAR*)Reader->GetData();
+				const UTF8CHAR* bytedata = (const UTF8CHAR*)bytes.GetData();
 				// end UE5.0
 
-				FString recvMessage = FString(BytesRead, bytedata);
-				DataReceivedDelegate.ExecuteIfBound(recvMessage, FPoseAIEndpoint(Sender));
+				// adapter for string listeners, which costs a widening copy per packet
+				FString recvMessage = FString(bytes.Num(), bytedata);
+				DataReceivedDelegate.ExecuteIfBound(recvMessage, Endpoint);
 			}
-
 		}
-		
-
 	}
 
 protected:
@@ -188,7 +343,25 @@ protected:
 	}
 
 private:
-	FArrayReaderPtr Reader = MakeShared<FArrayReader, ESPMode::ThreadSafe>(true);
+	struct FBatchEntry
+	{
+		int32 Offset;
+		int32 Length;
+	};
+
+	/** Recycled storage for the datagrams of one batch when running on its own thread, each sender address is kept in SenderPool at the same index. */
+	TArray<uint8> BatchBuffer;
+	TArray<FBatchEntry, TInlineAllocator<32>> Batch;
+	TArray<TSharedRef<FInternetAddr>> SenderPool;
+
+	/** The most datagrams read before they are handed on. */
+	int32 MaxBatchDatagrams = 32;
+
+	/** Counters, written by the receiver thread only. */
+	std::atomic<uint64> DatagramsReceived{ 0 };
+	std::atomic<uint64> BatchesRead{ 0 };
+	std::atomic<int32> LargestBatch{ 0 };
+
 	/** The network socket. */
 	TSharedPtr<FSocket> Socket = nullptr;
 
@@ -216,5 +389,11 @@ private:
 
 	/** Holds the data received delegate. */
 	FPoseAIOnSocketDataReceived DataReceivedDelegate;
+
+	/** Holds the binary frame received delegate. */
+	FPoseAIOnSocketBinaryReceived BinaryReceivedDelegate;
+
+	/** Holds the raw bytes received delegate. */
+	FPoseAIOnSocketBytesReceived BytesReceivedDelegate;
 };
 
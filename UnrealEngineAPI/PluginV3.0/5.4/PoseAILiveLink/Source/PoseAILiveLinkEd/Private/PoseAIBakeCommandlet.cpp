@@ -0,0 +1,53 @@
+// Copyright Pose AI Ltd 2022.  All Rights Reserved.
+
+#include "PoseAIBakeCommandlet.h"
+#include "Animation/Skeleton.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "PoseAICaptureBaker.h"
+#include "PoseAICaptureFile.h"
+
+#define LOCTEXT_NAMESPACE "PoseAI"
+
+
+UPoseAIBakeCommandlet::UPoseAIBakeCommandlet() {
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	HelpDescription = TEXT("Bakes PoseAI capture files into animation sequences, decoding long files in parallel chunks");
+	HelpUsage = TEXT("-run=PoseAIBake -Skeleton=<skeleton asset> -Files=<a.paicap+b.paicap> -Dir=<capture directory> -Out=<package path> -FPS=<30> -ChunkBlocks=<4>");
+}
+
+int32 UPoseAIBakeCommandlet::Main(const FString& Params) {
+	TArray<FString> tokens;
+	TArray<FString> switches;
+	TMap<FString, FString> paramValues;
+	ParseCommandLine(*Params, tokens, switches, paramValues);
+
+	FPoseAIBakeSettings settings;
+	if (const FString* skeletonPath = paramValues.Find(TEXT("Skeleton")))
+		settings.Skeleton = LoadObject<USkeleton>(nullptr, **skeletonPath);
+	if (const FString* files = paramValues.Find(TEXT("Files")))
+		files->ParseIntoArray(settings.Files, TEXT("+"));
+	if (const FString* directory = paramValues.Find(TEXT("Dir"))) {
+		TArray<FString> found;
+		IFileManager::Get().FindFiles(found, *(*directory / (FString(TEXT("*")) + PoseAICapture::Extension)), true, false);
+		for (const FString& file : found)
+			settings.Files.Add(*directory / file);
+	}
+	if (const FString* outputPath = paramValues.Find(TEXT("Out")))
+		settings.OutputPath = *outputPath;
+	if (const FString* frameRate = paramValues.Find(TEXT("FPS")))
+		settings.FrameRate = FCString::Atoi(**frameRate);
+	if (const FString* chunkBlocks = paramValues.Find(TEXT("ChunkBlocks")))
+		settings.ChunkBlocks = FCString::Atoi(**chunkBlocks);
+
+	if (settings.Skeleton == nullptr || settings.Files.Num() == 0) {
+		UE_LOG(LogTemp, Error, TEXT("PoseAI LiveLink: usage %s"), *HelpUsage);
+		return 1;
+	}
+	return FPoseAICaptureBaker::Bake(settings) == settings.Files.Num() ? 0 : 1;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,371 @@
+'''
+Authored by Pose AI Ltd, 2022
+
+Loopback tool which imitates the Pose Camera app for testing game engine plugins without a phone.
+Sends the hello message to a plugin listening on a port, waits for the handshake and then streams
+synthetic frames in the verbose (PF=0), compact (PF=1) or binary (PF=2) packet format, or replays
+recorded packets.  Several virtual phones can stream at once, one per port, for soak and load tests.
+Everything the plugin sends back (handshakes, configs and disconnect requests) is reported.
+
+Example, streaming binary packets to the Unreal plugin on port 8080 of this machine:
+    python posecam_simulator.py --host 127.0.0.1 --port 8080 --format binary
+
+Example, four phones on ports 8080 to 8083 at 120 fps for ten minutes, without face blendshapes:
+    python posecam_simulator.py --phones 4 --fps 120 --seconds 600 --face off
+
+Apache License 2.0
+'''
+
+import argparse
+import json
+import math
+import os
+import re
+import socket
+import struct
+import threading
+import time
+import uuid
+
+APP_VERSION = '1.3.0'
+
+B64_ALPHABET = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/'
+
+# (body joints including root, joints per hand) as configured by the plugin rig classes
+RIG_JOINTS = {
+    'MetaHuman': (24, 22),
+    'UE4': (21, 17),
+    'Mixamo': (21, 17),
+    'DazUE': (28, 21),
+    'MixamoAlt': (21, 17),
+}
+# matches EPoseAiRigPresets
+RIG_PRESETS = ['MetaHuman', 'UE4', 'Mixamo', 'DazUE', 'MixamoAlt']
+
+NUM_FACE_BLENDSHAPES = 52
+NUM_EVENTS = 9
+
+# the plugin's rig layouts, from which the verbose format takes its joint names
+RIG_DEFINITIONS = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'UnrealEngineAPI', 'PluginV3.0', '5.4', 'PoseAILiveLink',
+                               'Source', 'PoseAILiveLink', 'Public', 'PoseAIRigDefinitions.h')
+
+BINARY_MAGIC = b'PB'
+BINARY_VERSION = 1
+BINARY_HEADER = struct.Struct('<2sBBBBHd8H')
+# section order of the binary header offset table
+SECTIONS = ['BodyRotations', 'LeftHandRotations', 'RightHandRotations', 'Scalars', 'Vectors', 'Events', 'HandVectors', 'Face']
+
+
+''' Fixed point encoding shared by the compact and binary formats: [-1, 1] mapped onto 12 bits '''
+def fixed12(value):
+    return max(0, min(4095, int(round((value + 1.0) * 4094.0 / 2.0))))
+
+
+def b64_fixed12(value):
+    v = fixed12(value)
+    return B64_ALPHABET[v >> 6] + B64_ALPHABET[v & 63]
+
+
+def b64_uint(value, chars):
+    return ''.join(B64_ALPHABET[(value >> (6 * (chars - 1 - i))) & 63] for i in range(chars))
+
+
+def pack12(values):
+    ''' packs 12 bit values two per three bytes, low value first '''
+    ints = [fixed12(v) for v in values]
+    if len(ints) % 2:
+        ints.append(0)
+    out = bytearray()
+    for a, b in zip(ints[0::2], ints[1::2]):
+        out += bytes((a & 0xFF, (a >> 8) | ((b & 0x0F) << 4), b >> 4))
+    return bytes(out[:(len(values) * 3 + 1) // 2])
+
+
+class SyntheticFrame:
+    ''' a deterministic, smoothly varying frame so decoded output can be checked by eye in the engine '''
+
+    def __init__(self, rig, t, hands=True, face=True):
+        body_joints, hand_joints = RIG_JOINTS[rig]
+        self.rig = rig
+        self.timestamp = t
+        self.body = [self.quat(i, t) for i in range(body_joints - 1)]
+        self.left = [self.quat(i + 50, t) for i in range(hand_joints)] if hands else []
+        self.right = [self.quat(i + 90, t) for i in range(hand_joints)] if hands else []
+        self.visibility = [1, 1, 1, 1, 1, 1 if face else 0]
+        self.body_height = 0.2
+        self.chest_yaw = 0.1 * math.sin(t)
+        self.stance_yaw = 0.1 * math.cos(t)
+        self.stable_feet = 1
+        self.hand_zones = (5, 5)
+        self.crouching = 0
+        self.vectors = [0.05 * math.sin(t + i) for i in range(21)]
+        # counts increase every couple of seconds so the event dispatcher fires
+        step = int(t / 2.0)
+        self.events = [(step + i, 0.25) for i in range(NUM_EVENTS - 2)] + [(step, 3), (step, 4)]
+        self.hand_vectors = [(0.1, 0.2, 0.1, 0.15, 0.5), (-0.1, 0.2, -0.1, 0.15, 0.5)] if hands else []
+        self.face = [0.5 + 0.5 * math.sin(t + i) for i in range(NUM_FACE_BLENDSHAPES)] if face else []
+
+    @staticmethod
+    def quat(i, t):
+        angle = 0.3 * math.sin(t * 2.0 + i)
+        axis = (math.sin(i), math.cos(i), 0.5)
+        n = math.sqrt(sum(a * a for a in axis))
+        s = math.sin(angle / 2.0) / n
+        return (axis[0] * s, axis[1] * s, axis[2] * s, math.cos(angle / 2.0))
+
+
+def load_joint_names(path=RIG_DEFINITIONS):
+    ''' joint names per rig as (body without root, left hand, right hand), read from the traits structs of PoseAIRigDefinitions.h '''
+    with open(path, encoding='utf-8') as f:
+        source = f.read()
+    rigs = {}
+    for match in re.finditer(r'struct FPoseAIRigTraits(\w+)\s*\{(.*?)\n\};', source, re.S):
+        rig, body = match.groups()
+        names = re.findall(r'\{\s*TEXT\("([^"]+)"\)', body)
+        body_joints, hand_joints = RIG_JOINTS[rig]
+        rigs[rig] = (names[1:body_joints], names[body_joints:body_joints + hand_joints],
+                     names[body_joints + hand_joints:body_joints + 2 * hand_joints])
+    return rigs
+
+
+def encode_verbose(frame, joint_names):
+    ''' PF=0 JSON packet with named joints and fields, as described in FrameworkDocumentation/StreamFormat.md '''
+    body_names, left_names, right_names = joint_names[frame.rig]
+    rotations = lambda names, quats: {name: [round(c, 5) for c in q] for name, q in zip(names, quats)}
+    vis = frame.visibility
+    scalars = {
+        'VisTorso': vis[0], 'VisLegL': vis[1], 'VisLegR': vis[2], 'VisArmL': vis[3], 'VisArmR': vis[4], 'VisFace': vis[5],
+        'BodyHeight': frame.body_height, 'ChestYaw': frame.chest_yaw, 'StanceYaw': frame.stance_yaw,
+        'StableFoot': frame.stable_feet, 'HandZoneL': frame.hand_zones[0], 'HandZoneR': frame.hand_zones[1],
+        'IsCrouching': frame.crouching,
+    }
+    v = frame.vectors
+    vectors = {'HipLean': v[0:2], 'HipScreen': v[2:4], 'ChestScreen': v[4:6], 'HandIkL': v[6:9], 'HandIkR': v[9:12],
+               'Hip': v[12:15], 'FootIkL': v[15:18], 'FootIkR': v[18:21]}
+    event_names = ['Footstep', 'SidestepL', 'SidestepR', 'Jump', 'FeetSplit', 'ArmPump', 'ArmFlex', 'ArmGestureL', 'ArmGestureR']
+    events = {name: ({'Count': count, 'Magnitude': second} if i < NUM_EVENTS - 2 else {'Count': count, 'Current': second})
+              for i, (name, (count, second)) in enumerate(zip(event_names, frame.events))}
+    packet = {'Rig': frame.rig, 'Timestamp': frame.timestamp, 'ModelLatency': 20,
+              'Body': {'Rotations': rotations(body_names, frame.body), 'Scalars': scalars, 'Vectors': vectors, 'Events': events}}
+    for key, names, quats, vectors in (('LeftHand', left_names, frame.left, frame.hand_vectors[:1]),
+                                       ('RightHand', right_names, frame.right, frame.hand_vectors[1:])):
+        if quats:
+            hand = vectors[0]
+            packet[key] = {'Rotations': rotations(names, quats), 'Open': hand[4],
+                           'Vectors': {'PointScreen': list(hand[0:2]), 'ThumbScreen': list(hand[2:4])}}
+    if frame.face:
+        packet['Face'] = [round(f, 4) for f in frame.face]
+    return json.dumps(packet, separators=(',', ':')).encode()
+
+
+def encode_compact(frame):
+    ''' PF=1 JSON packet '''
+    rota = lambda quats: ''.join(b64_fixed12(c) for q in quats for c in q)
+    body = {
+        'RotA': rota(frame.body),
+        'VisA': ''.join(str(v) for v in frame.visibility),
+        'ScaA': b64_fixed12(frame.body_height - 1.0) + b64_fixed12(frame.chest_yaw) + b64_fixed12(frame.stance_yaw) +
+                b64_uint(frame.stable_feet, 2) + b64_uint(frame.hand_zones[0], 2) + b64_uint(frame.hand_zones[1], 2) +
+                b64_uint(frame.crouching, 2),
+        'VecA': ''.join(b64_fixed12(v) for v in frame.vectors),
+        'EveA': ''.join(b64_uint(count, 3) + (b64_fixed12(second) if i < NUM_EVENTS - 2 else b64_uint(second, 2))
+                        for i, (count, second) in enumerate(frame.events)),
+    }
+    packet = {'Rig': frame.rig, 'PF': 1, 'Timestamp': frame.timestamp, 'ModelLatency': 20, 'Body': body}
+    for key, quats, vectors in (('LeftHand', frame.left, frame.hand_vectors[:1]), ('RightHand', frame.right, frame.hand_vectors[1:])):
+        if quats:
+            point = ''.join(b64_fixed12(v) for v in vectors[0][:4])
+            packet[key] = {'RotA': rota(quats), 'Point': point, 'Open': vectors[0][4]}
+    if frame.face:
+        packet['Face'] = ''.join(b64_fixed12(v) for v in frame.face)
+    return json.dumps(packet, separators=(',', ':')).encode()
+
+
+def encode_binary(frame, mirrored=True):
+    ''' PF=2 binary packet, see FrameworkDocumentation/StreamFormat.md '''
+    sections = {}
+    sections['BodyRotations'] = bytes((len(frame.body),)) + pack12([c for q in frame.body for c in q])
+    if frame.left:
+        sections['LeftHandRotations'] = bytes((len(frame.left),)) + pack12([c for q in frame.left for c in q])
+    if frame.right:
+        sections['RightHandRotations'] = bytes((len(frame.right),)) + pack12([c for q in frame.right for c in q])
+    vis_bits = sum(v << i for i, v in enumerate(frame.visibility))
+    sections['Scalars'] = bytes((vis_bits, frame.stable_feet, frame.hand_zones[0], frame.hand_zones[1], frame.crouching, 0)) + \
+        pack12([frame.body_height - 1.0, frame.chest_yaw, frame.stance_yaw, 0.0])
+    sections['Vectors'] = bytes((len(frame.vectors),)) + pack12(frame.vectors)
+    events = bytearray((len(frame.events),))
+    for i, (count, second) in enumerate(frame.events):
+        events += struct.pack('<IH', count, fixed12(second) if i < NUM_EVENTS - 2 else second)
+    sections['Events'] = bytes(events)
+    if frame.hand_vectors:
+        mask = (1 if frame.left else 0) | (2 if frame.right else 0)
+        sections['HandVectors'] = bytes((mask,)) + b''.join(pack12(list(v) + [0.0]) for v in frame.hand_vectors)
+    if frame.face:
+        sections['Face'] = bytes((len(frame.face),)) + pack12(frame.face)
+
+    offsets = []
+    payload = bytearray()
+    for name in SECTIONS:
+        if name in sections:
+            offsets.append(BINARY_HEADER.size + len(payload))
+            payload += sections[name]
+        else:
+            offsets.append(0)
+    flags = 1 if mirrored else 0
+    header = BINARY_HEADER.pack(BINARY_MAGIC, BINARY_VERSION, flags, RIG_PRESETS.index(frame.rig), 0, 20, frame.timestamp, *offsets)
+    return header + bytes(payload)
+
+
+FORMATS = ['verbose', 'compact', 'binary']
+
+
+def hello(user_name):
+    return json.dumps({'version': APP_VERSION, 'userName': user_name, 'sessionUUID': str(uuid.uuid4())}).encode()
+
+
+def load_recording(path):
+    ''' packets captured from the app, one JSON packet per line in any of the JSON formats '''
+    with open(path, encoding='utf-8') as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+class Phone:
+    ''' one virtual Pose Camera streaming to a plugin port, recording everything the plugin sends back '''
+
+    def __init__(self, index, args, joint_names, recording):
+        self.name = 'Simulator-%d' % index if args.phones > 1 else 'Simulator'
+        self.address = (args.host, args.port + index)
+        self.args = args
+        self.joint_names = joint_names
+        self.recording = recording
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.handshake = None
+        self.handshakes = 0
+        self.configs = []
+        self.disconnected = False
+        self.packet_format = None
+        self.frames = 0
+        self.sent_bytes = 0
+        self.late_frames = 0
+
+    def connect(self, timeout=10.0):
+        ''' repeats the hello until the plugin answers with a handshake, as the app does '''
+        self.sock.settimeout(1.0)
+        deadline = time.time() + timeout
+        while time.time() < deadline and self.handshake is None:
+            self.sock.sendto(hello(self.name), self.address)
+            try:
+                message, _ = self.sock.recvfrom(65507)
+            except socket.timeout:
+                continue
+            self.receive(message)
+        return self.handshake is not None
+
+    def receive(self, message):
+        try:
+            decoded = json.loads(message.decode('utf-8'))
+        except ValueError:
+            print('%s: unreadable reply %r' % (self.name, message[:80]))
+            return
+        if 'HANDSHAKE' in decoded:
+            self.handshake = decoded['HANDSHAKE']
+            self.handshakes += 1
+        elif 'CONFIG' in decoded:
+            self.configs.append(decoded['CONFIG'])
+            print('%s: received config %s' % (self.name, decoded['CONFIG']))
+        elif 'DISCONNECT' in decoded.get('REQUESTS', []):
+            self.disconnected = True
+            print('%s: disconnect requested' % self.name)
+
+    def poll(self):
+        ''' reads any replies waiting on the socket without blocking the stream '''
+        self.sock.setblocking(False)
+        while True:
+            try:
+                message, _ = self.sock.recvfrom(65507)
+            except (BlockingIOError, socket.error):
+                return
+            self.receive(message)
+
+    def encoder(self):
+        if self.packet_format == 'verbose':
+            return lambda frame: encode_verbose(frame, self.joint_names)
+        return {'compact': encode_compact, 'binary': encode_binary}[self.packet_format]
+
+    def packets(self, start):
+        ''' endless packets, synthetic or looped from the recording with timestamps rewritten so none are stale '''
+        rig = self.handshake.get('rig', 'UE4')
+        hands = self.handshake.get('mode', 'Room') not in ('RoomBodyOnly', 'PortraitBodyOnly')
+        face = self.handshake.get('face', 'NO') == 'YES'
+        hands = hands if self.args.hands == 'auto' else self.args.hands == 'on'
+        face = face if self.args.face == 'auto' else self.args.face == 'on'
+        encode = None if self.recording else self.encoder()
+        i = 0
+        while True:
+            t = time.time() - start
+            if self.recording:
+                packet = dict(self.recording[i % len(self.recording)])
+                packet['Timestamp'] = t
+                yield json.dumps(packet, separators=(',', ':')).encode()
+            else:
+                yield encode(SyntheticFrame(rig, t, hands, face))
+            i += 1
+
+    def stream(self):
+        if not self.connect():
+            print('%s: no handshake received from %s:%d' % (self.name, *self.address))
+            return
+        print('%s: received handshake %s' % (self.name, self.handshake))
+        requested = ['verbose', 'compact', 'binary'][min(2, int(self.handshake.get('packetFormat', 1)))]
+        self.packet_format = 'recorded' if self.recording else (self.args.format or requested)
+
+        interval = 1.0 / self.args.fps
+        start = time.time()
+        for packet in self.packets(start):
+            if time.time() - start >= self.args.seconds or self.disconnected:
+                break
+            self.sock.sendto(packet, self.address)
+            self.frames += 1
+            self.sent_bytes += len(packet)
+            self.poll()
+            delay = start + self.frames * interval - time.time()
+            if delay < 0:
+                self.late_frames += 1
+            time.sleep(max(0.0, delay))
+
+    def report(self):
+        if self.handshake is None:
+            return
+        print('%s: sent %d %s frames to port %d, average %d bytes, %d late.  Plugin sent %d handshakes, %d configs%s' % (
+            self.name, self.frames, self.packet_format, self.address[1], self.sent_bytes // max(1, self.frames), self.late_frames,
+            self.handshakes, len(self.configs), ' and requested a disconnect' if self.disconnected else ''))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pose Camera loopback simulator')
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=8080, help='port of the first phone, further phones use the following ports')
+    parser.add_argument('--phones', type=int, default=1, help='number of virtual phones streaming concurrently')
+    parser.add_argument('--format', choices=FORMATS, default=None,
+                        help='packet format to stream.  Defaults to the packetFormat requested in the handshake')
+    parser.add_argument('--recording', default=None, help='replay packets from this file, one JSON packet per line, instead of synthetic ones')
+    parser.add_argument('--hands', choices=['auto', 'on', 'off'], default='auto', help='auto follows the mode in the handshake')
+    parser.add_argument('--face', choices=['auto', 'on', 'off'], default='auto', help='auto follows the face setting in the handshake')
+    parser.add_argument('--fps', type=float, default=60.0)
+    parser.add_argument('--seconds', type=float, default=30.0)
+    args = parser.parse_args()
+
+    joint_names = load_joint_names() if args.format in ('verbose', None) and not args.recording else None
+    recording = load_recording(args.recording) if args.recording else None
+    phones = [Phone(i, args, joint_names, recording) for i in range(args.phones)]
+    threads = [threading.Thread(target=phone.stream, daemon=True) for phone in phones]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for phone in phones:
+        phone.report()
+
+
+if __name__ == '__main__':
+    main()